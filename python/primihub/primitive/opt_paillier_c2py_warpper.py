@@ -1,5 +1,13 @@
+import numpy as np
 import opt_paillier_c2py
 
+# c++ key handle cached in key object by opt_paillier_c2py,
+# it is rebuilt from the other attributes after the key is unpickled
+_KEY_HANDLE_ATTR = "_key_handle"
+
+def _key_attributes(key):
+    return {k: v for k, v in key.__dict__.items() if k != _KEY_HANDLE_ATTR}
+
 class Opt_paillier_public_key(object):
     """
     Attributes:
@@ -23,7 +31,10 @@ class Opt_paillier_public_key(object):
         pass
     
     def __str__(self):
-        return str(self.__dict__)
+        return str(_key_attributes(self))
+
+    def __getstate__(self):
+        return _key_attributes(self)
 
 class Opt_paillier_secret_key(object):
     """
@@ -52,7 +63,10 @@ class Opt_paillier_secret_key(object):
         pass
 
     def __str__(self):
-        return str(self.__dict__)
+        return str(_key_attributes(self))
+
+    def __getstate__(self):
+        return _key_attributes(self)
 
 class Opt_paillier_ciphertext(object):
     """
@@ -143,3 +157,119 @@ def opt_paillier_cons_mul(pub, op1_cipher_text, op2_cons_value):
     opt_paillier_c2py.opt_paillier_cons_mul_warpper(cons_mul_res_cipher_text, op1_cipher_text, str(op2_cons_value), pub)
 
     return cons_mul_res_cipher_text
+
+class Opt_paillier_batch_pack_ciphertext(object):
+    """
+    Attributes:
+        ciphertexts  numpy.ndarray of uint8, shape (num, cipher_bytes)
+        crtMod       dict   <-> CrtMod
+        pack_size    int, number of packed plaintexts
+    """
+    def __init__(self, ciphertexts, crtMod, pack_size):
+        self.ciphertexts = ciphertexts
+        self.crtMod = crtMod
+        self.pack_size = pack_size
+
+# batch api: plaintexts are int64 arrays, ciphertexts are uint8 arrays of
+# shape (num, cipher_bytes), computed by num_threads threads without GIL,
+# num_threads = 0 uses all cores
+
+def opt_paillier_batch_encrypt(pub, plain_texts, num_threads=0):
+    plain_texts = np.ascontiguousarray(plain_texts, dtype=np.int64).ravel()
+    return opt_paillier_c2py.opt_paillier_batch_encrypt_warpper(pub, plain_texts, num_threads)
+
+def opt_paillier_batch_encrypt_crt(pub, prv, plain_texts, num_threads=0):
+    plain_texts = np.ascontiguousarray(plain_texts, dtype=np.int64).ravel()
+    return opt_paillier_c2py.opt_paillier_batch_encrypt_crt_warpper(pub, prv, plain_texts, num_threads)
+
+def opt_paillier_batch_decrypt_crt(pub, prv, cipher_texts, num_threads=0):
+    return opt_paillier_c2py.opt_paillier_batch_decrypt_crt_warpper(pub, prv, cipher_texts, num_threads)
+
+def opt_paillier_batch_add(pub, op1_cipher_texts, op2_cipher_texts, num_threads=0):
+    return opt_paillier_c2py.opt_paillier_batch_add_warpper(pub, op1_cipher_texts, op2_cipher_texts, num_threads)
+
+def opt_paillier_batch_cons_mul(pub, op1_cipher_texts, op2_cons_values, num_threads=0):
+    op2_cons_values = np.ascontiguousarray(op2_cons_values, dtype=np.int64).ravel()
+    return opt_paillier_c2py.opt_paillier_batch_cons_mul_warpper(pub, op1_cipher_texts, op2_cons_values, num_threads)
+
+def opt_paillier_batch_pack_encrypt_crt(pub, prv, plain_texts, crt_mod=None, num_threads=0):
+    plain_texts = np.ascontiguousarray(plain_texts, dtype=np.int64).ravel()
+    ciphertexts, crt_mod = opt_paillier_c2py.opt_paillier_batch_pack_encrypt_crt_warpper(
+        pub, prv, plain_texts, crt_mod, num_threads)
+    return Opt_paillier_batch_pack_ciphertext(ciphertexts, crt_mod, len(plain_texts))
+
+def opt_paillier_batch_pack_decrypt_crt(pub, prv, pack_cipher_text, num_threads=0):
+    if not isinstance (pack_cipher_text, Opt_paillier_batch_pack_ciphertext):
+        print("opt_paillier_batch_pack_decrypt_crt pack_cipher_text should be type of Opt_paillier_batch_pack_ciphertext()")
+        return
+
+    return opt_paillier_c2py.opt_paillier_batch_pack_decrypt_crt_warpper(
+        pub, prv, pack_cipher_text.ciphertexts, pack_cipher_text.pack_size,
+        pack_cipher_text.crtMod, num_threads)
+
+# aggregation over ciphertext vectors, every vector is a ciphertext array of
+# the batch api or an Opt_paillier_batch_pack_ciphertext, all of the same
+# shape and crtMod, packed slots are aggregated element-wise
+
+def _stack_cipher_texts(cipher_texts_list):
+    if len(cipher_texts_list) == 0:
+        raise ValueError("cipher_texts_list should not be empty")
+    first = cipher_texts_list[0]
+    if not isinstance(first, Opt_paillier_batch_pack_ciphertext):
+        return np.concatenate(cipher_texts_list), None
+    for pack in cipher_texts_list:
+        if pack.pack_size != first.pack_size or pack.crtMod != first.crtMod:
+            raise ValueError("pack ciphertexts should have same pack_size and crtMod")
+    return np.concatenate([pack.ciphertexts for pack in cipher_texts_list]), first
+
+def _unstack_cipher_texts(ciphertexts, rows, pack):
+    res = np.split(ciphertexts, rows)
+    if pack is not None:
+        res = [Opt_paillier_batch_pack_ciphertext(r, pack.crtMod, pack.pack_size) for r in res]
+    return res
+
+def opt_paillier_batch_sum(pub, cipher_texts_list, num_threads=0):
+    ciphertexts, pack = _stack_cipher_texts(cipher_texts_list)
+    res = opt_paillier_c2py.opt_paillier_batch_sum_warpper(
+        pub, ciphertexts, len(cipher_texts_list), num_threads)
+    return _unstack_cipher_texts(res, 1, pack)[0]
+
+def opt_paillier_batch_inner_product(pub, scalars, cipher_texts_list, num_threads=0):
+    """
+    Returns:
+        sum of scalars[j] * cipher_texts_list[j]
+    """
+    scalars = np.ascontiguousarray(scalars, dtype=np.int64).ravel()
+    ciphertexts, pack = _stack_cipher_texts(cipher_texts_list)
+    res = opt_paillier_c2py.opt_paillier_batch_inner_product_warpper(
+        pub, ciphertexts, scalars, num_threads)
+    return _unstack_cipher_texts(res, 1, pack)[0]
+
+def opt_paillier_batch_matvec(pub, matrix, cipher_texts_list, num_threads=0):
+    """
+    Returns:
+        list of len(matrix), item i is sum of matrix[i][j] * cipher_texts_list[j]
+    """
+    matrix = np.ascontiguousarray(matrix, dtype=np.int64)
+    ciphertexts, pack = _stack_cipher_texts(cipher_texts_list)
+    res = opt_paillier_c2py.opt_paillier_batch_matvec_warpper(
+        pub, matrix, ciphertexts, num_threads)
+    return _unstack_cipher_texts(res, matrix.shape[0], pack)
+
+# precomputed obfuscators, encryption of pub takes obfuscators from a pool
+# filled by num_threads background threads instead of computing h_s^r inline,
+# prv is optional and speeds up precomputation
+
+def opt_paillier_start_obfuscator_pool(pub, prv=None, capacity=100000, num_threads=1):
+    opt_paillier_c2py.opt_paillier_start_obfuscator_pool_warpper(pub, prv, capacity, num_threads)
+
+def opt_paillier_stop_obfuscator_pool(pub):
+    opt_paillier_c2py.opt_paillier_stop_obfuscator_pool_warpper(pub)
+
+def opt_paillier_obfuscator_pool_stat(pub):
+    """
+    Returns:
+        dict of capacity, depth, produced, consumed, fallback, refill_rate(/s),
+        empty if pool is not started
+    """
+    return opt_paillier_c2py.opt_paillier_obfuscator_pool_stat_warpper(pub)
@@ -18,6 +18,8 @@
 
 #include "src/primihub/util/network/mpc_channel.h"
 #include "src/primihub/util/network/link_context.h"
+#include "src/primihub/util/network/shm_channel.h"
+#include "src/primihub/util/network/shm_link_context.h"
 #include "src/primihub/node/server_config.h"
 
 namespace primihub {
@@ -254,18 +256,41 @@ int AlgorithmBase::initPartyComm() {
   LOG(INFO) << "job_id: " << job_id << " task_id: "
             << task_id << " request id: " << request_id;
 
-  auto recv_channel = link_ctx->getChannel(this->proxy_node_);
-  // The 'osuCrypto::Channel' will consider it to be a unique_ptr and will
-  // reset the unique_ptr, so the 'osuCrypto::Channel' will delete it.
+  auto self_node = this->party_config_.SelfPartyInfo();
+  std::shared_ptr<network::IChannel> recv_channel{nullptr};
+  // shared memory ring is used only for party on the same host
+  auto build_channel = [&](const std::string& peer_party_name,
+                           const Node& peer_node,
+                           std::shared_ptr<network::IChannel> send_channel)
+      -> std::shared_ptr<ph_link::ChannelBase> {
+    if (link_ctx->linkMode() == network::LinkMode::SHARED_MEMORY &&
+        network::ShmLinkContext::IsSameHost(self_node, peer_node)) {
+      auto ring_size =
+          static_cast<network::ShmLinkContext*>(link_ctx)->ringSize();
+      try {
+        return std::make_shared<network::ShmChannel>(
+            this->party_name(), peer_party_name, link_ctx, ring_size);
+      } catch (std::exception& e) {
+        LOG(ERROR) << "build shared memory channel failed, " << e.what();
+        return nullptr;
+      }
+    }
+    if (recv_channel == nullptr) {
+      recv_channel = link_ctx->getChannel(this->proxy_node_);
+    }
+    // The 'osuCrypto::Channel' will consider it to be a unique_ptr and will
+    // reset the unique_ptr, so the 'osuCrypto::Channel' will delete it.
+    return std::make_shared<network::MPCTaskChannel>(
+        this->party_name(), peer_party_name,
+        link_ctx, send_channel, recv_channel);
+  };
   auto channel_impl_prev =
-      std::make_shared<network::MPCTaskChannel>(
-          this->party_name(), party_name_prev,
-          link_ctx, base_channel_prev, recv_channel);
-
+      build_channel(party_name_prev, party_node_prev, base_channel_prev);
   auto channel_impl_next =
-      std::make_shared<network::MPCTaskChannel>(
-          this->party_name(), party_name_next,
-          link_ctx, base_channel_next, recv_channel);
+      build_channel(party_name_next, party_node_next, base_channel_next);
+  if (channel_impl_prev == nullptr || channel_impl_next == nullptr) {
+    return -1;
+  }
 
   ph_link::Channel chl_prev(channel_impl_prev);
   ph_link::Channel chl_next(channel_impl_next);
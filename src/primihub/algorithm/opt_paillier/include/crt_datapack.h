@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <vector>
 #include <cstdlib>
+#include <cstdint>
 #include "powmod.h"
 #include "utils.h"
 
@@ -42,6 +43,22 @@ void data_retrieve_crt(
   const size_t data_size,
   const int radix = 10);
 
+/**
+ * @brief packing and retrieving of int64 values,
+ * retrieving fails if a value does not fit in int64
+ */
+void data_packing_crt_si(
+  mpz_t res,
+  const int64_t* seq,
+  const size_t seq_size,
+  const CrtMod* crtmod);
+
+bool data_retrieve_crt_si(
+  int64_t* seq,
+  const mpz_t pack,
+  const CrtMod* crtmod,
+  const size_t data_size);
+
 // void data_packing_mul(
 //   mpz_t res,
 //   const mpz_t cipher_pack,
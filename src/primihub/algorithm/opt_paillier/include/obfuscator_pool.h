@@ -0,0 +1,88 @@
+/**
+  \file 		obfuscator_pool.h
+  \brief		precomputed obfuscators of opt paillier encryption
+ */
+
+#ifndef __OPT_PAILLIER_OBFUSCATOR_POOL__
+#define __OPT_PAILLIER_OBFUSCATOR_POOL__
+
+#include <gmp.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "paillier.h"
+
+struct obfuscator_pool_stat_t {
+  size_t capacity;
+  size_t depth;// obfuscators ready in pool
+  uint64_t produced;
+  uint64_t consumed;
+  uint64_t fallback;// computed inline because pool was drained
+  double refill_rate;// obfuscators produced per second since start
+};
+
+/**
+ * @brief bounded pool of obfuscators h_s^r mod n^2 of one public key
+ *
+ * background threads keep the pool filled, encryption takes one
+ * obfuscator and only does a modular multiplication online,
+ * obfuscator is computed inline when the pool is drained.
+ * with secret key, obfuscators are computed by crt and fixed-base,
+ * keys must outlive the pool
+ *
+ */
+class ObfuscatorPool {
+ public:
+  ObfuscatorPool(
+    const opt_public_key_t* pub,
+    const opt_secret_key_t* prv,
+    size_t capacity,
+    size_t num_threads = 1);
+  ~ObfuscatorPool();
+  ObfuscatorPool(const ObfuscatorPool&) = delete;
+  ObfuscatorPool& operator=(const ObfuscatorPool&) = delete;
+
+  void start();
+  void stop();
+  /* obfuscator must be initialized */
+  void get(mpz_t obfuscator);
+  void compute(mpz_t obfuscator) const;
+  obfuscator_pool_stat_t stat();
+  const opt_public_key_t* pub() const { return pub_; }
+
+ private:
+  void fill_thread();
+
+  const opt_public_key_t* pub_{nullptr};
+  const opt_secret_key_t* prv_{nullptr};
+  size_t capacity_{0};
+  size_t num_threads_{1};
+  /* ring buffer of obfuscators */
+  mpz_t* slots_{nullptr};
+  size_t head_{0};
+  size_t count_{0};
+  size_t pending_{0};
+  bool stop_{true};
+  std::mutex mtx_;
+  std::condition_variable not_full_cv_;
+  std::vector<std::thread> threads_;
+  std::chrono::steady_clock::time_point start_time_;
+  uint64_t produced_{0};
+  uint64_t consumed_{0};
+  std::atomic<uint64_t> fallback_{0};
+};
+
+/**
+ * @brief encryption with obfuscator taken from pool
+ *
+ */
+void opt_paillier_encrypt_pool(
+  mpz_t res,
+  ObfuscatorPool* pool,
+  const mpz_t plaintext);
+
+#endif
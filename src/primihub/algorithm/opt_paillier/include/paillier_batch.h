@@ -0,0 +1,164 @@
+/**
+  \file 		paillier_batch.h
+  \brief		batch operations of opt paillier on contiguous buffers
+ */
+
+#ifndef __OPT_PAILLIER_BATCH__
+#define __OPT_PAILLIER_BATCH__
+
+#include <gmp.h>
+#include <cstddef>
+#include <cstdint>
+#include "paillier.h"
+#include "crt_datapack.h"
+#include "obfuscator_pool.h"
+
+/**
+ * @brief fixed-width encoding of ciphertext
+ *
+ * ciphertext (< n^2) is stored as little-endian bytes padded to
+ * whole 64-bit limbs, every ciphertext of a buffer takes
+ * opt_paillier_cipher_bytes(pub) bytes
+ *
+ */
+size_t opt_paillier_cipher_bytes(
+  const opt_public_key_t* pub);
+
+void opt_paillier_cipher_export(
+  uint8_t* buf,
+  const mpz_t ciphertext,
+  const size_t cipher_bytes);
+
+void opt_paillier_cipher_import(
+  mpz_t ciphertext,
+  const uint8_t* buf,
+  const size_t cipher_bytes);
+
+/**
+ * @brief batch functions
+ *
+ * element i of the inputs is processed into element i of res,
+ * work is split over num_threads threads, 0 means hardware concurrency,
+ * plaintext is int64, negative value is encoded as n + value,
+ * decryption returns false if any plaintext does not fit in int64
+ *
+ */
+void opt_paillier_batch_encrypt(
+  uint8_t* res,
+  const int64_t* plaintexts,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const size_t num_threads = 0);
+
+void opt_paillier_batch_encrypt_crt_fb(
+  uint8_t* res,
+  const int64_t* plaintexts,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const opt_secret_key_t* prv,
+  const size_t num_threads = 0);
+
+void opt_paillier_batch_encrypt_pool(
+  uint8_t* res,
+  const int64_t* plaintexts,
+  const size_t num,
+  ObfuscatorPool* pool,
+  const size_t num_threads = 0);
+
+bool opt_paillier_batch_decrypt_crt(
+  int64_t* res,
+  const uint8_t* ciphertexts,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const opt_secret_key_t* prv,
+  const size_t num_threads = 0);
+
+void opt_paillier_batch_add(
+  uint8_t* res,
+  const uint8_t* op1,
+  const uint8_t* op2,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const size_t num_threads = 0);
+
+void opt_paillier_batch_constant_mul(
+  uint8_t* res,
+  const uint8_t* op1,
+  const int64_t* op2,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const size_t num_threads = 0);
+
+/**
+ * @brief aggregation kernels
+ *
+ * ciphertexts is a (num x width) matrix of ciphertexts in row-major order,
+ * row j is a vector of width ciphertexts, packed or not, so every kernel
+ * works slot-wise on crt packed ciphertexts as well.
+ *   sum:           res(width) = sum of the num rows
+ *   inner product: res(width) = sum of scalars[j] * row j
+ *   matvec:        res(rows x width) = matrix(rows x num) * ciphertexts
+ * rows are reduced by a tree across threads, negative scalars are applied
+ * by one modular inverse per output ciphertext.
+ * packed slots hold values modulo crt primes, the aggregate of every slot
+ * must stay within int64 and half of the crt prime
+ *
+ */
+void opt_paillier_batch_sum(
+  uint8_t* res,
+  const uint8_t* ciphertexts,
+  const size_t num,
+  const size_t width,
+  const opt_public_key_t* pub,
+  const size_t num_threads = 0);
+
+void opt_paillier_batch_inner_product(
+  uint8_t* res,
+  const uint8_t* ciphertexts,
+  const int64_t* scalars,
+  const size_t num,
+  const size_t width,
+  const opt_public_key_t* pub,
+  const size_t num_threads = 0);
+
+void opt_paillier_batch_matvec(
+  uint8_t* res,
+  const int64_t* matrix,
+  const size_t rows,
+  const uint8_t* ciphertexts,
+  const size_t num,
+  const size_t width,
+  const opt_public_key_t* pub,
+  const size_t num_threads = 0);
+
+/**
+ * @brief batch functions with crt data packing
+ *
+ * every crtmod->crt_size plaintexts are packed into one ciphertext,
+ * res of encryption holds opt_paillier_batch_pack_num(num, crtmod)
+ * ciphertexts, num is the number of plaintexts for both functions
+ *
+ */
+size_t opt_paillier_batch_pack_num(
+  const size_t num,
+  const CrtMod* crtmod);
+
+void opt_paillier_batch_pack_encrypt_crt_fb(
+  uint8_t* res,
+  const int64_t* plaintexts,
+  const size_t num,
+  const CrtMod* crtmod,
+  const opt_public_key_t* pub,
+  const opt_secret_key_t* prv,
+  const size_t num_threads = 0);
+
+bool opt_paillier_batch_pack_decrypt_crt(
+  int64_t* res,
+  const uint8_t* ciphertexts,
+  const size_t num,
+  const CrtMod* crtmod,
+  const opt_public_key_t* pub,
+  const opt_secret_key_t* prv,
+  const size_t num_threads = 0);
+
+#endif
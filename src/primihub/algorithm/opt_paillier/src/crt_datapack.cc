@@ -87,6 +87,64 @@ void data_retrieve_crt(
     mpz_clear(cur);
   }
 
+void data_packing_crt_si(
+  mpz_t res,
+  const int64_t* seq,
+  const size_t seq_size,
+  const CrtMod* crtmod) {
+    if (seq_size > crtmod->crt_size) {
+      throw "size of packing is more than crt's";
+    }
+    mpz_set_ui(res, 0);
+    mpz_t cur, muls, coef;
+    mpz_inits(cur, muls, coef, nullptr);
+    mpz_set_ui(muls, 1);
+    for (size_t i = 0; i < seq_size; ++i) {
+      mpz_mul(muls, muls, crtmod->crt_mod[i]);
+    }
+    for (size_t i = 0; i < seq_size; ++i) {
+      mpz_set_si(cur, seq[i]);
+      if (seq[i] < 0) {
+        mpz_add(cur, cur, crtmod->crt_mod[i]);
+        mpz_mod(cur, cur, crtmod->crt_mod[i]);
+      }
+      mpz_divexact(coef, muls, crtmod->crt_mod[i]);
+      mpz_mul(cur, cur, coef);
+      mpz_invert(coef, coef, crtmod->crt_mod[i]);
+      mpz_mul(cur, cur, coef);
+      mpz_add(res, res, cur);
+      mpz_mod(res, res, muls);
+    }
+    mpz_clears(cur, muls, coef, nullptr);
+  }
+
+bool data_retrieve_crt_si(
+  int64_t* seq,
+  const mpz_t pack,
+  const CrtMod* crtmod,
+  const size_t data_size) {
+    if (data_size > crtmod->crt_size) {
+      throw "size of packing is more than crt's";
+    }
+    bool fits = true;
+    mpz_t cur;
+    mpz_init(cur);
+    for (size_t i = 0; i < data_size; ++i) {
+      mpz_mod(cur, pack, crtmod->crt_mod[i]);
+      if (mpz_cmp(cur, crtmod->crt_half_mod[i]) >= 0) {
+        mpz_sub(cur, cur, crtmod->crt_mod[i]);
+      }
+      if (!mpz_fits_slong_p(cur)) {
+        fits = false;
+        seq[i] = 0;
+        continue;
+      }
+      seq[i] = mpz_get_si(cur);
+    }
+    mpz_clear(cur);
+    return fits;
+  }
+
 // void data_packing_mul(
 //   mpz_t res,
 //   const mpz_t cipher_pack,
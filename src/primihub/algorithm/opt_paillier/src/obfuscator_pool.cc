@@ -0,0 +1,141 @@
+/**
+  \file 		obfuscator_pool.cc
+  \brief		precomputed obfuscators of opt paillier encryption
+ */
+
+#include "../include/obfuscator_pool.h"
+#include "../include/utils.h"
+#include <algorithm>
+#include <cstdlib>
+
+ObfuscatorPool::ObfuscatorPool(
+  const opt_public_key_t* pub,
+  const opt_secret_key_t* prv,
+  size_t capacity,
+  size_t num_threads)
+  : pub_(pub), prv_(prv), capacity_(std::max<size_t>(capacity, 1)),
+    num_threads_(std::max<size_t>(num_threads, 1)) {
+    slots_ = (mpz_t*)malloc(sizeof(mpz_t) * capacity_);
+    for (size_t i = 0; i < capacity_; ++i) {
+      mpz_init(slots_[i]);
+    }
+  }
+
+ObfuscatorPool::~ObfuscatorPool() {
+    stop();
+    for (size_t i = 0; i < capacity_; ++i) {
+      mpz_clear(slots_[i]);
+    }
+    free(slots_);
+    slots_ = nullptr;
+  }
+
+void ObfuscatorPool::start() {
+    std::lock_guard<std::mutex> lck(mtx_);
+    if (!stop_) {
+      return;
+    }
+    stop_ = false;
+    start_time_ = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_threads_; ++i) {
+      threads_.emplace_back([this]() { fill_thread(); });
+    }
+  }
+
+void ObfuscatorPool::stop() {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      stop_ = true;
+      threads.swap(threads_);
+    }
+    not_full_cv_.notify_all();
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+void ObfuscatorPool::compute(
+  mpz_t obfuscator) const {
+    aby_prng(obfuscator, pub_->lbits);
+    if (prv_ != nullptr) {
+      opt_paillier_mod_n_squared_crt_fb(obfuscator, obfuscator, pub_, prv_);
+    } else {
+      mpz_powm(obfuscator, pub_->h_s, obfuscator, pub_->n_squared);
+    }
+  }
+
+void ObfuscatorPool::fill_thread() {
+    mpz_t obfuscator;
+    mpz_init(obfuscator);
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lck(mtx_);
+        not_full_cv_.wait(lck, [this]() {
+          return stop_ || count_ + pending_ < capacity_;
+        });
+        if (stop_) {
+          break;
+        }
+        pending_++;
+      }
+      compute(obfuscator);
+      std::lock_guard<std::mutex> lck(mtx_);
+      pending_--;
+      mpz_swap(slots_[(head_ + count_) % capacity_], obfuscator);
+      count_++;
+      produced_++;
+    }
+    mpz_clear(obfuscator);
+  }
+
+void ObfuscatorPool::get(
+  mpz_t obfuscator) {
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      if (count_ > 0) {
+        mpz_swap(obfuscator, slots_[head_]);
+        head_ = (head_ + 1) % capacity_;
+        count_--;
+        consumed_++;
+        not_full_cv_.notify_one();
+        return;
+      }
+    }
+    fallback_.fetch_add(1, std::memory_order_relaxed);
+    compute(obfuscator);
+  }
+
+obfuscator_pool_stat_t ObfuscatorPool::stat() {
+    obfuscator_pool_stat_t stat;
+    std::lock_guard<std::mutex> lck(mtx_);
+    stat.capacity = capacity_;
+    stat.depth = count_;
+    stat.produced = produced_;
+    stat.consumed = consumed_;
+    stat.fallback = fallback_.load(std::memory_order_relaxed);
+    stat.refill_rate = 0.0;
+    if (produced_ > 0) {
+      std::chrono::duration<double> elapse =
+          std::chrono::steady_clock::now() - start_time_;
+      if (elapse.count() > 0) {
+        stat.refill_rate = produced_ / elapse.count();
+      }
+    }
+    return stat;
+  }
+
+void opt_paillier_encrypt_pool(
+  mpz_t res,
+  ObfuscatorPool* pool,
+  const mpz_t plaintext) {
+    const opt_public_key_t* pub = pool->pub();
+    mpz_t r;
+    mpz_init(r);
+    pool->get(r);
+    mpz_mul(res, plaintext, pub->n);
+    mpz_add_ui(res, res, 1);
+    mpz_mul(res, res, r);
+    mpz_mod(res, res, pub->n_squared);
+    mpz_clear(r);
+  }
@@ -0,0 +1,540 @@
+/**
+  \file 		paillier_batch.cc
+  \brief		batch operations of opt paillier on contiguous buffers
+ */
+
+#include "../include/paillier_batch.h"
+#include "../include/utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+size_t resolve_threads(
+  const size_t num,
+  size_t num_threads) {
+    if (num_threads == 0) {
+      num_threads = std::thread::hardware_concurrency();
+    }
+    return std::max<size_t>(std::min(num_threads, num), 1);
+  }
+
+/**
+ * @brief split [0, num) into ranges and run func(begin, end) on each
+ * range in its own thread, returns false if any range fails
+ *
+ */
+template <typename Func>
+bool parallel_run(
+  const size_t num,
+  size_t num_threads,
+  Func func) {
+    if (num == 0) {
+      return true;
+    }
+    num_threads = resolve_threads(num, num_threads);
+    if (num_threads == 1) {
+      return func(0, num);
+    }
+    size_t step = ceil_divide(num, num_threads);
+    std::vector<std::future<bool>> futs;
+    for (size_t begin = 0; begin < num; begin += step) {
+      size_t end = std::min(num, begin + step);
+      futs.push_back(std::async(std::launch::async, func, begin, end));
+    }
+    bool success = true;
+    for (auto& fut : futs) {
+      success = fut.get() && success;
+    }
+    return success;
+  }
+
+void set_plaintext_si(
+  mpz_t res,
+  const int64_t value,
+  const opt_public_key_t* pub) {
+    mpz_set_si(res, value);
+    if (value < 0) {
+      mpz_add(res, res, pub->n);
+    }
+  }
+
+bool get_plaintext_si(
+  int64_t* res,
+  mpz_t value,
+  const opt_public_key_t* pub) {
+    if (mpz_cmp(value, pub->half_n) >= 0) {
+      mpz_sub(value, value, pub->n);
+    }
+    if (!mpz_fits_slong_p(value)) {
+      *res = 0;
+      return false;
+    }
+    *res = mpz_get_si(value);
+    return true;
+  }
+
+mpz_t* new_mpz_array(
+  const size_t num) {
+    mpz_t* res = (mpz_t*)malloc(sizeof(mpz_t) * num);
+    for (size_t i = 0; i < num; ++i) {
+      mpz_init(res[i]);
+    }
+    return res;
+  }
+
+void free_mpz_array(
+  mpz_t* arr,
+  const size_t num) {
+    for (size_t i = 0; i < num; ++i) {
+      mpz_clear(arr[i]);
+    }
+    free(arr);
+  }
+
+void import_ciphertexts(
+  mpz_t* res,
+  const uint8_t* ciphertexts,
+  const size_t num,
+  const size_t cipher_bytes,
+  const size_t num_threads) {
+    parallel_run(num, num_threads, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        opt_paillier_cipher_import(res[i], ciphertexts + i * cipher_bytes,
+                                   cipher_bytes);
+      }
+      return true;
+    });
+  }
+
+/**
+ * pos[k] *= prod c[j][k]^s[j] for s[j] > 0 and neg[k] *= prod c[j][k]^-s[j]
+ * for s[j] < 0, over rows [row_begin, row_end) and columns
+ * [col_begin, col_end), all scalars are 1 if scalars is nullptr
+ */
+void accumulate_rows(
+  mpz_t* pos,
+  mpz_t* neg,
+  const mpz_t* ciphers,
+  const int64_t* scalars,
+  const size_t row_begin,
+  const size_t row_end,
+  const size_t col_begin,
+  const size_t col_end,
+  const size_t width,
+  const opt_public_key_t* pub) {
+    mpz_t tmp;
+    mpz_init(tmp);
+    for (size_t j = row_begin; j < row_end; ++j) {
+      int64_t scalar = scalars == nullptr ? 1 : scalars[j];
+      if (scalar == 0) {
+        continue;
+      }
+      mpz_t* acc = scalar > 0 ? pos : neg;
+      uint64_t exp = scalar > 0 ? static_cast<uint64_t>(scalar) :
+                                  0 - static_cast<uint64_t>(scalar);
+      for (size_t k = col_begin; k < col_end; ++k) {
+        if (exp == 1) {
+          mpz_mul(acc[k], acc[k], ciphers[j * width + k]);
+        } else {
+          mpz_powm_ui(tmp, ciphers[j * width + k], exp, pub->n_squared);
+          mpz_mul(acc[k], acc[k], tmp);
+        }
+        mpz_mod(acc[k], acc[k], pub->n_squared);
+      }
+    }
+    mpz_clear(tmp);
+  }
+
+/**
+ * res[k] = pos[k] * neg[k]^-1 mod n^2, exported to buffer
+ */
+void export_aggregate(
+  uint8_t* res,
+  mpz_t* pos,
+  mpz_t* neg,
+  const size_t col_begin,
+  const size_t col_end,
+  const size_t cipher_bytes,
+  const opt_public_key_t* pub) {
+    for (size_t k = col_begin; k < col_end; ++k) {
+      if (mpz_cmp_ui(neg[k], 1) != 0) {
+        mpz_invert(neg[k], neg[k], pub->n_squared);
+        mpz_mul(pos[k], pos[k], neg[k]);
+        mpz_mod(pos[k], pos[k], pub->n_squared);
+      }
+      opt_paillier_cipher_export(res + k * cipher_bytes, pos[k], cipher_bytes);
+    }
+  }
+
+/**
+ * aggregate rows of ciphers into res, columns are split over threads if
+ * there are enough of them, otherwise rows are split and the partial
+ * results are combined by a tree reduction
+ */
+void aggregate_rows(
+  uint8_t* res,
+  const mpz_t* ciphers,
+  const int64_t* scalars,
+  const size_t num,
+  const size_t width,
+  const opt_public_key_t* pub,
+  size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    if (width == 0) {
+      return;
+    }
+    if (num_threads == 0) {
+      num_threads = std::thread::hardware_concurrency();
+    }
+    size_t parts = resolve_threads(num, num_threads);
+    if (parts == 1 || width >= num_threads) {
+      parallel_run(width, num_threads, [&](size_t begin, size_t end) {
+        mpz_t* pos = new_mpz_array(width);
+        mpz_t* neg = new_mpz_array(width);
+        for (size_t k = begin; k < end; ++k) {
+          mpz_set_ui(pos[k], 1);
+          mpz_set_ui(neg[k], 1);
+        }
+        accumulate_rows(pos, neg, ciphers, scalars, 0, num, begin, end,
+                        width, pub);
+        export_aggregate(res, pos, neg, begin, end, cipher_bytes, pub);
+        free_mpz_array(pos, width);
+        free_mpz_array(neg, width);
+        return true;
+      });
+      return;
+    }
+
+    size_t step = ceil_divide(num, parts);
+    parts = ceil_divide(num, step);
+    mpz_t* pos = new_mpz_array(parts * width);
+    mpz_t* neg = new_mpz_array(parts * width);
+    parallel_run(parts, parts, [&](size_t begin, size_t end) {
+      for (size_t p = begin; p < end; ++p) {
+        for (size_t k = 0; k < width; ++k) {
+          mpz_set_ui(pos[p * width + k], 1);
+          mpz_set_ui(neg[p * width + k], 1);
+        }
+        accumulate_rows(pos + p * width, neg + p * width, ciphers, scalars,
+                        p * step, std::min(num, (p + 1) * step), 0, width,
+                        width, pub);
+      }
+      return true;
+    });
+    for (size_t stride = 1; stride < parts; stride *= 2) {
+      size_t pairs = ceil_divide(parts - stride, 2 * stride);
+      parallel_run(pairs, pairs, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          size_t dst = i * 2 * stride * width;
+          size_t src = dst + stride * width;
+          for (size_t k = 0; k < width; ++k) {
+            mpz_mul(pos[dst + k], pos[dst + k], pos[src + k]);
+            mpz_mod(pos[dst + k], pos[dst + k], pub->n_squared);
+            mpz_mul(neg[dst + k], neg[dst + k], neg[src + k]);
+            mpz_mod(neg[dst + k], neg[dst + k], pub->n_squared);
+          }
+        }
+        return true;
+      });
+    }
+    export_aggregate(res, pos, neg, 0, width, cipher_bytes, pub);
+    free_mpz_array(pos, parts * width);
+    free_mpz_array(neg, parts * width);
+  }
+}  // namespace
+
+size_t opt_paillier_cipher_bytes(
+  const opt_public_key_t* pub) {
+    size_t bits = mpz_sizeinbase(pub->n_squared, 2);
+    return ceil_divide(bits, 64) * sizeof(uint64_t);
+  }
+
+void opt_paillier_cipher_export(
+  uint8_t* buf,
+  const mpz_t ciphertext,
+  const size_t cipher_bytes) {
+    memset(buf, 0, cipher_bytes);
+    mpz_export(buf, nullptr, -1, 1, 0, 0, ciphertext);
+  }
+
+void opt_paillier_cipher_import(
+  mpz_t ciphertext,
+  const uint8_t* buf,
+  const size_t cipher_bytes) {
+    mpz_import(ciphertext, cipher_bytes, -1, 1, 0, 0, buf);
+  }
+
+void opt_paillier_batch_encrypt(
+  uint8_t* res,
+  const int64_t* plaintexts,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    parallel_run(num, num_threads, [&](size_t begin, size_t end) {
+      mpz_t plain_text, cipher_text;
+      mpz_inits(plain_text, cipher_text, nullptr);
+      for (size_t i = begin; i < end; ++i) {
+        set_plaintext_si(plain_text, plaintexts[i], pub);
+        opt_paillier_encrypt(cipher_text, pub, plain_text);
+        opt_paillier_cipher_export(res + i * cipher_bytes,
+                                   cipher_text, cipher_bytes);
+      }
+      mpz_clears(plain_text, cipher_text, nullptr);
+      return true;
+    });
+  }
+
+void opt_paillier_batch_encrypt_crt_fb(
+  uint8_t* res,
+  const int64_t* plaintexts,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const opt_secret_key_t* prv,
+  const size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    parallel_run(num, num_threads, [&](size_t begin, size_t end) {
+      mpz_t plain_text, cipher_text;
+      mpz_inits(plain_text, cipher_text, nullptr);
+      for (size_t i = begin; i < end; ++i) {
+        set_plaintext_si(plain_text, plaintexts[i], pub);
+        opt_paillier_encrypt_crt_fb(cipher_text, pub, prv, plain_text);
+        opt_paillier_cipher_export(res + i * cipher_bytes,
+                                   cipher_text, cipher_bytes);
+      }
+      mpz_clears(plain_text, cipher_text, nullptr);
+      return true;
+    });
+  }
+
+void opt_paillier_batch_encrypt_pool(
+  uint8_t* res,
+  const int64_t* plaintexts,
+  const size_t num,
+  ObfuscatorPool* pool,
+  const size_t num_threads) {
+    const opt_public_key_t* pub = pool->pub();
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    parallel_run(num, num_threads, [&](size_t begin, size_t end) {
+      mpz_t plain_text, cipher_text;
+      mpz_inits(plain_text, cipher_text, nullptr);
+      for (size_t i = begin; i < end; ++i) {
+        set_plaintext_si(plain_text, plaintexts[i], pub);
+        opt_paillier_encrypt_pool(cipher_text, pool, plain_text);
+        opt_paillier_cipher_export(res + i * cipher_bytes,
+                                   cipher_text, cipher_bytes);
+      }
+      mpz_clears(plain_text, cipher_text, nullptr);
+      return true;
+    });
+  }
+
+bool opt_paillier_batch_decrypt_crt(
+  int64_t* res,
+  const uint8_t* ciphertexts,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const opt_secret_key_t* prv,
+  const size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    return parallel_run(num, num_threads, [&](size_t begin, size_t end) {
+      bool fits = true;
+      mpz_t cipher_text, decrypt_text;
+      mpz_inits(cipher_text, decrypt_text, nullptr);
+      for (size_t i = begin; i < end; ++i) {
+        opt_paillier_cipher_import(cipher_text, ciphertexts + i * cipher_bytes,
+                                   cipher_bytes);
+        opt_paillier_decrypt_crt(decrypt_text, pub, prv, cipher_text);
+        fits = get_plaintext_si(res + i, decrypt_text, pub) && fits;
+      }
+      mpz_clears(cipher_text, decrypt_text, nullptr);
+      return fits;
+    });
+  }
+
+void opt_paillier_batch_add(
+  uint8_t* res,
+  const uint8_t* op1,
+  const uint8_t* op2,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    parallel_run(num, num_threads, [&](size_t begin, size_t end) {
+      mpz_t cipher_op1, cipher_op2, cipher_res;
+      mpz_inits(cipher_op1, cipher_op2, cipher_res, nullptr);
+      for (size_t i = begin; i < end; ++i) {
+        opt_paillier_cipher_import(cipher_op1, op1 + i * cipher_bytes,
+                                   cipher_bytes);
+        opt_paillier_cipher_import(cipher_op2, op2 + i * cipher_bytes,
+                                   cipher_bytes);
+        opt_paillier_add(cipher_res, cipher_op1, cipher_op2, pub);
+        opt_paillier_cipher_export(res + i * cipher_bytes,
+                                   cipher_res, cipher_bytes);
+      }
+      mpz_clears(cipher_op1, cipher_op2, cipher_res, nullptr);
+      return true;
+    });
+  }
+
+void opt_paillier_batch_constant_mul(
+  uint8_t* res,
+  const uint8_t* op1,
+  const int64_t* op2,
+  const size_t num,
+  const opt_public_key_t* pub,
+  const size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    parallel_run(num, num_threads, [&](size_t begin, size_t end) {
+      mpz_t cipher_op1, cons_value, cipher_res;
+      mpz_inits(cipher_op1, cons_value, cipher_res, nullptr);
+      for (size_t i = begin; i < end; ++i) {
+        opt_paillier_cipher_import(cipher_op1, op1 + i * cipher_bytes,
+                                   cipher_bytes);
+        set_plaintext_si(cons_value, op2[i], pub);
+        opt_paillier_constant_mul(cipher_res, cipher_op1, cons_value, pub);
+        opt_paillier_cipher_export(res + i * cipher_bytes,
+                                   cipher_res, cipher_bytes);
+      }
+      mpz_clears(cipher_op1, cons_value, cipher_res, nullptr);
+      return true;
+    });
+  }
+
+void opt_paillier_batch_sum(
+  uint8_t* res,
+  const uint8_t* ciphertexts,
+  const size_t num,
+  const size_t width,
+  const opt_public_key_t* pub,
+  const size_t num_threads) {
+    opt_paillier_batch_inner_product(res, ciphertexts, nullptr, num, width,
+                                     pub, num_threads);
+  }
+
+void opt_paillier_batch_inner_product(
+  uint8_t* res,
+  const uint8_t* ciphertexts,
+  const int64_t* scalars,
+  const size_t num,
+  const size_t width,
+  const opt_public_key_t* pub,
+  const size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    mpz_t* ciphers = new_mpz_array(num * width);
+    import_ciphertexts(ciphers, ciphertexts, num * width, cipher_bytes,
+                       num_threads);
+    aggregate_rows(res, ciphers, scalars, num, width, pub, num_threads);
+    free_mpz_array(ciphers, num * width);
+  }
+
+void opt_paillier_batch_matvec(
+  uint8_t* res,
+  const int64_t* matrix,
+  const size_t rows,
+  const uint8_t* ciphertexts,
+  const size_t num,
+  const size_t width,
+  const opt_public_key_t* pub,
+  const size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    mpz_t* ciphers = new_mpz_array(num * width);
+    import_ciphertexts(ciphers, ciphertexts, num * width, cipher_bytes,
+                       num_threads);
+    size_t threads = num_threads == 0 ? std::thread::hardware_concurrency() :
+                                        num_threads;
+    if (rows >= threads) {
+      // one output row per task, no reduction across threads
+      parallel_run(rows, threads, [&](size_t begin, size_t end) {
+        mpz_t* pos = new_mpz_array(width);
+        mpz_t* neg = new_mpz_array(width);
+        for (size_t i = begin; i < end; ++i) {
+          for (size_t k = 0; k < width; ++k) {
+            mpz_set_ui(pos[k], 1);
+            mpz_set_ui(neg[k], 1);
+          }
+          accumulate_rows(pos, neg, ciphers, matrix + i * num, 0, num,
+                          0, width, width, pub);
+          export_aggregate(res + i * width * cipher_bytes, pos, neg,
+                           0, width, cipher_bytes, pub);
+        }
+        free_mpz_array(pos, width);
+        free_mpz_array(neg, width);
+        return true;
+      });
+    } else {
+      for (size_t i = 0; i < rows; ++i) {
+        aggregate_rows(res + i * width * cipher_bytes, ciphers,
+                       matrix + i * num, num, width, pub, threads);
+      }
+    }
+    free_mpz_array(ciphers, num * width);
+  }
+
+size_t opt_paillier_batch_pack_num(
+  const size_t num,
+  const CrtMod* crtmod) {
+    return ceil_divide(num, crtmod->crt_size);
+  }
+
+void opt_paillier_batch_pack_encrypt_crt_fb(
+  uint8_t* res,
+  const int64_t* plaintexts,
+  const size_t num,
+  const CrtMod* crtmod,
+  const opt_public_key_t* pub,
+  const opt_secret_key_t* prv,
+  const size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    size_t pack_num = opt_paillier_batch_pack_num(num, crtmod);
+    parallel_run(pack_num, num_threads, [&](size_t begin, size_t end) {
+      mpz_t pack, cipher_text;
+      mpz_inits(pack, cipher_text, nullptr);
+      for (size_t i = begin; i < end; ++i) {
+        size_t pos = i * crtmod->crt_size;
+        size_t data_size = std::min(num - pos, crtmod->crt_size);
+        data_packing_crt_si(pack, plaintexts + pos, data_size, crtmod);
+        opt_paillier_encrypt_crt_fb(cipher_text, pub, prv, pack);
+        opt_paillier_cipher_export(res + i * cipher_bytes,
+                                   cipher_text, cipher_bytes);
+      }
+      mpz_clears(pack, cipher_text, nullptr);
+      return true;
+    });
+  }
+
+bool opt_paillier_batch_pack_decrypt_crt(
+  int64_t* res,
+  const uint8_t* ciphertexts,
+  const size_t num,
+  const CrtMod* crtmod,
+  const opt_public_key_t* pub,
+  const opt_secret_key_t* prv,
+  const size_t num_threads) {
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+    size_t pack_num = opt_paillier_batch_pack_num(num, crtmod);
+    return parallel_run(pack_num, num_threads, [&](size_t begin, size_t end) {
+      bool fits = true;
+      mpz_t cipher_text, decrypt_text;
+      mpz_inits(cipher_text, decrypt_text, nullptr);
+      for (size_t i = begin; i < end; ++i) {
+        size_t pos = i * crtmod->crt_size;
+        size_t data_size = std::min(num - pos, crtmod->crt_size);
+        opt_paillier_cipher_import(cipher_text, ciphertexts + i * cipher_bytes,
+                                   cipher_bytes);
+        opt_paillier_decrypt_crt(decrypt_text, pub, prv, cipher_text);
+        // aggregates with negative scalars wrap around n
+        if (mpz_cmp(decrypt_text, pub->half_n) >= 0) {
+          mpz_sub(decrypt_text, decrypt_text, pub->n);
+        }
+        fits = data_retrieve_crt_si(res + pos, decrypt_text,
+                                    crtmod, data_size) && fits;
+      }
+      mpz_clears(cipher_text, decrypt_text, nullptr);
+      return fits;
+    });
+  }
@@ -0,0 +1,229 @@
+#include "../include/paillier.h"
+#include "../include/paillier_batch.h"
+#include "../include/crt_datapack.h"
+#include "../include/obfuscator_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+/**
+ * compare batch api with one by one calls on the calling thread,
+ * usage: batch_bench [num_values] [max_threads]
+ */
+namespace {
+double elapse_ms(std::chrono::high_resolution_clock::time_point start) {
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      end - start).count() / 1000.0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t num = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+  size_t max_threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) :
+                                  std::thread::hardware_concurrency();
+  opt_public_key_t* pub;
+  opt_secret_key_t* prv;
+  opt_paillier_keygen(112, &pub, &prv);
+  CrtMod* crtmod;
+  init_crt(&crtmod, 28, 70);
+
+  std::default_random_engine e;
+  std::uniform_int_distribution<int64_t> u(-1000000, 1000000);
+  std::vector<int64_t> plain1(num), plain2(num), expected(num);
+  for (size_t i = 0; i < num; ++i) {
+    plain1[i] = u(e);
+    plain2[i] = u(e);
+    expected[i] = plain1[i] + plain2[i];
+  }
+  size_t cipher_bytes = opt_paillier_cipher_bytes(pub);
+  std::cout << "values: " << num << " ciphertext bytes: " << cipher_bytes
+            << std::endl;
+
+  // baseline, one value at a time on calling thread
+  {
+    mpz_t plain_text, cipher_text, decrypt_text;
+    mpz_inits(plain_text, cipher_text, decrypt_text, nullptr);
+    auto st = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < num; ++i) {
+      mpz_set_si(plain_text, plain1[i]);
+      if (plain1[i] < 0) {
+        mpz_add(plain_text, plain_text, pub->n);
+      }
+      opt_paillier_encrypt_crt_fb(cipher_text, pub, prv, plain_text);
+    }
+    double encrypt_cost = elapse_ms(st);
+    st = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < num; ++i) {
+      opt_paillier_decrypt_crt(decrypt_text, pub, prv, cipher_text);
+    }
+    double decrypt_cost = elapse_ms(st);
+    std::cout << "serial encrypt(ms): " << encrypt_cost
+              << " decrypt(ms): " << decrypt_cost << std::endl;
+    mpz_clears(plain_text, cipher_text, decrypt_text, nullptr);
+  }
+
+  std::vector<uint8_t> cipher1(num * cipher_bytes);
+  std::vector<uint8_t> cipher2(num * cipher_bytes);
+  std::vector<uint8_t> cipher_sum(num * cipher_bytes);
+  std::vector<int64_t> result(num);
+  size_t pack_num = opt_paillier_batch_pack_num(num, crtmod);
+  std::vector<uint8_t> pack_cipher(pack_num * cipher_bytes);
+  int error = 0;
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    auto st = std::chrono::high_resolution_clock::now();
+    opt_paillier_batch_encrypt_crt_fb(cipher1.data(), plain1.data(), num,
+                                      pub, prv, threads);
+    double encrypt_cost = elapse_ms(st);
+    opt_paillier_batch_encrypt_crt_fb(cipher2.data(), plain2.data(), num,
+                                      pub, prv, threads);
+    st = std::chrono::high_resolution_clock::now();
+    opt_paillier_batch_add(cipher_sum.data(), cipher1.data(), cipher2.data(),
+                           num, pub, threads);
+    double add_cost = elapse_ms(st);
+    st = std::chrono::high_resolution_clock::now();
+    bool fits = opt_paillier_batch_decrypt_crt(result.data(),
+        cipher_sum.data(), num, pub, prv, threads);
+    double decrypt_cost = elapse_ms(st);
+    if (!fits || result != expected) {
+      std::cout << "Error: batch add result mismatch" << std::endl;
+      error = 1;
+    }
+    st = std::chrono::high_resolution_clock::now();
+    opt_paillier_batch_pack_encrypt_crt_fb(pack_cipher.data(), plain1.data(),
+                                           num, crtmod, pub, prv, threads);
+    double pack_encrypt_cost = elapse_ms(st);
+    st = std::chrono::high_resolution_clock::now();
+    fits = opt_paillier_batch_pack_decrypt_crt(result.data(),
+        pack_cipher.data(), num, crtmod, pub, prv, threads);
+    double pack_decrypt_cost = elapse_ms(st);
+    if (!fits || result != plain1) {
+      std::cout << "Error: batch pack result mismatch" << std::endl;
+      error = 1;
+    }
+    std::cout << "threads: " << threads
+              << " encrypt(ms): " << encrypt_cost
+              << " add(ms): " << add_cost
+              << " decrypt(ms): " << decrypt_cost
+              << " pack encrypt(ms): " << pack_encrypt_cost
+              << " pack decrypt(ms): " << pack_decrypt_cost << std::endl;
+  }
+
+  // aggregation of rows x width ciphertexts, plain and crt packed
+  {
+    size_t width = std::min<size_t>(num, 100);
+    size_t rows = num / width;
+    size_t out_rows = 4;
+    std::vector<int64_t> scalars(rows), matrix(out_rows * rows);
+    std::vector<int64_t> sum(width, 0), inner(width, 0);
+    std::vector<int64_t> matvec(out_rows * width, 0);
+    for (size_t j = 0; j < rows; ++j) {
+      scalars[j] = u(e) % 1000;
+      for (size_t i = 0; i < out_rows; ++i) {
+        matrix[i * rows + j] = u(e) % 1000;
+      }
+      for (size_t k = 0; k < width; ++k) {
+        int64_t v = plain1[j * width + k];
+        sum[k] += v;
+        inner[k] += scalars[j] * v;
+        for (size_t i = 0; i < out_rows; ++i) {
+          matvec[i * width + k] += matrix[i * rows + j] * v;
+        }
+      }
+    }
+    opt_paillier_batch_encrypt_crt_fb(cipher1.data(), plain1.data(),
+                                      rows * width, pub, prv, max_threads);
+    size_t pack_width = opt_paillier_batch_pack_num(width, crtmod);
+    std::vector<uint8_t> pack_rows(rows * pack_width * cipher_bytes);
+    for (size_t j = 0; j < rows; ++j) {
+      opt_paillier_batch_pack_encrypt_crt_fb(
+          pack_rows.data() + j * pack_width * cipher_bytes,
+          plain1.data() + j * width, width, crtmod, pub, prv, max_threads);
+    }
+    std::vector<uint8_t> agg(out_rows * width * cipher_bytes);
+    std::vector<int64_t> agg_result(out_rows * width);
+    auto check = [&](const char* name, const std::vector<int64_t>& expect,
+                     size_t out_num, bool packed) {
+      bool fits = packed ?
+          opt_paillier_batch_pack_decrypt_crt(agg_result.data(), agg.data(),
+              out_num, crtmod, pub, prv, 1) :
+          opt_paillier_batch_decrypt_crt(agg_result.data(), agg.data(),
+              out_num, pub, prv, 1);
+      if (!fits || !std::equal(expect.begin(), expect.begin() + out_num,
+                               agg_result.begin())) {
+        std::cout << "Error: " << name << " result mismatch" << std::endl;
+        error = 1;
+      }
+    };
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+      auto st = std::chrono::high_resolution_clock::now();
+      opt_paillier_batch_sum(agg.data(), cipher1.data(), rows, width,
+                             pub, threads);
+      double sum_cost = elapse_ms(st);
+      check("sum", sum, width, false);
+      st = std::chrono::high_resolution_clock::now();
+      opt_paillier_batch_inner_product(agg.data(), cipher1.data(),
+                                       scalars.data(), rows, width,
+                                       pub, threads);
+      double inner_cost = elapse_ms(st);
+      check("inner product", inner, width, false);
+      st = std::chrono::high_resolution_clock::now();
+      opt_paillier_batch_matvec(agg.data(), matrix.data(), out_rows,
+                                cipher1.data(), rows, width, pub, threads);
+      double matvec_cost = elapse_ms(st);
+      check("matvec", matvec, out_rows * width, false);
+      st = std::chrono::high_resolution_clock::now();
+      opt_paillier_batch_inner_product(agg.data(), pack_rows.data(),
+                                       scalars.data(), rows, pack_width,
+                                       pub, threads);
+      double pack_inner_cost = elapse_ms(st);
+      check("pack inner product", inner, width, true);
+      std::cout << "threads: " << threads
+                << " rows: " << rows << " width: " << width
+                << " sum(ms): " << sum_cost
+                << " inner product(ms): " << inner_cost
+                << " matvec(ms): " << matvec_cost
+                << " pack inner product(ms): " << pack_inner_cost
+                << std::endl;
+    }
+  }
+
+  // online encryption with precomputed obfuscators
+  {
+    size_t pool_num = std::min<size_t>(num, 1000);
+    ObfuscatorPool pool(pub, prv, pool_num, std::max<size_t>(max_threads, 1));
+    pool.start();
+    while (pool.stat().depth < pool_num) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto stat = pool.stat();
+    std::cout << "obfuscator pool filled, depth: " << stat.depth
+              << " refill rate(/s): " << stat.refill_rate << std::endl;
+    pool.stop();
+    auto st = std::chrono::high_resolution_clock::now();
+    opt_paillier_batch_encrypt_pool(cipher1.data(), plain1.data(), pool_num,
+                                    &pool, 1);
+    double online_cost = elapse_ms(st);
+    opt_paillier_batch_decrypt_crt(result.data(), cipher1.data(), pool_num,
+                                   pub, prv, 1);
+    if (!std::equal(result.begin(), result.begin() + pool_num,
+                    plain1.begin())) {
+      std::cout << "Error: pool encryption result mismatch" << std::endl;
+      error = 1;
+    }
+    stat = pool.stat();
+    std::cout << "pool encrypt(ms): " << online_cost
+              << " per value(us): " << online_cost * 1000 / pool_num
+              << " consumed: " << stat.consumed
+              << " fallback: " << stat.fallback << std::endl;
+  }
+
+  free_crt(crtmod);
+  opt_paillier_freepubkey(pub);
+  opt_paillier_freeprvkey(prv);
+  return error;
+}
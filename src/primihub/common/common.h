@@ -19,6 +19,30 @@ namespace primihub {
 
 [[maybe_unused]] static uint16_t ABY3_TOTAL_PARTY_NUM = 3;
 [[maybe_unused]] static uint64_t LIMITED_PACKAGE_SIZE = 3 * 1024 * 1024;  // 4M
+// max number of messages on the fly which have not been acked by peer
+[[maybe_unused]] static uint64_t DATA_STREAM_WINDOW_SIZE = 64;
+// each DataStream holds a grpc sync server thread until its channel is closed,
+// stream beyond this limit is rejected and sender falls back to Send rpc
+[[maybe_unused]] static int MAX_DATA_STREAMS = 256;
+// time to wait for peer to ack the rest messages when data stream is closed
+[[maybe_unused]] static int DATA_STREAM_CLOSE_TIMEOUT_MS = 10 * 1000;
+// upper limit of grpc sync server threads, larger than
+// MAX_DATA_STREAMS + MAX_SUBSCRIBE_STREAMS to leave room for other rpcs
+[[maybe_unused]] static int GRPC_SERVER_MAX_THREADS = 512;
+// message smaller than this size is not compressed even if compress is enabled
+[[maybe_unused]] static uint64_t COMPRESS_THRESHOLD_SIZE = 4 * 1024;
+// max raw length of one compressed message, length claimed by peer
+// beyond this is rejected before any memory is allocated
+[[maybe_unused]] static uint64_t MAX_DECOMPRESSED_DATA_SIZE =
+    2ULL * 1024 * 1024 * 1024;
+// small messages to the same peer are packed into frames up to this size
+[[maybe_unused]] static uint64_t COALESCE_MAX_FRAME_SIZE = 64 * 1024;
+// pending frame is sent at most this long after its first message
+[[maybe_unused]] static int COALESCE_MAX_DELAY_US = 200;
+// capacity of shared memory ring buffer for each direction between parties
+[[maybe_unused]] static uint64_t SHM_RING_SIZE = 8 * 1024 * 1024;
+// time to wait for peer to create and initialize shared memory ring
+[[maybe_unused]] static int SHM_ATTACH_TIMEOUT_MS = 5*1000;
 // macro defination
 [[maybe_unused]] static const char* ROLE_CLIENT = "CLIENT";
 [[maybe_unused]] static const char* ROLE_SCHEDULER = "SCHEDULER";
@@ -35,7 +59,26 @@ namespace primihub {
 [[maybe_unused]] static int CACHED_TASK_STATUS_TIMEOUT_S = 5;
 [[maybe_unused]] static int SCHEDULE_WORKER_TIMEOUT_S = 20;
 [[maybe_unused]] static int CONTROL_CMD_TIMEOUT_S = 5;
+// limit of data cached for task workers which are not ready yet,
+// for each task and for all tasks of the node
+[[maybe_unused]] static uint64_t EARLY_ARRIVED_DATA_TASK_LIMIT = 64 * 1024 * 1024;
+[[maybe_unused]] static uint64_t EARLY_ARRIVED_DATA_TOTAL_LIMIT = 512 * 1024 * 1024;
+// time to remember a task which failed before its worker is ready
+[[maybe_unused]] static int EARLY_ARRIVED_FAILED_TASK_TIMEOUT_S = 60;
+// pooled task process which is not ready within this time is killed
+[[maybe_unused]] static int TASK_PROCESS_STARTUP_TIMEOUT_MS = 60 * 1000;
+// time to wait for task process to exit after its stdin is closed
+[[maybe_unused]] static int TASK_PROCESS_EXIT_TIMEOUT_MS = 5 * 1000;
+// pool stops replenishing after this many launch failures in a row
+[[maybe_unused]] static int TASK_PROCESS_MAX_LAUNCH_FAILURES = 5;
+// interval to check whether subscriber of recv data has gone
+[[maybe_unused]] static int SUBSCRIBE_CHECK_INTERVAL_MS = 100;
+// each subscription holds a grpc sync server thread until its task ends,
+// subscriber beyond this limit is rejected and falls back to ForwardRecv
+[[maybe_unused]] static int MAX_SUBSCRIBE_STREAMS = 64;
 [[maybe_unused]] static int GRPC_RETRY_MAX_TIMES = 3;
+// rows read at once by task which loads dataset in batches
+[[maybe_unused]] static int64_t DATASET_READ_BATCH_ROWS = 100000;
 // common type defination
 using u64 = uint64_t;
 using i64 = int64_t;
@@ -115,6 +115,75 @@ struct ServerInfo {
   Node host_info;
 };
 
+/**
+ * payload compression for data exchanged between parties
+ * mode: none, zstd, lz4
+*/
+struct LinkCompress {
+  std::string mode{"none"};
+  int level{1};
+  uint64_t threshold{COMPRESS_THRESHOLD_SIZE};
+};
+
+/**
+ * pack consecutive small messages sent to one party into one frame,
+ * all parties of a task must use the same setting
+ * max_frame_size: frame is sent when it reaches this size
+ * max_delay_us: frame is sent this long after its first message,
+ *               0: frame is sent at the end of every send call
+*/
+struct LinkCoalesce {
+  bool enable{false};
+  uint64_t max_frame_size{COALESCE_MAX_FRAME_SIZE};
+  int max_delay_us{COALESCE_MAX_DELAY_US};
+};
+
+/**
+ * data channels of mpc tasks go through shared memory instead of grpc
+ * for parties running on the same host (same ip), channel to party on
+ * another host still uses grpc. all parties on the host must enable it
+ * ring_size: bytes of ring buffer for each direction between two parties
+*/
+struct LinkSharedMemory {
+  bool enable{false};
+  uint64_t ring_size{SHM_RING_SIZE};
+};
+
+struct KeywordPir {
+  bool batch_query{false};
+  int max_batch_delay_ms{0};
+};
+
+/**
+ * pre-warmed task_main processes which execute tasks one after another
+ * pool_size: number of idle processes kept ready, 0: disable
+ * max_task_per_process: process is recycled after executing these tasks
+*/
+struct TaskProcessPool {
+  int pool_size{0};
+  int max_task_per_process{100};
+};
+
+/**
+ * cache for dataset meta resolved from meta service
+ * ttl_ms: 0 disables the cache
+ * negative_ttl_ms: ttl for dataset id which is not found, 0: not cached
+*/
+struct DatasetMetaCache {
+  int64_t ttl_ms{60000};
+  int64_t negative_ttl_ms{5000};
+};
+
+/**
+ * node local cache of datasets loaded by csv/sqlite driver,
+ * saved as arrow ipc file in cache_dir
+ * capacity_mb: 0 disables the cache
+*/
+struct DatasetCache {
+  std::string cache_dir{"data/cache/dataset"};
+  uint64_t capacity_mb{0};
+};
+
 struct Tee {
   bool executor{false};
   bool sgx_enable{false};
@@ -130,6 +199,13 @@ struct NodeConfig {
   std::string notify_server;
   Tee tee_conf;
   ServerInfo proxy_server_cfg;
+  LinkCompress link_compress;
+  LinkCoalesce link_coalesce;
+  LinkSharedMemory link_shared_memory;
+  KeywordPir keyword_pir;
+  TaskProcessPool task_process_pool;
+  DatasetMetaCache dataset_meta_cache;
+  DatasetCache dataset_cache;
 };
 
 }  // namespace primihub::common
@@ -145,6 +221,13 @@ using ServerInfo = primihub::common::ServerInfo;
 using CertificateConfig = primihub::common::CertificateConfig;
 using RedisConfig = primihub::common::RedisConfig;
 using Tee = primihub::common::Tee;
+using LinkCompress = primihub::common::LinkCompress;
+using LinkCoalesce = primihub::common::LinkCoalesce;
+using LinkSharedMemory = primihub::common::LinkSharedMemory;
+using KeywordPir = primihub::common::KeywordPir;
+using TaskProcessPool = primihub::common::TaskProcessPool;
+using DatasetMetaCache = primihub::common::DatasetMetaCache;
+using DatasetCache = primihub::common::DatasetCache;
 
 template <> struct convert<RedisConfig> {
   static Node encode(const RedisConfig &redis_cfg) {
@@ -267,7 +350,9 @@ template <> struct convert<ServerInfo> {
   }
 
   static bool decode(const Node& node, ServerInfo& cfg) {            // NOLINT
-    cfg.mode = node["mode"].as<std::string>();
+    if (node["mode"]) {
+      cfg.mode = node["mode"].as<std::string>();
+    }
     cfg.host_info.ip_ = node["ip"].as<std::string>();
     cfg.host_info.port_ = node["port"].as<int32_t>();
     cfg.host_info.use_tls_ = node["use_tls"].as<bool>();
@@ -276,6 +361,145 @@ template <> struct convert<ServerInfo> {
   }
 };
 
+template <> struct convert<LinkCompress> {
+  static Node encode(const LinkCompress& cfg) {
+    Node node;
+    node["mode"] = cfg.mode;
+    node["level"] = cfg.level;
+    node["threshold"] = cfg.threshold;
+    return node;
+  }
+
+  static bool decode(const Node& node, LinkCompress& cfg) {   // NOLINT
+    if (node["mode"]) {
+      cfg.mode = node["mode"].as<std::string>();
+    }
+    if (node["level"]) {
+      cfg.level = node["level"].as<int>();
+    }
+    if (node["threshold"]) {
+      cfg.threshold = node["threshold"].as<uint64_t>();
+    }
+    return true;
+  }
+};
+
+template <> struct convert<LinkCoalesce> {
+  static Node encode(const LinkCoalesce& cfg) {
+    Node node;
+    node["enable"] = cfg.enable;
+    node["max_frame_size"] = cfg.max_frame_size;
+    node["max_delay_us"] = cfg.max_delay_us;
+    return node;
+  }
+
+  static bool decode(const Node& node, LinkCoalesce& cfg) {   // NOLINT
+    if (node["enable"]) {
+      cfg.enable = node["enable"].as<bool>();
+    }
+    if (node["max_frame_size"]) {
+      cfg.max_frame_size = node["max_frame_size"].as<uint64_t>();
+    }
+    if (node["max_delay_us"]) {
+      cfg.max_delay_us = node["max_delay_us"].as<int>();
+    }
+    return true;
+  }
+};
+
+template <> struct convert<LinkSharedMemory> {
+  static Node encode(const LinkSharedMemory& cfg) {
+    Node node;
+    node["enable"] = cfg.enable;
+    node["ring_size"] = cfg.ring_size;
+    return node;
+  }
+
+  static bool decode(const Node& node, LinkSharedMemory& cfg) {   // NOLINT
+    cfg.enable = node["enable"].as<bool>();
+    if (node["ring_size"]) {
+      cfg.ring_size = node["ring_size"].as<uint64_t>();
+    }
+    return true;
+  }
+};
+
+template <> struct convert<KeywordPir> {
+  static Node encode(const KeywordPir& cfg) {
+    Node node;
+    node["batch_query"] = cfg.batch_query;
+    node["max_batch_delay_ms"] = cfg.max_batch_delay_ms;
+    return node;
+  }
+
+  static bool decode(const Node& node, KeywordPir& cfg) {   // NOLINT
+    if (node["batch_query"]) {
+      cfg.batch_query = node["batch_query"].as<bool>();
+    }
+    if (node["max_batch_delay_ms"]) {
+      cfg.max_batch_delay_ms = node["max_batch_delay_ms"].as<int>();
+    }
+    return true;
+  }
+};
+
+template <> struct convert<TaskProcessPool> {
+  static Node encode(const TaskProcessPool& cfg) {
+    Node node;
+    node["pool_size"] = cfg.pool_size;
+    node["max_task_per_process"] = cfg.max_task_per_process;
+    return node;
+  }
+
+  static bool decode(const Node& node, TaskProcessPool& cfg) {   // NOLINT
+    if (node["pool_size"]) {
+      cfg.pool_size = node["pool_size"].as<int>();
+    }
+    if (node["max_task_per_process"]) {
+      cfg.max_task_per_process = node["max_task_per_process"].as<int>();
+    }
+    return true;
+  }
+};
+
+template <> struct convert<DatasetMetaCache> {
+  static Node encode(const DatasetMetaCache& cfg) {
+    Node node;
+    node["ttl_ms"] = cfg.ttl_ms;
+    node["negative_ttl_ms"] = cfg.negative_ttl_ms;
+    return node;
+  }
+
+  static bool decode(const Node& node, DatasetMetaCache& cfg) {   // NOLINT
+    if (node["ttl_ms"]) {
+      cfg.ttl_ms = node["ttl_ms"].as<int64_t>();
+    }
+    if (node["negative_ttl_ms"]) {
+      cfg.negative_ttl_ms = node["negative_ttl_ms"].as<int64_t>();
+    }
+    return true;
+  }
+};
+
+template <> struct convert<DatasetCache> {
+  static Node encode(const DatasetCache& cfg) {
+    Node node;
+    node["cache_dir"] = cfg.cache_dir;
+    node["capacity_mb"] = cfg.capacity_mb;
+    return node;
+  }
+
+  static bool decode(const Node& node, DatasetCache& cfg) {   // NOLINT
+    if (node["cache_dir"]) {
+      cfg.cache_dir = node["cache_dir"].as<std::string>();
+    }
+    if (node["capacity_mb"]) {
+      cfg.capacity_mb = node["capacity_mb"].as<uint64_t>();
+    }
+    return true;
+  }
+};
+
 template <> struct convert<NodeConfig> {
   static Node encode(const NodeConfig& nc) {
     Node node;
@@ -312,6 +536,29 @@ template <> struct convert<NodeConfig> {
     if (node["tee"]) {
       nc.tee_conf = node["tee"].as<Tee>();
     }
+    if (node["link_compress"]) {
+      nc.link_compress = node["link_compress"].as<LinkCompress>();
+    }
+    if (node["link_coalesce"]) {
+      nc.link_coalesce = node["link_coalesce"].as<LinkCoalesce>();
+    }
+    if (node["link_shared_memory"]) {
+      nc.link_shared_memory =
+          node["link_shared_memory"].as<LinkSharedMemory>();
+    }
+    if (node["keyword_pir"]) {
+      nc.keyword_pir = node["keyword_pir"].as<KeywordPir>();
+    }
+    if (node["task_process_pool"]) {
+      nc.task_process_pool = node["task_process_pool"].as<TaskProcessPool>();
+    }
+    if (node["dataset_meta_cache"]) {
+      nc.dataset_meta_cache =
+          node["dataset_meta_cache"].as<DatasetMetaCache>();
+    }
+    if (node["dataset_cache"]) {
+      nc.dataset_cache = node["dataset_cache"].as<DatasetCache>();
+    }
     return true;
   }
 };
@@ -25,10 +25,12 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <map>
 #include <nlohmann/json.hpp>
 #include "arrow/io/memory.h"
 
 #include "src/primihub/data_store/csv/csv_driver.h"
+#include "src/primihub/data_store/dataset_cache.h"
 #include "src/primihub/data_store/driver.h"
 #include "src/primihub/util/util.h"
 #include "src/primihub/util/file_util.h"
@@ -221,10 +223,8 @@ std::shared_ptr<arrow::Table> ReadCSVData(std::string_view data_buff,
   return Read(input, read_opt, parse_opt, convert_opt);
 }
 
-std::shared_ptr<arrow::Table> ReadCSVFile(const std::string& file_path,
-                                          const ReadOptions& read_opt,
-                                          const ParseOptions& parse_opt,
-                                          const ConvertOptions& convert_opt) {
+std::shared_ptr<arrow::io::InputStream> OpenCSVFile(
+    const std::string& file_path) {
   auto local_fs_options = arrow::fs::LocalFileSystemOptions::Defaults();
   local_fs_options.use_mmap = true;
   arrow::fs::LocalFileSystem local_fs(local_fs_options);
@@ -238,10 +238,48 @@ std::shared_ptr<arrow::Table> ReadCSVFile(const std::string& file_path,
     LOG(ERROR) << err_msg;
     return nullptr;
   }
-  std::shared_ptr<arrow::io::InputStream> input = result_ifstream.ValueOrDie();
+  return result_ifstream.ValueOrDie();
+}
+
+std::shared_ptr<arrow::Table> ReadCSVFile(const std::string& file_path,
+                                          const ReadOptions& read_opt,
+                                          const ParseOptions& parse_opt,
+                                          const ConvertOptions& convert_opt) {
+  auto input = OpenCSVFile(file_path);
+  if (input == nullptr) {
+    return nullptr;
+  }
   return Read(input, read_opt, parse_opt, convert_opt);
 }
 
+/**
+ * reader which parses csv file block by block,
+ * memory usage is bounded by block size instead of file size
+*/
+std::shared_ptr<arrow::csv::StreamingReader> MakeStreamingReader(
+    const std::string& file_path,
+    const ReadOptions& read_opt,
+    const ParseOptions& parse_opt,
+    const ConvertOptions& convert_opt) {
+  auto input = OpenCSVFile(file_path);
+  if (input == nullptr) {
+    return nullptr;
+  }
+  arrow::io::IOContext io_context = arrow::io::default_io_context();
+  auto maybe_reader = arrow::csv::StreamingReader::Make(
+      io_context, input, read_opt, parse_opt, convert_opt);
+  if (!maybe_reader.ok()) {
+    std::stringstream ss;
+    ss << "create streaming reader failed, "
+       << "detail: " << maybe_reader.status();
+    std::string err_msg = ss.str();
+    SetThreadLocalErrorMsg(err_msg);
+    LOG(ERROR) << err_msg;
+    return nullptr;
+  }
+  return maybe_reader.ValueOrDie();
+}
+
 std::string ReadRawData(const std::string& file_path, int64_t line_number) {
   // read data first 100 lines
   std::ifstream csv_data(file_path, std::ios::in);
@@ -371,6 +409,8 @@ CSVCursor::CSVCursor(const std::string& file_path,
 CSVCursor::~CSVCursor() { this->close(); }
 
 void CSVCursor::close() {
+  batch_reader_.reset();
+  pending_batch_.reset();
 }
 
 retcode CSVCursor::ColumnIndexToColumnName(const std::string& file_path,
@@ -526,22 +566,164 @@ std::shared_ptr<Dataset> CSVCursor::read() {
 }
 
 std::shared_ptr<Dataset> CSVCursor::read(int64_t offset, int64_t limit) {
-  return nullptr;
+  if (offset < 0 || limit <= 0) {
+    LOG(ERROR) << "invalid offset: " << offset << " or limit: " << limit;
+    return nullptr;
+  }
+  CsvOptions csv_options;
+  auto ret = MakeCsvOptions(&csv_options);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "make csv file options failed";
+    return nullptr;
+  }
+  // skip title row and rows before offset
+  csv_options.read_options.skip_rows += offset;
+  auto reader = csv::MakeStreamingReader(this->file_path_,
+                                         csv_options.read_options,
+                                         csv_options.parse_options,
+                                         csv_options.convert_options);
+  if (reader == nullptr) {
+    return nullptr;
+  }
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  int64_t num_rows{0};
+  while (num_rows < limit) {
+    std::shared_ptr<arrow::RecordBatch> batch{nullptr};
+    auto status = reader->ReadNext(&batch);
+    if (!status.ok()) {
+      std::stringstream ss;
+      ss << "read data failed, " << "detail: " << status;
+      std::string err_msg = ss.str();
+      SetThreadLocalErrorMsg(err_msg);
+      LOG(ERROR) << err_msg;
+      return nullptr;
+    }
+    if (batch == nullptr) {
+      break;
+    }
+    if (batch->num_rows() > limit - num_rows) {
+      batch = batch->Slice(0, limit - num_rows);
+    }
+    num_rows += batch->num_rows();
+    batches.push_back(std::move(batch));
+  }
+  auto maybe_table = arrow::Table::FromRecordBatches(reader->schema(), batches);
+  if (!maybe_table.ok()) {
+    LOG(ERROR) << "make table failed, " << maybe_table.status();
+    return nullptr;
+  }
+  return std::make_shared<Dataset>(maybe_table.ValueOrDie(), this->driver_);
+}
+
+retcode CSVCursor::ReadNextBatch(int64_t batch_size,
+                                 std::shared_ptr<arrow::RecordBatch>* batch) {
+  if (batch_size <= 0) {
+    LOG(ERROR) << "invalid batch size: " << batch_size;
+    return retcode::FAIL;
+  }
+  if (batch_reader_ == nullptr) {
+    CsvOptions csv_options;
+    auto ret = MakeCsvOptions(batch_data_schema_, &csv_options);
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "make csv file options failed";
+      return retcode::FAIL;
+    }
+    batch_reader_ = csv::MakeStreamingReader(this->file_path_,
+                                             csv_options.read_options,
+                                             csv_options.parse_options,
+                                             csv_options.convert_options);
+    if (batch_reader_ == nullptr) {
+      return retcode::FAIL;
+    }
+  }
+  while (pending_batch_ == nullptr || pending_batch_->num_rows() == 0) {
+    auto status = batch_reader_->ReadNext(&pending_batch_);
+    if (!status.ok()) {
+      std::stringstream ss;
+      ss << "read data failed, " << "detail: " << status;
+      std::string err_msg = ss.str();
+      SetThreadLocalErrorMsg(err_msg);
+      LOG(ERROR) << err_msg;
+      return retcode::FAIL;
+    }
+    if (pending_batch_ == nullptr) {
+      *batch = nullptr;
+      return retcode::SUCCESS;
+    }
+  }
+  // block parsed by reader may be larger than batch_size
+  if (pending_batch_->num_rows() > batch_size) {
+    *batch = pending_batch_->Slice(0, batch_size);
+    pending_batch_ = pending_batch_->Slice(batch_size);
+  } else {
+    *batch = std::move(pending_batch_);
+    pending_batch_ = nullptr;
+  }
+  batch_offset_ += (*batch)->num_rows();
+  return retcode::SUCCESS;
 }
 
 std::shared_ptr<Dataset> CSVCursor::ReadImpl(const std::string& file_path,
     const ReadOptions& read_options,
     const ParseOptions& parse_options,
     const ConvertOptions& convert_options) {
+  auto& dataset_cache = DatasetCache::getInstance();
+  std::string cache_key;
+  if (dataset_cache.Enabled()) {
+    auto ret = CacheKey(file_path, read_options, parse_options,
+                        convert_options, &cache_key);
+    if (ret == retcode::SUCCESS) {
+      auto cached_table = dataset_cache.Get(cache_key);
+      if (cached_table != nullptr) {
+        return std::make_shared<Dataset>(cached_table, this->driver_);
+      }
+    }
+  }
   auto arrow_table = csv::ReadCSVFile(file_path, read_options,
                                       parse_options, convert_options);
   if (arrow_table == nullptr) {
     return nullptr;
   }
+  if (!cache_key.empty()) {
+    dataset_cache.Put(cache_key, arrow_table);
+  }
   auto dataset = std::make_shared<Dataset>(arrow_table, this->driver_);
   return dataset;
 }
 
+retcode CSVCursor::CacheKey(const std::string& file_path,
+                            const ReadOptions& read_options,
+                            const ParseOptions& parse_options,
+                            const ConvertOptions& convert_options,
+                            std::string* cache_key) {
+  std::string stamp;
+  auto ret = DatasetCache::FileStamp(file_path, &stamp);
+  if (ret != retcode::SUCCESS) {
+    return retcode::FAIL;
+  }
+  std::stringstream ss;
+  ss << "CSV|" << file_path << "|" << stamp << "|"
+     << read_options.skip_rows << "|" << parse_options.delimiter << "|";
+  for (const auto& name : read_options.column_names) {
+    ss << name << ",";
+  }
+  ss << "|";
+  for (const auto& name : convert_options.include_columns) {
+    ss << name << ",";
+  }
+  ss << "|";
+  // column_types is unordered
+  std::map<std::string, std::string> column_types;
+  for (const auto& [name, type] : convert_options.column_types) {
+    column_types[name] = type->ToString();
+  }
+  for (const auto& [name, type] : column_types) {
+    ss << name << ":" << type << ",";
+  }
+  *cache_key = ss.str();
+  return retcode::SUCCESS;
+}
+
 std::shared_ptr<Dataset> CSVCursor::ReadImpl(std::string_view input_data,
     const ReadOptions& read_options,
     const ParseOptions& parse_options,
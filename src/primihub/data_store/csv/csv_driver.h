@@ -66,6 +66,12 @@ class CSVCursor : public Cursor {
   std::shared_ptr<Dataset> read(
       const std::shared_ptr<arrow::Schema>& data_schema) override;
   std::shared_ptr<Dataset> read(int64_t offset, int64_t limit) override;
+  /**
+   * keep a streaming reader open across calls,
+   * so the file is parsed only once
+  */
+  retcode ReadNextBatch(int64_t batch_size,
+                        std::shared_ptr<arrow::RecordBatch>* batch) override;
   int write(std::shared_ptr<Dataset> dataset) override;
   void close() override;
 
@@ -94,6 +100,14 @@ class CSVCursor : public Cursor {
   retcode MakeCsvOptions(CsvOptions* options);
   retcode MakeCsvOptions(const std::shared_ptr<arrow::Schema>& data_schema,
                          CsvOptions* options);
+  /**
+   * key of dataset cache: file, file fingerprint and read options
+  */
+  retcode CacheKey(const std::string& file_path,
+                   const ReadOptions& read_opt,
+                   const ParseOptions& parse_opt,
+                   const ConvertOptions& convert_opt,
+                   std::string* cache_key);
 
   std::shared_ptr<Dataset> ReadImpl(const std::string& file_path,
                                     const ReadOptions& read_opt,
@@ -110,6 +124,9 @@ class CSVCursor : public Cursor {
   unsigned long long offset_{0};   // NOLINT
   std::shared_ptr<CSVDriver> driver_;
   std::vector<int> colum_index_;
+  std::shared_ptr<arrow::csv::StreamingReader> batch_reader_{nullptr};
+  // rows parsed by batch_reader_ but not returned yet
+  std::shared_ptr<arrow::RecordBatch> pending_batch_{nullptr};
 };
 
 class CSVDriver : public DataDriver,
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2023 by PrimiHub
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      https://www.apache.org/licenses/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "src/primihub/data_store/dataset_cache.h"
+#include <glog/logging.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "src/primihub/util/hash.h"
+
+namespace primihub {
+namespace fs = std::filesystem;
+namespace {
+constexpr char kCacheFileSuffix[] = ".arrow";
+// key is saved in schema metadata to detect hash collision
+constexpr char kCacheKeyMeta[] = "primihub_dataset_cache_key";
+
+std::string ToHex(const std::string& data) {
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(data.size() * 2);
+  for (unsigned char c : data) {
+    hex.push_back(digits[c >> 4]);
+    hex.push_back(digits[c & 0x0f]);
+  }
+  return hex;
+}
+}  // namespace
+
+retcode DatasetCache::Init(const std::string& cache_dir,
+                           uint64_t capacity_bytes) {
+  if (capacity_bytes == 0) {
+    VLOG(0) << "dataset cache is disabled";
+    return retcode::SUCCESS;
+  }
+  std::error_code ec;
+  fs::create_directories(cache_dir, ec);
+  if (ec) {
+    LOG(ERROR) << "create dataset cache dir: " << cache_dir << " failed, "
+               << ec.message();
+    return retcode::FAIL;
+  }
+  cache_dir_ = cache_dir;
+  capacity_bytes_ = capacity_bytes;
+  LOG(INFO) << "dataset cache dir: " << cache_dir_ << " "
+            << "capacity(bytes): " << capacity_bytes_;
+  return retcode::SUCCESS;
+}
+
+std::string DatasetCache::CachePath(const std::string& key) {
+  Hash hash;
+  return cache_dir_ + "/" + ToHex(hash.HashToString(key)) + kCacheFileSuffix;
+}
+
+retcode DatasetCache::FileStamp(const std::string& file_path,
+                                std::string* stamp) {
+  struct stat file_stat;
+  if (::stat(file_path.c_str(), &file_stat) != 0) {
+    LOG(ERROR) << "stat file: " << file_path << " failed";
+    return retcode::FAIL;
+  }
+  stamp->clear();
+  stamp->append(std::to_string(file_stat.st_size)).append("_")
+        .append(std::to_string(file_stat.st_mtim.tv_sec)).append("_")
+        .append(std::to_string(file_stat.st_mtim.tv_nsec)).append("_")
+        .append(std::to_string(file_stat.st_ino));
+  return retcode::SUCCESS;
+}
+
+std::shared_ptr<arrow::Table> DatasetCache::Get(const std::string& key) {
+  if (!Enabled()) {
+    return nullptr;
+  }
+  auto cache_path = CachePath(key);
+  auto file_result = arrow::io::MemoryMappedFile::Open(
+      cache_path, arrow::io::FileMode::READ);
+  if (!file_result.ok()) {
+    miss_count_.fetch_add(1);
+    return nullptr;
+  }
+  auto reader_result = arrow::ipc::RecordBatchFileReader::Open(
+      file_result.ValueOrDie());
+  if (!reader_result.ok()) {
+    LOG(WARNING) << "open dataset cache: " << cache_path << " failed, "
+                 << reader_result.status();
+    miss_count_.fetch_add(1);
+    return nullptr;
+  }
+  auto reader = reader_result.ValueOrDie();
+  auto metadata = reader->schema()->metadata();
+  int key_index = metadata == nullptr ? -1 : metadata->FindKey(kCacheKeyMeta);
+  if (key_index < 0 || metadata->value(key_index) != key) {
+    VLOG(5) << "dataset cache: " << cache_path << " belongs to other key";
+    miss_count_.fetch_add(1);
+    return nullptr;
+  }
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (int i = 0; i < reader->num_record_batches(); i++) {
+    auto batch_result = reader->ReadRecordBatch(i);
+    if (!batch_result.ok()) {
+      LOG(WARNING) << "read dataset cache: " << cache_path << " failed, "
+                   << batch_result.status();
+      miss_count_.fetch_add(1);
+      return nullptr;
+    }
+    batches.push_back(batch_result.ValueOrDie());
+  }
+  auto table_result = arrow::Table::FromRecordBatches(
+      reader->schema()->RemoveMetadata(), batches);
+  if (!table_result.ok()) {
+    LOG(WARNING) << "build table from dataset cache failed, "
+                 << table_result.status();
+    miss_count_.fetch_add(1);
+    return nullptr;
+  }
+  // mtime of cache file records the last use for eviction
+  ::utimes(cache_path.c_str(), nullptr);
+  auto hit_count = hit_count_.fetch_add(1) + 1;
+  VLOG(5) << "dataset cache hit: " << cache_path << " "
+          << "hit: " << hit_count << " miss: " << miss_count_.load();
+  return table_result.ValueOrDie();
+}
+
+retcode DatasetCache::Put(const std::string& key,
+                          const std::shared_ptr<arrow::Table>& table) {
+  if (!Enabled() || table == nullptr) {
+    return retcode::FAIL;
+  }
+  auto cache_path = CachePath(key);
+  std::stringstream ss;
+  ss << cache_path << ".tmp." << ::getpid() << "."
+     << std::this_thread::get_id();
+  auto tmp_path = ss.str();
+  std::lock_guard<std::mutex> lck(put_mtx_);
+  {
+    auto out_result = arrow::io::FileOutputStream::Open(tmp_path);
+    if (!out_result.ok()) {
+      LOG(ERROR) << "open dataset cache file: " << tmp_path << " failed, "
+                 << out_result.status();
+      return retcode::FAIL;
+    }
+    auto out = out_result.ValueOrDie();
+    auto schema = table->schema()->WithMetadata(
+        arrow::key_value_metadata({kCacheKeyMeta}, {key}));
+    auto writer_result = arrow::ipc::MakeFileWriter(out, schema);
+    if (!writer_result.ok()) {
+      LOG(ERROR) << "create dataset cache writer failed, "
+                 << writer_result.status();
+      return retcode::FAIL;
+    }
+    auto writer = writer_result.ValueOrDie();
+    auto status = writer->WriteTable(*table);
+    if (status.ok()) {
+      status = writer->Close();
+    }
+    if (status.ok()) {
+      status = out->Close();
+    }
+    if (!status.ok()) {
+      LOG(ERROR) << "write dataset cache failed, " << status;
+      fs::remove(tmp_path);
+      return retcode::FAIL;
+    }
+  }
+  std::error_code ec;
+  uint64_t file_size = fs::file_size(tmp_path, ec);
+  if (ec || file_size > capacity_bytes_) {
+    VLOG(5) << "dataset is too large for cache, size: " << file_size;
+    fs::remove(tmp_path, ec);
+    return retcode::FAIL;
+  }
+  Evict(file_size);
+  fs::rename(tmp_path, cache_path, ec);
+  if (ec) {
+    LOG(ERROR) << "rename dataset cache file failed, " << ec.message();
+    fs::remove(tmp_path, ec);
+    return retcode::FAIL;
+  }
+  put_count_.fetch_add(1);
+  VLOG(5) << "put dataset into cache: " << cache_path << " "
+          << "size: " << file_size;
+  return retcode::SUCCESS;
+}
+
+void DatasetCache::Evict(uint64_t incoming_bytes) {
+  // path, size, last use time
+  std::vector<std::tuple<std::string, uint64_t, int64_t>> files;
+  uint64_t total_size{0};
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator(cache_dir_, ec)) {
+    const auto& path = entry.path();
+    if (path.extension() != kCacheFileSuffix) {
+      continue;
+    }
+    struct stat file_stat;
+    if (::stat(path.c_str(), &file_stat) != 0) {
+      continue;
+    }
+    int64_t last_use = file_stat.st_mtim.tv_sec * 1000000000LL +
+                       file_stat.st_mtim.tv_nsec;
+    files.emplace_back(path.string(), file_stat.st_size, last_use);
+    total_size += file_stat.st_size;
+  }
+  if (total_size + incoming_bytes <= capacity_bytes_) {
+    return;
+  }
+  std::sort(files.begin(), files.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return std::get<2>(lhs) < std::get<2>(rhs);
+            });
+  for (const auto& [path, size, last_use] : files) {
+    if (total_size + incoming_bytes <= capacity_bytes_) {
+      break;
+    }
+    // memory mapped by reader is still valid after the file is removed
+    if (fs::remove(path, ec)) {
+      total_size -= size;
+      evict_count_.fetch_add(1);
+      VLOG(5) << "evict dataset cache: " << path;
+    }
+  }
+}
+
+DatasetCacheStat DatasetCache::Stat() {
+  DatasetCacheStat stat;
+  stat.hit_count = hit_count_.load();
+  stat.miss_count = miss_count_.load();
+  stat.put_count = put_count_.load();
+  stat.evict_count = evict_count_.load();
+  return stat;
+}
+}  // namespace primihub
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2023 by PrimiHub
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      https://www.apache.org/licenses/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_PRIMIHUB_DATA_STORE_DATASET_CACHE_H_
+#define SRC_PRIMIHUB_DATA_STORE_DATASET_CACHE_H_
+#include <arrow/api.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "src/primihub/common/common.h"
+
+namespace primihub {
+struct DatasetCacheStat {
+  size_t hit_count{0};
+  size_t miss_count{0};
+  size_t put_count{0};
+  size_t evict_count{0};
+};
+
+/**
+ * node level cache of datasets read by driver cursors.
+ * a dataset is materialized into an arrow ipc file in cache_dir,
+ * named by the hash of the cache key, and later reads of the same key
+ * are served from the memory mapped file without copy.
+ * cache key is built by cursor from dataset source, selected columns
+ * and a fingerprint of the source, such as file size and mtime.
+ * files are shared by all processes of the node using the same cache_dir,
+ * total size is bounded by capacity, least recently used file is evicted
+*/
+class DatasetCache {
+ public:
+  static DatasetCache& getInstance() {
+    static DatasetCache ins;
+    return ins;
+  }
+  /**
+   * capacity_bytes: 0 disables the cache
+  */
+  retcode Init(const std::string& cache_dir, uint64_t capacity_bytes);
+  bool Enabled() {return capacity_bytes_ > 0;}
+  /**
+   * return nullptr if the key is not cached
+  */
+  std::shared_ptr<arrow::Table> Get(const std::string& key);
+  retcode Put(const std::string& key,
+              const std::shared_ptr<arrow::Table>& table);
+  DatasetCacheStat Stat();
+  /**
+   * fingerprint of local file: size, mtime and inode
+  */
+  static retcode FileStamp(const std::string& file_path, std::string* stamp);
+
+ protected:
+  DatasetCache() = default;
+  std::string CachePath(const std::string& key);
+  /**
+   * remove least recently used files until incoming_bytes can be stored
+  */
+  void Evict(uint64_t incoming_bytes);
+
+ private:
+  std::string cache_dir_;
+  uint64_t capacity_bytes_{0};
+  std::mutex put_mtx_;
+  std::atomic<size_t> hit_count_{0};
+  std::atomic<size_t> miss_count_{0};
+  std::atomic<size_t> put_count_{0};
+  std::atomic<size_t> evict_count_{0};
+};
+}  // namespace primihub
+#endif  // SRC_PRIMIHUB_DATA_STORE_DATASET_CACHE_H_
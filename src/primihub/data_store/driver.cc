@@ -15,6 +15,7 @@
  */
 
 #include "src/primihub/data_store/driver.h"
+#include <arrow/compute/api.h>
 #include "src/primihub/util/arrow_wrapper_util.h"
 
 namespace primihub {
@@ -196,6 +197,99 @@ Cursor::MakeArrowSchema(const std::vector<FieldType>& data_schema) {
   VLOG(5) << "arrow_schema: " << arrow_schema->field_names().size();
   return arrow_schema;
 }
+
+retcode Cursor::ReadNextBatch(int64_t batch_size,
+                              std::shared_ptr<arrow::RecordBatch>* batch) {
+  if (batch_size <= 0) {
+    LOG(ERROR) << "invalid batch size: " << batch_size;
+    return retcode::FAIL;
+  }
+  auto dataset = read(batch_offset_, batch_size);
+  if (dataset == nullptr) {
+    LOG(ERROR) << "read data failed, offset: " << batch_offset_ << " "
+               << "limit: " << batch_size;
+    return retcode::FAIL;
+  }
+  auto table_ptr = std::get_if<std::shared_ptr<arrow::Table>>(&dataset->data);
+  if (table_ptr == nullptr) {
+    LOG(ERROR) << "dataset is not organized as table";
+    return retcode::FAIL;
+  }
+  auto& table = *table_ptr;
+  if (table == nullptr || table->num_rows() == 0) {
+    *batch = nullptr;
+    return retcode::SUCCESS;
+  }
+  auto ret = TableToRecordBatch(table, batch);
+  if (ret != retcode::SUCCESS) {
+    return retcode::FAIL;
+  }
+  if (batch_data_schema_ != nullptr) {
+    ret = CastBatch(batch_data_schema_, batch);
+    if (ret != retcode::SUCCESS) {
+      return retcode::FAIL;
+    }
+  }
+  batch_offset_ += (*batch)->num_rows();
+  return retcode::SUCCESS;
+}
+
+retcode Cursor::CastBatch(const std::shared_ptr<arrow::Schema>& data_schema,
+                          std::shared_ptr<arrow::RecordBatch>* batch) {
+  auto& in_batch = *batch;
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  for (int i = 0; i < in_batch->num_columns(); i++) {
+    auto field = in_batch->schema()->field(i);
+    auto column = in_batch->column(i);
+    auto expected_field = data_schema->GetFieldByName(field->name());
+    if (expected_field != nullptr &&
+        !expected_field->type()->Equals(column->type())) {
+      auto result = arrow::compute::Cast(*column, expected_field->type());
+      if (!result.ok()) {
+        LOG(ERROR) << "cast column: " << field->name() << " "
+                   << "to " << expected_field->type()->ToString() << " "
+                   << "failed, " << result.status();
+        return retcode::FAIL;
+      }
+      column = result.ValueOrDie();
+      field = field->WithType(expected_field->type());
+    }
+    fields.push_back(std::move(field));
+    columns.push_back(std::move(column));
+  }
+  *batch = arrow::RecordBatch::Make(arrow::schema(std::move(fields)),
+                                    in_batch->num_rows(),
+                                    std::move(columns));
+  return retcode::SUCCESS;
+}
+
+retcode Cursor::TableToRecordBatch(const std::shared_ptr<arrow::Table>& table,
+                                   std::shared_ptr<arrow::RecordBatch>* batch) {
+  auto combined = table->CombineChunks();
+  if (!combined.ok()) {
+    LOG(ERROR) << "combine chunks failed, " << combined.status();
+    return retcode::FAIL;
+  }
+  auto combined_table = combined.ValueOrDie();
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  for (const auto& column : combined_table->columns()) {
+    if (column->num_chunks() == 0) {
+      auto empty_array = arrow::MakeArrayOfNull(column->type(), 0);
+      if (!empty_array.ok()) {
+        LOG(ERROR) << "make empty array failed, " << empty_array.status();
+        return retcode::FAIL;
+      }
+      columns.push_back(empty_array.ValueOrDie());
+    } else {
+      columns.push_back(column->chunk(0));
+    }
+  }
+  *batch = arrow::RecordBatch::Make(combined_table->schema(),
+                                    combined_table->num_rows(),
+                                    std::move(columns));
+  return retcode::SUCCESS;
+}
 ////////////////////// DataDriver /////////////////////////////
 std::string DataDriver::getDriverType() const {
   return driver_type;
@@ -94,12 +94,42 @@ class Cursor {
   }
 
   virtual std::shared_ptr<Dataset> read(const std::shared_ptr<arrow::Schema>& data_schema) = 0;
+  /**
+   * streaming read for dataset which is too large to be loaded at once,
+   * read at most batch_size rows following the rows of last call,
+   * batch is set to nullptr when all data has been read.
+   * default implementation pages through read(offset, limit),
+   * driver which can keep a reader open should override it
+  */
+  virtual retcode ReadNextBatch(int64_t batch_size,
+                                std::shared_ptr<arrow::RecordBatch>* batch);
+  /**
+   * convert columns returned by ReadNextBatch to data_schema,
+   * the same as read(data_schema), call it before the first ReadNextBatch
+  */
+  void SetBatchSchema(const std::vector<FieldType>& data_schema) {
+    batch_data_schema_ = MakeArrowSchema(data_schema);
+  }
   virtual int write(std::shared_ptr<Dataset> dataset) = 0;
   virtual void close() = 0;
   std::vector<int>& SelectedColumnIndex() {return selected_column_index_;}
 
  protected:
   std::shared_ptr<arrow::Schema> MakeArrowSchema(const std::vector<FieldType>& data_schema);
+  /**
+   * merge all chunks of table into one record batch
+  */
+  retcode TableToRecordBatch(const std::shared_ptr<arrow::Table>& table,
+                             std::shared_ptr<arrow::RecordBatch>* batch);
+  /**
+   * cast columns of batch to the type of field with the same name in data_schema
+  */
+  retcode CastBatch(const std::shared_ptr<arrow::Schema>& data_schema,
+                    std::shared_ptr<arrow::RecordBatch>* batch);
+  // number of rows returned by ReadNextBatch
+  int64_t batch_offset_{0};
+  // schema set by SetBatchSchema, nullptr means schema of dataset
+  std::shared_ptr<arrow::Schema> batch_data_schema_{nullptr};
 
  public:
   std::vector<int> selected_column_index_;
@@ -19,7 +19,9 @@
 #include <arrow/api.h>
 #include <arrow/io/api.h>
 
+#include <charconv>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <sstream>
 
@@ -48,6 +50,10 @@ std::string MySQLAccessInfo::toString() {
         }
         js["query_index"] = std::move(quey_col_info);
     }
+    if (!partition_column_.empty()) {
+        js["partitionColumn"] = this->partition_column_;
+        js["partitionNum"] = this->partition_num_;
+    }
     js["schema"] = SchemaToJsonString();
     ss << std::setw(4) << js;
     return ss.str();
@@ -65,6 +71,12 @@ retcode MySQLAccessInfo::ParseFromJsonImpl(const nlohmann::json& access_info) {
     this->db_name_ = js["dbName"].get<std::string>();
     this->table_name_ = js["tableName"].get<std::string>();
     this->query_colums_.clear();
+    if (js.contains("partitionColumn")) {
+      this->partition_column_ = js["partitionColumn"].get<std::string>();
+    }
+    if (js.contains("partitionNum")) {
+      this->partition_num_ = js["partitionNum"].get<uint32_t>();
+    }
   } catch (std::exception& e) {
     std::stringstream ss;
     ss << "parse access info encountes error, " << e.what();
@@ -114,6 +126,12 @@ retcode MySQLAccessInfo::ParseFromYamlConfigImpl(const YAML::Node& meta_info) {
       std::string query_index = meta_info["query_index"].as<std::string>();
       str_split(query_index, &query_colums_, ',');
     }
+    if (meta_info["partitionColumn"]) {
+      this->partition_column_ = meta_info["partitionColumn"].as<std::string>();
+    }
+    if (meta_info["partitionNum"]) {
+      this->partition_num_ = meta_info["partitionNum"].as<uint32_t>();
+    }
   } catch (std::exception& e) {
     LOG(ERROR) << e.what();
     return retcode::FAIL;
@@ -122,12 +140,6 @@ retcode MySQLAccessInfo::ParseFromYamlConfigImpl(const YAML::Node& meta_info) {
 }
 
 // mysql cursor implementation
-auto sql_result_deleter = [](MYSQL_RES* result) {
-  if (result) {
-    mysql_free_result(result);
-  }
-};
-
 MySQLCursor::MySQLCursor(const std::string& sql, std::shared_ptr<MySQLDriver> driver) {
   this->sql_ = sql;
   this->driver_ = driver;
@@ -149,7 +161,11 @@ MySQLCursor::~MySQLCursor() {
   this->close();
 }
 
-void MySQLCursor::close() {}
+void MySQLCursor::close() {
+  // remaining rows of unbuffered result are discarded before connection close
+  batch_result_.reset();
+  batch_conn_.reset();
+}
 
 std::shared_ptr<arrow::Schema> MySQLCursor::makeArrowSchema() {
   auto arrow_schema = this->driver_->dataSetAccessInfo()->ArrowSchema();
@@ -204,8 +220,7 @@ auto MySQLCursor::getDBConnector(
 retcode MySQLCursor::fetchData(const std::string& query_sql,
                                const std::shared_ptr<arrow::Schema>& table_schema,
                                std::vector<std::shared_ptr<arrow::Array>>* data_arr) {
-  VLOG(5) << "fetchData query sql: " << this->sql_;
-  std::vector<std::vector<std::string>> result_data;
+  VLOG(5) << "fetchData query sql: " << query_sql;
   // fetch data from db
   auto db_connector_ptr = this->getDBConnector(this->driver_->dataSetAccessInfo());
   if (db_connector_ptr == nullptr) {
@@ -213,6 +228,30 @@ retcode MySQLCursor::fetchData(const std::string& query_sql,
     return retcode::FAIL;
   }
   auto db_connector = db_connector_ptr.get();
+  MySQLResultPtr result{nullptr, sql_result_deleter};
+  auto ret = ExecuteQuery(db_connector, query_sql, &result);
+  if (ret != retcode::SUCCESS) {
+    return retcode::FAIL;
+  }
+  int64_t num_rows{0};
+  ret = FetchRows(result.get(), -1, table_schema, data_arr, &num_rows);
+  if (ret != retcode::SUCCESS) {
+    return retcode::FAIL;
+  }
+  if (mysql_errno(db_connector) != 0) {
+    std::stringstream ss;
+    ss << "fetch rows failed: " << mysql_error(db_connector);
+    std::string err_msg = ss.str();
+    SetThreadLocalErrorMsg(err_msg);
+    LOG(ERROR) << err_msg;
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+retcode MySQLCursor::ExecuteQuery(MYSQL* db_connector,
+                                  const std::string& query_sql,
+                                  MySQLResultPtr* result) {
   if (query_sql.empty()) {
     LOG(ERROR) << "query sql is invalid: ";
     return retcode::FAIL;
@@ -225,10 +264,9 @@ retcode MySQLCursor::fetchData(const std::string& query_sql,
     LOG(ERROR) << err_msg;
     return retcode::FAIL;
   }
-  // fetch data
-  std::unique_ptr<MYSQL_RES, decltype(sql_result_deleter)> result{nullptr, sql_result_deleter};
-  result.reset(mysql_use_result(db_connector));
-  if (result == nullptr) {
+  // rows are transferred from server on demand by mysql_fetch_row
+  result->reset(mysql_use_result(db_connector));
+  if (*result == nullptr) {
     std::stringstream ss;
     ss << "fetch result failed: " << mysql_error(db_connector);
     std::string err_msg = ss.str();
@@ -236,7 +274,14 @@ retcode MySQLCursor::fetchData(const std::string& query_sql,
     LOG(ERROR) << err_msg;
     return retcode::FAIL;
   }
-  uint32_t num_fields = mysql_num_fields(result.get());
+  return retcode::SUCCESS;
+}
+
+retcode MySQLCursor::FetchRows(MYSQL_RES* result, int64_t max_rows,
+    const std::shared_ptr<arrow::Schema>& table_schema,
+    std::vector<std::shared_ptr<arrow::Array>>* data_arr,
+    int64_t* num_rows) {
+  uint32_t num_fields = mysql_num_fields(result);
   VLOG(5) << "numbers of fields: " << num_fields;
   size_t selected_fields = this->SelectedColumnIndex().size();
   if (num_fields != selected_fields) {
@@ -248,42 +293,55 @@ retcode MySQLCursor::fetchData(const std::string& query_sql,
     LOG(ERROR) << err_msg;
     return retcode::FAIL;
   }
-  result_data.resize(num_fields);
+  int schema_fields = table_schema->num_fields();
+  if (num_fields > schema_fields) {
+    std::stringstream ss;
+    ss << "index out of range, query size: " << num_fields << " "
+        << "total colnum fields: " << schema_fields;
+    std::string err_msg = ss.str();
+    SetThreadLocalErrorMsg(err_msg);
+    LOG(ERROR) << err_msg;
+    return retcode::FAIL;
+  }
+  // cells are appended to typed builders as rows arrive from server
+  std::vector<arrow_wrapper::util::ArrowColumnBuilder> builders;
+  builders.reserve(num_fields);
+  for (uint32_t i = 0; i < num_fields; i++) {
+    auto& field_ptr = table_schema->field(i);
+    int field_type = field_ptr->type()->id();
+    VLOG(7) << "field_name: " << field_ptr->name() << " type: " << field_type;
+    builders.emplace_back(field_type);
+    if (max_rows > 0) {
+      auto ret = builders.back().Reserve(max_rows);
+      if (ret != retcode::SUCCESS) {
+        return retcode::FAIL;
+      }
+    }
+  }
+  *num_rows = 0;
   MYSQL_ROW row;
-  while (nullptr != (row = mysql_fetch_row(result.get()))) {
-    unsigned long* lengths;
-    lengths = mysql_fetch_lengths(result.get());
+  while ((max_rows < 0 || *num_rows < max_rows) &&
+         nullptr != (row = mysql_fetch_row(result))) {
+    unsigned long* lengths = mysql_fetch_lengths(result);   // NOLINT
     for (uint32_t i = 0; i < num_fields; i++) {
-      std::string item{"NA"};
-      if (lengths[i] > 0) {
-        item = std::string(row[i], lengths[i]);
+      // NULL cell has zero length and is treated as empty cell
+      auto ret = builders[i].Append(row[i], lengths[i]);
+      if (ret != retcode::SUCCESS) {
+        return retcode::FAIL;
       }
-      VLOG(7) << "fetch item: " << item << " length: " << lengths[i];
-      result_data[i].push_back(item);
     }
+    (*num_rows)++;
   }
-
-  int schema_fields = table_schema->num_fields();
-  auto& all_select_index = this->SelectedColumnIndex();
-  for (size_t i = 0; i < selected_fields; i++) {
-    // int index = all_select_index[i];
-    if (i < schema_fields) {
-      auto& field_ptr = table_schema->field(i);
-      int field_type = field_ptr->type()->id();
-      VLOG(7) << "field_name: " << field_ptr->name() << " type: " << field_type;
-      auto array = arrow_wrapper::util::MakeArrowArray(field_type, result_data[i]);
-      data_arr->push_back(std::move(array));
-    } else {
-      std::stringstream ss;
-      ss << "index out of range, current index: " << i << " "
-          << "total colnum fields: " << schema_fields;
-      std::string err_msg = ss.str();
-      SetThreadLocalErrorMsg(err_msg);
-      LOG(ERROR) << err_msg;
+  for (auto& builder : builders) {
+    std::shared_ptr<arrow::Array> array;
+    auto ret = builder.Finish(&array);
+    if (ret != retcode::SUCCESS) {
       return retcode::FAIL;
     }
+    data_arr->push_back(std::move(array));
   }
-  VLOG(5) << "end of fetch data: " << data_arr->size();
+  VLOG(5) << "end of fetch data: " << data_arr->size() << " "
+          << "rows: " << *num_rows;
   return retcode::SUCCESS;
 }
 
@@ -313,22 +371,200 @@ std::shared_ptr<Dataset> MySQLCursor::read(const std::shared_ptr<arrow::Schema>&
 }
 
 std::shared_ptr<Dataset> MySQLCursor::read(int64_t offset, int64_t limit) {
-  return nullptr;
+  if (offset < 0 || limit <= 0) {
+    LOG(ERROR) << "invalid offset: " << offset << " or limit: " << limit;
+    return nullptr;
+  }
+  auto schema = makeArrowSchema();
+  if (schema == nullptr) {
+    return nullptr;
+  }
+  std::string query_sql = this->sql_;
+  query_sql.append(" LIMIT ").append(std::to_string(offset))
+           .append(",").append(std::to_string(limit));
+  std::vector<std::shared_ptr<arrow::Array>> array_data;
+  auto ret = fetchData(query_sql, schema, &array_data);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "fetchdata failed using sql: " << query_sql;
+    return nullptr;
+  }
+  auto table = arrow::Table::Make(schema, array_data);
+  return std::make_shared<Dataset>(table, this->driver_);
 }
 
-std::shared_ptr<Dataset> MySQLCursor::ReadImpl(const std::shared_ptr<arrow::Schema>& schema) {
+retcode MySQLCursor::ReadNextBatch(int64_t batch_size,
+                                   std::shared_ptr<arrow::RecordBatch>* batch) {
+  if (batch_size <= 0) {
+    LOG(ERROR) << "invalid batch size: " << batch_size;
+    return retcode::FAIL;
+  }
+  if (batch_result_ == nullptr) {
+    batch_schema_ = makeArrowSchema();
+    if (batch_schema_ == nullptr) {
+      return retcode::FAIL;
+    }
+    auto db_connector = this->getDBConnector(this->driver_->dataSetAccessInfo());
+    // deleter of lambda type is not assignable, transfer the raw pointer
+    batch_conn_.reset(db_connector.release());
+    if (batch_conn_ == nullptr) {
+      LOG(ERROR) << "connect to db failed";
+      return retcode::FAIL;
+    }
+    auto ret = ExecuteQuery(batch_conn_.get(), this->sql_, &batch_result_);
+    if (ret != retcode::SUCCESS) {
+      batch_conn_.reset();
+      return retcode::FAIL;
+    }
+  }
   std::vector<std::shared_ptr<arrow::Array>> array_data;
+  int64_t num_rows{0};
+  auto ret = FetchRows(batch_result_.get(), batch_size, batch_schema_,
+                       &array_data, &num_rows);
+  if (ret != retcode::SUCCESS) {
+    return retcode::FAIL;
+  }
+  if (num_rows < batch_size && mysql_errno(batch_conn_.get()) != 0) {
+    std::stringstream ss;
+    ss << "fetch rows failed: " << mysql_error(batch_conn_.get());
+    std::string err_msg = ss.str();
+    SetThreadLocalErrorMsg(err_msg);
+    LOG(ERROR) << err_msg;
+    return retcode::FAIL;
+  }
+  if (num_rows == 0) {
+    *batch = nullptr;
+    return retcode::SUCCESS;
+  }
+  *batch = arrow::RecordBatch::Make(batch_schema_, num_rows,
+                                    std::move(array_data));
+  if (batch_data_schema_ != nullptr) {
+    ret = CastBatch(batch_data_schema_, batch);
+    if (ret != retcode::SUCCESS) {
+      return retcode::FAIL;
+    }
+  }
+  batch_offset_ += num_rows;
+  return retcode::SUCCESS;
+}
+
+std::shared_ptr<Dataset> MySQLCursor::ReadImpl(const std::shared_ptr<arrow::Schema>& schema) {
   VLOG(5) << "sql_sql_sql_: " << this->sql_;
-  auto ret = fetchData(this->sql_, schema, &array_data);
+  std::vector<std::string> query_sqls;
+  auto ret = PartitionQuerySQL(&query_sqls);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "build partition query sql failed";
+    return nullptr;
+  }
+  // each partition is fetched by its own connection
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> part_arrays(
+      query_sqls.size());
+  std::vector<std::future<retcode>> futs;
+  for (size_t i = 1; i < query_sqls.size(); i++) {
+    futs.push_back(std::async(std::launch::async, [&, i]() -> retcode {
+      return fetchData(query_sqls[i], schema, &part_arrays[i]);
+    }));
+  }
+  ret = fetchData(query_sqls[0], schema, &part_arrays[0]);
+  for (auto& fut : futs) {
+    if (fut.get() != retcode::SUCCESS) {
+      ret = retcode::FAIL;
+    }
+  }
   if (ret != retcode::SUCCESS) {
     LOG(ERROR) << "fetchdata failed using sql: " << this->sql_;
     return nullptr;
   }
-  auto table = arrow::Table::Make(schema, array_data);
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  size_t num_columns = part_arrays[0].size();
+  for (size_t col = 0; col < num_columns; col++) {
+    arrow::ArrayVector chunks;
+    for (auto& arrays : part_arrays) {
+      chunks.push_back(std::move(arrays[col]));
+    }
+    columns.push_back(std::make_shared<arrow::ChunkedArray>(std::move(chunks)));
+  }
+  auto table = arrow::Table::Make(schema, columns);
   auto dataset = std::make_shared<Dataset>(table, this->driver_);
   return dataset;
 }
 
+retcode MySQLCursor::PartitionQuerySQL(std::vector<std::string>* query_sqls) {
+  query_sqls->clear();
+  auto access_info = dynamic_cast<MySQLAccessInfo*>(
+      this->driver_->dataSetAccessInfo().get());
+  if (access_info == nullptr || access_info->partition_column_.empty() ||
+      access_info->partition_num_ <= 1) {
+    query_sqls->push_back(this->sql_);
+    return retcode::SUCCESS;
+  }
+  const auto& column = access_info->partition_column_;
+  std::string range_sql = "SELECT MIN(`" + column + "`), MAX(`" + column +
+                          "`) FROM `" + access_info->table_name_ + "`";
+  auto db_connector = this->getDBConnector(this->driver_->dataSetAccessInfo());
+  if (db_connector == nullptr) {
+    LOG(ERROR) << "connect to db failed";
+    return retcode::FAIL;
+  }
+  MySQLResultPtr result{nullptr, sql_result_deleter};
+  auto ret = ExecuteQuery(db_connector.get(), range_sql, &result);
+  if (ret != retcode::SUCCESS) {
+    return retcode::FAIL;
+  }
+  MYSQL_ROW row = mysql_fetch_row(result.get());
+  if (row == nullptr || row[0] == nullptr || row[1] == nullptr) {
+    // empty table or no value other than NULL
+    query_sqls->push_back(this->sql_);
+    return retcode::SUCCESS;
+  }
+  unsigned long* lengths = mysql_fetch_lengths(result.get());   // NOLINT
+  int64_t min_value{0};
+  int64_t max_value{0};
+  auto min_result = std::from_chars(row[0], row[0] + lengths[0], min_value);
+  auto max_result = std::from_chars(row[1], row[1] + lengths[1], max_value);
+  if (min_result.ec != std::errc() || max_result.ec != std::errc()) {
+    LOG(WARNING) << "partition column: " << column << " is not integer, "
+                 << "read without partition";
+    query_sqls->push_back(this->sql_);
+    return retcode::SUCCESS;
+  }
+  uint64_t span = static_cast<uint64_t>(max_value) -
+                  static_cast<uint64_t>(min_value);
+  uint64_t step = span / access_info->partition_num_ + 1;
+  for (uint64_t lower_offset = 0; ; lower_offset += step) {
+    auto lower = static_cast<int64_t>(
+        static_cast<uint64_t>(min_value) + lower_offset);
+    // the first and the last partition are open ended,
+    // NULL never matches a range so the first one also takes NULL rows
+    bool first_partition = lower_offset == 0;
+    bool last_partition = span - lower_offset < step;
+    if (first_partition && last_partition) {
+      query_sqls->push_back(this->sql_);
+      break;
+    }
+    std::string query_sql = this->sql_;
+    if (first_partition) {
+      auto upper = static_cast<int64_t>(static_cast<uint64_t>(lower) + step);
+      query_sql.append(" WHERE `").append(column).append("` < ")
+               .append(std::to_string(upper))
+               .append(" OR `").append(column).append("` IS NULL");
+    } else {
+      query_sql.append(" WHERE `").append(column).append("` >= ")
+               .append(std::to_string(lower));
+      if (!last_partition) {
+        auto upper = static_cast<int64_t>(static_cast<uint64_t>(lower) + step);
+        query_sql.append(" AND `").append(column).append("` < ")
+                 .append(std::to_string(upper));
+      }
+    }
+    VLOG(5) << "partition query sql: " << query_sql;
+    query_sqls->push_back(std::move(query_sql));
+    if (last_partition) {
+      break;
+    }
+  }
+  return retcode::SUCCESS;
+}
+
 
 int MySQLCursor::write(std::shared_ptr<Dataset> dataset) {}
 
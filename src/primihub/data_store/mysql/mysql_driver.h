@@ -48,6 +48,14 @@ auto conn_threadsafe_dctor = [](MYSQL* conn) {
   mysql_thread_end();
 };
 
+auto sql_result_deleter = [](MYSQL_RES* result) {
+  if (result) {
+    mysql_free_result(result);
+  }
+};
+using MySQLConnPtr = std::unique_ptr<MYSQL, decltype(conn_threadsafe_dctor)>;
+using MySQLResultPtr = std::unique_ptr<MYSQL_RES, decltype(sql_result_deleter)>;
+
 struct MySQLAccessInfo : public DataSetAccessInfo {
   MySQLAccessInfo() = default;
   MySQLAccessInfo(const std::string& ip, uint32_t port, const std::string& user_name,
@@ -77,6 +85,13 @@ struct MySQLAccessInfo : public DataSetAccessInfo {
   std::string db_name_;
   std::string table_name_;
   std::vector<std::string> query_colums_;
+  /**
+   * optional, integer primary key used to split full read into
+   * partition_num range queries which are fetched in parallel,
+   * rows are returned grouped by partition instead of table order
+  */
+  std::string partition_column_;
+  uint32_t partition_num_{1};
 };
 
 class MySQLCursor : public Cursor {
@@ -90,6 +105,12 @@ class MySQLCursor : public Cursor {
     std::shared_ptr<Dataset> read() override;
     std::shared_ptr<Dataset> read(const std::shared_ptr<arrow::Schema>& data_schema) override;
     std::shared_ptr<Dataset> read(int64_t offset, int64_t limit) override;
+    /**
+     * keep an unbuffered result open on a dedicated connection,
+     * rows are transferred from server batch by batch
+    */
+    retcode ReadNextBatch(int64_t batch_size,
+                          std::shared_ptr<arrow::RecordBatch>* batch) override;
     int write(std::shared_ptr<Dataset> dataset) override;
     void close() override;
 
@@ -101,12 +122,31 @@ class MySQLCursor : public Cursor {
     retcode fetchData(const std::string& query_sql,
                       const std::shared_ptr<arrow::Schema>& data_schema,
                       std::vector<std::shared_ptr<arrow::Array>>* data_arr);
+    retcode ExecuteQuery(MYSQL* db_connector, const std::string& query_sql,
+                         MySQLResultPtr* result);
+    /**
+     * fetch at most max_rows rows from result, -1 for all rows,
+     * cells are converted to arrow arrays of data_schema
+    */
+    retcode FetchRows(MYSQL_RES* result, int64_t max_rows,
+                      const std::shared_ptr<arrow::Schema>& data_schema,
+                      std::vector<std::shared_ptr<arrow::Array>>* data_arr,
+                      int64_t* num_rows);
     std::shared_ptr<arrow::Schema> makeArrowSchema();
+    /**
+     * split sql_ into range queries on partition column,
+     * rows with NULL partition column are read by the first partition,
+     * sql_ itself is returned if partition is not configured
+    */
+    retcode PartitionQuerySQL(std::vector<std::string>* query_sqls);
 
  private:
     std::string sql_;
     size_t offset{0};
     std::shared_ptr<MySQLDriver> driver_{nullptr};
+    std::shared_ptr<arrow::Schema> batch_schema_{nullptr};
+    MySQLConnPtr batch_conn_{nullptr, conn_threadsafe_dctor};
+    MySQLResultPtr batch_result_{nullptr, sql_result_deleter};
 };
 
 class MySQLDriver : public DataDriver, public std::enable_shared_from_this<MySQLDriver> {
@@ -26,6 +26,7 @@
 #include <sstream>
 
 #include <nlohmann/json.hpp>
+#include "src/primihub/data_store/dataset_cache.h"
 #include "src/primihub/data_store/driver.h"
 #include "src/primihub/util/arrow_wrapper_util.h"
 #include "src/primihub/util/util.h"
@@ -108,7 +109,9 @@ SQLiteCursor::SQLiteCursor(const std::string& sql,
 
 SQLiteCursor::~SQLiteCursor() { this->close(); }
 
-void SQLiteCursor::close() {}
+void SQLiteCursor::close() {
+  batch_stmt_.reset();
+}
 
 std::shared_ptr<Dataset> SQLiteCursor::readMeta() {
   std::string query_meta_sql = sql_;
@@ -120,7 +123,31 @@ std::shared_ptr<Dataset> SQLiteCursor::readMeta() {
 // read all data from csv file
 std::shared_ptr<Dataset> SQLiteCursor::read() {
   VLOG(5) << "sql_sql_sql_sql_: " << sql_;
-  return readInternal(sql_);
+  auto& dataset_cache = DatasetCache::getInstance();
+  std::string cache_key;
+  if (dataset_cache.Enabled()) {
+    auto sqlite_access_info = dynamic_cast<SQLiteAccessInfo*>(
+        this->driver_->dataSetAccessInfo().get());
+    std::string stamp;
+    if (sqlite_access_info != nullptr &&
+        DatasetCache::FileStamp(sqlite_access_info->db_path_, &stamp) ==
+            retcode::SUCCESS) {
+      cache_key = "SQLITE|" + sqlite_access_info->db_path_ + "|" +
+                  stamp + "|" + sql_;
+      auto cached_table = dataset_cache.Get(cache_key);
+      if (cached_table != nullptr) {
+        return std::make_shared<Dataset>(cached_table, this->driver_);
+      }
+    }
+  }
+  auto dataset = readInternal(sql_);
+  if (dataset != nullptr && !cache_key.empty()) {
+    auto table = std::get_if<std::shared_ptr<arrow::Table>>(&dataset->data);
+    if (table != nullptr) {
+      dataset_cache.Put(cache_key, *table);
+    }
+  }
+  return dataset;
 }
 
 std::shared_ptr<Dataset> SQLiteCursor::read(const std::shared_ptr<arrow::Schema>& data_schema) {
@@ -128,11 +155,80 @@ std::shared_ptr<Dataset> SQLiteCursor::read(const std::shared_ptr<arrow::Schema>
 }
 
 std::shared_ptr<Dataset> SQLiteCursor::read(int64_t offset, int64_t limit) {
-  return nullptr;
+  if (offset < 0 || limit <= 0) {
+    LOG(ERROR) << "invalid offset: " << offset << " or limit: " << limit;
+    return nullptr;
+  }
+  std::string query_sql = sql_;
+  query_sql.append(" LIMIT ").append(std::to_string(limit))
+           .append(" OFFSET ").append(std::to_string(offset));
+  VLOG(5) << "page query sql: " << query_sql;
+  return readInternal(query_sql);
+}
+
+retcode SQLiteCursor::ReadNextBatch(int64_t batch_size,
+                                    std::shared_ptr<arrow::RecordBatch>* batch) {
+  if (batch_size <= 0) {
+    LOG(ERROR) << "invalid batch size: " << batch_size;
+    return retcode::FAIL;
+  }
+  try {
+    if (batch_stmt_ == nullptr) {
+      auto& db_connector = this->driver_->getDBConnector();
+      if (db_connector == nullptr) {
+        LOG(ERROR) << "db connector for sqlite is invalid";
+        return retcode::FAIL;
+      }
+      batch_stmt_ = std::make_unique<SQLite::Statement>(*db_connector, sql_);
+    }
+    std::vector<std::vector<std::string>> query_result;
+    int64_t num_rows = FetchRows(batch_stmt_.get(), batch_size, &query_result);
+    if (num_rows == 0) {
+      *batch = nullptr;
+      return retcode::SUCCESS;
+    }
+    auto table = MakeTable(query_result);
+    if (table == nullptr) {
+      return retcode::FAIL;
+    }
+    auto ret = TableToRecordBatch(table, batch);
+    if (ret != retcode::SUCCESS) {
+      return retcode::FAIL;
+    }
+    if (batch_data_schema_ != nullptr) {
+      ret = CastBatch(batch_data_schema_, batch);
+      if (ret != retcode::SUCCESS) {
+        return retcode::FAIL;
+      }
+    }
+  } catch (std::exception& e) {
+    std::stringstream ss;
+    ss << "read data from sqlite failed, " << e.what();
+    std::string err_msg = ss.str();
+    SetThreadLocalErrorMsg(err_msg);
+    LOG(ERROR) << err_msg;
+    return retcode::FAIL;
+  }
+  batch_offset_ += (*batch)->num_rows();
+  return retcode::SUCCESS;
+}
+
+int64_t SQLiteCursor::FetchRows(SQLite::Statement* sql_query,
+    int64_t max_rows,
+    std::vector<std::vector<std::string>>* query_result) {
+  query_result->resize(SelectedColumnIndex().size());
+  int64_t num_rows{0};
+  while ((max_rows < 0 || num_rows < max_rows) && sql_query->executeStep()) {
+    for (int i = 0; i < sql_query->getColumnCount(); i++) {
+      std::string result = sql_query->getColumn(i).getString();
+      (*query_result)[i].push_back(std::move(result));
+    }
+    num_rows++;
+  }
+  return num_rows;
 }
 
 std::shared_ptr<Dataset> SQLiteCursor::readInternal(const std::string& query_sql) {
-  std::shared_ptr<arrow::Table> table{nullptr};
   auto& db_connector = this->driver_->getDBConnector();
   if (db_connector == nullptr) {
     std::stringstream ss;
@@ -145,13 +241,17 @@ std::shared_ptr<Dataset> SQLiteCursor::readInternal(const std::string& query_sql
   SQLite::Statement sql_query(*db_connector, query_sql);
 
   std::vector<std::vector<std::string>> query_result;
-  query_result.resize(SelectedColumnIndex().size());
-  while (sql_query.executeStep()) {
-    for (int i = 0; i < sql_query.getColumnCount(); i++) {
-      std::string result = sql_query.getColumn(i).getString();
-      query_result[i].push_back(std::move(result));
-    }
+  FetchRows(&sql_query, -1, &query_result);
+  auto table = MakeTable(query_result);
+  if (table == nullptr) {
+    return nullptr;
   }
+  auto dataset = std::make_shared<Dataset>(table, this->driver_);
+  return dataset;
+}
+
+std::shared_ptr<arrow::Table> SQLiteCursor::MakeTable(
+    const std::vector<std::vector<std::string>>& query_result) {
   // convert data to arrow format
   auto table_schema = this->driver_->dataSetAccessInfo()->ArrowSchema();
   if (VLOG_IS_ON(5)) {
@@ -188,9 +288,7 @@ std::shared_ptr<Dataset> SQLiteCursor::readInternal(const std::string& query_sql
   }
   VLOG(5) << "end of fetch data: " << array_data.size();
   auto schema = std::make_shared<arrow::Schema>(result_schema_filed);
-  table = arrow::Table::Make(schema, array_data);
-  auto dataset = std::make_shared<Dataset>(table, this->driver_);
-  return dataset;
+  return arrow::Table::Make(schema, array_data);
 }
 
 std::shared_ptr<arrow::Table> SQLiteCursor::read_from_abnormal(
@@ -544,7 +642,7 @@ std::string SQLiteDriver::buildQuerySQL(const std::string& table_name,
 }
 
 std::unique_ptr<Cursor> SQLiteDriver::GetCursor() {
-  return nullptr;
+  return read();
 }
 
 std::unique_ptr<Cursor> SQLiteDriver::GetCursor(const std::vector<int>& col_index) {
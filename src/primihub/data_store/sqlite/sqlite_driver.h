@@ -61,6 +61,11 @@ public:
   std::shared_ptr<Dataset> read() override;
   std::shared_ptr<Dataset> read(const std::shared_ptr<arrow::Schema>& data_schema) override;
   std::shared_ptr<Dataset> read(int64_t offset, int64_t limit) override;
+  /**
+   * step a statement kept open across calls instead of LIMIT/OFFSET query
+  */
+  retcode ReadNextBatch(int64_t batch_size,
+                        std::shared_ptr<arrow::RecordBatch>* batch) override;
   std::shared_ptr<Dataset> readInternal(const std::string& query_sql);
   std::shared_ptr<arrow::Table>
   read_from_abnormal(std::map<std::string, uint32_t> col_type,
@@ -96,11 +101,20 @@ public:
     }
     return sql_type_t::UNKONW;
   }
+  /**
+   * fetch at most max_rows rows from statement, -1 for all rows,
+   * return number of rows fetched
+  */
+  int64_t FetchRows(SQLite::Statement* sql_query, int64_t max_rows,
+                    std::vector<std::vector<std::string>>* query_result);
+  std::shared_ptr<arrow::Table> MakeTable(
+      const std::vector<std::vector<std::string>>& query_result);
 
  private:
   std::string sql_;
   unsigned long long offset_{0};
   std::shared_ptr<SQLiteDriver> driver_{nullptr};
+  std::unique_ptr<SQLite::Statement> batch_stmt_{nullptr};
   std::map<std::string, sql_type_t> sql_type_name_to_enum {
     {"TEXT", sql_type_t::STRING},
     {"INTEGER", sql_type_t::INT64},
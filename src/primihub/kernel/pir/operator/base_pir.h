@@ -31,7 +31,14 @@ struct Options {
   bool use_cache{false};
   // offline task
   bool generate_db{false};
+  // offline task, apply changed rows to existing db
+  bool update_db{false};
+  // remove the items from db instead of insert or update
+  bool delete_db_items{false};
   std::string db_path;
+  // coalesce concurrent queries against the same db
+  bool batch_query{false};
+  int max_batch_delay_ms{0};
   Node peer_node;
   Node proxy_node;
 };
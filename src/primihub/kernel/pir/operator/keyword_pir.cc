@@ -3,6 +3,15 @@
 #include <fstream>
 #include <algorithm>
 #include <unordered_map>
+#include <cstdio>
+#include <mutex>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
 
 #include "src/primihub/common/value_check_util.h"
 #include "src/primihub/util/util.h"
@@ -21,6 +30,45 @@ using CiphertextPowers = apsi::sender::CiphertextPowers;
 using PowersDag = apsi::PowersDag;
 using PSIParams = apsi::PSIParams;
 
+namespace {
+/**
+ * exclusive lock of a db cache, held across load, update and save,
+ * flock on a lock file next to the db serializes tasks run by threads
+ * and by processes
+*/
+class DbFileLock {
+ public:
+  explicit DbFileLock(const std::string& db_path) {
+    std::string lock_path = db_path + ".lock";
+    fd_ = ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      LOG(ERROR) << "open lock file: " << lock_path << " failed, "
+                 << strerror(errno);
+      return;
+    }
+    while (::flock(fd_, LOCK_EX) != 0) {
+      if (errno != EINTR) {
+        LOG(ERROR) << "lock file: " << lock_path << " failed, "
+                   << strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        return;
+      }
+    }
+  }
+  ~DbFileLock() {
+    if (fd_ >= 0) {
+      ::flock(fd_, LOCK_UN);
+      ::close(fd_);
+    }
+  }
+  bool IsLocked() const {return fd_ >= 0;}
+
+ private:
+  int fd_{-1};
+};
+}  // namespace
+
 
 retcode KeywordPirOperator::OnExecute(const PirDataType& input,
                                       PirDataType* result) {
@@ -107,10 +155,14 @@ retcode KeywordPirOperator::ExecuteAsServer(const PirDataType& input) {
   VLOG(0) << "enter KeywordPirOperator  OPRFKey ctr";
   this->oprf_key_ = std::make_unique<apsi::oprf::OPRFKey>();
   VLOG(0) << "exit enter KeywordPirOperator OPRFKey ctr";
-  size_t cpu_core_num = std::thread::hardware_concurrency();
-  size_t use_core_num = cpu_core_num / 2;
-  LOG(INFO) << "ThreadPoolMgr thread count: " << use_core_num;
-  ThreadPoolMgr::SetThreadCount(use_core_num);
+  // ThreadPoolMgr is process wide, no need to reset it for each task
+  static std::once_flag thread_pool_init_flag;
+  std::call_once(thread_pool_init_flag, []() {
+    size_t cpu_core_num = std::thread::hardware_concurrency();
+    size_t use_core_num = std::max<size_t>(cpu_core_num / 2, 1);
+    LOG(INFO) << "ThreadPoolMgr thread count: " << use_core_num;
+    ThreadPoolMgr::SetThreadCount(use_core_num);
+  });
 
   auto params = SetPsiParams();
   CHECK_NULLPOINTER(params, retcode::FAIL);
@@ -126,6 +178,14 @@ retcode KeywordPirOperator::ExecuteAsServer(const PirDataType& input) {
     }
     return retcode::SUCCESS;
   }
+  if (this->options_.update_db) {
+    auto ret = UpdateDbDataCache(input);
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "UpdateDbDataCache failed.";
+      return retcode::FAIL;
+    }
+    return retcode::SUCCESS;
+  }
 
   auto ret = ProcessPSIParams();
   CHECK_RETCODE_WITH_RETVALUE(ret, retcode::FAIL);
@@ -170,10 +230,119 @@ retcode KeywordPirOperator::CreateDbDataCache(const DBData& db_data,
     LOG(ERROR) << "create sender db failed";
     return retcode::FAIL;
   }
-  std::fstream fout(this->options_.db_path, std::ios::out);
-  size_t save_size = sender_db->save(fout);
-  VLOG(0) << "save_size: " << save_size
-          << " db path: " << this->options_.db_path;
+  DbFileLock db_lock(this->options_.db_path);
+  if (!db_lock.IsLocked()) {
+    return retcode::FAIL;
+  }
+  return SaveDbToCache(*sender_db, this->options_.db_path);
+}
+
+retcode KeywordPirOperator::UpdateDbDataCache(const PirDataType& input) {
+  CHECK_TASK_STOPPED(retcode::FAIL);
+  SCopedTimer timer;
+  const auto& db_path = this->options_.db_path;
+  // concurrent updates of the same db are applied one after another,
+  // each one on the db saved by the previous one
+  DbFileLock db_lock(db_path);
+  if (!db_lock.IsLocked()) {
+    return retcode::FAIL;
+  }
+  // load a private copy, the resident db shared by query tasks
+  // is never modified in place
+  std::unique_ptr<SenderDB> sender_db{nullptr};
+  try {
+    std::fstream fin(db_path, std::ios::in | std::ios::binary);
+    if (!fin.is_open()) {
+      LOG(ERROR) << "open db cache file: " << db_path << " failed";
+      return retcode::FAIL;
+    }
+    auto db_info = SenderDB::Load(fin);
+    sender_db = std::make_unique<SenderDB>(std::move(std::get<0>(db_info)));
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "load SenderDB from: " << db_path << " failed, " << e.what();
+    return retcode::FAIL;
+  }
+  auto load_ts = timer.timeElapse();
+  size_t item_count_before = sender_db->get_item_count();
+  try {
+    if (this->options_.delete_db_items) {
+      std::vector<apsi::Item> items;
+      items.reserve(input.size());
+      for (const auto& [item_str, _] : input) {
+        apsi::Item item = item_str;
+        if (!sender_db->has_item(item)) {
+          VLOG(5) << "item: " << item_str << " is not in db, skip";
+          continue;
+        }
+        items.emplace_back(std::move(item));
+      }
+      if (!items.empty()) {
+        sender_db->remove(items);
+      }
+    } else {
+      auto db_data = CreateDb(input);
+      CHECK_NULLPOINTER(db_data, retcode::FAIL);
+      auto& labeled_db_data = std::get<LabeledData>(*db_data);
+      if (!labeled_db_data.empty()) {
+        sender_db->insert_or_assign(labeled_db_data);
+      }
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "update keyword pir SenderDB failed, " << e.what();
+    return retcode::FAIL;
+  }
+  auto update_ts = timer.timeElapse();
+  auto ret = SaveDbToCache(*sender_db, db_path);
+  CHECK_RETCODE_WITH_RETVALUE(ret, retcode::FAIL);
+  auto save_ts = timer.timeElapse();
+  LOG(INFO) << "update db: " << db_path << " "
+            << (this->options_.delete_db_items ? "delete" : "upsert") << " "
+            << "changed rows: " << input.size() << " "
+            << "item count: " << item_count_before << " -> "
+            << sender_db->get_item_count() << " "
+            << "load time cost(ms): " << load_ts << " "
+            << "update time cost(ms): " << update_ts - load_ts << " "
+            << "save time cost(ms): " << save_ts - update_ts;
+  return retcode::SUCCESS;
+}
+
+retcode KeywordPirOperator::SaveDbToCache(const SenderDB& sender_db,
+                                          const std::string& db_path) {
+  // write to temporary file and rename, so that running query tasks never
+  // read a partially written cache, the resident SenderDb is reloaded
+  // by the next query task once the file is replaced.
+  // temporary file is unique for each writer
+  std::string tmp_db_path = db_path + ".tmp.XXXXXX";
+  int tmp_fd = ::mkstemp(tmp_db_path.data());
+  if (tmp_fd < 0) {
+    LOG(ERROR) << "create temporary file: " << tmp_db_path << " failed, "
+               << strerror(errno);
+    return retcode::FAIL;
+  }
+  // mkstemp creates file with mode 0600
+  ::fchmod(tmp_fd, 0644);
+  ::close(tmp_fd);
+  size_t save_size = 0;
+  try {
+    std::fstream fout(tmp_db_path, std::ios::out | std::ios::binary);
+    if (!fout.is_open()) {
+      LOG(ERROR) << "open db cache file: " << tmp_db_path << " failed";
+      ::unlink(tmp_db_path.c_str());
+      return retcode::FAIL;
+    }
+    save_size = sender_db.save(fout);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "save SenderDB to: " << tmp_db_path << " failed, "
+               << e.what();
+    ::unlink(tmp_db_path.c_str());
+    return retcode::FAIL;
+  }
+  if (std::rename(tmp_db_path.c_str(), db_path.c_str()) != 0) {
+    LOG(ERROR) << "rename " << tmp_db_path << " to " << db_path << " failed";
+    ::unlink(tmp_db_path.c_str());
+    return retcode::FAIL;
+  }
+  VLOG(0) << "save_size: " << save_size << " db path: " << db_path;
   return retcode::SUCCESS;
 }
 
@@ -410,6 +579,12 @@ retcode KeywordPirOperator::ProcessOprf() {
 
 retcode KeywordPirOperator::ProcessQuery(std::shared_ptr<SenderDB> sender_db) {
   CHECK_TASK_STOPPED(retcode::FAIL);
+  // batch leader of the same db waits for this query from now on
+  std::unique_ptr<ExpectedQuery> expected_query{nullptr};
+  if (this->options_.batch_query) {
+    expected_query = std::make_unique<ExpectedQuery>(
+        &QueryBatcher::getInstance(), sender_db);
+  }
   CryptoContext crypto_context(sender_db->get_crypto_context());
   auto seal_context = sender_db->get_seal_context();
   auto query_request = std::make_unique<SenderOperationQuery>();
@@ -527,36 +702,58 @@ retcode KeywordPirOperator::ProcessQuery(std::shared_ptr<SenderDB> sender_db) {
   VLOG(5) << "Finished computing powers for all bundle indices";
   VLOG(5) << "Start processing bin bundle caches";
   primihub::ThreadSafeQueue<std::string> result_package_queue;
+  auto eval_cache = [&, this](uint32_t bundle_idx,
+                              const apsi::sender::BinBundleCache& cache) {
+    auto result_package =
+        ProcessBinBundleCache(sender_db,
+                              crypto_context,
+                              std::cref(cache),
+                              all_powers,
+                              bundle_idx,
+                              compr_mode,
+                              pool);
+    if (result_package == nullptr) {
+      return;
+    }
+    // serialize and push into result package queue
+    std::ostringstream string_ss;
+    result_package->save(string_ss);
+    std::string result_package_str = string_ss.str();
+    size_t data_len = result_package_str.length();
+    result_package_queue.push(std::move(result_package_str));
+    VLOG(5) << "push data into result package queue, "
+            << "data length: " << data_len
+            << " label_result size: "
+            << result_package->label_result.size();
+  };
   std::vector<future<void>> futures;
-  for (uint32_t bundle_idx = 0; bundle_idx < bundle_idx_count; bundle_idx++) {
-    auto bundle_caches = sender_db->get_cache_at(bundle_idx);
-    for (auto &cache : bundle_caches) {
-      futures.push_back(
-        std::async(
-          std::launch::async,
-          [&, bundle_idx, cache, this]() -> void {
-            auto result_package =
-                ProcessBinBundleCache(sender_db,
-                                      crypto_context,
-                                      cache,
-                                      all_powers,
-                                      static_cast<uint32_t>(bundle_idx),
-                                      compr_mode,
-                                      pool);
-            if (result_package == nullptr) {
-              return;
-            }
-            // serialize and push into result package queue
-            std::ostringstream string_ss;
-            result_package->save(string_ss);
-            std::string result_package_str = string_ss.str();
-            size_t data_len = result_package_str.length();
-            result_package_queue.push(std::move(result_package_str));
-            VLOG(5) << "push data into result package queue, "
-                    << "data length: " << data_len
-                    << " label_result size: "
-                    << result_package->label_result.size();
-          }));
+  std::atomic<bool> eval_failed{false};
+  if (this->options_.batch_query) {
+    // evaluated together with other queries on the same db
+    futures.push_back(
+      std::async(
+        std::launch::async,
+        [&]() -> void {
+          auto ret = expected_query->Process(eval_cache,
+                                             this->options_.max_batch_delay_ms);
+          if (ret != retcode::SUCCESS) {
+            // result packages will never be complete, stop sending
+            eval_failed.store(true);
+            result_package_queue.shutdown();
+          }
+        }));
+  } else {
+    for (uint32_t bundle_idx = 0; bundle_idx < bundle_idx_count;
+        bundle_idx++) {
+      auto bundle_caches = sender_db->get_cache_at(bundle_idx);
+      for (auto &cache : bundle_caches) {
+        futures.push_back(
+          std::async(
+            std::launch::async,
+            [&, bundle_idx, cache]() -> void {
+              eval_cache(bundle_idx, cache.get());
+            }));
+      }
     }
   }
 
@@ -569,6 +766,11 @@ retcode KeywordPirOperator::ProcessQuery(std::shared_ptr<SenderDB> sender_db) {
         for (size_t i = 0; i < package_count; i++) {
           std::string send_data;
           result_package_queue.wait_and_pop(send_data);
+          if (result_package_queue.is_shutdown()) {
+            LOG(ERROR) << "result package queue is shutdown, "
+                       << "sent packages: " << i;
+            return;
+          }
           auto ret = link_ctx->Send(this->key_, PeerNode(), send_data);
           if (ret != retcode::SUCCESS) {
             LOG(ERROR) << "send result to client, index: " << i
@@ -583,6 +785,10 @@ retcode KeywordPirOperator::ProcessQuery(std::shared_ptr<SenderDB> sender_db) {
   for (auto& f : futures) {
     f.get();
   }
+  if (eval_failed.load()) {
+    LOG(ERROR) << "evaluate query request failed";
+    return retcode::FAIL;
+  }
 
   VLOG(5) << "Finished processing query request";
   return retcode::SUCCESS;
@@ -785,14 +991,16 @@ bool KeywordPirOperator::DbCacheAvailable(const std::string& db_path) {
 std::shared_ptr<apsi::sender::SenderDB>
 KeywordPirOperator::LoadDbFromCache(const std::string& db_file_cache) {
   SCopedTimer timer;
-  std::fstream fin(db_file_cache, std::ios::in);
-  auto db_info = SenderDB::Load(fin);
-  auto sender_db = std::make_shared<SenderDB>(std::move(std::get<0>(db_info)));
-  VLOG(0) << "load data from cache file, db_size: " << std::get<1>(db_info);
-  *(this->oprf_key_) = sender_db->get_oprf_key();
+  auto& db_cache = SenderDbCache::getInstance();
+  auto db_entry = db_cache.Get(db_file_cache, psi_params_str_);
+  if (db_entry == nullptr) {
+    LOG(ERROR) << "load SenderDb from cache: " << db_file_cache << " failed";
+    return nullptr;
+  }
+  *(this->oprf_key_) = db_entry->oprf_key;
   auto time_cost = timer.timeElapse();
   VLOG(5) << "LoadDbFromCache cost time(ms): " << time_cost;
-  return sender_db;
+  return db_entry->sender_db;
 }
 
 }  // namespace primihub::pir
@@ -9,6 +9,8 @@
 
 #include "src/primihub/kernel/pir/operator/base_pir.h"
 #include "src/primihub/kernel/pir/common.h"
+#include "src/primihub/kernel/pir/operator/sender_db_cache.h"
+#include "src/primihub/kernel/pir/operator/query_batcher.h"
 
 // APSI
 #include "apsi/thread_pool_mgr.h"
@@ -121,6 +123,16 @@ class KeywordPirOperator : public BasePirOperator {
                             apsi::oprf::OPRFKey &oprf_key,
                             size_t nonce_byte_count,
                             bool compress);
+  /**
+   * apply inserted/updated or deleted items to the db generated offline,
+   * only the bins touched by the changed items are recomputed
+  */
+  retcode UpdateDbDataCache(const PirDataType& input);
+  /**
+   * save db to temporary file and rename it to db_path
+  */
+  retcode SaveDbToCache(const apsi::sender::SenderDB& sender_db,
+                        const std::string& db_path);
 
   auto CreateSenderDb(const DBData &db_data,
                       std::unique_ptr<PSIParams> psi_params,
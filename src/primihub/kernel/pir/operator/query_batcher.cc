@@ -0,0 +1,119 @@
+// "Copyright [2023] <PrimiHub>"
+#include "src/primihub/kernel/pir/operator/query_batcher.h"
+#include <glog/logging.h>
+#include <chrono>
+#include <utility>
+
+#include "apsi/thread_pool_mgr.h"
+#include "src/primihub/util/util.h"
+
+namespace primihub::pir {
+retcode QueryBatcher::Process(std::shared_ptr<apsi::sender::SenderDB> sender_db,
+                              EvalFunc eval, int max_batch_delay_ms) {
+  auto query = std::make_shared<Query>();
+  query->eval = std::move(eval);
+  auto fut = query->done.get_future();
+  const auto* db = sender_db.get();
+  std::shared_ptr<Batch> batch{nullptr};
+  bool is_leader{false};
+  {
+    std::unique_lock<std::mutex> lck(batch_mtx_);
+    auto it = expected_.find(db);
+    if (it != expected_.end() && --it->second == 0) {
+      expected_.erase(it);
+    }
+    auto& collecting_batch = batches_[db];
+    if (collecting_batch == nullptr) {
+      collecting_batch = std::make_shared<Batch>();
+      is_leader = true;
+    }
+    collecting_batch->queries.push_back(query);
+    batch = collecting_batch;
+    batch_cv_.notify_all();
+    if (is_leader) {
+      // the first query of a batch waits for other expected queries
+      // to join, no wait if there is none
+      if (max_batch_delay_ms > 0) {
+        batch_cv_.wait_for(lck, std::chrono::milliseconds(max_batch_delay_ms),
+            [&]() { return expected_.find(db) == expected_.end(); });
+      }
+      batches_.erase(db);
+    }
+  }
+  if (is_leader) {
+    RunBatch(sender_db, batch);
+  }
+  try {
+    fut.get();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "evaluate query in batch failed, " << e.what();
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+void QueryBatcher::Expect(const apsi::sender::SenderDB* sender_db) {
+  std::lock_guard<std::mutex> lck(batch_mtx_);
+  expected_[sender_db]++;
+}
+
+void QueryBatcher::Cancel(const apsi::sender::SenderDB* sender_db) {
+  {
+    std::lock_guard<std::mutex> lck(batch_mtx_);
+    auto it = expected_.find(sender_db);
+    if (it == expected_.end()) {
+      return;
+    }
+    if (--it->second == 0) {
+      expected_.erase(it);
+    }
+  }
+  batch_cv_.notify_all();
+}
+
+void QueryBatcher::RunBatch(
+    const std::shared_ptr<apsi::sender::SenderDB>& sender_db,
+    const std::shared_ptr<Batch>& batch) {
+  SCopedTimer timer;
+  apsi::ThreadPoolMgr tpm;
+  std::vector<std::future<void>> futures;
+  uint32_t bundle_idx_count = sender_db->get_params().bundle_idx_count();
+  for (uint32_t bundle_idx = 0; bundle_idx < bundle_idx_count; bundle_idx++) {
+    auto bundle_caches = sender_db->get_cache_at(bundle_idx);
+    for (auto& cache : bundle_caches) {
+      futures.push_back(tpm.thread_pool().enqueue(
+        [&batch, bundle_idx, cache]() {
+          for (auto& query : batch->queries) {
+            if (query->failed.load(std::memory_order_relaxed)) {
+              continue;
+            }
+            try {
+              query->eval(bundle_idx, cache.get());
+            } catch (const std::exception& e) {
+              LOG(ERROR) << "evaluate bin bundle cache failed, "
+                         << "bundle_idx: " << bundle_idx << " " << e.what();
+              std::lock_guard<std::mutex> lck(query->error_mtx);
+              if (query->error == nullptr) {
+                query->error = std::current_exception();
+                query->failed.store(true);
+              }
+            }
+          }
+        }));
+    }
+  }
+  for (auto& f : futures) {
+    f.get();
+  }
+  VLOG(5) << "process batch of " << batch->queries.size() << " queries, "
+          << "bin bundle cache count: " << futures.size() << " "
+          << "time cost(ms): " << timer.timeElapse();
+  for (auto& query : batch->queries) {
+    if (query->error != nullptr) {
+      query->done.set_exception(query->error);
+    } else {
+      query->done.set_value();
+    }
+  }
+}
+}  // namespace primihub::pir
@@ -0,0 +1,107 @@
+// "Copyright [2023] <PrimiHub>"
+#ifndef SRC_PRIMIHUB_KERNEL_PIR_OPERATOR_QUERY_BATCHER_H_
+#define SRC_PRIMIHUB_KERNEL_PIR_OPERATOR_QUERY_BATCHER_H_
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "src/primihub/common/common.h"
+
+// APSI
+#include "apsi/sender_db.h"
+#include "apsi/bin_bundle.h"
+
+namespace primihub::pir {
+/**
+ * coalesce keyword pir queries against the same SenderDB which arrive
+ * within max batch delay. each bin bundle cache is evaluated for all queries
+ * of the batch by one job on the ThreadPoolMgr pool, so the cache is read
+ * once per batch and every query of the batch progresses at the same pace.
+ * queries only meet inside one process, i.e. tasks run in thread mode,
+ * a task process runs one query at a time, so the batch leader waits only
+ * while other queries on the same db are expected, see ExpectedQuery
+*/
+class QueryBatcher {
+ public:
+  /**
+   * evaluate one bin bundle cache for a query
+  */
+  using EvalFunc = std::function<void(uint32_t bundle_idx,
+      const apsi::sender::BinBundleCache& cache)>;
+  static QueryBatcher& getInstance() {
+    static QueryBatcher ins;
+    return ins;
+  }
+  /**
+   * block until all bin bundle caches of sender_db
+   * have been evaluated for the query,
+   * return FAIL if eval throws for any of them
+  */
+  retcode Process(std::shared_ptr<apsi::sender::SenderDB> sender_db,
+                  EvalFunc eval, int max_batch_delay_ms);
+  /**
+   * announce a query which will call Process later,
+   * Cancel withdraws it if the query fails before
+  */
+  void Expect(const apsi::sender::SenderDB* sender_db);
+  void Cancel(const apsi::sender::SenderDB* sender_db);
+
+ protected:
+  QueryBatcher() = default;
+  struct Query {
+    EvalFunc eval;
+    std::promise<void> done;
+    // first exception thrown by eval, rethrown to the query by done
+    std::mutex error_mtx;
+    std::exception_ptr error{nullptr};
+    std::atomic<bool> failed{false};
+  };
+  struct Batch {
+    std::vector<std::shared_ptr<Query>> queries;
+  };
+  void RunBatch(const std::shared_ptr<apsi::sender::SenderDB>& sender_db,
+                const std::shared_ptr<Batch>& batch);
+
+ private:
+  std::mutex batch_mtx_;
+  std::condition_variable batch_cv_;
+  // key: SenderDB, value: batch which is still collecting queries
+  std::map<const apsi::sender::SenderDB*, std::shared_ptr<Batch>> batches_;
+  // key: SenderDB, value: number of expected queries not joined a batch yet
+  std::map<const apsi::sender::SenderDB*, size_t> expected_;
+};
+
+/**
+ * query which is expected by QueryBatcher from creation,
+ * until it is processed or destroyed
+*/
+class ExpectedQuery {
+ public:
+  ExpectedQuery(QueryBatcher* batcher,
+                std::shared_ptr<apsi::sender::SenderDB> sender_db)
+      : batcher_(batcher), sender_db_(std::move(sender_db)) {
+    batcher_->Expect(sender_db_.get());
+  }
+  ~ExpectedQuery() {
+    if (!processed_) {
+      batcher_->Cancel(sender_db_.get());
+    }
+  }
+  retcode Process(QueryBatcher::EvalFunc eval, int max_batch_delay_ms) {
+    processed_ = true;
+    return batcher_->Process(sender_db_, std::move(eval), max_batch_delay_ms);
+  }
+
+ private:
+  QueryBatcher* batcher_{nullptr};
+  std::shared_ptr<apsi::sender::SenderDB> sender_db_{nullptr};
+  bool processed_{false};
+};
+}  // namespace primihub::pir
+#endif  // SRC_PRIMIHUB_KERNEL_PIR_OPERATOR_QUERY_BATCHER_H_
@@ -0,0 +1,131 @@
+// "Copyright [2023] <PrimiHub>"
+#include "src/primihub/kernel/pir/operator/sender_db_cache.h"
+#include <glog/logging.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <functional>
+#include <tuple>
+#include <utility>
+
+#include "src/primihub/util/util.h"
+
+namespace primihub::pir {
+using SenderDB = apsi::sender::SenderDB;
+
+std::shared_ptr<const SenderDbEntry> SenderDbCache::Get(
+    const std::string& db_path, const std::string& psi_params_str) {
+  size_t params_hash = std::hash<std::string>{}(psi_params_str);
+  std::string stamp;
+  auto ret = FileStamp(db_path, &stamp);
+  if (ret != retcode::SUCCESS) {
+    return nullptr;
+  }
+  auto entry = Lookup(db_path, params_hash, stamp);
+  if (entry != nullptr) {
+    return entry;
+  }
+  std::shared_ptr<std::mutex> load_mtx;
+  {
+    std::lock_guard<std::mutex> lck(entry_mtx_);
+    auto& mtx = load_mtx_[db_path];
+    if (mtx == nullptr) {
+      mtx = std::make_shared<std::mutex>();
+    }
+    load_mtx = mtx;
+  }
+  std::lock_guard<std::mutex> load_lck(*load_mtx);
+  // loaded by other task while waiting
+  entry = Lookup(db_path, params_hash, stamp);
+  if (entry != nullptr) {
+    return entry;
+  }
+  miss_count_.fetch_add(1);
+  auto new_entry = Load(db_path);
+  if (new_entry == nullptr) {
+    return nullptr;
+  }
+  new_entry->params_hash = params_hash;
+  new_entry->file_stamp = std::move(stamp);
+  {
+    std::lock_guard<std::mutex> lck(entry_mtx_);
+    entries_[db_path] = new_entry;
+    total_load_time_ms_ += new_entry->load_time_ms;
+  }
+  auto stat = Stat();
+  LOG(INFO) << "SenderDb cache miss, load db: " << db_path << " "
+            << "time cost(ms): " << new_entry->load_time_ms << " "
+            << "hit: " << stat.hit_count << " miss: " << stat.miss_count << " "
+            << "total load time(ms): " << stat.total_load_time_ms;
+  return new_entry;
+}
+
+std::shared_ptr<const SenderDbEntry> SenderDbCache::Lookup(
+    const std::string& db_path, size_t params_hash, const std::string& stamp) {
+  std::lock_guard<std::mutex> lck(entry_mtx_);
+  auto it = entries_.find(db_path);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  auto& entry = it->second;
+  if (entry->params_hash != params_hash || entry->file_stamp != stamp) {
+    VLOG(5) << "SenderDb cache for " << db_path << " is outdated";
+    return nullptr;
+  }
+  auto hit_count = hit_count_.fetch_add(1) + 1;
+  VLOG(5) << "SenderDb cache hit, db: " << db_path << " "
+          << "hit: " << hit_count << " miss: " << miss_count_.load();
+  return entry;
+}
+
+void SenderDbCache::Erase(const std::string& db_path) {
+  std::lock_guard<std::mutex> lck(entry_mtx_);
+  entries_.erase(db_path);
+}
+
+SenderDbCacheStat SenderDbCache::Stat() {
+  SenderDbCacheStat stat;
+  stat.hit_count = hit_count_.load();
+  stat.miss_count = miss_count_.load();
+  std::lock_guard<std::mutex> lck(entry_mtx_);
+  stat.total_load_time_ms = total_load_time_ms_;
+  stat.entry_count = entries_.size();
+  return stat;
+}
+
+retcode SenderDbCache::FileStamp(const std::string& db_path,
+                                 std::string* stamp) {
+  struct stat file_stat;
+  if (::stat(db_path.c_str(), &file_stat) != 0) {
+    LOG(ERROR) << "stat db cache file: " << db_path << " failed";
+    return retcode::FAIL;
+  }
+  stamp->clear();
+  stamp->append(std::to_string(file_stat.st_size)).append("_")
+        .append(std::to_string(file_stat.st_mtim.tv_sec)).append("_")
+        .append(std::to_string(file_stat.st_mtim.tv_nsec)).append("_")
+        .append(std::to_string(file_stat.st_ino));
+  return retcode::SUCCESS;
+}
+
+std::shared_ptr<SenderDbEntry> SenderDbCache::Load(const std::string& db_path) {
+  SCopedTimer timer;
+  auto entry = std::make_shared<SenderDbEntry>();
+  try {
+    std::fstream fin(db_path, std::ios::in | std::ios::binary);
+    if (!fin.is_open()) {
+      LOG(ERROR) << "open db cache file: " << db_path << " failed";
+      return nullptr;
+    }
+    auto db_info = SenderDB::Load(fin);
+    entry->sender_db =
+        std::make_shared<SenderDB>(std::move(std::get<0>(db_info)));
+    VLOG(0) << "load data from cache file, db_size: " << std::get<1>(db_info);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "load SenderDB from: " << db_path << " failed, " << e.what();
+    return nullptr;
+  }
+  entry->oprf_key = entry->sender_db->get_oprf_key();
+  entry->load_time_ms = timer.timeElapse();
+  return entry;
+}
+}  // namespace primihub::pir
@@ -0,0 +1,77 @@
+// "Copyright [2023] <PrimiHub>"
+#ifndef SRC_PRIMIHUB_KERNEL_PIR_OPERATOR_SENDER_DB_CACHE_H_
+#define SRC_PRIMIHUB_KERNEL_PIR_OPERATOR_SENDER_DB_CACHE_H_
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "src/primihub/common/common.h"
+
+// APSI
+#include "apsi/sender_db.h"
+#include "apsi/oprf/oprf_sender.h"
+
+namespace primihub::pir {
+/**
+ * SenderDB loaded from db cache file together with its OPRF key
+*/
+struct SenderDbEntry {
+  std::shared_ptr<apsi::sender::SenderDB> sender_db{nullptr};
+  apsi::oprf::OPRFKey oprf_key;
+  // hash of the serialized psi params used by the task
+  size_t params_hash{0};
+  // size, modify time and inode of the cache file when it is loaded
+  std::string file_stamp;
+  double load_time_ms{0};
+};
+
+struct SenderDbCacheStat {
+  uint64_t hit_count{0};
+  uint64_t miss_count{0};
+  double total_load_time_ms{0};
+  size_t entry_count{0};
+};
+
+/**
+ * keep keyword pir SenderDB resident across tasks,
+ * entry is identified by db cache path (one per dataset) and psi params hash.
+ * when the cache file is regenerated, the entry is reloaded and swapped,
+ * tasks holding the previous entry keep using it until they finish
+*/
+class SenderDbCache {
+ public:
+  static SenderDbCache& getInstance() {
+    static SenderDbCache ins;
+    return ins;
+  }
+  /**
+   * return resident SenderDB for db_path, load it if not cached
+   * or the cache file has changed, nullptr if load failed
+  */
+  std::shared_ptr<const SenderDbEntry> Get(const std::string& db_path,
+                                           const std::string& psi_params_str);
+  void Erase(const std::string& db_path);
+  SenderDbCacheStat Stat();
+
+ protected:
+  SenderDbCache() = default;
+  retcode FileStamp(const std::string& db_path, std::string* stamp);
+  std::shared_ptr<SenderDbEntry> Load(const std::string& db_path);
+  std::shared_ptr<const SenderDbEntry> Lookup(const std::string& db_path,
+                                              size_t params_hash,
+                                              const std::string& stamp);
+
+ private:
+  std::mutex entry_mtx_;
+  // key: db cache path
+  std::map<std::string, std::shared_ptr<const SenderDbEntry>> entries_;
+  // make sure the same db is loaded only once when tasks arrive concurrently
+  std::map<std::string, std::shared_ptr<std::mutex>> load_mtx_;
+  std::atomic<uint64_t> hit_count_{0};
+  std::atomic<uint64_t> miss_count_{0};
+  double total_load_time_ms_{0};
+};
+}  // namespace primihub::pir
+#endif  // SRC_PRIMIHUB_KERNEL_PIR_OPERATOR_SENDER_DB_CACHE_H_
@@ -15,8 +15,12 @@
  */
 
 #include "src/primihub/kernel/psi/operator/base_psi.h"
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 
+#include "src/primihub/common/value_check_util.h"
 #include "src/primihub/util/endian_util.h"
 #include "src/primihub/util/util.h"
 
@@ -43,6 +47,103 @@ retcode BasePsiOperator::Execute(const std::vector<std::string>& input,
   return ret;
 }
 
+retcode BasePsiOperator::ExecuteIndex(const std::vector<std::string>& input,
+                                      bool sync_result,
+                                      std::vector<int64_t>* result_index) {
+  auto ret = this->OnExecuteIndex(input, result_index);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "Execut PSI failed";
+    return retcode::FAIL;
+  }
+  if (!sync_result || IgnoreResult(options_.self_party)) {
+    return retcode::SUCCESS;
+  }
+  SCopedTimer timer;
+  if (RoleValidation::IsClient(options_.self_party)) {
+    ret = BroadcastResult(input, *result_index);
+  } else {
+    std::vector<std::string> result;
+    ret = ReceiveResult(&result);
+    if (ret == retcode::SUCCESS) {
+      ret = ItemToIndex(input, result, result_index);
+    }
+  }
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "Broadcast Psi Result failed";
+  }
+  auto time_cost = timer.timeElapse();
+  VLOG(5) << "BroadcastPsiResult time cost(ms): " << time_cost;
+  return ret;
+}
+
+retcode BasePsiOperator::OnExecuteIndex(const std::vector<std::string>& input,
+                                        std::vector<int64_t>* result_index) {
+  std::vector<std::string> result;
+  auto ret = this->OnExecute(input, &result);
+  CHECK_RETCODE(ret);
+  return ItemToIndex(input, result, result_index);
+}
+
+retcode BasePsiOperator::ExtractResultIndex(size_t num_input,
+    const std::vector<int64_t>& intersection,
+    std::vector<int64_t>* result_index) {
+  result_index->clear();
+  if (options_.psi_result_type == PsiResultType::DIFFERENCE) {
+    std::vector<bool> in_intersection(num_input, false);
+    for (const auto index : intersection) {
+      if (index < 0 || static_cast<size_t>(index) >= num_input) {
+        LOG(ERROR) << "intersection index: " << index << " out of range";
+        return retcode::FAIL;
+      }
+      in_intersection[index] = true;
+    }
+    result_index->reserve(num_input - std::min(num_input, intersection.size()));
+    for (size_t i = 0; i < num_input; i++) {
+      if (!in_intersection[i]) {
+        result_index->push_back(i);
+      }
+    }
+  } else {
+    *result_index = intersection;
+    std::sort(result_index->begin(), result_index->end());
+    result_index->erase(
+        std::unique(result_index->begin(), result_index->end()),
+        result_index->end());
+  }
+  return retcode::SUCCESS;
+}
+
+retcode BasePsiOperator::ItemToIndex(const std::vector<std::string>& input,
+                                     const std::vector<std::string>& items,
+                                     std::vector<int64_t>* index) {
+  std::unordered_map<std::string_view, int64_t> index_map(input.size());
+  for (size_t i = 0; i < input.size(); i++) {
+    index_map.emplace(input[i], i);
+  }
+  index->clear();
+  index->reserve(items.size());
+  for (const auto& item : items) {
+    auto it = index_map.find(item);
+    if (it == index_map.end()) {
+      LOG(ERROR) << "result item does not belong to input of party: "
+                 << options_.self_party;
+      return retcode::FAIL;
+    }
+    index->push_back(it->second);
+  }
+  std::sort(index->begin(), index->end());
+  return retcode::SUCCESS;
+}
+
+void BasePsiOperator::IndexToItem(const std::vector<std::string>& input,
+                                  const std::vector<int64_t>& index,
+                                  std::vector<std::string>* items) {
+  items->reserve(items->size() + index.size());
+  for (const auto i : index) {
+    items->push_back(input[i]);
+  }
+}
+
 retcode BasePsiOperator::BroadcastPsiResult(std::vector<std::string>* result) {
   if (IgnoreResult(options_.self_party)) {
     return retcode::SUCCESS;
@@ -58,7 +159,6 @@ retcode BasePsiOperator::BroadcastPsiResult(std::vector<std::string>* result) {
 
 retcode BasePsiOperator::BroadcastResult(
     const std::vector<std::string>& result) {
-  retcode ret{retcode::SUCCESS};
   VLOG(5) << "broadcast result to server";
   std::string result_str;
   size_t total_size{0};
@@ -74,6 +174,32 @@ retcode BasePsiOperator::BroadcastResult(
                       sizeof(be_item_len));
     result_str.append(item);
   }
+  return SendResultToParties(result_str);
+}
+
+retcode BasePsiOperator::BroadcastResult(
+    const std::vector<std::string>& input,
+    const std::vector<int64_t>& result_index) {
+  VLOG(5) << "broadcast result to server";
+  std::string result_str;
+  size_t total_size{0};
+  for (const auto index : result_index) {
+    total_size += input[index].size();
+  }
+  total_size += result_index.size() * sizeof(uint64_t);
+  result_str.reserve(total_size);
+  for (const auto index : result_index) {
+    const auto& item = input[index];
+    uint64_t item_len = item.size();
+    uint64_t be_item_len = htonll(item_len);
+    result_str.append(reinterpret_cast<char*>(&be_item_len),
+                      sizeof(be_item_len));
+    result_str.append(item);
+  }
+  return SendResultToParties(result_str);
+}
+
+retcode BasePsiOperator::SendResultToParties(const std::string& result_str) {
   std::vector<Node> party_list;
   BroadcastPartyList(&party_list);
   for (const auto& party_info : party_list) {
@@ -31,6 +31,10 @@ struct Options {
   PsiResultType psi_result_type{PsiResultType::INTERSECTION};
   std::string code;
   Node proxy_node;      // location to fecth recv data
+  // number of elements per batch exchanged by ecdh psi, 0: single batch
+  size_t chunk_size{0};
+  // number of threads for local computation of operator, 0: hardware threads
+  size_t worker_num{0};
 };
 
 class BasePsiOperator {
@@ -47,6 +51,20 @@ class BasePsiOperator {
                   std::vector<std::string>* result);
   virtual retcode OnExecute(const std::vector<std::string>& input,
                             std::vector<std::string>* result) = 0;
+  /**
+   * PSI protocol, result is index of input in ascending order,
+   * party receives result by broadcast can only get intersection index,
+   * since items of difference do not belong to its input
+  */
+  retcode ExecuteIndex(const std::vector<std::string>& input,
+                       bool sync_result,
+                       std::vector<int64_t>* result_index);
+  /**
+   * default implementation maps items returned by OnExecute to input index,
+   * operator which gets intersection index in protocol should override it
+  */
+  virtual retcode OnExecuteIndex(const std::vector<std::string>& input,
+                                 std::vector<int64_t>* result_index);
   /**
    * broadcast from the party who get the result to the others who participate
    * in the protocol
@@ -72,7 +90,28 @@ class BasePsiOperator {
   */
   bool IgnoreResult(const std::string& party_name);
   retcode BroadcastResult(const std::vector<std::string>& result);
+  /**
+   * broadcast input items selected by result_index
+  */
+  retcode BroadcastResult(const std::vector<std::string>& input,
+                          const std::vector<int64_t>& result_index);
   retcode ReceiveResult(std::vector<std::string>* result);
+  /**
+   * map intersection index to result index according to psi result type,
+   * result index is sorted in ascending order
+  */
+  retcode ExtractResultIndex(size_t num_input,
+                             const std::vector<int64_t>& intersection,
+                             std::vector<int64_t>* result_index);
+  /**
+   * map items to the index of input, item not in input is reported as error
+  */
+  retcode ItemToIndex(const std::vector<std::string>& input,
+                      const std::vector<std::string>& items,
+                      std::vector<int64_t>* index);
+  void IndexToItem(const std::vector<std::string>& input,
+                   const std::vector<int64_t>& index,
+                   std::vector<std::string>* items);
 
   void set_stop() {stop_.store(true);}
 
@@ -86,6 +125,7 @@ class BasePsiOperator {
   Node PeerNode();
   Node& ProxyServerNode();
   retcode GetNodeByName(const std::string& party_name, Node* node_info);
+  retcode SendResultToParties(const std::string& result_str);
 
  protected:
   std::atomic<bool> stop_{false};
@@ -0,0 +1,248 @@
+// "Copyright [2023] <Primihub>"
+#include "src/primihub/kernel/psi/operator/ecdh_parallel.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <utility>
+
+#include "private_join_and_compute/crypto/ec_commutative_cipher.h"
+#include "private_set_intersection/cpp/bloom_filter.h"
+#include "private_set_intersection/cpp/gcs.h"
+#include "src/primihub/common/value_check_util.h"
+
+namespace primihub::psi {
+namespace openminded_psi = private_set_intersection;
+using private_join_and_compute::ECCommutativeCipher;
+namespace {
+// partition smaller than this is not worth a thread
+constexpr size_t kMinElementsPerWorker = 4096;
+// elements processed by a worker between two stop checks
+constexpr size_t kElementsPerBatch = 64 * 1024;
+}  // namespace
+
+EcdhParallelExecutor::EcdhParallelExecutor(size_t worker_num,
+    const std::atomic<bool>* stop_flag) : stop_flag_(stop_flag) {
+  if (worker_num == 0) {
+    worker_num = std::thread::hardware_concurrency();
+  }
+  worker_num_ = std::max<size_t>(worker_num, 1);
+}
+
+size_t EcdhParallelExecutor::WorkerNum(size_t element_num) {
+  size_t max_worker_num =
+      (element_num + kMinElementsPerWorker - 1) / kMinElementsPerWorker;
+  return std::max<size_t>(std::min(worker_num_, max_worker_num), 1);
+}
+
+retcode EcdhParallelExecutor::ParallelRun(size_t element_num,
+                                          const PartitionFunc& func) {
+  size_t worker_num = WorkerNum(element_num);
+  if (worker_num == 1) {
+    return func(0, 0, element_num);
+  }
+  size_t step = (element_num + worker_num - 1) / worker_num;
+  std::vector<std::future<retcode>> futs;
+  for (size_t part = 0; part < worker_num; part++) {
+    size_t offset = part * step;
+    if (offset >= element_num) {
+      break;
+    }
+    size_t count = std::min(step, element_num - offset);
+    futs.push_back(std::async(std::launch::async, func, part, offset, count));
+  }
+  auto ret{retcode::SUCCESS};
+  for (auto& fut : futs) {
+    if (fut.get() != retcode::SUCCESS) {
+      ret = retcode::FAIL;
+    }
+  }
+  return ret;
+}
+
+retcode EcdhParallelExecutor::CreateRequest(const std::string& key_bytes,
+    bool reveal_intersection,
+    absl::Span<const std::string> input,
+    psi_proto::Request* request) {
+  std::vector<psi_proto::Request> part_requests(WorkerNum(input.size()));
+  auto ret = ParallelRun(input.size(),
+    [&, this](size_t part, size_t offset, size_t count) -> retcode {
+      auto client_or = openminded_psi::PsiClient::CreateFromKey(
+          key_bytes, reveal_intersection);
+      if (!client_or.ok()) {
+        LOG(ERROR) << "create psi client failed, " << client_or.status();
+        return retcode::FAIL;
+      }
+      auto client = std::move(client_or).value();
+      auto& part_request = part_requests[part];
+      part_request.mutable_encrypted_elements()->Reserve(count);
+      for (size_t i = 0; i < count; i += kElementsPerBatch) {
+        CHECK_TASK_STOPPED(retcode::FAIL);
+        size_t batch_size = std::min(kElementsPerBatch, count - i);
+        auto request_or =
+            client->CreateRequest(input.subspan(offset + i, batch_size));
+        if (!request_or.ok()) {
+          LOG(ERROR) << "create psi request failed, " << request_or.status();
+          return retcode::FAIL;
+        }
+        for (auto& element : *(request_or->mutable_encrypted_elements())) {
+          part_request.add_encrypted_elements(std::move(element));
+        }
+      }
+      return retcode::SUCCESS;
+    });
+  CHECK_RETCODE(ret);
+  request->Clear();
+  request->set_reveal_intersection(reveal_intersection);
+  request->mutable_encrypted_elements()->Reserve(input.size());
+  for (auto& part_request : part_requests) {
+    for (auto& element : *(part_request.mutable_encrypted_elements())) {
+      request->add_encrypted_elements(std::move(element));
+    }
+  }
+  return retcode::SUCCESS;
+}
+
+retcode EcdhParallelExecutor::ProcessRequest(const std::string& key_bytes,
+    bool reveal_intersection,
+    const psi_proto::Request& request,
+    psi_proto::Response* response) {
+  size_t element_num = request.encrypted_elements_size();
+  if (!reveal_intersection) {
+    // server shuffles the whole response when intersection is not revealed,
+    // which can not be done by partition
+    auto server_or = openminded_psi::PsiServer::CreateFromKey(
+        key_bytes, reveal_intersection);
+    if (!server_or.ok()) {
+      LOG(ERROR) << "create psi server failed, " << server_or.status();
+      return retcode::FAIL;
+    }
+    auto response_or = std::move(server_or).value()->ProcessRequest(request);
+    if (!response_or.ok()) {
+      LOG(ERROR) << "process psi request failed, " << response_or.status();
+      return retcode::FAIL;
+    }
+    *response = std::move(response_or).value();
+    return retcode::SUCCESS;
+  }
+  std::vector<psi_proto::Response> part_responses(WorkerNum(element_num));
+  auto ret = ParallelRun(element_num,
+    [&, this](size_t part, size_t offset, size_t count) -> retcode {
+      auto server_or = openminded_psi::PsiServer::CreateFromKey(
+          key_bytes, reveal_intersection);
+      if (!server_or.ok()) {
+        LOG(ERROR) << "create psi server failed, " << server_or.status();
+        return retcode::FAIL;
+      }
+      auto server = std::move(server_or).value();
+      auto& part_response = part_responses[part];
+      part_response.mutable_encrypted_elements()->Reserve(count);
+      for (size_t i = 0; i < count; i += kElementsPerBatch) {
+        CHECK_TASK_STOPPED(retcode::FAIL);
+        size_t batch_size = std::min(kElementsPerBatch, count - i);
+        psi_proto::Request batch_request;
+        batch_request.set_reveal_intersection(reveal_intersection);
+        batch_request.mutable_encrypted_elements()->Reserve(batch_size);
+        for (size_t j = offset + i; j < offset + i + batch_size; j++) {
+          batch_request.add_encrypted_elements(request.encrypted_elements(j));
+        }
+        auto response_or = server->ProcessRequest(batch_request);
+        if (!response_or.ok()) {
+          LOG(ERROR) << "process psi request failed, " << response_or.status();
+          return retcode::FAIL;
+        }
+        for (auto& element : *(response_or->mutable_encrypted_elements())) {
+          part_response.add_encrypted_elements(std::move(element));
+        }
+      }
+      return retcode::SUCCESS;
+    });
+  CHECK_RETCODE(ret);
+  response->Clear();
+  response->mutable_encrypted_elements()->Reserve(element_num);
+  for (auto& part_response : part_responses) {
+    for (auto& element : *(part_response.mutable_encrypted_elements())) {
+      response->add_encrypted_elements(std::move(element));
+    }
+  }
+  return retcode::SUCCESS;
+}
+
+retcode EcdhParallelExecutor::GetIntersection(const std::string& key_bytes,
+    bool reveal_intersection,
+    const psi_proto::ServerSetup& server_setup,
+    const psi_proto::Response& response,
+    std::vector<int64_t>* intersection) {
+  if (!reveal_intersection) {
+    LOG(ERROR) << "intersection is not revealed";
+    return retcode::FAIL;
+  }
+  std::vector<std::string> decrypted;
+  auto ret = DecryptResponse(key_bytes, response, &decrypted);
+  CHECK_RETCODE(ret);
+  return Intersect(server_setup, decrypted, intersection);
+}
+
+retcode EcdhParallelExecutor::DecryptResponse(const std::string& key_bytes,
+    const psi_proto::Response& response,
+    std::vector<std::string>* decrypted) {
+  size_t element_num = response.encrypted_elements_size();
+  size_t base = decrypted->size();
+  decrypted->resize(base + element_num);
+  return ParallelRun(element_num,
+    [&, this](size_t part, size_t offset, size_t count) -> retcode {
+      // same cipher as PsiClient creates from the key
+      auto cipher_or = ECCommutativeCipher::CreateFromKey(
+          NID_X9_62_prime256v1, key_bytes,
+          ECCommutativeCipher::HashType::SHA256);
+      if (!cipher_or.ok()) {
+        LOG(ERROR) << "create ec cipher failed, " << cipher_or.status();
+        return retcode::FAIL;
+      }
+      auto cipher = std::move(cipher_or).value();
+      for (size_t i = offset; i < offset + count; i++) {
+        if ((i - offset) % kElementsPerBatch == 0) {
+          CHECK_TASK_STOPPED(retcode::FAIL);
+        }
+        auto element_or = cipher->Decrypt(response.encrypted_elements(i));
+        if (!element_or.ok()) {
+          LOG(ERROR) << "decrypt element failed, " << element_or.status();
+          return retcode::FAIL;
+        }
+        (*decrypted)[base + i] = std::move(element_or).value();
+      }
+      return retcode::SUCCESS;
+    });
+}
+
+retcode EcdhParallelExecutor::Intersect(
+    const psi_proto::ServerSetup& server_setup,
+    const std::vector<std::string>& decrypted,
+    std::vector<int64_t>* intersection) {
+  auto elements = absl::MakeConstSpan(decrypted);
+  if (server_setup.data_structure_case() ==
+      psi_proto::ServerSetup::DataStructureCase::kGcs) {
+    auto container_or = openminded_psi::GCS::CreateFromProtobuf(server_setup);
+    if (!container_or.ok()) {
+      LOG(ERROR) << "create gcs failed, " << container_or.status();
+      return retcode::FAIL;
+    }
+    *intersection = std::move(container_or).value()->Intersect(elements);
+  } else if (server_setup.data_structure_case() ==
+             psi_proto::ServerSetup::DataStructureCase::kBloomFilter) {
+    auto container_or =
+        openminded_psi::BloomFilter::CreateFromProtobuf(server_setup);
+    if (!container_or.ok()) {
+      LOG(ERROR) << "create bloom filter failed, " << container_or.status();
+      return retcode::FAIL;
+    }
+    *intersection = std::move(container_or).value()->Intersect(elements);
+  } else {
+    LOG(ERROR) << "unknown data structure of server setup";
+    return retcode::FAIL;
+  }
+  std::sort(intersection->begin(), intersection->end());
+  return retcode::SUCCESS;
+}
+}  // namespace primihub::psi
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2023 by PrimiHub
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      https://www.apache.org/licenses/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_PRIMIHUB_KERNEL_PSI_OPERATOR_ECDH_PARALLEL_H_
+#define SRC_PRIMIHUB_KERNEL_PSI_OPERATOR_ECDH_PARALLEL_H_
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "private_set_intersection/cpp/psi_client.h"
+#include "private_set_intersection/cpp/psi_server.h"
+#include "src/primihub/common/common.h"
+
+namespace primihub::psi {
+/**
+ * run the elliptic curve operations of openminded psi with multiple threads.
+ * elements are split into contiguous partitions, each worker uses its own
+ * PsiClient/PsiServer created from the same private key,
+ * so the output keeps the order of the input
+*/
+class EcdhParallelExecutor {
+ public:
+  /**
+   * worker_num: 0 means the number of hardware threads
+   * stop_flag: optional, checked by workers between batches
+  */
+  explicit EcdhParallelExecutor(size_t worker_num,
+                                const std::atomic<bool>* stop_flag = nullptr);
+  /**
+   * client: blind input with its private key
+  */
+  retcode CreateRequest(const std::string& key_bytes,
+                        bool reveal_intersection,
+                        absl::Span<const std::string> input,
+                        psi_proto::Request* request);
+  /**
+   * server: re-blind elements of client request with its private key
+  */
+  retcode ProcessRequest(const std::string& key_bytes,
+                         bool reveal_intersection,
+                         const psi_proto::Request& request,
+                         psi_proto::Response* response);
+  /**
+   * client: unblind server response and look up in server setup,
+   * return index of intersection element in ascending order
+  */
+  retcode GetIntersection(const std::string& key_bytes,
+                          bool reveal_intersection,
+                          const psi_proto::ServerSetup& server_setup,
+                          const psi_proto::Response& response,
+                          std::vector<int64_t>* intersection);
+  /**
+   * client: unblind elements of server response,
+   * decrypted elements are appended to the end of decrypted
+  */
+  retcode DecryptResponse(const std::string& key_bytes,
+                          const psi_proto::Response& response,
+                          std::vector<std::string>* decrypted);
+  /**
+   * client: build the filter of server setup once and look up all
+   * decrypted elements, return their index in ascending order
+  */
+  static retcode Intersect(const psi_proto::ServerSetup& server_setup,
+                           const std::vector<std::string>& decrypted,
+                           std::vector<int64_t>* intersection);
+  size_t WorkerNum(size_t element_num);
+
+ protected:
+  using PartitionFunc =
+      std::function<retcode(size_t part, size_t offset, size_t count)>;
+  retcode ParallelRun(size_t element_num, const PartitionFunc& func);
+  bool has_stopped() {
+    return stop_flag_ != nullptr &&
+        stop_flag_->load(std::memory_order_relaxed);
+  }
+
+ private:
+  size_t worker_num_{1};
+  const std::atomic<bool>* stop_flag_{nullptr};
+};
+}  // namespace primihub::psi
+#endif  // SRC_PRIMIHUB_KERNEL_PSI_OPERATOR_ECDH_PARALLEL_H_
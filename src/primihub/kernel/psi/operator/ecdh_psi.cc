@@ -3,6 +3,12 @@
 
 #include <utility>
 #include <set>
+#include <future>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+#include "absl/types/span.h"
 
 #include "private_set_intersection/cpp/psi_client.h"
 #include "private_set_intersection/cpp/psi_server.h"
@@ -15,12 +21,21 @@
 namespace primihub::psi {
 retcode EcdhPsiOperator::OnExecute(const std::vector<std::string>& input,
                                    std::vector<std::string>* result) {
+  std::vector<int64_t> result_index;
+  auto ret = OnExecuteIndex(input, &result_index);
+  CHECK_RETCODE(ret);
+  IndexToItem(input, result_index, result);
+  return retcode::SUCCESS;
+}
+
+retcode EcdhPsiOperator::OnExecuteIndex(const std::vector<std::string>& input,
+                                        std::vector<int64_t>* result_index) {
   if (input.empty()) {
     LOG(ERROR) << "no data is set for ecdh psi";
     return retcode::FAIL;
   }
   if (RoleValidation::IsClient(PartyName())) {
-    return ExecuteAsClient(input, result);
+    return ExecuteAsClient(input, result_index);
   } else if (RoleValidation::IsServer(this->PartyName())) {
     return ExecuteAsServer(input);
   } else {
@@ -32,8 +47,11 @@ retcode EcdhPsiOperator::OnExecute(const std::vector<std::string>& input,
 }
 
 retcode EcdhPsiOperator::ExecuteAsClient(const std::vector<std::string>& input,
-    std::vector<std::string>* result) {
+    std::vector<int64_t>* result_index) {
   CHECK_TASK_STOPPED(retcode::FAIL);
+  if (this->options_.chunk_size > 0) {
+    return ExecuteAsClientByChunk(input, result_index);
+  }
   SCopedTimer timer;
   rpc::TaskRequest request;
   std::string init_param_str;
@@ -52,7 +70,12 @@ retcode EcdhPsiOperator::ExecuteAsClient(const std::vector<std::string>& input,
   auto client = openminded_psi::PsiClient::CreateWithNewKey(
       reveal_intersection_).value();
   // psi_proto::Request
-  auto client_request = client->CreateRequest(input).value();
+  psi_proto::Request client_request;
+  ret = ParallelExecutor().CreateRequest(client->GetPrivateKeyBytes(),
+                                         reveal_intersection_,
+                                         absl::MakeConstSpan(input),
+                                         &client_request);
+  CHECK_RETCODE_WITH_ERROR_MSG(ret, "create psi request failed");
   // psi_proto::Response server_response;
   auto build_req_ts = timer.timeElapse();
   auto build_req_time_cost = build_req_ts - ts;
@@ -63,7 +86,8 @@ retcode EcdhPsiOperator::ExecuteAsClient(const std::vector<std::string>& input,
                                       &task_response);
   CHECK_RETCODE(ret);
   auto _start = timer.timeElapse();
-  ret = this->GetIntersection(input, client, task_response, result);
+  ret = this->GetIntersection(input.size(), client, task_response,
+                              result_index);
   CHECK_RETCODE_WITH_ERROR_MSG(ret, "Node psi client get insection failed.");
   auto _end =  timer.timeElapse();
   auto get_intersection_time_cost = _end - _start;
@@ -72,10 +96,10 @@ retcode EcdhPsiOperator::ExecuteAsClient(const std::vector<std::string>& input,
 }
 
 retcode EcdhPsiOperator::GetIntersection(
-    const std::vector<std::string> origin_data,
+    size_t num_elements,
     const std::unique_ptr<openminded_psi::PsiClient>& client,
     rpc::PsiResponse& response,
-    std::vector<std::string>* result) {
+    std::vector<int64_t>* result_index) {
   CHECK_TASK_STOPPED(retcode::FAIL);
   SCopedTimer timer;
   psi_proto::Response entrpy_response;
@@ -103,35 +127,170 @@ retcode EcdhPsiOperator::GetIntersection(
   auto build_resp_time_cost = timer.timeElapse();
   VLOG(5) << "build_response_time_cost(ms): " << build_resp_time_cost;
 
-  std::vector<int64_t> intersection =
-      std::move(client->GetIntersection(server_setup, entrpy_response)).value();
+  std::vector<int64_t> intersection;
+  auto ret = ParallelExecutor().GetIntersection(client->GetPrivateKeyBytes(),
+                                                reveal_intersection_,
+                                                server_setup,
+                                                entrpy_response,
+                                                &intersection);
+  CHECK_RETCODE_WITH_ERROR_MSG(ret, "get intersection failed");
   auto get_intersection_ts = timer.timeElapse();
   auto get_intersection_time_cost = get_intersection_ts - build_resp_time_cost;
   VLOG(5) << "get_intersection_time_cost: " << get_intersection_time_cost;
-  size_t num_intersection = intersection.size();
+  return ExtractResultIndex(num_elements, intersection, result_index);
+}
 
-  if (options_.psi_result_type == PsiResultType::DIFFERENCE) {
-    std::unordered_map<int64_t, int> inter_map(num_intersection);
-    size_t num_elements = origin_data.size();
-    result->reserve(num_elements);
-    for (size_t i = 0; i < num_intersection; i++) {
-      inter_map[intersection[i]] = 1;
+retcode EcdhPsiOperator::ExecuteAsClientByChunk(
+    const std::vector<std::string>& input,
+    std::vector<int64_t>* result_index) {
+  SCopedTimer timer;
+  size_t chunk_size = this->options_.chunk_size;
+  std::string init_param_str;
+  auto ret = BuildInitParam(input.size(), &init_param_str, chunk_size);
+  CHECK_RETCODE(ret);
+  ret = SendInitParam(init_param_str);
+  CHECK_RETCODE(ret);
+  auto client_or = openminded_psi::PsiClient::CreateWithNewKey(
+      reveal_intersection_);
+  if (!client_or.ok()) {
+    LOG(ERROR) << "create psi client failed, " << client_or.status();
+    return retcode::FAIL;
+  }
+  // EC context of psi client is not thread safe, every worker creates
+  // its own client from the key, so that responses can be matched
+  // while requests are being built
+  auto key_bytes = std::move(client_or).value()->GetPrivateKeyBytes();
+  // response of a chunk is only waited for after the chunk has been sent,
+  // so the receiver does not block forever when sending fails
+  std::mutex sent_mtx;
+  std::condition_variable sent_cv;
+  size_t sent_chunks{0};
+  bool send_finished{false};
+  auto wait_chunk_sent = [&](size_t chunk_index) -> bool {
+    std::unique_lock<std::mutex> lck(sent_mtx);
+    sent_cv.wait(lck, [&]() {
+      return send_finished || sent_chunks > chunk_index;
+    });
+    return sent_chunks > chunk_index;
+  };
+  std::vector<int64_t> intersection;
+  auto recv_fut = std::async(
+    std::launch::async,
+    [&]() -> retcode {
+      return RecvChunkResponse(key_bytes, input.size(), wait_chunk_sent,
+                               &intersection);
+    });
+  auto executor = ParallelExecutor();
+  size_t num_chunk = (input.size() + chunk_size - 1) / chunk_size;
+  auto input_span = absl::MakeConstSpan(input);
+  auto send_ret{retcode::SUCCESS};
+  for (size_t i = 0; i < num_chunk; i++) {
+    if (has_stopped()) {
+      LOG(ERROR) << "task has been set stopped";
+      send_ret = retcode::FAIL;
+      break;
     }
-    for (size_t i = 0; i < num_elements; i++) {
-      if (inter_map.find(i) == inter_map.end()) {
-        result->push_back(origin_data[i]);
-      }
+    size_t offset = i * chunk_size;
+    size_t count = std::min(chunk_size, input.size() - offset);
+    psi_proto::Request request;
+    send_ret = executor.CreateRequest(key_bytes, reveal_intersection_,
+                                      input_span.subspan(offset, count),
+                                      &request);
+    if (send_ret != retcode::SUCCESS) {
+      LOG(ERROR) << "create psi request for chunk: " << i << " failed";
+      break;
     }
-  } else {
-    for (size_t i = 0; i < num_intersection; i++) {
-      result->push_back(origin_data[intersection[i]]);
+    std::string request_str;
+    request.SerializeToString(&request_str);
+    send_ret = this->GetLinkContext()->Send(this->key_,
+                                            this->peer_node_, request_str);
+    if (send_ret != retcode::SUCCESS) {
+      LOG(ERROR) << "send psi request chunk: " << i << " to ["
+                 << this->peer_node_.to_string() << "] failed";
+      break;
     }
+    {
+      std::lock_guard<std::mutex> lck(sent_mtx);
+      sent_chunks++;
+    }
+    sent_cv.notify_all();
   }
-  return retcode::SUCCESS;
+  {
+    std::lock_guard<std::mutex> lck(sent_mtx);
+    send_finished = true;
+  }
+  sent_cv.notify_all();
+  if (send_ret != retcode::SUCCESS) {
+    // server is waiting for the next chunk, best effort to stop it
+    auto abort_ret = this->GetLinkContext()->Send(this->key_,
+        this->peer_node_, std::string(kChunkAbortMessage));
+    if (abort_ret != retcode::SUCCESS) {
+      LOG(ERROR) << "notify server to abort chunked psi failed";
+    }
+  }
+  auto send_ts = timer.timeElapse();
+  VLOG(5) << "send " << num_chunk << " psi request chunks, "
+          << "time cost(ms): " << send_ts;
+  auto recv_ret = recv_fut.get();
+  if (send_ret != retcode::SUCCESS || recv_ret != retcode::SUCCESS) {
+    LOG(ERROR) << "chunked ecdh psi failed";
+    return retcode::FAIL;
+  }
+  VLOG(5) << "receive psi responses, time cost(ms): " << timer.timeElapse();
+  return ExtractResultIndex(input.size(), intersection, result_index);
+}
+
+retcode EcdhPsiOperator::RecvChunkResponse(
+    const std::string& key_bytes,
+    size_t num_elements,
+    const std::function<bool(size_t)>& wait_chunk_sent,
+    std::vector<int64_t>* intersection) {
+  size_t chunk_size = this->options_.chunk_size;
+  auto executor = ParallelExecutor();
+  auto link_ctx = this->GetLinkContext();
+  std::string recv_str;
+  auto ret = link_ctx->Recv(this->key_, this->ProxyServerNode(), &recv_str);
+  CHECK_RETCODE_WITH_ERROR_MSG(ret, "receive server setup failed");
+  psi_proto::ServerSetup server_setup;
+  if (!server_setup.ParseFromString(recv_str)) {
+    LOG(ERROR) << "parse server setup failed";
+    return retcode::FAIL;
+  }
+  // chunks are only decrypted when they arrive, the filter of server setup
+  // is built and looked up once after all chunks
+  std::vector<std::string> decrypted;
+  decrypted.reserve(num_elements);
+  size_t num_chunk = (num_elements + chunk_size - 1) / chunk_size;
+  for (size_t i = 0; i < num_chunk; i++) {
+    CHECK_TASK_STOPPED(retcode::FAIL);
+    if (!wait_chunk_sent(i)) {
+      LOG(ERROR) << "psi request chunk: " << i << " was not sent";
+      return retcode::FAIL;
+    }
+    ret = link_ctx->Recv(this->key_, this->ProxyServerNode(), &recv_str);
+    CHECK_RETCODE_WITH_ERROR_MSG(ret, "receive psi response chunk failed");
+    psi_proto::Response response;
+    if (!response.ParseFromString(recv_str)) {
+      LOG(ERROR) << "parse psi response chunk: " << i << " failed";
+      return retcode::FAIL;
+    }
+    ret = executor.DecryptResponse(key_bytes, response, &decrypted);
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "decrypt psi response chunk: " << i << " failed";
+      return retcode::FAIL;
+    }
+  }
+  if (!reveal_intersection_) {
+    LOG(ERROR) << "intersection is not revealed";
+    return retcode::FAIL;
+  }
+  return EcdhParallelExecutor::Intersect(server_setup, decrypted,
+                                         intersection);
 }
 
 retcode EcdhPsiOperator::BuildInitParam(int64_t element_size,
-                                        std::string* init_param) {
+                                        std::string* init_param,
+                                        size_t chunk_size) {
   CHECK_TASK_STOPPED(retcode::FAIL);
   rpc::Params init_params;
   auto param_map = init_params.mutable_param_map();
@@ -147,6 +306,13 @@ retcode EcdhPsiOperator::BuildInitParam(int64_t element_size,
   pv_intersection.set_value_int32(this->reveal_intersection_ ? 1 : 0);
   pv_intersection.set_is_array(false);
   (*param_map)["reveal_intersection"] = pv_intersection;
+  if (chunk_size > 0) {
+    rpc::ParamValue pv_chunk_size;
+    pv_chunk_size.set_var_type(rpc::VarType::INT64);
+    pv_chunk_size.set_value_int64(chunk_size);
+    pv_chunk_size.set_is_array(false);
+    (*param_map)["chunk_size"] = pv_chunk_size;
+  }
   bool success = init_params.SerializeToString(init_param);
   if (!success) {
     LOG(ERROR) << "serialize init param failed";
@@ -245,7 +411,9 @@ retcode EcdhPsiOperator::ExecuteAsServer(
   SCopedTimer timer;
   size_t num_client_elements{0};
   bool reveal_intersection_flag{false};
-  auto ret = RecvInitParam(&num_client_elements, &reveal_intersection_flag);
+  size_t chunk_size{0};
+  auto ret = RecvInitParam(&num_client_elements, &reveal_intersection_flag,
+                           &chunk_size);
   CHECK_RETCODE(ret);
   // prepare for local compuation
   VLOG(5) << "sever begin to SetupMessage";
@@ -259,6 +427,10 @@ retcode EcdhPsiOperator::ExecuteAsServer(
                                            num_client_elements,
                                            input)).value();
   VLOG(5) << "sever end of SetupMessage";
+  if (chunk_size > 0) {
+    return ExecuteAsServerByChunk(server, server_setup,
+                                  num_client_elements, chunk_size);
+  }
   // recv request from clinet
   VLOG(5) << "server begin to init reauest according to recv data from client";
   psi_proto::Request psi_request;
@@ -267,14 +439,71 @@ retcode EcdhPsiOperator::ExecuteAsServer(
   auto init_req_ts = timer.timeElapse();
   auto init_req_time_cost = init_req_ts;
   VLOG(5) << "init_req_time_cost(ms): " << init_req_time_cost;
-  psi_proto::Response server_response =
-      std::move(server->ProcessRequest(psi_request)).value();
+  psi_proto::Response server_response;
+  ret = ParallelExecutor().ProcessRequest(server->GetPrivateKeyBytes(),
+                                          reveal_intersection_flag,
+                                          psi_request, &server_response);
+  CHECK_RETCODE_WITH_ERROR_MSG(ret, "process psi request failed");
   VLOG(5) << "server end of process request, begin to build response";
   PreparePSIResponse(std::move(server_response), std::move(server_setup));
   VLOG(5) << "end of send psi response to client";
   return retcode::SUCCESS;
 }
 
+retcode EcdhPsiOperator::ExecuteAsServerByChunk(
+    const std::unique_ptr<openminded_psi::PsiServer>& server,
+    const psi_proto::ServerSetup& server_setup,
+    size_t num_client_elements,
+    size_t chunk_size) {
+  SCopedTimer timer;
+  auto link_ctx = this->GetLinkContext();
+  std::string setup_str;
+  server_setup.SerializeToString(&setup_str);
+  auto ret = link_ctx->Send(this->key_, this->peer_node_, setup_str);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "send server setup to ["
+               << this->peer_node_.to_string() << "] failed";
+    return retcode::FAIL;
+  }
+  auto key_bytes = server->GetPrivateKeyBytes();
+  auto executor = ParallelExecutor();
+  size_t num_chunk = (num_client_elements + chunk_size - 1) / chunk_size;
+  for (size_t i = 0; i < num_chunk; i++) {
+    CHECK_TASK_STOPPED(retcode::FAIL);
+    std::string request_str;
+    ret = link_ctx->Recv(this->key_, this->ProxyServerNode(), &request_str);
+    CHECK_RETCODE_WITH_ERROR_MSG(ret, "receive request from client failed");
+    if (request_str == kChunkAbortMessage) {
+      LOG(ERROR) << "client aborted chunked psi at chunk: " << i;
+      return retcode::FAIL;
+    }
+    psi_proto::Request psi_request;
+    if (!psi_request.ParseFromString(request_str)) {
+      LOG(ERROR) << "parse psi request chunk: " << i << " failed";
+      return retcode::FAIL;
+    }
+    psi_proto::Response psi_response;
+    ret = executor.ProcessRequest(key_bytes,
+                                  psi_request.reveal_intersection(),
+                                  psi_request, &psi_response);
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "process psi request chunk: " << i << " failed";
+      return retcode::FAIL;
+    }
+    std::string response_str;
+    psi_response.SerializeToString(&response_str);
+    ret = link_ctx->Send(this->key_, this->peer_node_, response_str);
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "send psi response chunk: " << i << " to ["
+                 << this->peer_node_.to_string() << "] failed";
+      return retcode::FAIL;
+    }
+  }
+  VLOG(5) << "process " << num_chunk << " psi request chunks, "
+          << "time cost(ms): " << timer.timeElapse();
+  return retcode::SUCCESS;
+}
+
 retcode EcdhPsiOperator::InitRequest(psi_proto::Request* psi_request) {
   CHECK_TASK_STOPPED(retcode::FAIL);
   std::string request_str;
@@ -324,7 +553,8 @@ retcode EcdhPsiOperator::PreparePSIResponse(psi_proto::Response&& psi_response,
 }
 
 retcode EcdhPsiOperator::RecvInitParam(size_t* client_dataset_size,
-                                       bool* reveal_intersection) {
+                                       bool* reveal_intersection,
+                                       size_t* chunk_size) {
   CHECK_TASK_STOPPED(retcode::FAIL);
   VLOG(5) << "begin to recvInitParam ";
   std::string init_param_str;
@@ -350,6 +580,9 @@ retcode EcdhPsiOperator::RecvInitParam(size_t* client_dataset_size,
   }
   reveal_flag = it->second.value_int32() > 0;
   VLOG(5) << "reveal_intersection_: " << reveal_flag;
+  it = parm_map.find("chunk_size");
+  *chunk_size = it != parm_map.end() ? it->second.value_int64() : 0;
+  VLOG(5) << "chunk_size: " << *chunk_size;
   VLOG(5) << "end of recvInitParam ";
   return retcode::SUCCESS;
 }
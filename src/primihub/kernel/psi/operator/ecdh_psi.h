@@ -17,13 +17,17 @@
 #ifndef SRC_PRIMIHUB_KERNEL_PSI_OPERATOR_ECDH_PSI_H_
 #define SRC_PRIMIHUB_KERNEL_PSI_OPERATOR_ECDH_PSI_H_
 #include <unordered_map>
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <set>
 #include <vector>
 
 #include "src/primihub/kernel/psi/operator/base_psi.h"
+#include "src/primihub/kernel/psi/operator/ecdh_parallel.h"
 #include "private_set_intersection/cpp/psi_client.h"
+#include "private_set_intersection/cpp/psi_server.h"
 #include "src/primihub/protos/common.pb.h"
 #include "src/primihub/protos/psi.pb.h"
 #include "src/primihub/protos/worker.pb.h"
@@ -32,15 +36,35 @@ namespace primihub::psi {
 namespace openminded_psi = private_set_intersection;
 class EcdhPsiOperator : public BasePsiOperator {
  public:
+  // sent by client instead of the next request chunk when it fails
+  static constexpr std::string_view kChunkAbortMessage = "ecdh_psi_abort";
   explicit EcdhPsiOperator(const Options& options) : BasePsiOperator(options) {}
   retcode OnExecute(const std::vector<std::string>& input,
                     std::vector<std::string>* result) override;
+  retcode OnExecuteIndex(const std::vector<std::string>& input,
+                         std::vector<int64_t>* result_index) override;
 
  protected:
   retcode ExecuteAsClient(const std::vector<std::string>& input,
-                          std::vector<std::string>* result);
+                          std::vector<int64_t>* result_index);
+  /**
+   * blind and send input in batches of chunk_size,
+   * while the responses are received and decrypted in another thread
+  */
+  retcode ExecuteAsClientByChunk(const std::vector<std::string>& input,
+                                 std::vector<int64_t>* result_index);
+  /**
+   * wait_chunk_sent: block until the request chunk has been sent,
+   * return false if it will never be sent
+  */
+  retcode RecvChunkResponse(
+      const std::string& key_bytes,
+      size_t num_elements,
+      const std::function<bool(size_t)>& wait_chunk_sent,
+      std::vector<int64_t>* intersection);
   retcode SendRequetToServer(psi_proto::Request&& psi_request);
-  retcode BuildInitParam(int64_t element_size, std::string* init_param);
+  retcode BuildInitParam(int64_t element_size, std::string* init_param,
+                         size_t chunk_size = 0);
   retcode SendInitParam(const std::string& init_param);
   retcode SendPSIRequestAndWaitResponse(const psi_proto::Request& request,
                                         rpc::PsiResponse* response);
@@ -48,17 +72,29 @@ class EcdhPsiOperator : public BasePsiOperator {
                                         rpc::PsiResponse* response);
   retcode ParsePsiResponseFromeString(const std::string& res_str,
                                       rpc::PsiResponse* response);
-  retcode GetIntersection(const std::vector<std::string> origin_data,
+  retcode GetIntersection(size_t num_elements,
     const std::unique_ptr<openminded_psi::PsiClient>& client,
     rpc::PsiResponse& response,
-    std::vector<std::string>* result);
+    std::vector<int64_t>* result_index);
   // server method
   retcode ExecuteAsServer(const std::vector<std::string>& input);
   retcode InitRequest(psi_proto::Request* psi_request);
   retcode PreparePSIResponse(psi_proto::Response&& psi_response,
                              psi_proto::ServerSetup&& setup);
-  retcode RecvInitParam(size_t* client_dataset_size, bool* reveal_intersection);
+  retcode RecvInitParam(size_t* client_dataset_size, bool* reveal_intersection,
+                        size_t* chunk_size);
+  /**
+   * send server setup once, then process client request batch by batch
+  */
+  retcode ExecuteAsServerByChunk(
+      const std::unique_ptr<openminded_psi::PsiServer>& server,
+      const psi_proto::ServerSetup& server_setup,
+      size_t num_client_elements,
+      size_t chunk_size);
   void SetFpr(double fpr) {fpr_ = fpr;}
+  EcdhParallelExecutor ParallelExecutor() {
+    return EcdhParallelExecutor(options_.worker_num, &stop_);
+  }
 
  private:
   bool reveal_intersection_{true};
@@ -0,0 +1,102 @@
+// "Copyright [2023] <PrimiHub>"
+#include "src/primihub/kernel/psi/operator/item_hasher.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#include "cryptoTools/Crypto/AES.h"
+#include "cryptoTools/Crypto/RandomOracle.h"
+
+namespace primihub::psi {
+namespace {
+// partition smaller than this is not worth a thread
+constexpr size_t kMinItemsPerWorker = 16 * 1024;
+// number of short items encrypted by one aes call
+constexpr size_t kAesBatchSize = 256;
+// item with length less than this fits in one block with its length
+constexpr size_t kShortItemMaxLen = sizeof(oc::block) - 1;
+}  // namespace
+
+ItemHasher::ItemHasher(size_t worker_num) {
+  if (worker_num == 0) {
+    worker_num = std::thread::hardware_concurrency();
+  }
+  worker_num_ = std::max<size_t>(worker_num, 1);
+}
+
+size_t ItemHasher::WorkerNum(size_t item_num) {
+  size_t max_worker_num =
+      (item_num + kMinItemsPerWorker - 1) / kMinItemsPerWorker;
+  return std::max<size_t>(std::min(worker_num_, max_worker_num), 1);
+}
+
+retcode ItemHasher::HashItems(const std::vector<std::string>& input,
+                              std::vector<oc::block>* result) {
+  result->resize(input.size());
+  size_t item_num = input.size();
+  size_t worker_num = WorkerNum(item_num);
+  if (worker_num == 1) {
+    HashPartition(input, 0, item_num, result->data());
+    return retcode::SUCCESS;
+  }
+  size_t step = (item_num + worker_num - 1) / worker_num;
+  std::vector<std::future<void>> futs;
+  for (size_t offset = 0; offset < item_num; offset += step) {
+    size_t count = std::min(step, item_num - offset);
+    futs.push_back(std::async(std::launch::async,
+        [&, offset, count]() {
+          HashPartition(input, offset, count, result->data() + offset);
+        }));
+  }
+  for (auto& fut : futs) {
+    fut.get();
+  }
+  return retcode::SUCCESS;
+}
+
+void ItemHasher::HashPartition(const std::vector<std::string>& input,
+                               size_t offset, size_t count,
+                               oc::block* result) {
+  u8 block_size = sizeof(oc::block);
+  oc::RandomOracle oracle(block_size);
+  u8 hash_dest[sizeof(oc::block)];
+  std::array<oc::block, kAesBatchSize> plain;
+  std::array<oc::block, kAesBatchSize> cipher;
+  std::array<size_t, kAesBatchSize> plain_index;
+  size_t batch_size{0};
+  auto flush_batch = [&]() {
+    oc::mAesFixedKey.ecbEncBlocks(plain.data(), batch_size, cipher.data());
+    for (size_t j = 0; j < batch_size; j++) {
+      result[plain_index[j]] = cipher[j] ^ plain[j];
+    }
+    batch_size = 0;
+  };
+  for (size_t i = 0; i < count; i++) {
+    const auto& item = input[offset + i];
+    if (item.size() <= kShortItemMaxLen) {
+      // item bytes followed by zero padding, last byte is the length,
+      // so the encoding is injective
+      u8 buf[sizeof(oc::block)] = {0};
+      std::memcpy(buf, item.data(), item.size());
+      buf[kShortItemMaxLen] = static_cast<u8>(item.size());
+      plain[batch_size] = oc::toBlock(buf);
+      plain_index[batch_size] = i;
+      batch_size++;
+      if (batch_size == kAesBatchSize) {
+        flush_batch();
+      }
+    } else {
+      oracle.Update(reinterpret_cast<const u8*>(item.data()), item.size());
+      oracle.Final(hash_dest);
+      result[i] = oc::toBlock(hash_dest);
+      oracle.Reset();
+    }
+  }
+  if (batch_size > 0) {
+    flush_batch();
+  }
+}
+}  // namespace primihub::psi
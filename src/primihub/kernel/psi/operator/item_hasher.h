@@ -0,0 +1,36 @@
+// "Copyright [2023] <PrimiHub>"
+#ifndef SRC_PRIMIHUB_KERNEL_PSI_OPERATOR_ITEM_HASHER_H_
+#define SRC_PRIMIHUB_KERNEL_PSI_OPERATOR_ITEM_HASHER_H_
+#include <string>
+#include <vector>
+
+#include "cryptoTools/Common/Defines.h"
+#include "src/primihub/common/common.h"
+
+namespace primihub::psi {
+/**
+ * map psi items to oc::block, both parties must use the same hasher.
+ * item shorter than a block is encoded into one block together with
+ * its length and hashed by fixed-key aes: H(x) = AES_k(x) ^ x,
+ * which runs on AES-NI in batches. longer item is hashed by RandomOracle.
+ * input is split into contiguous partitions by the number of workers
+*/
+class ItemHasher {
+ public:
+  /**
+   * worker_num: 0 means the number of hardware threads
+  */
+  explicit ItemHasher(size_t worker_num = 0);
+  retcode HashItems(const std::vector<std::string>& input,
+                    std::vector<oc::block>* result);
+  size_t WorkerNum(size_t item_num);
+
+ protected:
+  void HashPartition(const std::vector<std::string>& input,
+                     size_t offset, size_t count, oc::block* result);
+
+ private:
+  size_t worker_num_{1};
+};
+}  // namespace primihub::psi
+#endif  // SRC_PRIMIHUB_KERNEL_PSI_OPERATOR_ITEM_HASHER_H_
@@ -10,6 +10,7 @@
 #include "cryptoTools/Crypto/PRNG.h"
 #include "cryptoTools/Common/Timer.h"
 
+#include "src/primihub/kernel/psi/operator/item_hasher.h"
 #include "src/primihub/util/network/message_interface.h"
 #include "libPSI/PSI/Kkrt/KkrtPsiSender.h"
 #include "libOTe/NChooseOne/Kkrt/KkrtNcoOtReceiver.h"
@@ -23,6 +24,15 @@
 namespace primihub::psi {
 retcode KkrtPsiOperator::OnExecute(const std::vector<std::string>& input,
                                    std::vector<std::string>* result) {
+  std::vector<int64_t> result_index;
+  auto ret = OnExecuteIndex(input, &result_index);
+  CHECK_RETCODE(ret);
+  IndexToItem(input, result_index, result);
+  return retcode::SUCCESS;
+}
+
+retcode KkrtPsiOperator::OnExecuteIndex(const std::vector<std::string>& input,
+                                        std::vector<int64_t>* result_index) {
   if (input.empty()) {
     LOG(ERROR) << "no data is set for kkrt psi";
     return retcode::FAIL;
@@ -36,21 +46,12 @@ retcode KkrtPsiOperator::OnExecute(const std::vector<std::string>& input,
   oc::Channel chl(ios, msg_interface.release());
   auto ret{retcode::SUCCESS};
   if (RoleValidation::IsClient(PartyName())) {
-    std::unordered_set<uint64_t> result_index;
-    ret = KkrtRecv(chl, input, &result_index);
-    result->reserve(result_index.size());
-    if (options_.psi_result_type == PsiResultType::DIFFERENCE) {
-      uint64_t num_elements = input.size();
-      for (uint64_t i = 0; i < num_elements; i++) {
-        if (result_index.find(i) == result_index.end()) {
-          result->push_back(input[i]);
-        }
-      }
-    } else {
-      for (const auto pos : result_index) {
-        result->push_back(input[pos]);
-      }
-    }
+    std::unordered_set<uint64_t> intersection_index;
+    ret = KkrtRecv(chl, input, &intersection_index);
+    CHECK_RETCODE(ret);
+    std::vector<int64_t> intersection(intersection_index.begin(),
+                                      intersection_index.end());
+    ret = ExtractResultIndex(input.size(), intersection, result_index);
   } else {
     ret = KkrtSend(chl, input);
   }
@@ -108,7 +109,8 @@ retcode KkrtPsiOperator::KkrtRecv(oc::Channel& chl,
   sendSize = dest[0];
   std::vector<oc::block> sendSet(sendSize), recvSet(recvSize);
   SCopedTimer timer;
-  HashDataParallel(input, &recvSet);
+  auto ret = ItemHasher(options_.worker_num).HashItems(input, &recvSet);
+  CHECK_RETCODE(ret);
   auto time_cost = timer.timeElapse();
   VLOG(5) << "encrypt data cost time(ms): " << time_cost;
   oc::KkrtNcoOtReceiver otRecv;
@@ -170,7 +172,8 @@ retcode KkrtPsiOperator::KkrtSend(oc::Channel& chl,
   recvSize = dest[0];
   SCopedTimer timer;
   std::vector<oc::block> set(sendSize);
-  HashDataParallel(input, &set);
+  auto ret = ItemHasher(options_.worker_num).HashItems(input, &set);
+  CHECK_RETCODE(ret);
   auto time_cost = timer.timeElapse();
   VLOG(5) << "encrypt data cost time(ms): " << time_cost;
 
@@ -204,53 +207,4 @@ retcode KkrtPsiOperator::KkrtSend(oc::Channel& chl,
   return retcode::SUCCESS;
 }
 
-retcode KkrtPsiOperator::HashDataParallel(const std::vector<std::string>& input,
-                                          std::vector<oc::block>* result_ptr) {
-  if (result_ptr->size() != input.size()) {
-    result_ptr->resize(input.size());
-  }
-  auto& result = *result_ptr;
-  uint64_t data_size = input.size();
-  uint64_t MAX_BLOCK_NUM = 10000000;  // 1000W
-  uint64_t block_num = data_size / MAX_BLOCK_NUM;
-  if (data_size % MAX_BLOCK_NUM) {
-    block_num++;
-  }
-  if (block_num == 1) {
-    u8 block_size = sizeof(oc::block);
-    oc::RandomOracle sha1(block_size);
-    u8 hash_dest[block_size];                                       // NOLINT
-    for (u64 i = 0; i < data_size; ++i) {
-      sha1.Update((u8 *)input[i].data(), input[i].size());          // NOLINT
-      sha1.Final((u8 *)hash_dest);                                  // NOLINT
-      result[i] = oc::toBlock(hash_dest);
-      sha1.Reset();
-    }
-  } else {
-    std::vector<std::future<void>> futs;
-    for (uint64_t i = 0; i < block_num; i++) {
-      uint64_t start_i = i * MAX_BLOCK_NUM;
-      uint64_t end_i = std::min((i+1) * MAX_BLOCK_NUM, data_size);
-      futs.push_back(
-        std::async(
-          std::launch::async,
-          [&, start_i, end_i]() {
-            u8 block_size = sizeof(oc::block);
-            oc::RandomOracle sha1(block_size);
-            u8 hash_dest[block_size];                               // NOLINT
-            for (u64 index = start_i; index < end_i; ++index) {
-              sha1.Update((u8 *)input[index].data(),                // NOLINT
-                          input[index].size());
-              sha1.Final((u8 *)hash_dest);                          // NOLINT
-              result[index] = oc::toBlock(hash_dest);
-              sha1.Reset();
-            }
-          }));
-    }
-    for (auto&& fut : futs) {
-      fut.get();
-    }
-  }
-  return retcode::SUCCESS;
-}
 }  // namespace primihub::psi
@@ -20,6 +20,8 @@ class KkrtPsiOperator : public BasePsiOperator {
   explicit KkrtPsiOperator(const Options& options) : BasePsiOperator(options) {}
   retcode OnExecute(const std::vector<std::string>& input,
                     std::vector<std::string>* result) override;
+  retcode OnExecuteIndex(const std::vector<std::string>& input,
+                         std::vector<int64_t>* result_index) override;
 
  protected:
   auto BuildChannelInterface() -> std::unique_ptr<TaskMessagePassInterface>;
@@ -27,8 +29,6 @@ class KkrtPsiOperator : public BasePsiOperator {
                    const std::vector<std::string>& input,
                    std::unordered_set<uint64_t>* result_index);
   retcode KkrtSend(oc::Channel& chl, const std::vector<std::string>& input);
-  retcode HashDataParallel(const std::vector<std::string>& input,
-                           std::vector<oc::block>* result);
 };
 }  // namespace primihub::psi
 #endif  // SRC_PRIMIHUB_KERNEL_PSI_OPERATOR_KKRT_PSI_H_
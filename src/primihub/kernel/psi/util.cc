@@ -15,6 +15,7 @@
  */
 #include "src/primihub/kernel/psi/util.h"
 #include <glog/logging.h>
+#include <arrow/compute/api.h>
 #include <string>
 #include <set>
 #include <future>
@@ -202,6 +203,16 @@ retcode PsiCommonUtil::LoadDatasetInternal(
     const std::vector<int>& col_index,
     std::vector<std::string>* col_data,
     std::vector<std::string>* col_names) {
+  std::shared_ptr<arrow::Table> table;
+  return LoadDatasetInternal(driver, col_index, col_data, col_names, &table);
+}
+
+retcode PsiCommonUtil::LoadDatasetInternal(
+    std::shared_ptr<DataDriver>& driver,
+    const std::vector<int>& col_index,
+    std::vector<std::string>* col_data,
+    std::vector<std::string>* col_names,
+    std::shared_ptr<arrow::Table>* table) {
   auto cursor = driver->GetCursor(col_index);
   if (cursor == nullptr) {
     LOG(ERROR) << "get cursor for dataset failed";
@@ -229,13 +240,13 @@ retcode PsiCommonUtil::LoadDatasetInternal(
     LOG(ERROR) << "get data failed";
     return retcode::FAIL;
   }
-  auto& table = std::get<std::shared_ptr<arrow::Table>>(ds->data);
-  int col_count = table->num_columns();
+  *table = std::get<std::shared_ptr<arrow::Table>>(ds->data);
+  int col_count = (*table)->num_columns();
   bool all_colum_valid = validationDataColum(col_index, col_count);
   if (!all_colum_valid) {
     return retcode::FAIL;
   }
-  return LoadDatasetFromTable(table, col_index, col_data, col_names);
+  return LoadDatasetFromTable(*table, col_index, col_data, col_names);
 }
 
 retcode PsiCommonUtil::LoadDatasetInternal(
@@ -321,6 +332,45 @@ retcode PsiCommonUtil::SaveDataToCSVFile(
   return retcode::SUCCESS;
 }
 
+retcode PsiCommonUtil::SaveDataToCSVFile(
+    const std::shared_ptr<arrow::Table>& table,
+    const std::vector<int64_t>& row_index,
+    const std::string& file_path) {
+  SCopedTimer timer;
+  arrow::Int64Builder index_builder;
+  auto status = index_builder.AppendValues(row_index);
+  std::shared_ptr<arrow::Array> index_array;
+  if (status.ok()) {
+    status = index_builder.Finish(&index_array);
+  }
+  if (!status.ok()) {
+    LOG(ERROR) << "build row index array failed, " << status;
+    return retcode::FAIL;
+  }
+  auto take_result = arrow::compute::Take(table, index_array);
+  if (!take_result.ok()) {
+    LOG(ERROR) << "take result rows from table failed, "
+               << take_result.status();
+    return retcode::FAIL;
+  }
+  auto result_table = take_result.ValueOrDie().table();
+  VLOG(5) << "take " << row_index.size() << " rows, "
+          << "time cost(ms): " << timer.timeElapse();
+  auto driver = DataDirverFactory::getDriver("CSV", "test address");
+  auto csv_driver = std::dynamic_pointer_cast<CSVDriver>(driver);
+  if (ValidateDir(file_path)) {
+    LOG(ERROR) << "can't access file path: " << file_path;
+    return retcode::FAIL;
+  }
+  int ret = csv_driver->write(result_table, file_path);
+  if (ret != 0) {
+    LOG(ERROR) << "Save PSI result to file " << file_path << " failed.";
+    return retcode::FAIL;
+  }
+  LOG(INFO) << "Save PSI result to " << file_path << ".";
+  return retcode::SUCCESS;
+}
+
 retcode PsiCommonUtil::saveDataToCSVFile(
     const std::vector<std::string>& data,
     const std::string& file_path, const std::string& col_title) {
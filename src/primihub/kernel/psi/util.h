@@ -48,6 +48,15 @@ class PsiCommonUtil {
                               const std::vector<int>& data_col,
                               std::vector<std::string>* col_data,
                               std::vector<std::string>* col_names);
+  /**
+   * same as above, table of the selected colums read as string is returned,
+   * which is used to materialize the result rows after psi
+  */
+  retcode LoadDatasetInternal(std::shared_ptr<DataDriver>& driver,
+                              const std::vector<int>& data_col,
+                              std::vector<std::string>* col_data,
+                              std::vector<std::string>* col_names,
+                              std::shared_ptr<arrow::Table>* table);
   retcode LoadDatasetInternal(const std::string& driver_name,
                               const std::string& conn_str,
                               const std::vector<int>& data_cols,
@@ -58,6 +67,12 @@ class PsiCommonUtil {
   retcode SaveDataToCSVFile(const std::vector<std::string>& data,
                             const std::string& file_path,
                             const std::vector<std::string>& col_title);
+  /**
+   * take rows of table by row_index and save them to file_path
+  */
+  retcode SaveDataToCSVFile(const std::shared_ptr<arrow::Table>& table,
+                            const std::vector<int64_t>& row_index,
+                            const std::string& file_path);
 
  protected:
   /**
@@ -18,6 +18,7 @@
 #include <arrow/api.h>
 #include <arrow/flight/internal.h>
 #include <arrow/flight/server.h>
+#include <grpcpp/resource_quota.h>
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/memory/memory.h"
@@ -86,6 +87,11 @@ void RunServer(primihub::VMNodeInterface* node_service,
 #endif
         // set the max message size to 128M
         builder->SetMaxReceiveMessageSize(128 * 1024 * 1024);
+        // bound sync server threads, long-lived streams are limited
+        // by the service itself so other rpcs are still served
+        grpc::ResourceQuota quota("primihub_node");
+        quota.SetMaxThreads(primihub::GRPC_SERVER_MAX_THREADS);
+        builder->SetResourceQuota(quota);
     };
 
     if (host_config.use_tls()) {
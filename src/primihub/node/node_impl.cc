@@ -15,6 +15,7 @@
  */
 
 #include "src/primihub/node/node_impl.h"
+#include <algorithm>
 #include <vector>
 
 #include "src/primihub/common/common.h"
@@ -35,13 +36,22 @@ VMNodeImpl::VMNodeImpl(const std::string& config_file,
 }
 
 VMNodeImpl::~VMNodeImpl() {
-  stop_.store(true);
+  {
+    std::lock_guard<std::mutex> lck(worker_ready_mtx_);
+    stop_.store(true);
+  }
+  worker_ready_cv_.notify_all();
   fininished_workers_.shutdown();
   fininished_scheduler_workers_.shutdown();
+  finished_task_queue_.shutdown();
+  task_manage_queue_.shutdown();
+  kill_task_queue_.shutdown();
   finished_worker_fut_.get();
   clean_cached_task_status_fut_.get();
   finished_scheduler_worker_fut_.get();
   manage_task_worker_fut_.get();
+  kill_task_queue_fut_.get();
+  TaskProcessPool::getInstance().Shutdown();
   this->nodelet_.reset();
 }
 
@@ -58,6 +68,13 @@ retcode VMNodeImpl::Init() {
   CleanFinishedSchedulerWorkerThread();
   ManageTaskOperatorThread();
   ProcessKillTaskThread();
+  auto& pool_cfg = server_config.getNodeConfig().task_process_pool;
+  if (pool_cfg.pool_size > 0) {
+    TaskProcessPool::getInstance().Init(this->node_id_,
+                                        server_config.getConfigFile(),
+                                        pool_cfg.pool_size,
+                                        pool_cfg.max_task_per_process);
+  }
   return retcode::SUCCESS;
 }
 void VMNodeImpl::ProcessKillTaskThread() {
@@ -498,10 +515,6 @@ std::shared_ptr<Worker> VMNodeImpl::GetSchedulerWorker(
 }
 
 bool VMNodeImpl::IsTaskWorkerReady(const std::string& worker_id) {
-  if (write_flag_.load(std::memory_order::memory_order_relaxed)) {
-    LOG(WARNING) << "lock task_executor_mtx_ is not available";
-    return false;
-  }
   std::shared_lock<std::shared_mutex> lck(task_executor_mtx_);
   auto it = task_executor_map_.find(worker_id);
   if (it != task_executor_map_.end()) {
@@ -581,6 +594,7 @@ void VMNodeImpl::CleanTimeoutCachedTaskStatusThread() {
             finished_task_status_.erase(worker_id);
           }
         }
+        CleanTimeoutEarlyArrivedData();
         std::this_thread::sleep_for(
             std::chrono::seconds(this->cached_task_status_timeout_/2));
       }
@@ -656,10 +670,42 @@ retcode VMNodeImpl::ProcessReceivedData(const rpc::TaskContext& task_info,
     LOG(ERROR) << err_msg;
     return retcode::FAIL;
   }
-  auto ret = WaitUntilWorkerReady(worker_id, wait_worker_ready_timeout_ms_);
-  if (ret != retcode::SUCCESS) {
-    LOG(ERROR) << "wati worker ready timeout";
-    return retcode::FAIL;
+  {
+    // data may arrive before the worker is added by ManageTaskOperatorThread,
+    // cache it instead of blocking the rpc thread, it is delivered
+    // in arrival order by ExecuteAddTaskOperation
+    std::lock_guard<std::mutex> lck(worker_ready_mtx_);
+    if (early_arrived_failed_task_.count(worker_id)) {
+      LOG(ERROR) << "worker id: " << worker_id << " has failed "
+                 << "before it is ready, reject data for key: " << key;
+      return retcode::FAIL;
+    }
+    if (!IsTaskWorkerReady(worker_id)) {
+      size_t data_size = data_buffer.size();
+      auto it = early_arrived_data_.find(worker_id);
+      size_t task_bytes =
+          it == early_arrived_data_.end() ? 0 : std::get<1>(it->second);
+      if (task_bytes + data_size > EARLY_ARRIVED_DATA_TASK_LIMIT ||
+          early_arrived_bytes_ + data_size > EARLY_ARRIVED_DATA_TOTAL_LIMIT) {
+        LOG(ERROR) << "cache for data arrived before worker is ready is full, "
+                   << "worker id: " << worker_id << " "
+                   << "task cached bytes: " << task_bytes << " "
+                   << "total cached bytes: " << early_arrived_bytes_ << " "
+                   << "data size: " << data_size;
+        FailEarlyArrivedTask(worker_id);
+        return retcode::FAIL;
+      }
+      if (it == early_arrived_data_.end()) {
+        it = early_arrived_data_.emplace(worker_id,
+            early_data_t{::time(nullptr), 0, {}}).first;
+      }
+      std::get<1>(it->second) += data_size;
+      early_arrived_bytes_ += data_size;
+      std::get<2>(it->second).emplace_back(key, std::move(data_buffer));
+      VLOG(5) << "worker id: " << worker_id << " is not ready, "
+              << "cache data for key: " << key;
+      return retcode::SUCCESS;
+    }
   }
   auto worker_ptr = this->GetWorker(task_info);
   if (worker_ptr == nullptr) {
@@ -775,30 +821,167 @@ retcode VMNodeImpl::ProcessForwardData(const rpc::TaskContext& task_info,
   return retcode::SUCCESS;
 }
 
-retcode VMNodeImpl::WaitUntilWorkerReady(const std::string& worker_id,
-                                         int timeout_ms) {
-  SCopedTimer timer;
-  do {
-    // try to get lock
-    if (IsTaskWorkerReady(worker_id)) {
-      break;
-    }
-    VLOG(5) << "sleep and wait for worker ready, "
-            << "worker id : " << worker_id << " ........";
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    if (timeout_ms == -1) {
+retcode VMNodeImpl::ProcessSubscribeData(
+    const rpc::TaskContext& task_info,
+    const std::string& key,
+    const std::function<bool(const std::string&)>& write_fn,
+    const std::function<bool()>& is_cancelled) {
+  std::string worker_id = this->GetWorkerId(task_info);
+  auto ret = WaitUntilWorkerReady(worker_id,
+                                  this->wait_worker_ready_timeout_ms_);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "wati worker ready timeout";
+    return retcode::FAIL;
+  }
+  // keep worker alive until subscription ends
+  auto worker_ptr = this->GetWorker(task_info);
+  if (worker_ptr == nullptr) {
+    LOG(ERROR) << "Task worker for " << TaskInfoToString(task_info)
+               << " not found";
+    return retcode::FAIL;
+  }
+  auto& link_ctx = worker_ptr->getTask()->getTaskContext().getLinkContext();
+  if (link_ctx == nullptr) {
+    LOG(ERROR) << "LinkContext is empty for " << TaskInfoToString(task_info);
+    return retcode::FAIL;
+  }
+  auto& recv_queue = link_ctx->GetRecvQueue(key);
+  std::string data_buffer;
+  while (!is_cancelled()) {
+    if (!recv_queue.wait_for_and_pop(data_buffer,
+                                     SUBSCRIBE_CHECK_INTERVAL_MS)) {
+      if (recv_queue.is_shutdown() ||
+          std::get<0>(this->IsFinishedTask(worker_id))) {
+        break;
+      }
       continue;
     }
-    auto time_elapse_ms = timer.timeElapse();
-    if (time_elapse_ms > timeout_ms) {
-      LOG(ERROR) << "wait for worker ready timeout(ms): " << timeout_ms;
+    if (!write_fn(data_buffer)) {
+      LOG(ERROR) << "push data to subscriber failed, key: " << key << " "
+                 << "data size: " << data_buffer.size();
+      if (!std::get<0>(this->IsFinishedTask(worker_id))) {
+        // the message has been acknowledged to its sender and taken out of
+        // recv queue, it can not be put back in order, fail the task
+        // instead of leaving the receiver waiting for it forever
+        LOG(ERROR) << "kill worker id: " << worker_id << " "
+                   << "whose data of key: " << key << " is lost";
+        CacheLastTaskStatus(worker_id, rpc::TaskStatus::FAIL);
+        recv_queue.shutdown();
+        task_manage_queue_.push(
+            std::make_tuple(worker_id,
+                std::make_tuple(nullptr, std::future<void>()),
+                OperateTaskType::kKill));
+      }
       return retcode::FAIL;
     }
-  } while (true);
+  }
+  VLOG(5) << "subscription of key: " << key << " finished";
+  return retcode::SUCCESS;
+}
 
+retcode VMNodeImpl::WaitUntilWorkerReady(const std::string& worker_id,
+                                         int timeout_ms) {
+  SCopedTimer timer;
+  if (!WaitWorkerReadyFor(worker_id, timeout_ms)) {
+    if (stop_.load(std::memory_order::memory_order_relaxed)) {
+      LOG(ERROR) << "service is stopping, worker id: " << worker_id;
+    } else {
+      LOG(ERROR) << "wait for worker ready timeout(ms): " << timeout_ms;
+    }
+    return retcode::FAIL;
+  }
+  VLOG(5) << "worker id: " << worker_id << " is ready, "
+          << "wait time cost(ms): " << timer.timeElapse();
   return retcode::SUCCESS;
 }
 
+bool VMNodeImpl::WaitWorkerReadyFor(const std::string& worker_id,
+                                    int timeout_ms) {
+  std::unique_lock<std::mutex> lck(worker_ready_mtx_);
+  auto is_ready = [&]() {
+    return stop_.load(std::memory_order::memory_order_relaxed) ||
+        IsTaskWorkerReady(worker_id);
+  };
+  if (timeout_ms == -1) {
+    worker_ready_cv_.wait(lck, is_ready);
+  } else {
+    worker_ready_cv_.wait_for(lck,
+        std::chrono::milliseconds(timeout_ms), is_ready);
+  }
+  if (stop_.load(std::memory_order::memory_order_relaxed)) {
+    return false;
+  }
+  return IsTaskWorkerReady(worker_id);
+}
+
+bool VMNodeImpl::DeliverEarlyArrivedData(const std::string& worker_id,
+    const std::shared_ptr<Worker>& worker) {
+  if (early_arrived_failed_task_.count(worker_id)) {
+    LOG(ERROR) << "worker id: " << worker_id << " has failed "
+               << "before it is ready";
+    return false;
+  }
+  auto it = early_arrived_data_.find(worker_id);
+  if (it == early_arrived_data_.end()) {
+    return true;
+  }
+  auto task_ptr = worker != nullptr ? worker->getTask() : nullptr;
+  if (task_ptr == nullptr ||
+      task_ptr->getTaskContext().getLinkContext() == nullptr) {
+    LOG(ERROR) << "LinkContext is empty for worker id: " << worker_id;
+    FailEarlyArrivedTask(worker_id);
+    return false;
+  }
+  auto early_data = std::move(std::get<2>(it->second));
+  early_arrived_bytes_ -= std::get<1>(it->second);
+  early_arrived_data_.erase(it);
+  auto& link_ctx = task_ptr->getTaskContext().getLinkContext();
+  for (auto& [key, data] : early_data) {
+    link_ctx->GetRecvQueue(key).push(std::move(data));
+  }
+  VLOG(5) << "deliver early arrived data for worker id: " << worker_id << ", "
+          << "count: " << early_data.size();
+  return true;
+}
+
+void VMNodeImpl::FailEarlyArrivedTask(const std::string& worker_id) {
+  auto it = early_arrived_data_.find(worker_id);
+  if (it != early_arrived_data_.end()) {
+    LOG(ERROR) << "worker id: " << worker_id << " failed, "
+               << "drop early arrived data, count: "
+               << std::get<2>(it->second).size();
+    early_arrived_bytes_ -= std::get<1>(it->second);
+    early_arrived_data_.erase(it);
+  }
+  early_arrived_failed_task_[worker_id] = ::time(nullptr);
+  CacheLastTaskStatus(worker_id, rpc::TaskStatus::FAIL);
+}
+
+void VMNodeImpl::CleanTimeoutEarlyArrivedData() {
+  time_t timeout_s = std::max(wait_worker_ready_timeout_ms_ / 1000, 1);
+  time_t now_ = ::time(nullptr);
+  std::lock_guard<std::mutex> lck(worker_ready_mtx_);
+  std::vector<std::string> timeout_worker_id;
+  for (const auto& [worker_id, early_data] : early_arrived_data_) {
+    if (now_ - std::get<0>(early_data) > timeout_s) {
+      LOG(ERROR) << "worker id: " << worker_id << " is not ready in "
+                 << timeout_s << "s";
+      timeout_worker_id.push_back(worker_id);
+    }
+  }
+  for (const auto& worker_id : timeout_worker_id) {
+    FailEarlyArrivedTask(worker_id);
+  }
+  for (auto it = early_arrived_failed_task_.begin();
+      it != early_arrived_failed_task_.end();) {
+    if (now_ - it->second > EARLY_ARRIVED_FAILED_TASK_TIMEOUT_S) {
+      it = early_arrived_failed_task_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 void VMNodeImpl::CleanDuplicateTaskIdFilter() {
   SCopedTimer timer;
   std::map<std::string, int8_t> timeouted_task_id;
@@ -870,17 +1053,34 @@ retcode VMNodeImpl::ExecuteAddTaskOperation(task_manage_t&& task_detail_) {
     }
   } while (0);
 
+  bool delivered{true};
   do {
-    write_flag_.store(true);
-    SCopedTimer timer;
-    std::lock_guard<std::shared_mutex> lck(task_executor_mtx_);
-    auto& task_queue = task_executor_map_[worker_id];
-    task_queue.emplace(std::move(task));
-    double time_cost = timer.timeElapse();
-    VLOG(7) << "ManageTaskThread operator: add worker id: " << worker_id << " "
-            << "time cost(ms): " << time_cost;
-    write_flag_.store(false);
+    // hold worker_ready_mtx_ until early arrived data is delivered,
+    // so that data received later can not overtake it
+    std::lock_guard<std::mutex> ready_lck(worker_ready_mtx_);
+    auto worker = std::get<0>(task);
+    do {
+      SCopedTimer timer;
+      std::lock_guard<std::shared_mutex> lck(task_executor_mtx_);
+      auto& task_queue = task_executor_map_[worker_id];
+      task_queue.emplace(std::move(task));
+      double time_cost = timer.timeElapse();
+      VLOG(7) << "ManageTaskThread operator: add worker id: "
+              << worker_id << " "
+              << "time cost(ms): " << time_cost;
+    } while (0);
+    delivered = DeliverEarlyArrivedData(worker_id, worker);
   } while (0);
+  worker_ready_cv_.notify_all();
+  if (!delivered) {
+    // data acknowledged to peer is lost, the task can not succeed
+    LOG(ERROR) << "kill worker id: " << worker_id << " "
+               << "whose early arrived data is lost";
+    task_manage_queue_.push(
+        std::make_tuple(worker_id,
+            std::make_tuple(nullptr, std::future<void>()),
+            OperateTaskType::kKill));
+  }
 
   return retcode::SUCCESS;
 }
@@ -889,7 +1089,6 @@ retcode VMNodeImpl::ExecuteDelTaskOperation(task_manage_t&& task_detail_) {
   VLOG(7) << "VMNodeImpl::ManageTaskThread recv task operator DEL";
   SCopedTimer timer;
   auto task_detail = std::move(task_detail_);
-  write_flag_.store(true);
   std::lock_guard<std::shared_mutex> lck(task_executor_mtx_);
   auto lock_time = timer.timeElapse();
   auto& worker_id = std::get<0>(task_detail);
@@ -918,7 +1117,6 @@ retcode VMNodeImpl::ExecuteDelTaskOperation(task_manage_t&& task_detail_) {
   } else {
     LOG(WARNING) << "worker_id: " << worker_id << " has already been erased";
   }
-  write_flag_.store(false);
   return retcode::SUCCESS;
 }
 
@@ -926,7 +1124,6 @@ retcode VMNodeImpl::ExecuteKillTaskOperation(task_manage_t&& task_detail_) {
   VLOG(7) << "VMNodeImpl::ManageTaskThread recv task operator KILL";
   SCopedTimer timer;
   auto task_detail = std::move(task_detail_);
-  write_flag_.store(true);
   std::lock_guard<std::shared_mutex> lck(task_executor_mtx_);
   auto lock_time = timer.timeElapse();
   auto& worker_id = std::get<0>(task_detail);
@@ -953,7 +1150,6 @@ retcode VMNodeImpl::ExecuteKillTaskOperation(task_manage_t&& task_detail_) {
             << "destroy queue cost: " << dctr_cost << " "
             << "total time cost(ms): " << time_cost;
   }
-  write_flag_.store(false);
   return retcode::SUCCESS;
 }
 }  // namespace primihub
@@ -18,15 +18,18 @@
 #define SRC_PRIMIHUB_NODE_NODE_IMPL_H_
 #include <memory>
 #include <mutex>
+#include <condition_variable>
 #include <utility>
 #include <map>
 #include <unordered_map>
 #include <set>
 #include <future>
+#include <functional>
 #include <atomic>
 #include <tuple>
 #include <string>
 #include <queue>
+#include <vector>
 
 #include "src/primihub/common/common.h"
 #include "src/primihub/util/threadsafe_queue.h"
@@ -52,7 +55,7 @@ class VMNodeImpl {
 
   explicit VMNodeImpl(const std::string& config_file,
                       std::shared_ptr<service::DatasetService> service);
-  ~VMNodeImpl();
+  virtual ~VMNodeImpl();
   retcode DispatchTask(const rpc::PushTaskRequest& task_request,
                        rpc::PushTaskReply* reply);
   retcode ExecuteTask(const rpc::PushTaskRequest& task_request,
@@ -119,8 +122,23 @@ class VMNodeImpl {
   retcode ProcessForwardData(const rpc::TaskContext& task_info,
                              const std::string& key,
                              std::string* data_buffer);
+  /**
+   * deliver data of key to subscriber by write_fn as soon as it arrives,
+   * until the task finishes, is_cancelled returns true or write_fn fails.
+   * data taken out but not written is lost, so the unfinished task is failed
+  */
+  retcode ProcessSubscribeData(
+      const rpc::TaskContext& task_info,
+      const std::string& key,
+      const std::function<bool(const std::string&)>& write_fn,
+      const std::function<bool()>& is_cancelled);
   retcode WaitUntilWorkerReady(const std::string& worker_id,
                                int timeout_ms = -1);
+  /**
+   * block until worker is ready or timeout_ms elapsed, without error log,
+   * return true if worker is ready
+  */
+  bool WaitWorkerReadyFor(const std::string& worker_id, int timeout_ms);
   std::shared_ptr<Nodelet> GetNodelet() { return this->nodelet_;}
 
  protected:
@@ -142,6 +160,20 @@ class VMNodeImpl {
     return info;
   }
   retcode ExecuteAddTaskOperation(task_manage_t&& task_detail);
+  /**
+   * deliver data arrived before worker is ready to its link context,
+   * return false if the task has failed and the worker must be killed,
+   * caller must hold worker_ready_mtx_
+  */
+  bool DeliverEarlyArrivedData(const std::string& worker_id,
+                               const std::shared_ptr<Worker>& worker);
+  /**
+   * drop data cached for a worker which is not ready and fail the task,
+   * data sent to it later is rejected and the worker is killed once added,
+   * caller must hold worker_ready_mtx_
+  */
+  void FailEarlyArrivedTask(const std::string& worker_id);
+  void CleanTimeoutEarlyArrivedData();
   retcode ExecuteDelTaskOperation(task_manage_t&& task_detail);
   retcode ExecuteKillTaskOperation(task_manage_t&& task_detail);
 
@@ -179,7 +211,19 @@ class VMNodeImpl {
   std::future<void> manage_task_worker_fut_;
 
   ThreadSafeQueue<task_manage_t> task_manage_queue_;
-  std::atomic<bool> write_flag_{false};
+  // notify waiters when a worker is added to task_executor_map_,
+  // also protect early_arrived_data_
+  std::mutex worker_ready_mtx_;
+  std::condition_variable worker_ready_cv_;
+  // key: worker id
+  // value: first arrive timestamp, total bytes,
+  //        list of <key, data> in arrival order
+  using early_data_t = std::tuple<time_t, size_t,
+      std::vector<std::pair<std::string, std::string>>>;
+  std::unordered_map<std::string, early_data_t> early_arrived_data_;
+  size_t early_arrived_bytes_{0};
+  // key: worker id, value: timestamp of failure
+  std::unordered_map<std::string, time_t> early_arrived_failed_task_;
   ThreadSafeQueue<task_executor_container_t> finished_task_queue_;
   ThreadSafeQueue<task_executor_container_t> kill_task_queue_;
   std::future<void> kill_task_queue_fut_;
@@ -126,13 +126,17 @@ Status VMNodeInterface::Send(ServerContext* context,
               << "request_id: " << task_info.request_id() << " "
               << "recv key: " << key;
     }
-    received_data.append(request.data());
+    AppendPackage(&request, &received_data);
   }
   size_t data_size = received_data.size();
   auto ret = this->ServerImpl()->ProcessReceivedData(task_info, key,
                                                      std::move(received_data));
   if (ret != retcode::SUCCESS) {
+    std::string err_msg = "process received data for key: " + key + " failed";
+    LOG(ERROR) << err_msg << ", data size: " << data_size;
     response->set_ret_code(rpc::retcode::FAIL);
+    response->set_msg_info(std::move(err_msg));
+    return Status::OK;
   }
   VLOG(5) << "end of VMNodeImpl::Send, data total received size:" << data_size;
   response->set_ret_code(rpc::retcode::SUCCESS);
@@ -156,11 +160,7 @@ Status VMNodeInterface::Recv(ServerContext* context,
     writer->Write(response);
     return grpc::Status::OK;
   }
-  std::vector<std::unique_ptr<rpc::TaskResponse>> response_data;
-  BuildTaskResponse(send_data, &response_data);
-  for (const auto& res : response_data) {
-    writer->Write(*res);
-  }
+  WriteTaskResponse(send_data, writer);
   return grpc::Status::OK;
 }
 
@@ -187,7 +187,7 @@ Status VMNodeInterface::SendRecv(ServerContext* context,
               << "request_id: " << task_info.request_id() << " "
               << "send key: " << key;
     }
-    received_data.append(request.data());
+    AppendPackage(&request, &received_data);
   }
   size_t data_size = received_data.size();
   auto ret = this->ServerImpl()->ProcessReceivedData(task_info, key,
@@ -212,10 +212,89 @@ Status VMNodeInterface::SendRecv(ServerContext* context,
     stream->Write(response);
     return Status::OK;
   }
-  std::vector<std::unique_ptr<rpc::TaskResponse>> response_data;
-  BuildTaskResponse(send_data, &response_data);
-  for (const auto& res : response_data) {
-    stream->Write(*res);
+  WriteTaskResponse(send_data, stream);
+  return Status::OK;
+}
+
+Status VMNodeInterface::DataStream(ServerContext* context,
+    ServerReaderWriter<rpc::TaskResponse, rpc::TaskRequest>* stream) {
+  // every data stream holds a server thread until its channel is closed,
+  // reject it before the sync server pool is exhausted
+  auto active = active_data_streams_.fetch_add(1) + 1;
+  if (active > MAX_DATA_STREAMS) {
+    active_data_streams_.fetch_sub(1);
+    LOG(WARNING) << "too many data streams: " << active - 1 << ", "
+                 << "reject data stream from: " << context->peer();
+    return Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                  "too many data streams, use Send instead");
+  }
+  auto ret = DataStreamImpl(context, stream);
+  active_data_streams_.fetch_sub(1);
+  return ret;
+}
+
+Status VMNodeInterface::DataStreamImpl(ServerContext* context,
+    ServerReaderWriter<rpc::TaskResponse, rpc::TaskRequest>* stream) {
+  bool recv_meta_info{false};
+  rpc::TaskContext task_info;
+  std::string key;
+  std::string received_data;
+  size_t data_len{0};
+  uint64_t seq_no{0};
+  auto compress_mode{network::CompressMode::NONE};
+  size_t raw_data_len{0};
+  rpc::TaskRequest request;
+  while (stream->Read(&request)) {
+    if (!recv_meta_info) {
+      if (task_info.request_id() != request.task_info().request_id()) {
+        task_info.CopyFrom(request.task_info());
+      }
+      key = request.role();
+      data_len = request.data_len();
+      seq_no = request.seq_no();
+      compress_mode =
+          static_cast<network::CompressMode>(request.compress_mode());
+      raw_data_len = request.raw_data_len();
+      received_data.reserve(data_len);
+      recv_meta_info = true;
+    }
+    AppendPackage(&request, &received_data);
+    if (received_data.size() < data_len) {
+      continue;
+    }
+    // one message has been received completely
+    auto ret{retcode::SUCCESS};
+    if (compress_mode != network::CompressMode::NONE) {
+      std::string raw_data;
+      ret = network::Compressor::Decompress(compress_mode, received_data,
+                                            raw_data_len, &raw_data);
+      received_data = std::move(raw_data);
+    }
+    if (ret == retcode::SUCCESS) {
+      ret = this->ServerImpl()->ProcessReceivedData(
+          task_info, key, std::move(received_data));
+    }
+    rpc::TaskResponse ack;
+    ack.set_seq_no(seq_no);
+    ack.set_compress_support(network::Compressor::SupportedModes());
+    if (ret != retcode::SUCCESS) {
+      ack.set_ret_code(rpc::retcode::FAIL);
+      ack.set_msg_info("ProcessReceivedData encountes error, key: " + key);
+    } else {
+      ack.set_ret_code(rpc::retcode::SUCCESS);
+    }
+    if (!stream->Write(ack)) {
+      LOG(ERROR) << "write ack for seq_no: " << seq_no << " failed";
+      break;
+    }
+    received_data = std::string();
+    recv_meta_info = false;
+  }
+  if (recv_meta_info) {
+    LOG(ERROR) << "data stream closed before message is complete, "
+               << "key: " << key << " seq_no: " << seq_no << " "
+               << "expected: " << data_len << " "
+               << "received: " << received_data.size();
   }
   return Status::OK;
 }
@@ -295,14 +374,60 @@ Status VMNodeInterface::ForwardRecv(ServerContext* context,
     writer->Write(response);
     return Status::OK;
   }
-  std::vector<std::unique_ptr<rpc::TaskRequest>> forward_recv_datas;
-  this->BuildTaskRequest(task_info, key, recv_data, &forward_recv_datas);
-  for (const auto& data_ : forward_recv_datas) {
-    writer->Write(*data_);
-  }
+  this->WriteTaskRequest(task_info, key, recv_data, writer);
   return grpc::Status::OK;
 }
 
+Status VMNodeInterface::SubscribeRecv(ServerContext* context,
+                                      const rpc::TaskRequest* request,
+                                      ServerWriter<rpc::TaskRequest>* writer) {
+  const auto& task_info = request->task_info();
+  std::string key = request->role();
+  // every subscription holds a server thread until its task ends,
+  // reject it before the sync server pool is exhausted
+  auto active = active_subscriptions_.fetch_add(1) + 1;
+  if (active > MAX_SUBSCRIBE_STREAMS) {
+    active_subscriptions_.fetch_sub(1);
+    LOG(WARNING) << "too many subscriptions: " << active - 1 << ", "
+                 << "reject subscription of key: " << key;
+    return Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                  "too many subscriptions, use ForwardRecv instead");
+  }
+  auto ret = SubscribeRecvImpl(task_info, key, context, writer);
+  active_subscriptions_.fetch_sub(1);
+  return ret;
+}
+
+Status VMNodeInterface::SubscribeRecvImpl(
+    const rpc::TaskContext& task_info,
+    const std::string& key,
+    ServerContext* context,
+    ServerWriter<rpc::TaskRequest>* writer) {
+  // confirm subscription, so subscriber does not fall back to ForwardRecv
+  rpc::TaskRequest confirm;
+  confirm.mutable_task_info()->CopyFrom(task_info);
+  confirm.set_role(key);
+  confirm.set_seq_no(0);
+  if (!writer->Write(confirm)) {
+    LOG(ERROR) << "confirm subscription of key: " << key << " failed";
+    return Status::OK;
+  }
+  uint64_t seq_no{0};
+  auto write_fn = [&](const std::string& data) -> bool {
+    return this->WriteTaskRequest(task_info, key, data, writer, ++seq_no);
+  };
+  auto is_cancelled = [context]() -> bool {
+    return context->IsCancelled();
+  };
+  auto ret = this->ServerImpl()->ProcessSubscribeData(task_info, key,
+                                                      write_fn, is_cancelled);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "subscription of key: " << key << " "
+               << "ended with error, pushed messages: " << seq_no;
+  }
+  return Status::OK;
+}
+
 retcode VMNodeInterface::WaitUntilWorkerReady(const std::string& worker_id,
                                               grpc::ServerContext* context,
                                               int timeout_ms) {
@@ -310,95 +435,90 @@ retcode VMNodeInterface::WaitUntilWorkerReady(const std::string& worker_id,
     LOG(ERROR) << "context is cancelled by client";
     return retcode::FAIL;
   }
-  auto _start = std::chrono::high_resolution_clock::now();
+  // wake up periodically to check whether the client has cancelled,
+  // worker ready is notified immediately by VMNodeImpl
+  constexpr int kCancelCheckIntervalMs = 100;
   SCopedTimer timer;
   do {
-    // try to get lock
-    if (ServerImpl()->IsTaskWorkerReady(worker_id)) {
+    int wait_ms = kCancelCheckIntervalMs;
+    if (timeout_ms != -1) {
+      auto remain_ms = timeout_ms - static_cast<int>(timer.timeElapse());
+      if (remain_ms <= 0) {
+        LOG(ERROR) << "wait for worker ready timeout";
+        return retcode::FAIL;
+      }
+      wait_ms = std::min(wait_ms, remain_ms);
+    }
+    if (ServerImpl()->WaitWorkerReadyFor(worker_id, wait_ms)) {
       break;
     }
     if (context->IsCancelled()) {
       LOG(ERROR) << "context is cancelled by client";
       return retcode::FAIL;
     }
-    VLOG(5) << "sleep and wait for worker ready, "
-            << "worker id : " << worker_id << " ........";
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    if (timeout_ms == -1) {
-      continue;
-    }
-    auto time_elapse_ms = timer.timeElapse();
-    if (time_elapse_ms > timeout_ms) {
-      LOG(ERROR) << "wait for worker ready timeout";
-      return retcode::FAIL;
-    }
   } while (true);
   return retcode::SUCCESS;
 }
 
-retcode VMNodeInterface::BuildTaskResponse(const std::string& data,
-    std::vector<std::unique_ptr<rpc::TaskResponse>>* response) {
+void VMNodeInterface::AppendPackage(rpc::TaskRequest* package,
+                                    std::string* data_buffer) {
+  if (data_buffer->empty() && package->data().size() == package->data_len()) {
+    // the whole message is in one package, take over it directly
+    data_buffer->swap(*package->mutable_data());
+    return;
+  }
+  data_buffer->append(package->data());
+}
+
+template<typename Writer>
+bool VMNodeInterface::WriteTaskResponse(const std::string& data,
+                                        Writer* writer) {
   size_t sended_size = 0;
   size_t max_package_size = LIMITED_PACKAGE_SIZE;
   size_t total_length = data.size();
-  size_t split_number = total_length / max_package_size;
-  if (total_length % max_package_size) {
-    split_number++;
-  }
-  response->reserve(split_number);
-  char* send_buf = const_cast<char*>(data.c_str());
+  // reuse the package for each slice, only data field is updated
+  rpc::TaskResponse task_response;
+  task_response.set_ret_code(rpc::retcode::SUCCESS);
+  task_response.set_data_len(total_length);
   do {
-    auto task_response = std::make_unique<rpc::TaskResponse>();
-    task_response->set_ret_code(rpc::retcode::SUCCESS);
-    task_response->set_data_len(total_length);
-    auto data_ptr = task_response->mutable_data();
-    data_ptr->reserve(max_package_size);
     size_t data_len = std::min(max_package_size, total_length - sended_size);
-    data_ptr->append(send_buf + sended_size, data_len);
-    sended_size += data_len;
-    response->emplace_back(std::move(task_response));
-    if (sended_size < total_length) {
-      continue;
-    } else {
-      break;
+    task_response.set_data(data.data() + sended_size, data_len);
+    if (!writer->Write(task_response)) {
+      LOG(ERROR) << "write response failed, sended size: " << sended_size
+                 << " total size: " << total_length;
+      return false;
     }
-  } while (true);
-  return retcode::SUCCESS;
+    sended_size += data_len;
+  } while (sended_size < total_length);
+  return true;
 }
 
-retcode VMNodeInterface::BuildTaskRequest(const rpc::TaskContext& task_info,
-    const std::string& key,
-    const std::string& data,
-    std::vector<std::unique_ptr<rpc::TaskRequest>>* requests) {
+template<typename Writer>
+bool VMNodeInterface::WriteTaskRequest(const rpc::TaskContext& task_info,
+                                       const std::string& key,
+                                       const std::string& data,
+                                       Writer* writer,
+                                       uint64_t seq_no) {
   size_t sended_size = 0;
   size_t max_package_size = LIMITED_PACKAGE_SIZE;
   size_t total_length = data.size();
-  size_t split_num = total_length / max_package_size;
-  if (total_length % max_package_size) {
-    split_num++;
-  }
-  requests->reserve(split_num);
-  char* send_buf = const_cast<char*>(data.c_str());
+  // reuse the package for each slice, only data field is updated
+  rpc::TaskRequest task_request;
+  task_request.mutable_task_info()->CopyFrom(task_info);
+  task_request.set_role(key);
+  task_request.set_data_len(total_length);
+  task_request.set_seq_no(seq_no);
   do {
-    // rpc::TaskRequest task_request;
-    auto task_request = std::make_unique<rpc::TaskRequest>();
-    auto task_info_ptr = task_request->mutable_task_info();
-    task_info_ptr->CopyFrom(task_info);
-    task_request->set_role(key);
-    task_request->set_data_len(total_length);
-    auto data_ptr = task_request->mutable_data();
-    data_ptr->reserve(max_package_size);
     size_t data_len = std::min(max_package_size, total_length - sended_size);
-    data_ptr->append(send_buf + sended_size, data_len);
-    sended_size += data_len;
-    requests->emplace_back(std::move(task_request));
-    if (sended_size < total_length) {
-      continue;
-    } else {
-      break;
+    task_request.set_data(data.data() + sended_size, data_len);
+    if (!writer->Write(task_request)) {
+      LOG(ERROR) << "write request failed, sended size: " << sended_size
+                 << " total size: " << total_length;
+      return false;
     }
-  } while (true);
-  return retcode::SUCCESS;
+    sended_size += data_len;
+  } while (sended_size < total_length);
+  return true;
 }
 
 }  // namespace primihub
@@ -23,6 +23,7 @@
 #include <grpcpp/server_builder.h>
 #include <grpcpp/server_context.h>
 
+#include <atomic>
 #include <memory>
 #include <thread>
 #include <string>
@@ -32,6 +33,7 @@
 #include "src/primihub/protos/common.pb.h"
 #include "src/primihub/node/node_impl.h"
 #include "src/primihub/common/common.h"
+#include "src/primihub/util/network/compressor.h"
 
 using Server = grpc::Server;
 using ServerBuilder = grpc::ServerBuilder;
@@ -91,6 +93,15 @@ class VMNodeInterface final : public rpc::VMNode::Service {
                   ServerReaderWriter<rpc::TaskResponse,
                                      rpc::TaskRequest>* stream) override;
 
+  /**
+   * long-lived data stream from peer, messages for different keys
+   * are multiplexed on the stream, each message is acked by its seq_no
+   * after it has been delivered into the task recv queue
+  */
+  Status DataStream(ServerContext* context,
+                    ServerReaderWriter<rpc::TaskResponse,
+                                       rpc::TaskRequest>* stream) override;
+
   // for communication between different process
   Status ForwardSend(ServerContext* context,
                      ServerReader<rpc::ForwardTaskRequest>* reader,
@@ -101,23 +112,60 @@ class VMNodeInterface final : public rpc::VMNode::Service {
                      const rpc::TaskRequest* request,
                      ServerWriter<rpc::TaskRequest>* writer) override;
 
+  /**
+   * subscriber in task process receives data of key without
+   * a ForwardRecv rpc for each message
+  */
+  Status SubscribeRecv(ServerContext* context,
+                       const rpc::TaskRequest* request,
+                       ServerWriter<rpc::TaskRequest>* writer) override;
+
   retcode WaitUntilWorkerReady(const std::string& worker_id,
                                ServerContext* context,
                                int timeout = -1);
 
  protected:
-  retcode BuildTaskResponse(const std::string& data,
-      std::vector<std::unique_ptr<rpc::TaskResponse>>* response);
+  /**
+   * append data of package to data_buffer,
+   * take over the package data directly if message has only one package
+  */
+  void AppendPackage(rpc::TaskRequest* package, std::string* data_buffer);
+  /**
+   * slice data into packages lazily and write each package as soon as
+   * it is built, so no extra copy of the whole data is made
+  */
+  template<typename Writer>
+  bool WriteTaskResponse(const std::string& data, Writer* writer);
 
-  retcode BuildTaskRequest(const rpc::TaskContext& task_info,
-      const std::string& key,
-      const std::string& data,
-      std::vector<std::unique_ptr<rpc::TaskRequest>>* requests);
+  template<typename Writer>
+  bool WriteTaskRequest(const rpc::TaskContext& task_info,
+                        const std::string& key,
+                        const std::string& data,
+                        Writer* writer,
+                        uint64_t seq_no = 0);
+
+  /**
+   * receive messages of data stream and ack each of them until peer closes it
+  */
+  Status DataStreamImpl(ServerContext* context,
+                        ServerReaderWriter<rpc::TaskResponse,
+                                           rpc::TaskRequest>* stream);
+  /**
+   * confirm subscription and push data of key until it ends
+  */
+  Status SubscribeRecvImpl(const rpc::TaskContext& task_info,
+                           const std::string& key,
+                           ServerContext* context,
+                           ServerWriter<rpc::TaskRequest>* writer);
 
   VMNodeImpl* ServerImpl() {return server_impl_.get();}
 
  private:
   std::unique_ptr<VMNodeImpl> server_impl_;
+  // number of SubscribeRecv streams holding a server thread
+  std::atomic<int> active_subscriptions_{0};
+  // number of DataStream streams holding a server thread
+  std::atomic<int> active_data_streams_{0};
 };
 }  // namespace primihub
 #endif  // SRC_PRIMIHUB_NODE_NODE_INTERFACE_H_
@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2023 by PrimiHub
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      https://www.apache.org/licenses/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "src/primihub/node/worker/task_process_pool.h"
+#include <glog/logging.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+#include "src/primihub/task_engine/task_process_protocol.h"
+#include "src/primihub/util/util.h"
+
+namespace primihub {
+using Process = Poco::Process;
+using ProcessHandle = Poco::ProcessHandle;
+
+TaskProcess::~TaskProcess() {
+  if (handle_ == nullptr) {
+    return;
+  }
+  try {
+    // process exits when stdin is closed
+    if (request_out_ != nullptr) {
+      request_out_->close();
+    }
+    in_pipe_.close(Poco::Pipe::CLOSE_WRITE);
+  } catch (std::exception& e) {
+    LOG(WARNING) << "close stdin of task process failed, " << e.what();
+  }
+  // kill the process if it does not exit in time
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(TASK_PROCESS_EXIT_TIMEOUT_MS);
+  while (Alive()) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      LOG(WARNING) << "task process: " << handle_->id() << " "
+                   << "does not exit in time, kill it";
+      Kill();
+      std::lock_guard<std::mutex> lck(exit_mtx_);
+      if (!exited_) {
+        ::waitpid(handle_->id(), nullptr, 0);
+        exited_ = true;
+      }
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+retcode TaskProcess::Launch(int startup_timeout_ms) {
+  SCopedTimer timer;
+  try {
+    auto handle = Process::launch(app_, args_, &in_pipe_, &out_pipe_, nullptr);
+    std::lock_guard<std::mutex> lck(exit_mtx_);
+    handle_ = std::make_unique<ProcessHandle>(handle);
+  } catch (std::exception& e) {
+    LOG(ERROR) << "launch task process failed, " << e.what();
+    broken_.store(true);
+    return retcode::FAIL;
+  }
+  if (broken_.load()) {
+    // killed by pool shutdown while launching
+    Kill();
+    return retcode::FAIL;
+  }
+  request_out_ = std::make_unique<Poco::PipeOutputStream>(in_pipe_);
+  result_in_ = std::make_unique<Poco::PipeInputStream>(out_pipe_);
+  // killing the process closes its stdout and unblocks the reading below
+  std::promise<void> ready_promise;
+  auto ready_fut = ready_promise.get_future();
+  auto watchdog = std::async(std::launch::async, [&]() {
+    auto timeout = std::chrono::milliseconds(startup_timeout_ms);
+    if (ready_fut.wait_for(timeout) == std::future_status::ready) {
+      return false;
+    }
+    Kill();
+    return true;
+  });
+  bool ready{false};
+  std::string line;
+  while (std::getline(*result_in_, line)) {
+    if (line == task_engine::kTaskProcessReady) {
+      ready = true;
+      break;
+    }
+  }
+  ready_promise.set_value();
+  bool timeout = watchdog.get();
+  if (timeout) {
+    LOG(ERROR) << "task process is not ready within "
+               << startup_timeout_ms << "ms, killed";
+    return retcode::FAIL;
+  }
+  if (!ready) {
+    LOG(ERROR) << "task process exit before it is ready";
+    broken_.store(true);
+    return retcode::FAIL;
+  }
+  startup_time_ms_ = timer.timeElapse();
+  VLOG(5) << "task process: " << handle_->id() << " is ready, "
+          << "startup time cost(ms): " << startup_time_ms_;
+  return retcode::SUCCESS;
+}
+
+bool TaskProcess::Alive() {
+  std::lock_guard<std::mutex> lck(exit_mtx_);
+  if (handle_ == nullptr || exited_) {
+    return false;
+  }
+  auto pid = ::waitpid(handle_->id(), nullptr, WNOHANG);
+  if (pid == 0) {
+    return true;
+  }
+  // exited and reaped, or not a child any more
+  exited_ = true;
+  broken_.store(true);
+  return false;
+}
+
+retcode TaskProcess::Execute(const std::string& request_base64_str) {
+  if (broken_.load()) {
+    LOG(ERROR) << "task process is not available";
+    return retcode::FAIL;
+  }
+  task_count_++;
+  *request_out_ << request_base64_str << "\n";
+  request_out_->flush();
+  if (!request_out_->good()) {
+    LOG(ERROR) << "send task request to task process failed";
+    broken_.store(true);
+    return retcode::FAIL;
+  }
+  std::string line;
+  if (!std::getline(*result_in_, line)) {
+    LOG(ERROR) << "task process exit while executing task";
+    broken_.store(true);
+    return retcode::FAIL;
+  }
+  if (line != task_engine::kTaskProcessSuccess) {
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+void TaskProcess::Kill() {
+  broken_.store(true);
+  std::lock_guard<std::mutex> lck(exit_mtx_);
+  if (handle_ == nullptr || exited_) {
+    // pid may have been reused by another process
+    return;
+  }
+  try {
+    Process::kill(*handle_);
+  } catch (std::exception& e) {
+    LOG(WARNING) << "kill task process failed, " << e.what();
+  }
+}
+
+TaskProcessPool::~TaskProcessPool() {
+  Shutdown();
+}
+
+retcode TaskProcessPool::Init(const std::string& node_id,
+                              const std::string& config_file,
+                              size_t pool_size,
+                              size_t max_task_per_process) {
+  if (pool_size == 0) {
+    VLOG(0) << "task process pool is disabled";
+    return retcode::SUCCESS;
+  }
+  // writing to pipe of a dead task process must not kill the node
+  signal(SIGPIPE, SIG_IGN);
+  execute_app_ = getCurrentProcessDir() + "/task_main";
+  args_.push_back("--node_id=" + node_id);
+  args_.push_back("--config_file=" + config_file);
+  args_.push_back("--pool_mode=true");
+  pool_size_ = pool_size;
+  max_task_per_process_ = max_task_per_process;
+  replenish_fut_ = std::async(std::launch::async,
+                              [this]() { ReplenishThread(); });
+  LOG(INFO) << "task process pool size: " << pool_size_ << " "
+            << "max task per process: " << max_task_per_process_;
+  return retcode::SUCCESS;
+}
+
+void TaskProcessPool::Shutdown() {
+  std::list<std::shared_ptr<TaskProcess>> idle_processes;
+  std::shared_ptr<TaskProcess> launching_process{nullptr};
+  {
+    std::lock_guard<std::mutex> lck(pool_mtx_);
+    if (stop_) {
+      return;
+    }
+    stop_ = true;
+    idle_processes.swap(idle_processes_);
+    launching_process = launching_process_;
+  }
+  replenish_cv_.notify_all();
+  // do not wait for a process which is starting up
+  if (launching_process != nullptr) {
+    launching_process->Kill();
+  }
+  if (replenish_fut_.valid()) {
+    replenish_fut_.get();
+  }
+  idle_processes.clear();
+}
+
+void TaskProcessPool::ReplenishThread() {
+  SET_THREAD_NAME("TaskProcessPool");
+  int launch_failures{0};
+  auto backoff = std::chrono::seconds(1);
+  constexpr auto kMaxBackoff = std::chrono::seconds(60);
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lck(pool_mtx_);
+      replenish_cv_.wait(lck, [this]() {
+        return stop_ || idle_processes_.size() < pool_size_;
+      });
+      if (stop_) {
+        break;
+      }
+    }
+    auto process = std::make_shared<TaskProcess>(execute_app_, args_);
+    {
+      std::lock_guard<std::mutex> lck(pool_mtx_);
+      if (stop_) {
+        break;
+      }
+      launching_process_ = process;
+    }
+    auto ret = process->Launch();
+    {
+      std::lock_guard<std::mutex> lck(pool_mtx_);
+      launching_process_.reset();
+      if (stop_) {
+        break;
+      }
+    }
+    if (ret != retcode::SUCCESS) {
+      launch_failures++;
+      if (launch_failures >= TASK_PROCESS_MAX_LAUNCH_FAILURES) {
+        LOG(ERROR) << "launch task process for pool failed "
+                   << launch_failures << " times in a row, "
+                   << "stop replenishing, tasks are run by new process";
+        break;
+      }
+      LOG(ERROR) << "launch task process for pool failed, "
+                 << "retry after " << backoff.count() << "s";
+      std::unique_lock<std::mutex> lck(pool_mtx_);
+      if (replenish_cv_.wait_for(lck, backoff, [this]() {return stop_;})) {
+        break;
+      }
+      backoff = std::min(backoff * 2, kMaxBackoff);
+      continue;
+    }
+    launch_failures = 0;
+    backoff = std::chrono::seconds(1);
+    std::lock_guard<std::mutex> lck(pool_mtx_);
+    stat_.launch_count++;
+    stat_.total_startup_time_ms += process->StartupTimeMs();
+    if (stop_) {
+      break;
+    }
+    idle_processes_.push_back(std::move(process));
+  }
+  VLOG(0) << "task process pool replenish thread exit";
+}
+
+std::shared_ptr<TaskProcess> TaskProcessPool::Acquire() {
+  std::shared_ptr<TaskProcess> process{nullptr};
+  // idle process may have exited, it is recycled instead of being used
+  std::list<std::shared_ptr<TaskProcess>> dead_processes;
+  {
+    std::lock_guard<std::mutex> lck(pool_mtx_);
+    while (!idle_processes_.empty()) {
+      auto candidate = std::move(idle_processes_.front());
+      idle_processes_.pop_front();
+      if (candidate->Available() && candidate->Alive()) {
+        process = std::move(candidate);
+        break;
+      }
+      stat_.recycle_count++;
+      dead_processes.push_back(std::move(candidate));
+    }
+    if (process == nullptr) {
+      stat_.miss_count++;
+    } else {
+      stat_.hit_count++;
+    }
+  }
+  replenish_cv_.notify_all();
+  if (!dead_processes.empty()) {
+    LOG(WARNING) << "recycle " << dead_processes.size() << " "
+                 << "exited idle task process";
+    dead_processes.clear();
+  }
+  auto stat = Stat();
+  VLOG(5) << "acquire task process " << (process ? "hit" : "miss") << ", "
+          << "hit: " << stat.hit_count << " miss: " << stat.miss_count << " "
+          << "idle: " << stat.idle_count;
+  return process;
+}
+
+void TaskProcessPool::Release(std::shared_ptr<TaskProcess> process) {
+  if (process == nullptr) {
+    return;
+  }
+  bool reuse{false};
+  {
+    std::lock_guard<std::mutex> lck(pool_mtx_);
+    if (!stop_ && process->Available() &&
+        process->TaskCount() < max_task_per_process_ &&
+        idle_processes_.size() < pool_size_) {
+      idle_processes_.push_back(process);
+      reuse = true;
+    } else {
+      stat_.recycle_count++;
+    }
+  }
+  if (!reuse) {
+    VLOG(5) << "recycle task process after "
+            << process->TaskCount() << " tasks";
+    // destructor waits until the process exits
+    process.reset();
+    replenish_cv_.notify_all();
+  }
+}
+
+TaskProcessPoolStat TaskProcessPool::Stat() {
+  std::lock_guard<std::mutex> lck(pool_mtx_);
+  TaskProcessPoolStat stat = stat_;
+  stat.idle_count = idle_processes_.size();
+  return stat;
+}
+}  // namespace primihub
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2023 by PrimiHub
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      https://www.apache.org/licenses/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_PRIMIHUB_NODE_WORKER_TASK_PROCESS_POOL_H_
+#define SRC_PRIMIHUB_NODE_WORKER_TASK_PROCESS_POOL_H_
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Poco/Pipe.h"
+#include "Poco/PipeStream.h"
+#include "Poco/Process.h"
+#include "src/primihub/common/common.h"
+
+namespace primihub {
+/**
+ * task_main process started with --pool_mode,
+ * server config, dataset service, link context and python interpreter
+ * are initialized once and shared by tasks executed by the process
+*/
+class TaskProcess {
+ public:
+  TaskProcess(const std::string& app, const std::vector<std::string>& args)
+      : app_(app), args_(args) {}
+  ~TaskProcess();
+  /**
+   * start process and block until it is ready to accept task,
+   * process is killed if it is not ready within startup_timeout_ms
+  */
+  retcode Launch(int startup_timeout_ms = TASK_PROCESS_STARTUP_TIMEOUT_MS);
+  /**
+   * send task request to process, block until the task is finished
+  */
+  retcode Execute(const std::string& request_base64_str);
+  void Kill();
+  bool Available() {return !broken_.load();}
+  /**
+   * check whether the process is still running,
+   * it is marked as broken if it has exited
+  */
+  bool Alive();
+  size_t TaskCount() {return task_count_;}
+  int64_t StartupTimeMs() {return startup_time_ms_;}
+
+ private:
+  std::string app_;
+  std::vector<std::string> args_;
+  Poco::Pipe in_pipe_;
+  Poco::Pipe out_pipe_;
+  std::unique_ptr<Poco::PipeOutputStream> request_out_{nullptr};
+  std::unique_ptr<Poco::PipeInputStream> result_in_{nullptr};
+  std::unique_ptr<Poco::ProcessHandle> handle_{nullptr};
+  std::mutex exit_mtx_;
+  bool exited_{false};
+  std::atomic<bool> broken_{false};
+  size_t task_count_{0};
+  int64_t startup_time_ms_{0};
+};
+
+struct TaskProcessPoolStat {
+  size_t hit_count{0};
+  size_t miss_count{0};
+  size_t launch_count{0};
+  size_t recycle_count{0};
+  size_t idle_count{0};
+  int64_t total_startup_time_ms{0};
+};
+
+/**
+ * keep pool_size pre-warmed task processes for node,
+ * a process is taken by one task at a time and returned after the task,
+ * it is recycled when it has executed max_task_per_process tasks
+ * or exits unexpectedly
+*/
+class TaskProcessPool {
+ public:
+  static TaskProcessPool& getInstance() {
+    static TaskProcessPool ins;
+    return ins;
+  }
+  ~TaskProcessPool();
+  retcode Init(const std::string& node_id, const std::string& config_file,
+               size_t pool_size, size_t max_task_per_process);
+  void Shutdown();
+  bool Enabled() {return pool_size_ > 0;}
+  /**
+   * return nullptr if no idle process is available,
+   * caller should launch a new task_main process for the task
+  */
+  std::shared_ptr<TaskProcess> Acquire();
+  void Release(std::shared_ptr<TaskProcess> process);
+  TaskProcessPoolStat Stat();
+
+ protected:
+  TaskProcessPool() = default;
+  /**
+   * launch processes until pool is full, back off after launch failure
+   * and give up after TASK_PROCESS_MAX_LAUNCH_FAILURES failures in a row,
+   * tasks are executed by new processes since then
+  */
+  void ReplenishThread();
+
+ private:
+  std::string execute_app_;
+  std::vector<std::string> args_;
+  size_t pool_size_{0};
+  size_t max_task_per_process_{0};
+  std::mutex pool_mtx_;
+  std::condition_variable replenish_cv_;
+  std::list<std::shared_ptr<TaskProcess>> idle_processes_;
+  // process being launched by replenish thread, killed by Shutdown
+  std::shared_ptr<TaskProcess> launching_process_{nullptr};
+  bool stop_{false};
+  std::future<void> replenish_fut_;
+  TaskProcessPoolStat stat_;
+};
+}  // namespace primihub
+#endif  // SRC_PRIMIHUB_NODE_WORKER_TASK_PROCESS_POOL_H_
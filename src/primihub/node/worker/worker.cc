@@ -106,6 +106,12 @@ retcode Worker::ExecuteTaskByThread(const PushTaskRequest* task_request) {
     LOG(ERROR) << "Error occurs during execute task.";
     return retcode::FAIL;
   }
+  // task succeeds only if data it has sent is delivered
+  auto& link_ctx = task_ptr->getTaskContext().getLinkContext();
+  if (link_ctx != nullptr && link_ctx->Flush() != retcode::SUCCESS) {
+    LOG(ERROR) << "data sent by task is not delivered to peer";
+    return retcode::FAIL;
+  }
   return retcode::SUCCESS;
 }
 
@@ -156,6 +162,15 @@ retcode Worker::ExecuteTaskByProcess(const PushTaskRequest* task_request) {
     return retcode::FAIL;
   }
   std::string request_base64_str = base64_encode(task_config_str);
+  auto& process_pool = TaskProcessPool::getInstance();
+  if (process_pool.Enabled()) {
+    auto process = process_pool.Acquire();
+    if (process != nullptr) {
+      return ExecuteTaskByPooledProcess(std::move(process),
+                                        request_base64_str);
+    }
+    VLOG(5) << "no idle process in task process pool, launch new process";
+  }
 
   // std::future<std::string> data;
   std::string current_process_dir = getCurrentProcessDir();
@@ -193,6 +208,23 @@ retcode Worker::ExecuteTaskByProcess(const PushTaskRequest* task_request) {
   return retcode::SUCCESS;
 }
 
+retcode Worker::ExecuteTaskByPooledProcess(
+    std::shared_ptr<TaskProcess> process,
+    const std::string& request_base64_str) {
+  std::atomic_store(&pooled_process_, process);
+  task_ready_promise_.set_value(true);
+  LOG(INFO) << "Worker start execute task by pooled process, "
+            << "startup time saved(ms): " << process->StartupTimeMs();
+  auto ret = process->Execute(request_base64_str);
+  std::atomic_store(&pooled_process_, std::shared_ptr<TaskProcess>());
+  TaskProcessPool::getInstance().Release(std::move(process));
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "execute task by pooled process failed";
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
 // kill task which is running in the worker
 void Worker::kill_task() {
   if (task_ptr) {
@@ -201,6 +233,10 @@ void Worker::kill_task() {
   if (process_handler_ != nullptr) {
     Poco::Process::kill(*process_handler_);
   }
+  auto pooled_process = std::atomic_load(&pooled_process_);
+  if (pooled_process != nullptr) {
+    pooled_process->Kill();
+  }
 }
 
 retcode Worker::fetchTaskStatus(rpc::TaskStatus* task_status) {
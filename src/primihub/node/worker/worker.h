@@ -40,6 +40,7 @@
 #include "src/primihub/protos/worker.pb.h"
 #include "src/primihub/task/semantic/task.h"
 #include "src/primihub/common/common.h"
+#include "src/primihub/node/worker/task_process_pool.h"
 #include "Poco/Process.h"
 
 using PushTaskRequest = primihub::rpc::PushTaskRequest;
@@ -77,6 +78,13 @@ class Worker {
   std::shared_ptr<primihub::task::TaskBase> getTask() {
     return task_ptr;
   }
+  /**
+   * attach task created outside of worker, for tools which drive
+   * the data path of node without executing a real task
+  */
+  void AttachTask(std::shared_ptr<primihub::task::TaskBase> task) {
+    task_ptr = std::move(task);
+  }
   retcode waitForTaskReady();
 
   // scheduler method
@@ -88,6 +96,11 @@ class Worker {
 
  protected:
   TaskRunMode ExecuteMode(const PushTaskRequest& request);
+  /**
+   * execute task by pre-warmed process acquired from task process pool
+  */
+  retcode ExecuteTaskByPooledProcess(std::shared_ptr<TaskProcess> process,
+                                     const std::string& request_base64_str);
 
  private:
   std::unordered_map<std::string, std::shared_ptr<Worker>> workers_
@@ -114,6 +127,7 @@ class Worker {
   // TaskRunMode task_run_mode_{TaskRunMode::THREAD};
   TaskRunMode task_run_mode_{TaskRunMode::PROCESS};
   std::unique_ptr<Poco::ProcessHandle> process_handler_{nullptr};
+  std::shared_ptr<TaskProcess> pooled_process_{nullptr};
 };
 }  // namespace primihub
 
@@ -71,6 +71,10 @@ void opt_paillier_keygen_warpper(
     py_prv_dict["double_q"]                        = mpz_get_str(nullptr, BASE, prv->double_q);
     py_prv_dict["Q_mul_double_p_inverse"]          = mpz_get_str(nullptr, BASE, prv->Q_mul_double_p_inverse);
     py_prv_dict["P_mul_double_q_inverse"]          = mpz_get_str(nullptr, BASE, prv->P_mul_double_q_inverse);
+
+    // generated keys are owned by the handles
+    py_pub_dict[KEY_HANDLE_ATTR] = std::make_shared<PaillierPublicKey>(pub);
+    py_prv_dict[KEY_HANDLE_ATTR] = std::make_shared<PaillierSecretKey>(prv);
 }
 
 opt_public_key_t* py_pub_2_cpp_pub(const py::object &py_pub) {
@@ -116,12 +120,35 @@ opt_secret_key_t* py_prv_2_cpp_prv(const py::object &py_prv) {
     return res;
 }
 
+std::shared_ptr<PaillierPublicKey> get_public_key(const py::object &py_pub) {
+    py::dict py_pub_dict = py_pub.attr("__dict__");
+    if (py_pub_dict.contains(KEY_HANDLE_ATTR)) {
+        return py_pub_dict[KEY_HANDLE_ATTR].cast<std::shared_ptr<PaillierPublicKey>>();
+    }
+    // key restored from python attributes, e.g. received from other party,
+    // convert it once and keep the handle in the key object
+    auto pub_key = std::make_shared<PaillierPublicKey>(py_pub_2_cpp_pub(py_pub));
+    py_pub_dict[KEY_HANDLE_ATTR] = pub_key;
+    return pub_key;
+}
+
+std::shared_ptr<PaillierSecretKey> get_secret_key(const py::object &py_prv) {
+    py::dict py_prv_dict = py_prv.attr("__dict__");
+    if (py_prv_dict.contains(KEY_HANDLE_ATTR)) {
+        return py_prv_dict[KEY_HANDLE_ATTR].cast<std::shared_ptr<PaillierSecretKey>>();
+    }
+    auto prv_key = std::make_shared<PaillierSecretKey>(py_prv_2_cpp_prv(py_prv));
+    py_prv_dict[KEY_HANDLE_ATTR] = prv_key;
+    return prv_key;
+}
+
 void opt_paillier_encrypt_warpper(
     const py::object &py_cipher_text,
     const py::object &py_pub,
     const std::string py_plain_text) {
 
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
+    auto pub_key = get_public_key(py_pub);
+    opt_public_key_t* pub = pub_key->get();
 
     mpz_t plain_text;
     mpz_t cipher_text;
@@ -130,13 +157,17 @@ void opt_paillier_encrypt_warpper(
 
     opt_paillier_set_plaintext(plain_text, py_plain_text.c_str(), pub, PYTHON_INPUT_BASE);
 
-    opt_paillier_encrypt(cipher_text, pub, plain_text);
+    auto pool = pub_key->pool();
+    if (pool != nullptr) {
+        opt_paillier_encrypt_pool(cipher_text, pool.get(), plain_text);
+    } else {
+        opt_paillier_encrypt(cipher_text, pub, plain_text);
+    }
 
     py::dict py_cipher_text_dict = py_cipher_text.attr("__dict__");
     py_cipher_text_dict["ciphertext"] = mpz_get_str(nullptr, BASE, cipher_text);
 
     mpz_clears(plain_text, cipher_text, nullptr);
-    opt_paillier_freepubkey(pub);
 }
 
 void opt_paillier_encrypt_crt_warpper(
@@ -145,8 +176,10 @@ void opt_paillier_encrypt_crt_warpper(
     const py::object &py_prv,
     const std::string py_plain_text) {
 
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
-    opt_secret_key_t* prv = py_prv_2_cpp_prv(py_prv);
+    auto pub_key = get_public_key(py_pub);
+    opt_public_key_t* pub = pub_key->get();
+    auto prv_key = get_secret_key(py_prv);
+    opt_secret_key_t* prv = prv_key->get();
 
     mpz_t plain_text;
     mpz_t cipher_text;
@@ -155,14 +188,17 @@ void opt_paillier_encrypt_crt_warpper(
 
     opt_paillier_set_plaintext(plain_text, py_plain_text.c_str(), pub, PYTHON_INPUT_BASE);
 
-    opt_paillier_encrypt_crt_fb(cipher_text, pub, prv, plain_text);
+    auto pool = pub_key->pool();
+    if (pool != nullptr) {
+        opt_paillier_encrypt_pool(cipher_text, pool.get(), plain_text);
+    } else {
+        opt_paillier_encrypt_crt_fb(cipher_text, pub, prv, plain_text);
+    }
 
     py::dict py_cipher_text_dict = py_cipher_text.attr("__dict__");
     py_cipher_text_dict["ciphertext"] = mpz_get_str(nullptr, BASE, cipher_text);
 
     mpz_clears(plain_text, cipher_text, nullptr);
-    opt_paillier_freepubkey(pub);
-    opt_paillier_freeprvkey(prv);
 }
 
 py::str opt_paillier_decrypt_crt_warpper(
@@ -170,8 +206,10 @@ py::str opt_paillier_decrypt_crt_warpper(
     const py::object &py_prv,
     const py::object &py_cipher_text) {
 
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
-    opt_secret_key_t* prv = py_prv_2_cpp_prv(py_prv);
+    auto pub_key = get_public_key(py_pub);
+    opt_public_key_t* pub = pub_key->get();
+    auto prv_key = get_secret_key(py_prv);
+    opt_secret_key_t* prv = prv_key->get();
 
     mpz_t cipher_text;
     mpz_t decrypt_text;
@@ -187,8 +225,6 @@ py::str opt_paillier_decrypt_crt_warpper(
     opt_paillier_get_plaintext(tmp_str, decrypt_text, pub, PYTHON_INPUT_BASE);
 
     mpz_clears(cipher_text, decrypt_text, nullptr);
-    opt_paillier_freepubkey(pub);
-    opt_paillier_freeprvkey(prv);
 
     return std::string(tmp_str);
 }
@@ -199,7 +235,8 @@ void opt_paillier_add_warpper(
     const py::object &py_op2,
     const py::object &py_pub) {
 
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
+    auto pub_key = get_public_key(py_pub);
+    opt_public_key_t* pub = pub_key->get();
 
     mpz_t op1;
     mpz_t op2;
@@ -219,7 +256,6 @@ void opt_paillier_add_warpper(
     py_add_res_dict["ciphertext"] = mpz_get_str(nullptr, BASE, res);
 
     mpz_clears(op1, op2, res, nullptr);
-    opt_paillier_freepubkey(pub);
 }
 
 void opt_paillier_cons_mul_warpper(
@@ -228,7 +264,8 @@ void opt_paillier_cons_mul_warpper(
     const py::str    &py_cons_value,
     const py::object &py_pub) {
 
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
+    auto pub_key = get_public_key(py_pub);
+    opt_public_key_t* pub = pub_key->get();
 
     mpz_t cipher_text;
     mpz_t cons_value;
@@ -247,7 +284,6 @@ void opt_paillier_cons_mul_warpper(
     py_mul_res_dict["ciphertext"] = mpz_get_str(nullptr, BASE, res);
 
     mpz_clears(cipher_text, cons_value, res, nullptr);
-    opt_paillier_freepubkey(pub);
 }
 
 py::dict crtMod_2_dict(CrtMod* crtmod) {
@@ -290,7 +326,8 @@ void opt_paillier_pack_encrypt_warpper(
     const py::object &py_crt_mod
     ) {
 
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
+    auto pub_key = get_public_key(py_pub);
+    opt_public_key_t* pub = pub_key->get();
 
     CrtMod* crtmod;
     // if (py_crt_mod == py::none()) {
@@ -335,7 +372,6 @@ void opt_paillier_pack_encrypt_warpper(
 
     mpz_clears(pack, cipher_text, nullptr);
     free_crt(crtmod);
-    opt_paillier_freepubkey(pub);
 }
 
 void opt_paillier_pack_encrypt_crt_warpper(
@@ -346,8 +382,10 @@ void opt_paillier_pack_encrypt_crt_warpper(
     const py::object &py_crt_mod
     ) {
 
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
-    opt_secret_key_t* prv = py_prv_2_cpp_prv(py_prv);
+    auto pub_key = get_public_key(py_pub);
+    opt_public_key_t* pub = pub_key->get();
+    auto prv_key = get_secret_key(py_prv);
+    opt_secret_key_t* prv = prv_key->get();
 
     CrtMod* crtmod;
     // if (py_crt_mod == py::none()) {
@@ -392,8 +430,6 @@ void opt_paillier_pack_encrypt_crt_warpper(
 
     mpz_clears(pack, cipher_text, nullptr);
     free_crt(crtmod);
-    opt_paillier_freepubkey(pub);
-    opt_paillier_freeprvkey(prv);
 }
 
 py::list opt_paillier_pack_decrypt_crt_warpper(
@@ -401,8 +437,10 @@ py::list opt_paillier_pack_decrypt_crt_warpper(
     const py::object &py_prv,
     const py::object &py_pack_cipher_text) {
 
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
-    opt_secret_key_t* prv = py_prv_2_cpp_prv(py_prv);
+    auto pub_key = get_public_key(py_pub);
+    opt_public_key_t* pub = pub_key->get();
+    auto prv_key = get_secret_key(py_prv);
+    opt_secret_key_t* prv = prv_key->get();
 
     py::dict py_pack_cipher_text_dict = py_pack_cipher_text.attr("__dict__");
     py::list py_ciphertexts = py_pack_cipher_text_dict["ciphertexts"];
@@ -437,8 +475,6 @@ py::list opt_paillier_pack_decrypt_crt_warpper(
 
     mpz_clears(cipher_text, decrypt_text, nullptr);
     free_crt(crtmod);
-    opt_paillier_freepubkey(pub);
-    opt_paillier_freeprvkey(prv);
 
     return res;
 }
@@ -449,7 +485,8 @@ void opt_paillier_pack_add_warpper(
     const py::object &py_pack_op2,
     const py::object &py_pub) {
 
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
+    auto pub_key = get_public_key(py_pub);
+    opt_public_key_t* pub = pub_key->get();
 
     mpz_t op1;
     mpz_t op2;
@@ -480,12 +517,349 @@ void opt_paillier_pack_add_warpper(
     py_pack_add_res_dict["pack_size"] = py_pack_op1_dict["pack_size"];
 
     mpz_clears(op1, op2, res, nullptr);
-    opt_paillier_freepubkey(pub);
+}
+
+// batch api, plaintexts are int64 arrays, ciphertexts are uint8 arrays of
+// shape (num, cipher_bytes) with fixed-width encoding of paillier_batch.h
+using PlainArray = py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
+using CipherArray = py::array_t<uint8_t, py::array::c_style | py::array::forcecast>;
+
+size_t cipher_array_num(const CipherArray &ciphertexts, size_t cipher_bytes) {
+    if (ciphertexts.size() % cipher_bytes != 0) {
+        throw std::invalid_argument("size of ciphertext buffer is not multiple of " +
+                                    std::to_string(cipher_bytes) + " bytes");
+    }
+    return ciphertexts.size() / cipher_bytes;
+}
+
+CipherArray new_cipher_array(size_t num, size_t cipher_bytes) {
+    return CipherArray({num, cipher_bytes});
+}
+
+CipherArray opt_paillier_batch_encrypt_warpper(
+    const py::object &py_pub,
+    const PlainArray &py_plain_texts,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t num = py_plain_texts.size();
+    auto res = new_cipher_array(num, cipher_bytes);
+    const int64_t* plain_texts = py_plain_texts.data();
+    uint8_t* cipher_texts = res.mutable_data();
+    auto pool = pub_key->pool();
+    {
+        py::gil_scoped_release release;
+        if (pool != nullptr) {
+            opt_paillier_batch_encrypt_pool(cipher_texts, plain_texts, num,
+                                            pool.get(), num_threads);
+        } else {
+            opt_paillier_batch_encrypt(cipher_texts, plain_texts, num,
+                                       pub_key->get(), num_threads);
+        }
+    }
+    return res;
+}
+
+CipherArray opt_paillier_batch_encrypt_crt_warpper(
+    const py::object &py_pub,
+    const py::object &py_prv,
+    const PlainArray &py_plain_texts,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    auto prv_key = get_secret_key(py_prv);
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t num = py_plain_texts.size();
+    auto res = new_cipher_array(num, cipher_bytes);
+    const int64_t* plain_texts = py_plain_texts.data();
+    uint8_t* cipher_texts = res.mutable_data();
+    auto pool = pub_key->pool();
+    {
+        py::gil_scoped_release release;
+        if (pool != nullptr) {
+            opt_paillier_batch_encrypt_pool(cipher_texts, plain_texts, num,
+                                            pool.get(), num_threads);
+        } else {
+            opt_paillier_batch_encrypt_crt_fb(cipher_texts, plain_texts, num,
+                                              pub_key->get(), prv_key->get(), num_threads);
+        }
+    }
+    return res;
+}
+
+PlainArray opt_paillier_batch_decrypt_crt_warpper(
+    const py::object &py_pub,
+    const py::object &py_prv,
+    const CipherArray &py_cipher_texts,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    auto prv_key = get_secret_key(py_prv);
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t num = cipher_array_num(py_cipher_texts, cipher_bytes);
+    PlainArray res(static_cast<py::ssize_t>(num));
+    const uint8_t* cipher_texts = py_cipher_texts.data();
+    int64_t* plain_texts = res.mutable_data();
+    bool fits = true;
+    {
+        py::gil_scoped_release release;
+        fits = opt_paillier_batch_decrypt_crt(plain_texts, cipher_texts, num,
+                                              pub_key->get(), prv_key->get(), num_threads);
+    }
+    if (!fits) {
+        throw std::overflow_error("decrypted value does not fit in int64");
+    }
+    return res;
+}
+
+CipherArray opt_paillier_batch_add_warpper(
+    const py::object &py_pub,
+    const CipherArray &py_op1,
+    const CipherArray &py_op2,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t num = cipher_array_num(py_op1, cipher_bytes);
+    if (cipher_array_num(py_op2, cipher_bytes) != num) {
+        throw std::invalid_argument("number of ciphertexts does not match");
+    }
+    auto res = new_cipher_array(num, cipher_bytes);
+    const uint8_t* op1 = py_op1.data();
+    const uint8_t* op2 = py_op2.data();
+    uint8_t* cipher_texts = res.mutable_data();
+    {
+        py::gil_scoped_release release;
+        opt_paillier_batch_add(cipher_texts, op1, op2, num,
+                               pub_key->get(), num_threads);
+    }
+    return res;
+}
+
+CipherArray opt_paillier_batch_cons_mul_warpper(
+    const py::object &py_pub,
+    const CipherArray &py_op1,
+    const PlainArray &py_cons_values,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t num = cipher_array_num(py_op1, cipher_bytes);
+    if (static_cast<size_t>(py_cons_values.size()) != num) {
+        throw std::invalid_argument("number of constant values does not match");
+    }
+    auto res = new_cipher_array(num, cipher_bytes);
+    const uint8_t* op1 = py_op1.data();
+    const int64_t* cons_values = py_cons_values.data();
+    uint8_t* cipher_texts = res.mutable_data();
+    {
+        py::gil_scoped_release release;
+        opt_paillier_batch_constant_mul(cipher_texts, op1, cons_values, num,
+                                        pub_key->get(), num_threads);
+    }
+    return res;
+}
+
+// aggregation kernels, ciphertexts is a matrix of num rows, every row is
+// width ciphertexts, width is derived from the number of scalars or rows
+size_t cipher_array_width(const CipherArray &ciphertexts, size_t cipher_bytes,
+                          size_t num) {
+    size_t total = cipher_array_num(ciphertexts, cipher_bytes);
+    if (num == 0 || total % num != 0) {
+        throw std::invalid_argument("number of ciphertexts is not multiple of " +
+                                    std::to_string(num) + " rows");
+    }
+    return total / num;
+}
+
+CipherArray opt_paillier_batch_sum_warpper(
+    const py::object &py_pub,
+    const CipherArray &py_cipher_texts,
+    size_t num,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t width = cipher_array_width(py_cipher_texts, cipher_bytes, num);
+    auto res = new_cipher_array(width, cipher_bytes);
+    const uint8_t* cipher_texts = py_cipher_texts.data();
+    uint8_t* res_cipher_texts = res.mutable_data();
+    {
+        py::gil_scoped_release release;
+        opt_paillier_batch_sum(res_cipher_texts, cipher_texts, num, width,
+                               pub_key->get(), num_threads);
+    }
+    return res;
+}
+
+CipherArray opt_paillier_batch_inner_product_warpper(
+    const py::object &py_pub,
+    const CipherArray &py_cipher_texts,
+    const PlainArray &py_scalars,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t num = py_scalars.size();
+    size_t width = cipher_array_width(py_cipher_texts, cipher_bytes, num);
+    auto res = new_cipher_array(width, cipher_bytes);
+    const uint8_t* cipher_texts = py_cipher_texts.data();
+    const int64_t* scalars = py_scalars.data();
+    uint8_t* res_cipher_texts = res.mutable_data();
+    {
+        py::gil_scoped_release release;
+        opt_paillier_batch_inner_product(res_cipher_texts, cipher_texts, scalars,
+                                         num, width, pub_key->get(), num_threads);
+    }
+    return res;
+}
+
+CipherArray opt_paillier_batch_matvec_warpper(
+    const py::object &py_pub,
+    const PlainArray &py_matrix,
+    const CipherArray &py_cipher_texts,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    if (py_matrix.ndim() != 2) {
+        throw std::invalid_argument("matrix should be 2-dimensional");
+    }
+    size_t rows = py_matrix.shape(0);
+    size_t num = py_matrix.shape(1);
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t width = cipher_array_width(py_cipher_texts, cipher_bytes, num);
+    auto res = new_cipher_array(rows * width, cipher_bytes);
+    const int64_t* matrix = py_matrix.data();
+    const uint8_t* cipher_texts = py_cipher_texts.data();
+    uint8_t* res_cipher_texts = res.mutable_data();
+    {
+        py::gil_scoped_release release;
+        opt_paillier_batch_matvec(res_cipher_texts, matrix, rows, cipher_texts,
+                                  num, width, pub_key->get(), num_threads);
+    }
+    return res;
+}
+
+py::tuple opt_paillier_batch_pack_encrypt_crt_warpper(
+    const py::object &py_pub,
+    const py::object &py_prv,
+    const PlainArray &py_plain_texts,
+    const py::object &py_crt_mod,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    auto prv_key = get_secret_key(py_prv);
+
+    CrtMod* crtmod;
+    if (py_crt_mod.is(py::none())) {
+        init_crt(&crtmod, CRT_MOD_MAX_DIMENSION, CRT_MOD_SIZE);
+    } else {
+        crtmod = dict_2_CrtMod(py::dict(py_crt_mod));
+    }
+
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t num = py_plain_texts.size();
+    auto res = new_cipher_array(opt_paillier_batch_pack_num(num, crtmod), cipher_bytes);
+    const int64_t* plain_texts = py_plain_texts.data();
+    uint8_t* cipher_texts = res.mutable_data();
+    {
+        py::gil_scoped_release release;
+        opt_paillier_batch_pack_encrypt_crt_fb(cipher_texts, plain_texts, num, crtmod,
+                                               pub_key->get(), prv_key->get(), num_threads);
+    }
+    auto py_res_crt_mod = crtMod_2_dict(crtmod);
+    free_crt(crtmod);
+    return py::make_tuple(res, py_res_crt_mod);
+}
+
+PlainArray opt_paillier_batch_pack_decrypt_crt_warpper(
+    const py::object &py_pub,
+    const py::object &py_prv,
+    const CipherArray &py_cipher_texts,
+    size_t pack_size,
+    const py::dict &py_crt_mod,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    auto prv_key = get_secret_key(py_prv);
+    CrtMod* crtmod = dict_2_CrtMod(py_crt_mod);
+
+    size_t cipher_bytes = opt_paillier_cipher_bytes(pub_key->get());
+    size_t num = cipher_array_num(py_cipher_texts, cipher_bytes);
+    if (opt_paillier_batch_pack_num(pack_size, crtmod) != num) {
+        free_crt(crtmod);
+        throw std::invalid_argument("pack size does not match number of ciphertexts");
+    }
+    PlainArray res(static_cast<py::ssize_t>(pack_size));
+    const uint8_t* cipher_texts = py_cipher_texts.data();
+    int64_t* plain_texts = res.mutable_data();
+    bool fits = true;
+    {
+        py::gil_scoped_release release;
+        fits = opt_paillier_batch_pack_decrypt_crt(plain_texts, cipher_texts, pack_size, crtmod,
+                                                   pub_key->get(), prv_key->get(), num_threads);
+    }
+    free_crt(crtmod);
+    if (!fits) {
+        throw std::overflow_error("decrypted value does not fit in int64");
+    }
+    return res;
+}
+
+void opt_paillier_start_obfuscator_pool_warpper(
+    const py::object &py_pub,
+    const py::object &py_prv,
+    size_t capacity,
+    size_t num_threads) {
+
+    auto pub_key = get_public_key(py_pub);
+    std::shared_ptr<PaillierSecretKey> prv_key{nullptr};
+    if (!py_prv.is(py::none())) {
+        prv_key = get_secret_key(py_prv);
+    }
+    pub_key->start_pool(std::move(prv_key), capacity, num_threads);
+}
+
+void opt_paillier_stop_obfuscator_pool_warpper(
+    const py::object &py_pub) {
+
+    auto pub_key = get_public_key(py_pub);
+    auto pool = pub_key->pool();
+    pub_key->stop_pool();
+    // join pool threads without gil if this is the last reference
+    py::gil_scoped_release release;
+    pool.reset();
+}
+
+py::dict opt_paillier_obfuscator_pool_stat_warpper(
+    const py::object &py_pub) {
+
+    auto pub_key = get_public_key(py_pub);
+    auto pool = pub_key->pool();
+    py::dict res = py::dict();
+    if (pool == nullptr) {
+        return res;
+    }
+    auto stat = pool->stat();
+    res["capacity"] = stat.capacity;
+    res["depth"] = stat.depth;
+    res["produced"] = stat.produced;
+    res["consumed"] = stat.consumed;
+    res["fallback"] = stat.fallback;
+    res["refill_rate"] = stat.refill_rate;
+    return res;
 }
 
 PYBIND11_MODULE(opt_paillier_c2py, m) {
     m.doc() = "opt paillier cpp to python plugin"; // optional module docstring
 
+    py::class_<PaillierPublicKey, std::shared_ptr<PaillierPublicKey>>(
+        m, "PaillierPublicKey");
+
+    py::class_<PaillierSecretKey, std::shared_ptr<PaillierSecretKey>>(
+        m, "PaillierSecretKey");
+
     m.def("opt_paillier_keygen_warpper",
          &opt_paillier_keygen_warpper,
          "A function that generate opt paillier publice key and private key");
@@ -525,4 +899,56 @@ PYBIND11_MODULE(opt_paillier_c2py, m) {
     m.def("opt_paillier_pack_add_warpper",
          &opt_paillier_pack_add_warpper,
          "A opt paillier add function that add two pack ciphertext");
+
+    m.def("opt_paillier_batch_encrypt_warpper",
+         &opt_paillier_batch_encrypt_warpper,
+         "A opt paillier encrypt function that encrypt int64 array in parallel");
+
+    m.def("opt_paillier_batch_encrypt_crt_warpper",
+         &opt_paillier_batch_encrypt_crt_warpper,
+         "A opt paillier encrypt function that encrypt int64 array in parallel");
+
+    m.def("opt_paillier_batch_decrypt_crt_warpper",
+         &opt_paillier_batch_decrypt_crt_warpper,
+         "A opt paillier decrypt function that decrypt ciphertext array in parallel");
+
+    m.def("opt_paillier_batch_add_warpper",
+         &opt_paillier_batch_add_warpper,
+         "A opt paillier add function that add two ciphertext arrays in parallel");
+
+    m.def("opt_paillier_batch_cons_mul_warpper",
+         &opt_paillier_batch_cons_mul_warpper,
+         "A opt paillier constant multiplication function for ciphertext array in parallel");
+
+    m.def("opt_paillier_batch_pack_encrypt_crt_warpper",
+         &opt_paillier_batch_pack_encrypt_crt_warpper,
+         "A opt paillier encrypt function that pack encrypt int64 array in parallel");
+
+    m.def("opt_paillier_batch_pack_decrypt_crt_warpper",
+         &opt_paillier_batch_pack_decrypt_crt_warpper,
+         "A opt paillier decrypt function that pack decrypt ciphertext array in parallel");
+
+    m.def("opt_paillier_batch_sum_warpper",
+         &opt_paillier_batch_sum_warpper,
+         "A opt paillier function that sum rows of ciphertext matrix in parallel");
+
+    m.def("opt_paillier_batch_inner_product_warpper",
+         &opt_paillier_batch_inner_product_warpper,
+         "A opt paillier function that multiply plaintext vector with ciphertext matrix in parallel");
+
+    m.def("opt_paillier_batch_matvec_warpper",
+         &opt_paillier_batch_matvec_warpper,
+         "A opt paillier function that multiply plaintext matrix with ciphertext matrix in parallel");
+
+    m.def("opt_paillier_start_obfuscator_pool_warpper",
+         &opt_paillier_start_obfuscator_pool_warpper,
+         "A function that start precomputing obfuscators of public key for encryption");
+
+    m.def("opt_paillier_stop_obfuscator_pool_warpper",
+         &opt_paillier_stop_obfuscator_pool_warpper,
+         "A function that stop precomputing obfuscators of public key");
+
+    m.def("opt_paillier_obfuscator_pool_stat_warpper",
+         &opt_paillier_obfuscator_pool_stat_warpper,
+         "A function that return depth and refill metrics of obfuscator pool");
 }
@@ -1,10 +1,72 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <iostream>
 #include "src/primihub/algorithm/opt_paillier/include/paillier.h"
 #include "src/primihub/algorithm/opt_paillier/include/crt_datapack.h"
+#include "src/primihub/algorithm/opt_paillier/include/paillier_batch.h"
+#include "src/primihub/algorithm/opt_paillier/include/obfuscator_pool.h"
 #include <string>
+#include <memory>
+#include <stdexcept>
 
 #define BASE 10
 #define PYTHON_INPUT_BASE 10
 #define CRT_MOD_MAX_DIMENSION 28
 #define CRT_MOD_SIZE 70
+// attribute of python key object which holds the c++ key handle
+#define KEY_HANDLE_ATTR "_key_handle"
+
+/**
+ * c++ key owned by python key object, the fixed-base tables of public key
+ * are built once when the handle is created and shared by later calls
+ */
+class PaillierSecretKey {
+ public:
+  explicit PaillierSecretKey(opt_secret_key_t* prv) : prv_(prv) {}
+  ~PaillierSecretKey() {
+    if (prv_ != nullptr) {
+      opt_paillier_freeprvkey(prv_);
+    }
+  }
+  PaillierSecretKey(const PaillierSecretKey&) = delete;
+  PaillierSecretKey& operator=(const PaillierSecretKey&) = delete;
+  opt_secret_key_t* get() const { return prv_; }
+
+ private:
+  opt_secret_key_t* prv_{nullptr};
+};
+
+class PaillierPublicKey {
+ public:
+  explicit PaillierPublicKey(opt_public_key_t* pub) : pub_(pub) {}
+  ~PaillierPublicKey() {
+    // threads of pool use the keys
+    pool_.reset();
+    if (pub_ != nullptr) {
+      opt_paillier_freepubkey(pub_);
+    }
+  }
+  PaillierPublicKey(const PaillierPublicKey&) = delete;
+  PaillierPublicKey& operator=(const PaillierPublicKey&) = delete;
+  opt_public_key_t* get() const { return pub_; }
+  /**
+   * start background precomputation of obfuscators for encryption,
+   * prv_key is optional, it makes precomputation faster by crt
+   */
+  void start_pool(std::shared_ptr<PaillierSecretKey> prv_key,
+                  size_t capacity, size_t num_threads) {
+    pool_.reset();
+    opt_secret_key_t* prv = prv_key == nullptr ? nullptr : prv_key->get();
+    // secret key is kept alive until the pool is deleted
+    pool_ = std::shared_ptr<ObfuscatorPool>(
+        new ObfuscatorPool(pub_, prv, capacity, num_threads),
+        [prv_key](ObfuscatorPool* pool) { delete pool; });
+    pool_->start();
+  }
+  void stop_pool() { pool_.reset(); }
+  std::shared_ptr<ObfuscatorPool> pool() const { return pool_; }
+
+ private:
+  opt_public_key_t* pub_{nullptr};
+  std::shared_ptr<ObfuscatorPool> pool_{nullptr};
+};
@@ -38,7 +38,9 @@ PYBIND11_MODULE(linkcontext, m)
 {
     py::enum_<LinkMode>(m, "LinkMode", py::arithmetic())
         .value("GRPC", LinkMode::GRPC, "connection with grpc")
-        .value("RAW_SOCKET", LinkMode::RAW_SOCKET, "connect with socket");
+        .value("RAW_SOCKET", LinkMode::RAW_SOCKET, "connect with socket")
+        .value("SHARED_MEMORY", LinkMode::SHARED_MEMORY,
+               "grpc with shared memory data channel for co-located parties");
 
     py::class_<CertificateConfig>(m, "CertificateConfig")
         .def(py::init<const std::string&, const std::string&, const std::string&>());
@@ -56,7 +58,20 @@ PYBIND11_MODULE(linkcontext, m)
         .def("setRecvTimeout", &LinkContext::setRecvTimeout)
         .def("initCertificate", py::overload_cast<const std::string&,
                 const std::string&, const std::string&>(&LinkContext::initCertificate))
-        .def("setSendTimeout", &LinkContext::setSendTimeout);
+        .def("setSendTimeout", &LinkContext::setSendTimeout)
+        .def("setCompressOption",
+            [](LinkContext& self, const std::string& mode,
+               int level, size_t threshold) {
+              primihub::network::CompressOption option;
+              option.mode = primihub::network::Compressor::StrToMode(mode);
+              option.level = level;
+              option.threshold = threshold;
+              self.setCompressOption(option);
+            },
+            py::arg("mode"), py::arg("level") = 1,
+            py::arg("threshold") = primihub::COMPRESS_THRESHOLD_SIZE)
+        .def("rawSendBytes", &LinkContext::rawSendBytes)
+        .def("compressedSendBytes", &LinkContext::compressedSendBytes);
 
     py::class_<GrpcLinkContext, LinkContext>(m, "GrpcLinkContext")
         .def(py::init());
@@ -24,6 +24,7 @@
 
 #include "src/primihub/service/dataset/service.h"
 #include "src/primihub/data_store/factory.h"
+#include "src/primihub/data_store/dataset_cache.h"
 #include "src/primihub/common/config/config.h"
 #include "src/primihub/service/dataset/util.hpp"
 #include "src/primihub/util/redis_helper.h"
@@ -33,6 +34,15 @@
 using DataSetAccessInfoPtr = std::unique_ptr<primihub::DataSetAccessInfo>;
 
 namespace primihub::service {
+namespace {
+// expired entries are purged when cache grows to this size
+constexpr size_t kMaxMetaCacheEntries = 10000;
+
+int64_t NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}  // namespace
 
 DatasetService::DatasetService(
     std::unique_ptr<DatasetMetaService> meta_service) :
@@ -45,6 +55,15 @@ retcode DatasetService::Init() {
   auto& node_cfg = ins.getNodeConfig();
 
   nodelet_addr_ = node_cfg.server_config.to_string();
+  auto& meta_cache_cfg = node_cfg.dataset_meta_cache;
+  meta_cache_ttl_ms_.store(meta_cache_cfg.ttl_ms);
+  meta_cache_negative_ttl_ms_.store(meta_cache_cfg.negative_ttl_ms);
+  auto& dataset_cache_cfg = node_cfg.dataset_cache;
+  auto ret = DatasetCache::getInstance().Init(
+      dataset_cache_cfg.cache_dir, dataset_cache_cfg.capacity_mb * 1024 * 1024);
+  if (ret != retcode::SUCCESS) {
+    LOG(WARNING) << "init dataset cache failed, datasets are not cached";
+  }
   return retcode::SUCCESS;
 }
 
@@ -84,7 +103,7 @@ DatasetService::newDataset(std::shared_ptr<primihub::DataDriver> driver,
                         DatasetVisbility::PUBLIC,
                         dataset_access_info);
     // Save datameta in local storage.& Publish dataset meta on libp2p network.
-    MetaService()->PutMeta(*meta);
+    PutMeta(*meta);
     return dataset;
 }
 
@@ -102,7 +121,7 @@ void DatasetService::writeDataset(const std::shared_ptr<primihub::Dataset> &data
     // dataset.write();
     // dataset->getDataDriver()->getCursor()->write(dataset);     // TODO(fix in future)
     meta = DatasetMeta(dataset, description, DatasetVisbility::PUBLIC, dataset_access_info);
-    MetaService()->PutMeta(meta);
+    PutMeta(meta);
 }
 
 
@@ -112,7 +131,7 @@ void DatasetService::writeDataset(const std::shared_ptr<primihub::Dataset> &data
  * @param meta [input]: Dataset meta
  */
 void DatasetService::regDataset(const DatasetMeta& meta) {
-    MetaService()->PutMeta(meta);
+    PutMeta(meta);
 }
 
 /**
@@ -159,6 +178,7 @@ retcode DatasetService::findDataset(const DatasetId& id,
  * @return int
  */
 retcode DatasetService::deleteDataset(const DatasetId& id) {
+  InvalidateMetaCache(id);
   return retcode::SUCCESS;
 }
 
@@ -222,7 +242,7 @@ void DatasetService::restoreDatasetFromLocalStorage() {
     // meta.setDataURL(nodelet_addr_ + ":" + dataset_path);
     meta.setServerInfo(nodelet_addr_);
     // Publish dataset meta on public network.
-    MetaService()->PutMeta(meta);
+    PutMeta(meta);
   }
 }
 
@@ -237,6 +257,7 @@ std::string DatasetService::getNodeletAddr(void) {
 primihub::retcode DatasetService::registerDriver(
     const std::string& dataset_id,
     std::shared_ptr<primihub::DataDriver> driver) {
+  InvalidateMetaCache(dataset_id);
   std::lock_guard<std::shared_mutex> lck(driver_mtx_);
   auto it = driver_manager_.find(dataset_id);
   if (it != driver_manager_.end()) {
@@ -251,13 +272,8 @@ primihub::retcode DatasetService::registerDriver(
 
 std::shared_ptr<primihub::DataDriver>
 DatasetService::getDriver(const std::string& dataset_id, bool is_acces_info) {
-  // {
-  //   std::shared_lock<std::shared_mutex> lck(driver_mtx_);
-  //   auto it = driver_manager_.find(dataset_id);
-  //   if (it != driver_manager_.end()) {
-  //     return it->second;
-  //   }
-  // }
+  // driver holds cursor state and is not shared between tasks,
+  // only dataset meta is cached, a new driver is built from it every time
   if (is_acces_info) {
     DatasetMetaInfo meta_info;
     VLOG(5) << dataset_id;
@@ -283,44 +299,144 @@ DatasetService::getDriver(const std::string& dataset_id, bool is_acces_info) {
                                         std::move(access_info));
   }
 
-  // get Meta using meta service
-  std::shared_ptr<primihub::DataDriver> driver{nullptr};
-  MetaService()->GetMeta(dataset_id,
-                        [&](std::shared_ptr<DatasetMeta> meta) -> retcode {
-    if (meta) {
-      DatasetMetaInfo meta_info;
-      meta_info.id = meta->id;
-      meta_info.driver_type = meta->getDriverType();
-      meta_info.access_info = meta->getAccessInfo();
-      auto& schema = meta_info.schema;
-      auto table_schema = dynamic_cast<TableSchema*>(meta->getSchema().get());
-      for (const auto& field : table_schema->ArrowSchema()->fields()) {
-        auto name = field->name();
-        int type = field->type()->id();
-        schema.push_back(std::make_tuple(name, type));
-      }
-      VLOG(5) << "driver_type: " << meta_info.driver_type << " "
+  DatasetMetaInfo meta_info;
+  auto ret = GetMetaInfo(dataset_id, &meta_info);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "get dataset meta for: " << dataset_id << " failed";
+    return nullptr;
+  }
+  VLOG(5) << "driver_type: " << meta_info.driver_type << " "
           << "access_info: " << meta_info.access_info;
-      auto access_info = createAccessInfo(meta_info.driver_type, meta_info);
-      if (access_info == nullptr) {
-        std::string err_msg = "create access info failed";
+  auto access_info = createAccessInfo(meta_info.driver_type, meta_info);
+  if (access_info == nullptr) {
+    LOG(ERROR) << "create access info for: " << dataset_id << " failed";
+    return nullptr;
+  }
+  return DataDirverFactory::getDriver(meta_info.driver_type,
+                                      DatasetLocation(),
+                                      std::move(access_info));
+}
+
+retcode DatasetService::GetMetaInfo(const std::string& dataset_id,
+                                    DatasetMetaInfo* meta_info) {
+  int64_t ttl_ms = meta_cache_ttl_ms_.load();
+  int64_t negative_ttl_ms = meta_cache_negative_ttl_ms_.load();
+  if (ttl_ms > 0) {
+    std::shared_lock<std::shared_mutex> lck(meta_cache_mtx_);
+    auto it = meta_cache_.find(dataset_id);
+    if (it != meta_cache_.end() && it->second.expire_time_ms > NowMs()) {
+      meta_cache_hit_.fetch_add(1);
+      auto& entry = it->second;
+      if (!entry.found) {
+        LOG(ERROR) << "dataset: " << dataset_id << " is not found (cached)";
         return retcode::FAIL;
       }
-      driver = DataDirverFactory::getDriver(meta_info.driver_type,
-                                          DatasetLocation(),
-                                          std::move(access_info));
+      VLOG(5) << "dataset meta cache hit: " << dataset_id;
+      *meta_info = entry.meta_info;
+      return retcode::SUCCESS;
+    }
+  }
+  meta_cache_miss_.fetch_add(1);
+  auto version = meta_cache_version_.load();
+  bool not_found{false};
+  auto ret = FetchMetaInfo(dataset_id, meta_info, &not_found);
+  if (ttl_ms <= 0) {
+    return ret;
+  }
+  DatasetMetaCacheEntry entry;
+  if (ret == retcode::SUCCESS) {
+    entry.found = true;
+    entry.meta_info = *meta_info;
+    entry.expire_time_ms = NowMs() + ttl_ms;
+  } else if (not_found && negative_ttl_ms > 0) {
+    entry.found = false;
+    entry.expire_time_ms = NowMs() + negative_ttl_ms;
+  } else {
+    // failure of meta service is not cached
+    return ret;
+  }
+  std::lock_guard<std::shared_mutex> lck(meta_cache_mtx_);
+  if (meta_cache_version_.load() != version) {
+    VLOG(5) << "dataset meta is invalidated while fetching: " << dataset_id;
+    return ret;
+  }
+  if (meta_cache_.size() >= kMaxMetaCacheEntries) {
+    auto now = NowMs();
+    for (auto it = meta_cache_.begin(); it != meta_cache_.end();) {
+      if (it->second.expire_time_ms <= now) {
+        it = meta_cache_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  meta_cache_[dataset_id] = std::move(entry);
+  return ret;
+}
+
+retcode DatasetService::FetchMetaInfo(const std::string& dataset_id,
+                                      DatasetMetaInfo* meta_info,
+                                      bool* not_found) {
+  bool meta_found{false};
+  auto ret = MetaService()->GetMeta(dataset_id,
+      [&](std::shared_ptr<DatasetMeta> meta) -> retcode {
+    if (meta == nullptr) {
       return retcode::SUCCESS;
-    } else {
-      LOG(ERROR) << "get dataset meta failed";
-      return retcode::FAIL;
     }
+    meta_found = true;
+    meta_info->id = meta->id;
+    meta_info->driver_type = meta->getDriverType();
+    meta_info->access_info = meta->getAccessInfo();
+    auto& schema = meta_info->schema;
+    schema.clear();
+    auto table_schema = dynamic_cast<TableSchema*>(meta->getSchema().get());
+    for (const auto& field : table_schema->ArrowSchema()->fields()) {
+      auto name = field->name();
+      int type = field->type()->id();
+      schema.push_back(std::make_tuple(name, type));
+    }
+    return retcode::SUCCESS;
   });
-  return driver;
+  *not_found = (ret == retcode::SUCCESS && !meta_found);
+  if (ret != retcode::SUCCESS || !meta_found) {
+    LOG(ERROR) << "get dataset meta failed";
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+void DatasetService::PutMeta(const DatasetMeta& meta) {
+  InvalidateMetaCache(meta.id);
+  MetaService()->PutMeta(meta);
+}
+
+void DatasetService::InvalidateMetaCache(const std::string& dataset_id) {
+  std::lock_guard<std::shared_mutex> lck(meta_cache_mtx_);
+  meta_cache_version_.fetch_add(1);
+  meta_cache_.erase(dataset_id);
+}
+
+void DatasetService::SetMetaCacheTTL(int64_t ttl_ms, int64_t negative_ttl_ms) {
+  std::lock_guard<std::shared_mutex> lck(meta_cache_mtx_);
+  meta_cache_ttl_ms_.store(ttl_ms);
+  meta_cache_negative_ttl_ms_.store(negative_ttl_ms);
+  meta_cache_version_.fetch_add(1);
+  meta_cache_.clear();
+}
+
+DatasetMetaCacheStat DatasetService::MetaCacheStat() {
+  DatasetMetaCacheStat stat;
+  stat.hit_count = meta_cache_hit_.load();
+  stat.miss_count = meta_cache_miss_.load();
+  std::shared_lock<std::shared_mutex> lck(meta_cache_mtx_);
+  stat.entry_count = meta_cache_.size();
+  return stat;
 }
 
 primihub::retcode DatasetService::unRegisterDriver(
     const std::string& dataset_id) {
-    std::lock_guard<std::shared_mutex> lck(driver_mtx_);
+  InvalidateMetaCache(dataset_id);
+  std::lock_guard<std::shared_mutex> lck(driver_mtx_);
   auto it = driver_manager_.find(dataset_id);
   if (it != driver_manager_.end()) {
       LOG(WARNING) << "erase driver for dataset: " << dataset_id;
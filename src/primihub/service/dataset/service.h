@@ -22,6 +22,7 @@
 #include <arrow/record_batch.h>
 #include <arrow/table.h>
 
+#include <atomic>
 #include <shared_mutex>
 #include <memory>
 #include <mutex>
@@ -35,6 +36,21 @@
 #include "src/primihub/service/dataset/meta_service/interface.h"
 
 namespace primihub::service {
+/**
+ * dataset meta resolved from meta service,
+ * found is false for dataset id which does not exist (negative cache)
+*/
+struct DatasetMetaCacheEntry {
+  bool found{false};
+  DatasetMetaInfo meta_info;
+  int64_t expire_time_ms{0};
+};
+
+struct DatasetMetaCacheStat {
+  size_t hit_count{0};
+  size_t miss_count{0};
+  size_t entry_count{0};
+};
 
 class DatasetService  {
  public:
@@ -88,6 +104,31 @@ class DatasetService  {
   createAccessInfo(const std::string& driver_type, const std::string& meta_info);
   std::unique_ptr<DataSetAccessInfo>
   createAccessInfo(const std::string& driver_type, const DatasetMetaInfo& meta_info);
+  /**
+   * ttl for dataset meta cache, 0 disables the cache
+   * negative_ttl_ms: ttl for dataset id which is not found
+  */
+  void SetMetaCacheTTL(int64_t ttl_ms, int64_t negative_ttl_ms);
+  void InvalidateMetaCache(const std::string& dataset_id);
+  DatasetMetaCacheStat MetaCacheStat();
+
+ protected:
+  /**
+   * get dataset meta from cache,
+   * resolve it using meta service if it is not cached or has expired
+  */
+  retcode GetMetaInfo(const std::string& dataset_id,
+                      DatasetMetaInfo* meta_info);
+  /**
+   * not_found: meta service answered that the dataset does not exist
+  */
+  retcode FetchMetaInfo(const std::string& dataset_id,
+                        DatasetMetaInfo* meta_info,
+                        bool* not_found);
+  /**
+   * publish meta and drop the cached one
+  */
+  void PutMeta(const DatasetMeta& meta);
 
  private:
   /**
@@ -101,6 +142,17 @@ class DatasetService  {
   // use cache or not, maybe support in future
   std::shared_mutex driver_mtx_;
   std::unordered_map<std::string, std::shared_ptr<DataDriver>> driver_manager_;
+  // dataset meta cache
+  std::shared_mutex meta_cache_mtx_;
+  std::unordered_map<std::string, DatasetMetaCacheEntry> meta_cache_;
+  // increased by every invalidation, meta fetched before
+  // an invalidation is not cached
+  std::atomic<uint64_t> meta_cache_version_{0};
+  // read by GetMetaInfo without meta_cache_mtx_
+  std::atomic<int64_t> meta_cache_ttl_ms_{60000};
+  std::atomic<int64_t> meta_cache_negative_ttl_ms_{5000};
+  std::atomic<size_t> meta_cache_hit_{0};
+  std::atomic<size_t> meta_cache_miss_{0};
 };
 
 }  // namespace primihub::service
@@ -28,6 +28,7 @@ retcode PirTask::BuildOptions(const rpc::Task& task, pir::Options* options) {
     // paramater for offline generate db info
     const auto& param_map = task.params().param_map();
     auto iter = param_map.find("DbInfo");
+    auto update_iter = param_map.find("DbUpdateInfo");
     if (iter != param_map.end()) {
       options->db_path = iter->second.value_string();
       LOG(INFO) << "db_file_cache path: " << options->db_path;
@@ -37,6 +38,30 @@ retcode PirTask::BuildOptions(const rpc::Task& task, pir::Options* options) {
       }
       ValidateDir(options->db_path);
       options->generate_db = true;
+    } else if (update_iter != param_map.end()) {
+      // paramater for offline incremental update of generated db
+      options->db_path = update_iter->second.value_string();
+      LOG(INFO) << "update db_file_cache path: " << options->db_path;
+      if (this->dataset_id_.empty()) {
+        LOG(ERROR) << "dataset id is empty for party: " << party_name();
+        return retcode::FAIL;
+      }
+      if (!DbCacheAvailable(options->db_path)) {
+        LOG(ERROR) << "db cache: " << options->db_path << " does not exist";
+        return retcode::FAIL;
+      }
+      options->update_db = true;
+      auto type_iter = param_map.find("DbUpdateType");
+      if (type_iter != param_map.end()) {
+        const auto& update_type = type_iter->second.value_string();
+        if (update_type == "delete") {
+          options->delete_db_items = true;
+        } else if (update_type != "upsert") {
+          LOG(ERROR) << "invalid DbUpdateType: " << update_type << ", "
+                     << "upsert or delete is expected";
+          return retcode::FAIL;
+        }
+      }
     } else {
       // paramater for online task
       if (this->dataset_id_.empty()) {
@@ -60,6 +85,10 @@ retcode PirTask::BuildOptions(const rpc::Task& task, pir::Options* options) {
       if (DbCacheAvailable(options->db_path)) {
         options->use_cache = true;
       }
+      auto& server_config = ServerConfig::getInstance();
+      auto& keyword_pir_cfg = server_config.getNodeConfig().keyword_pir;
+      options->batch_query = keyword_pir_cfg.batch_query;
+      options->max_batch_delay_ms = keyword_pir_cfg.max_batch_delay_ms;
     }
   }
   // peer node info
@@ -222,18 +251,20 @@ retcode PirTask::ClientLoadDataset() {
     return retcode::FAIL;
   }
   VLOG(7) << "dataset_id: " << this->dataset_id_;
-  auto data_ptr = LoadDataSetInternal(this->dataset_id_);
-  if (data_ptr == nullptr) {
+  auto ret = LoadDataSetInBatches(this->dataset_id_,
+      [&](std::shared_ptr<arrow::Table>& table) -> retcode {
+        std::vector<int> key_col = {0};
+        auto key_array = GetSelectedContent(table, key_col);
+        for (auto& item : key_array) {
+          elements_[item];
+        }
+        return retcode::SUCCESS;
+      });
+  if (ret != retcode::SUCCESS) {
     LOG(ERROR) << "read data for dataset id: "
                << this->dataset_id_ << " failed";
     return retcode::FAIL;
   }
-  auto& table = std::get<std::shared_ptr<arrow::Table>>(data_ptr->data);
-  std::vector<int> key_col = {0};
-  auto key_array = GetSelectedContent(table, key_col);
-  for (auto& item : key_array) {
-    elements_[item];
-  }
   return retcode::SUCCESS;
 }
 
@@ -242,73 +273,84 @@ retcode PirTask::ServerLoadDataset() {
     VLOG(0) << "using cache data for party: " << party_name();
     return retcode::SUCCESS;
   }
-  auto data_ptr = LoadDataSetInternal(this->dataset_id_);
-  if (data_ptr == nullptr) {
+  auto ret = LoadDataSetInBatches(this->dataset_id_,
+      [&](std::shared_ptr<arrow::Table>& table) -> retcode {
+        std::vector<int> key_col = {0};
+        auto key_array = GetSelectedContent(table, key_col);
+        if (this->options_.delete_db_items) {
+          // only item is needed to remove from db
+          for (auto& key : key_array) {
+            elements_[key];
+          }
+          return retcode::SUCCESS;
+        }
+        int col_count = table->num_columns();
+        if (col_count < 2) {
+          LOG(ERROR) << "data for server must have lable";
+          return retcode::FAIL;
+        }
+        // get label
+        std::vector<int> value_col;
+        for (int i = 1; i < col_count; i++) {
+          value_col.push_back(i);
+        }
+        auto value_array = GetSelectedContent(table, value_col);
+        for (size_t i = 0; i < key_array.size(); ++i) {
+          elements_[key_array[i]].push_back(std::move(value_array[i]));
+        }
+        return retcode::SUCCESS;
+      });
+  if (ret != retcode::SUCCESS) {
     LOG(ERROR) << "read data for dataset id: "
                << this->dataset_id_ << " failed";
     return retcode::FAIL;
   }
-  auto& table = std::get<std::shared_ptr<arrow::Table>>(data_ptr->data);
-  int col_count = table->num_columns();
-  size_t row_count = table->num_rows();
-  if (col_count < 2) {
-    LOG(ERROR) << "data for server must have lable";
-    return retcode::FAIL;
-  }
-  std::vector<int> key_col = {0};
-  auto key_array = GetSelectedContent(table, key_col);
-  // get label
-  std::vector<int> value_col;
-  for (int i = 1; i < col_count; i++) {
-    value_col.push_back(i);
-  }
-  if (value_col.empty()) {
-    LOG(ERROR) << "no selected colum for lable";
-    return retcode::FAIL;
-  }
-  auto value_array = GetSelectedContent(table, value_col);
-  elements_.reserve(key_array.size());
-  for (size_t i = 0; i < key_array.size(); ++i) {
-    auto& key = key_array[i];
-    auto& value = value_array[i];
-    auto it = elements_.find(key);
-    if (it != elements_.end()) {
-      it->second.push_back(value);
-    } else {
-      std::vector<std::string> vec;
-      vec.push_back(value);
-      elements_.insert({key, std::move(vec)});
-    }
-  }
   return retcode::SUCCESS;
 }
 
-std::shared_ptr<Dataset> PirTask::LoadDataSetInternal(
-    const std::string& dataset_id) {
+retcode PirTask::LoadDataSetInBatches(const std::string& dataset_id,
+    const std::function<retcode(std::shared_ptr<arrow::Table>&)>& handler) {
   auto driver = this->getDatasetService()->getDriver(dataset_id,
                                                      is_dataset_detail_);
   if (driver == nullptr) {
     LOG(ERROR) << "get driver for dataset: " << dataset_id << " failed";
-    return nullptr;
+    return retcode::FAIL;
   }
   auto cursor = driver->GetCursor();
   if (cursor == nullptr) {
     LOG(ERROR) << "init cursor failed for dataset id: " << dataset_id;
-    return nullptr;
+    return retcode::FAIL;
   }
-  // maybe pass schema to get expected data type
   // copy dataset schema, and change all filed to string
   auto schema = driver->dataSetAccessInfo()->Schema();
   for (auto& field : schema) {
     auto& type = std::get<1>(field);
     type = arrow::Type::type::STRING;
   }
-  auto data = cursor->read(schema);
-  if (data == nullptr) {
-    LOG(ERROR) << "read data failed for dataset id: " << dataset_id;
-    return nullptr;
+  cursor->SetBatchSchema(schema);
+  // only one batch is kept in memory besides the items extracted from it
+  while (true) {
+    std::shared_ptr<arrow::RecordBatch> batch;
+    auto ret = cursor->ReadNextBatch(DATASET_READ_BATCH_ROWS, &batch);
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "read data failed for dataset id: " << dataset_id;
+      return retcode::FAIL;
+    }
+    if (batch == nullptr) {
+      break;
+    }
+    auto table_result = arrow::Table::FromRecordBatches({batch});
+    if (!table_result.ok()) {
+      LOG(ERROR) << "make table failed, " << table_result.status();
+      return retcode::FAIL;
+    }
+    auto table = table_result.ValueOrDie();
+    ret = handler(table);
+    if (ret != retcode::SUCCESS) {
+      return retcode::FAIL;
+    }
   }
-  return data;
+  return retcode::SUCCESS;
 }
 
 retcode PirTask::SaveResult() {
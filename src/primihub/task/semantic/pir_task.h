@@ -15,6 +15,7 @@
  */
 #ifndef SRC_PRIMIHUB_TASK_SEMANTIC_PIR_TASK_H_
 #define SRC_PRIMIHUB_TASK_SEMANTIC_PIR_TASK_H_
+#include <functional>
 #include <string>
 #include "src/primihub/task/semantic/task.h"
 #include "src/primihub/common/common.h"
@@ -39,7 +40,12 @@ class PirTask : public TaskBase {
   retcode LoadDataset();
   retcode ClientLoadDataset();
   retcode ServerLoadDataset();
-  std::shared_ptr<Dataset> LoadDataSetInternal(const std::string& dataset_id);
+  /**
+   * read dataset batch by batch with all columns as string,
+   * handler is called for each batch
+  */
+  retcode LoadDataSetInBatches(const std::string& dataset_id,
+      const std::function<retcode(std::shared_ptr<arrow::Table>&)>& handler);
   bool DbCacheAvailable(const std::string& db_file_cache) {
     return FileExists(db_file_cache);
   }
@@ -19,6 +19,8 @@
 #include <numeric>
 #include <utility>
 #include <map>
+#include <string_view>
+#include <unordered_set>
 
 #include "src/primihub/data_store/factory.h"
 #include "src/primihub/util/util.h"
@@ -73,6 +75,15 @@ retcode PsiTask::BuildOptions(const rpc::Task& task, psi::Options* options) {
     options->psi_result_type =
         static_cast<psi::PsiResultType>(it->second.value_int32());
   }
+  // only used by client, server follows the chunk size of client
+  it = param_map.find("psiChunkSize");
+  if (it != param_map.end() && it->second.value_int32() > 0) {
+    options->chunk_size = it->second.value_int32();
+  }
+  it = param_map.find("psiWorkerNum");
+  if (it != param_map.end() && it->second.value_int32() > 0) {
+    options->worker_num = it->second.value_int32();
+  }
   // end of build Options
   return retcode::SUCCESS;
 }
@@ -168,29 +179,41 @@ retcode PsiTask::LoadDataset(void) {
     LOG(ERROR) << "get driver for data set: " << this->dataset_id_ << " failed";
     return retcode::FAIL;
   }
-  auto ret = LoadDatasetInternal(driver, data_index_,
-                                 &elements_, &data_colums_name_);
+  auto ret = LoadDatasetInternal(driver, data_index_, &elements_,
+                                 &data_colums_name_, &data_table_);
   if (ret != retcode::SUCCESS) {
     LOG(ERROR) << "Load dataset for psi server failed.";
     return retcode::FAIL;
   }
-  // filter duplicated data
-  std::vector<std::string> filtered_data;
-  filtered_data.reserve(elements_.size());
-  std::unordered_set<std::string> dup(elements_.size());
-  int64_t duplicate_num = 0;
-  for (auto& item : elements_) {
-    if (dup.find(item) != dup.end()) {
-      duplicate_num++;
+  // filter duplicated data, the first row of each item is kept,
+  // items are moved in place after all duplicates are found,
+  // since the set refers to the items in elements_
+  size_t num_rows = elements_.size();
+  std::vector<bool> keep(num_rows, false);
+  {
+    std::unordered_set<std::string_view> dup(num_rows);
+    for (size_t i = 0; i < num_rows; i++) {
+      keep[i] = dup.insert(elements_[i]).second;
+    }
+  }
+  element_row_index_.clear();
+  element_row_index_.reserve(num_rows);
+  size_t num_kept = 0;
+  for (size_t i = 0; i < num_rows; i++) {
+    if (!keep[i]) {
       continue;
     }
-    dup.insert(item);
-    filtered_data.push_back(item);
+    if (num_kept != i) {
+      elements_[num_kept] = std::move(elements_[i]);
+    }
+    element_row_index_.push_back(i);
+    num_kept++;
   }
+  elements_.resize(num_kept);
+  int64_t duplicate_num = num_rows - num_kept;
   if (duplicate_num != 0) {
     LOG(WARNING) << "item has duplicated time, count: " << duplicate_num;
   }
-  elements_ = std::move(filtered_data);
   return retcode::SUCCESS;
 }
 
@@ -206,6 +229,10 @@ retcode PsiTask::InitOperator() {
 }
 
 retcode PsiTask::ExecuteOperator() {
+  if (UseIndexResult()) {
+    return psi_operator_->ExecuteIndex(elements_, broadcast_result_,
+                                       &result_index_);
+  }
   return psi_operator_->Execute(elements_, broadcast_result_, &result_);
 }
 
@@ -213,7 +240,17 @@ retcode PsiTask::SaveResult() {
   if (!NeedSaveResult()) {
     return retcode::SUCCESS;
   }
-  auto ret = SaveDataToCSVFile(result_, result_file_path_, data_colums_name_);
+  auto ret{retcode::SUCCESS};
+  if (UseIndexResult()) {
+    std::vector<int64_t> row_index;
+    row_index.reserve(result_index_.size());
+    for (const auto index : result_index_) {
+      row_index.push_back(element_row_index_[index]);
+    }
+    ret = SaveDataToCSVFile(data_table_, row_index, result_file_path_);
+  } else {
+    ret = SaveDataToCSVFile(result_, result_file_path_, data_colums_name_);
+  }
   if (ret != retcode::SUCCESS) {
     LOG(ERROR) << "save result to " << result_file_path_ << " failed";
     return retcode::FAIL;
@@ -275,6 +312,17 @@ bool PsiTask::NeedSaveResult() {
   return true;
 }
 
+bool PsiTask::UseIndexResult() {
+  if (data_table_ == nullptr) {
+    return false;
+  }
+  if (IsServer() && broadcast_result_ &&
+      options_.psi_result_type == psi::PsiResultType::DIFFERENCE) {
+    return false;
+  }
+  return true;
+}
+
 bool PsiTask::IsClient() {
   if (party_name() == PARTY_CLIENT) {
     return true;
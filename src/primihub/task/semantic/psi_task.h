@@ -54,6 +54,11 @@ class PsiTask : public TaskBase, public primihub::psi::PsiCommonUtil {
   retcode BuildOptions(const rpc::Task& task,
                        primihub::psi::Options* option);
   bool NeedSaveResult();
+  /**
+   * result is exchanged as row index unless server receives
+   * difference of client by broadcast, which is not part of its own input
+  */
+  bool UseIndexResult();
   bool IsClient();
   bool IsServer();
   bool IsTeeCompute();
@@ -66,7 +71,13 @@ class PsiTask : public TaskBase, public primihub::psi::PsiCommonUtil {
   std::string dataset_id_;
   std::string result_file_path_;
   std::vector<std::string> elements_;
+  // row of table for each element of elements_
+  std::vector<int64_t> element_row_index_;
+  // selected colums of dataset, result rows are taken from it
+  std::shared_ptr<arrow::Table> data_table_{nullptr};
   std::vector<std::string> result_;
+  // index of elements_ in result
+  std::vector<int64_t> result_index_;
   bool broadcast_result_{false};
   std::unique_ptr<BasePsiOperator> psi_operator_{nullptr};
   primihub::psi::Options options_;
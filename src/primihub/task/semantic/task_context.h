@@ -37,11 +37,17 @@ class TaskContext {
  public:
   TaskContext() {
     auto link_mode = primihub::network::LinkMode::GRPC;
+    auto& node_cfg = ServerConfig::getInstance().getNodeConfig();
+    if (node_cfg.link_shared_memory.enable) {
+      link_mode = primihub::network::LinkMode::SHARED_MEMORY;
+    }
     link_ctx_ = primihub::network::LinkFactory::createLinkContext(link_mode);
+    initLinkOption();
   }
 
   explicit TaskContext(primihub::network::LinkMode mode) {
     link_ctx_ = primihub::network::LinkFactory::createLinkContext(mode);
+    initLinkOption();
   }
 
   void setTaskInfo(const std::string& job_id,
@@ -55,6 +61,36 @@ class TaskContext {
     return link_ctx_;
   }
 
+  /**
+   * payload compression, message coalescing and shared memory ring for link
+   * are configured by link_compress, link_coalesce and link_shared_memory
+   * in node config
+  */
+  void initLinkOption() {
+    if (link_ctx_ == nullptr) {
+      return;
+    }
+    using Compressor = primihub::network::Compressor;
+    auto& node_cfg = ServerConfig::getInstance().getNodeConfig();
+    auto& compress_cfg = node_cfg.link_compress;
+    primihub::network::CompressOption option;
+    option.mode = Compressor::StrToMode(compress_cfg.mode);
+    option.level = compress_cfg.level;
+    option.threshold = compress_cfg.threshold;
+    link_ctx_->setCompressOption(option);
+    auto& coalesce_cfg = node_cfg.link_coalesce;
+    primihub::network::CoalesceOption coalesce_option;
+    coalesce_option.enable = coalesce_cfg.enable;
+    coalesce_option.max_frame_size = coalesce_cfg.max_frame_size;
+    coalesce_option.max_delay_us = coalesce_cfg.max_delay_us;
+    link_ctx_->setCoalesceOption(coalesce_option);
+    if (link_ctx_->linkMode() == primihub::network::LinkMode::SHARED_MEMORY) {
+      auto shm_link_ctx =
+          static_cast<primihub::network::ShmLinkContext*>(link_ctx_.get());
+      shm_link_ctx->setRingSize(node_cfg.link_shared_memory.ring_size);
+    }
+  }
+
   void clean() {
     stop_.store(true);
     if (link_ctx_) {
@@ -16,12 +16,16 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <Python.h>
+#include <unistd.h>
+#include <cstdio>
 #include <iostream>
 #include <string>
 #include "pybind11/stl.h"
 #include "pybind11/embed.h"
 #include "src/primihub/task_engine/task_executor.h"
+#include "src/primihub/task_engine/task_process_protocol.h"
 #include "src/primihub/node/server_config.h"
+#include "src/primihub/util/util.h"
 
 DEFINE_string(node_id, "node0", "unique node_id");
 DEFINE_int32(task_engine_type, 0, "task engine type, 0: python, 1: other");
@@ -29,8 +33,66 @@ DEFINE_string(config_file, "./config/node1.yaml", "server config file");
 DEFINE_string(request, "", "task request, serialized by rpc::Task");
 DEFINE_string(request_id, "", "task request, serialized by rpc::Task");
 DEFINE_string(log_path, "", "log path");
+DEFINE_bool(pool_mode, false,
+            "run as pre-warmed process of task process pool, "
+            "read task requests from stdin one per line");
 
 namespace py = pybind11;
+namespace {
+void WriteProtocolLine(FILE* out, const char* line) {
+  fprintf(out, "%s\n", line);
+  fflush(out);
+}
+
+int RunPoolMode(const std::string& config_file) {
+  // stdout is reserved for protocol with node,
+  // output of task is redirected to stderr
+  int protocol_fd = dup(STDOUT_FILENO);
+  dup2(STDERR_FILENO, STDOUT_FILENO);
+  FILE* protocol_out = fdopen(protocol_fd, "w");
+  if (protocol_out == nullptr) {
+    LOG(ERROR) << "open protocol output failed";
+    return -1;
+  }
+  primihub::SCopedTimer timer;
+  auto& server_cfg = primihub::ServerConfig::getInstance();
+  server_cfg.initServerConfig(config_file);
+  auto& service_cfg = server_cfg.getServiceConfig();
+  auto task_engine = std::make_unique<primihub::task_engine::TaskEngine>();
+  auto ret = task_engine->Prepare(service_cfg.id(), config_file);
+  if (ret != primihub::retcode::SUCCESS) {
+    LOG(ERROR) << "prepare task engine failed";
+    return -1;
+  }
+  VLOG(0) << "task process is ready, time cost(ms): " << timer.timeElapse();
+  WriteProtocolLine(protocol_out, primihub::task_engine::kTaskProcessReady);
+  std::string request_str;
+  size_t task_count{0};
+  while (std::getline(std::cin, request_str)) {
+    if (request_str.empty()) {
+      continue;
+    }
+    task_count++;
+    VLOG(0) << "task process begin to execute task: " << task_count;
+    ret = task_engine->Init(service_cfg.id(), config_file, request_str);
+    if (ret != primihub::retcode::SUCCESS) {
+      LOG(ERROR) << "init task engine failed";
+    } else {
+      ret = task_engine->Execute();
+      if (ret != primihub::retcode::SUCCESS) {
+        LOG(ERROR) << "task executor encoutes error when executing task";
+      }
+    }
+    task_engine->Reset();
+    WriteProtocolLine(protocol_out, ret == primihub::retcode::SUCCESS ?
+                      primihub::task_engine::kTaskProcessSuccess :
+                      primihub::task_engine::kTaskProcessFail);
+  }
+  VLOG(0) << "task process exit, executed tasks: " << task_count;
+  return 0;
+}
+}  // namespace
+
 int main(int argc, char **argv) {
   py::scoped_interpreter python;
   py::gil_scoped_release release;
@@ -41,7 +103,8 @@ int main(int argc, char **argv) {
   std::string request_id = FLAGS_request_id;
   std::string log_path = FLAGS_log_path;
 
-  google::InitGoogleLogging(request_id.c_str());
+  std::string log_name = FLAGS_pool_mode ? "task_process" : request_id;
+  google::InitGoogleLogging(log_name.c_str());
   FLAGS_colorlogtostderr = false;
   FLAGS_alsologtostderr = false;
   if (!log_path.empty()) {
@@ -49,6 +112,9 @@ int main(int argc, char **argv) {
     FLAGS_log_dir = log_path.c_str();
   }
 
+  if (FLAGS_pool_mode) {
+    return RunPoolMode(config_file);
+  }
   if (task_request_str.empty()) {
     LOG(ERROR) << "task request empty is not allowed";
     return -1;
@@ -21,11 +21,32 @@
 #include "src/primihub/task/semantic/factory.h"
 
 namespace primihub::task_engine {
+retcode TaskEngine::Prepare(const std::string& server_id,
+                            const std::string& config_file) {
+  this->node_id_ = server_id;
+  this->config_file_ = config_file;
+  VLOG(5) << "InitCommunication";
+  auto ret = InitCommunication();
+  VLOG(5) << "InitDatasetSerivce";
+  ret = InitDatasetSerivce();
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "InitDatasetSerivce failed";
+    return retcode::FAIL;
+  }
+  prepared_ = true;
+  return retcode::SUCCESS;
+}
+
 retcode TaskEngine::Init(const std::string& server_id,
                          const std::string& config_file,
                          const std::string& request) {
-  this->node_id_ = server_id;
-  this->config_file_ = config_file;
+  if (!prepared_) {
+    auto ret = Prepare(server_id, config_file);
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "Prepare task engine failed";
+      return retcode::FAIL;
+    }
+  }
   VLOG(5) << "ParseTaskRequest";
   auto ret = ParseTaskRequest(request);
   if (ret != retcode::SUCCESS) {
@@ -34,14 +55,6 @@ retcode TaskEngine::Init(const std::string& server_id,
   }
   VLOG(5) << "GetScheduleNode";
   ret = GetScheduleNode();
-  VLOG(5) << "InitCommunication";
-  ret = InitCommunication();
-  VLOG(5) << "InitDatasetSerivce";
-  ret = InitDatasetSerivce();
-  if (ret != retcode::SUCCESS) {
-    LOG(ERROR) << "InitDatasetSerivce failed";
-    return retcode::FAIL;
-  }
   VLOG(5) << "CreateTask";
   ret = CreateTask();
   if (ret != retcode::SUCCESS) {
@@ -134,6 +147,13 @@ retcode TaskEngine::Execute() {
   }
   try {
     auto ret = task_->execute();
+    // task succeeds only if data it has sent is delivered
+    auto& task_link_ctx = task_->getTaskContext().getLinkContext();
+    if (ret == 0 && task_link_ctx != nullptr &&
+        task_link_ctx->Flush() != retcode::SUCCESS) {
+      LOG(ERROR) << "data sent by task is not delivered to peer";
+      ret = -1;
+    }
     if (ret == 0) {
       LOG(INFO) << "run task success";
       return retcode::SUCCESS;
@@ -152,4 +172,9 @@ retcode TaskEngine::Execute() {
 
 }
 
-} // namespace primihub::task_engine
+void TaskEngine::Reset() {
+  task_.reset();
+  task_request_.reset();
+  schedule_node_available_ = false;
+}
+}  // namespace primihub::task_engine
@@ -36,10 +36,20 @@ class TaskEngine {
  public:
   TaskEngine() = default;
   ~TaskEngine() = default;
+  /**
+   * load server config, dataset service and link context,
+   * which are shared by tasks executed one after another by the engine
+  */
+  retcode Prepare(const std::string& server_id,
+                  const std::string& server_config_file);
   retcode Init(const std::string& server_id,
                const std::string& server_config_file,
                const std::string& request);
   retcode Execute();
+  /**
+   * release the finished task, keep resource loaded by Prepare
+  */
+  void Reset();
 
   retcode GetScheduleNode();
   retcode UpdateStatus(rpc::TaskStatus::StatusCode code_status,
@@ -60,6 +70,7 @@ class TaskEngine {
   LinkContextPtr link_ctx_{nullptr};
   TaskPtr task_{nullptr};
   DatasetServicePtr dataset_service_{nullptr};
+  bool prepared_{false};
 };
 }  // namespace primihub::task_engine
 #endif  // SRC_PRIMIHUB_TASK_ENGINE_TASK_EXECUTOR_H_
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2023 by PrimiHub
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      https://www.apache.org/licenses/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_PRIMIHUB_TASK_ENGINE_TASK_PROCESS_PROTOCOL_H_
+#define SRC_PRIMIHUB_TASK_ENGINE_TASK_PROCESS_PROTOCOL_H_
+
+namespace primihub::task_engine {
+/**
+ * line based protocol between node and pooled task_main process.
+ * task_main started with --pool_mode writes kTaskProcessReady to stdout
+ * once initialized, then reads one base64 encoded task request per line
+ * from stdin and answers kTaskProcessSuccess or kTaskProcessFail per task.
+ * anything else printed by task goes to stderr
+*/
+constexpr char kTaskProcessReady[] = "ready";
+constexpr char kTaskProcessSuccess[] = "success";
+constexpr char kTaskProcessFail[] = "fail";
+}  // namespace primihub::task_engine
+#endif  // SRC_PRIMIHUB_TASK_ENGINE_TASK_PROCESS_PROTOCOL_H_
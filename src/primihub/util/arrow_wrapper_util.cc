@@ -2,6 +2,9 @@
 #include "src/primihub/util/arrow_wrapper_util.h"
 #include <glog/logging.h>
 #include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 
 namespace primihub::arrow_wrapper::util {
 static std::unordered_map<std::string, int> sql_tyep_2_arrow_type_map {
@@ -223,4 +226,118 @@ std::shared_ptr<arrow::Array> BinaryArrowArrayBuilder(
   return array;
 }
 
+namespace {
+template <typename T>
+T ParseInteger(const char* data, size_t length) {
+  T value{0};
+  std::from_chars(data, data + length, value);
+  return value;
+}
+
+double ParseFloating(const char* data, size_t length) {
+  if (length == 0) {
+    return 0.0;
+  }
+  // strtod requires null-terminated input
+  char buf[64];
+  if (length >= sizeof(buf)) {
+    std::string value(data, length);
+    return std::strtod(value.c_str(), nullptr);
+  }
+  std::memcpy(buf, data, length);
+  buf[length] = '\0';
+  return std::strtod(buf, nullptr);
+}
+}  // namespace
+
+ArrowColumnBuilder::ArrowColumnBuilder(int field_type,
+                                       arrow::MemoryPool* pool) {
+  switch (field_type) {
+  case arrow::Type::type::INT64:
+  case arrow::Type::type::UINT64:
+    value_type_ = ValueType::INT64;
+    builder_ = std::make_unique<arrow::Int64Builder>(pool);
+    break;
+  case arrow::Type::type::INT32:
+  case arrow::Type::type::INT16:
+  case arrow::Type::type::INT8:
+  case arrow::Type::type::UINT32:
+  case arrow::Type::type::UINT16:
+  case arrow::Type::type::UINT8:
+    value_type_ = ValueType::INT32;
+    builder_ = std::make_unique<arrow::Int32Builder>(pool);
+    break;
+  case arrow::Type::type::FLOAT:
+    value_type_ = ValueType::FLOAT;
+    builder_ = std::make_unique<arrow::FloatBuilder>(pool);
+    break;
+  case arrow::Type::type::DOUBLE:
+    value_type_ = ValueType::DOUBLE;
+    builder_ = std::make_unique<arrow::DoubleBuilder>(pool);
+    break;
+  default:
+    if (field_type != arrow::Type::type::STRING) {
+      LOG(ERROR) << "unkonw data type: " << field_type
+          << " consider as string type";
+    }
+    value_type_ = ValueType::STRING;
+    builder_ = std::make_unique<arrow::StringBuilder>(pool);
+    break;
+  }
+}
+
+retcode ArrowColumnBuilder::Reserve(int64_t num_rows) {
+  auto status = builder_->Reserve(num_rows);
+  if (!status.ok()) {
+    LOG(ERROR) << "reserve arrow builder failed, " << status;
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+retcode ArrowColumnBuilder::Append(const char* data, size_t length) {
+  arrow::Status status;
+  switch (value_type_) {
+  case ValueType::INT32:
+    status = static_cast<arrow::Int32Builder*>(builder_.get())->Append(
+        ParseInteger<int32_t>(data, length));
+    break;
+  case ValueType::INT64:
+    status = static_cast<arrow::Int64Builder*>(builder_.get())->Append(
+        ParseInteger<int64_t>(data, length));
+    break;
+  case ValueType::FLOAT:
+    status = static_cast<arrow::FloatBuilder*>(builder_.get())->Append(
+        static_cast<float>(ParseFloating(data, length)));
+    break;
+  case ValueType::DOUBLE:
+    status = static_cast<arrow::DoubleBuilder*>(builder_.get())->Append(
+        ParseFloating(data, length));
+    break;
+  case ValueType::STRING:
+    if (length == 0) {
+      status = static_cast<arrow::StringBuilder*>(builder_.get())->Append(
+          "NA", 2);
+    } else {
+      status = static_cast<arrow::StringBuilder*>(builder_.get())->Append(
+          data, length);
+    }
+    break;
+  }
+  if (!status.ok()) {
+    LOG(ERROR) << "append value to arrow builder failed, " << status;
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+retcode ArrowColumnBuilder::Finish(std::shared_ptr<arrow::Array>* array) {
+  auto status = builder_->Finish(array);
+  if (!status.ok()) {
+    LOG(ERROR) << "finish arrow builder failed, " << status;
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
 }  // namespace primihub::arrow_wrapper::util
@@ -69,6 +69,34 @@ StringArrowArrayBuilder(const std::vector<std::string>& arr);
 std::shared_ptr<arrow::Array>
 BinaryArrowArrayBuilder(const std::vector<std::string>& arr);
 
+/**
+ * append raw cell value to typed arrow builder directly,
+ * without materializing the cell as std::string.
+ * conversion is the same as MakeArrowArray:
+ *  integer and float which can not be parsed is 0,
+ *  empty cell of string column is "NA"
+*/
+class ArrowColumnBuilder {
+ public:
+  explicit ArrowColumnBuilder(int field_type,
+      arrow::MemoryPool* pool = arrow::default_memory_pool());
+  retcode Reserve(int64_t num_rows);
+  retcode Append(const char* data, size_t length);
+  retcode Finish(std::shared_ptr<arrow::Array>* array);
+  int64_t length() const {return builder_->length();}
+
+ private:
+  enum class ValueType : int8_t {
+    INT32 = 0,
+    INT64,
+    FLOAT,
+    DOUBLE,
+    STRING,
+  };
+  ValueType value_type_;
+  std::unique_ptr<arrow::ArrayBuilder> builder_;
+};
+
 
 }  // namespace primihub::arrow_wrapper::util
 #endif  // SRC_PRIMIHUB_UTIL_ARROW_WRAPPER_UTIL_H_
@@ -0,0 +1,313 @@
+// Copyright [2023] <primihub.com>
+#ifndef SRC_PRIMIHUB_UTIL_LOCKFREE_QUEUE_H_
+#define SRC_PRIMIHUB_UTIL_LOCKFREE_QUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace primihub {
+/**
+ * multi-producer multi-consumer queue with the same interface as
+ * ThreadSafeQueue, items go through a bounded lock-free ring,
+ * each cell carries a sequence number, so producer and consumer only
+ * contend on one atomic position each, and an uncontended push or pop is
+ * a single compare-and-swap.
+ * push never blocks: items spill over into a locked list when ring is full
+ * and are taken after the ring is drained, which keeps fifo order per
+ * producer. try_push and wait_for_push apply backpressure instead.
+ * waiting spins for a while before it parks, producers only take the park
+ * lock when someone is parked.
+*/
+template<typename T>
+class LockFreeQueue {
+ public:
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  explicit LockFreeQueue(size_t capacity = kDefaultCapacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    cells_ = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; i++) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  LockFreeQueue(const LockFreeQueue&) = delete;
+  LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+  void push(const T& item) {
+    emplace(item);
+  }
+
+  void push(T&& item) {
+    emplace(std::move(item));
+  }
+
+  template<typename... Args>
+  void emplace(Args&&... args) {
+    T item(std::forward<Args>(args)...);
+    if (overflow_size_.load(std::memory_order_acquire) > 0 ||
+        !TryEnqueue(item)) {
+      std::lock_guard<std::mutex> lock(overflow_mtx_);
+      overflow_.push_back(std::move(item));
+      overflow_size_.fetch_add(1, std::memory_order_release);
+    }
+    Notify(&pop_waiters_, &not_empty_cv_);
+  }
+
+  /**
+   * push only if ring has free cell, return false if queue is full
+   * or has been shutdown
+  */
+  bool try_push(T&& item) {
+    if (!TryPush(item)) {
+      return false;
+    }
+    Notify(&pop_waiters_, &not_empty_cv_);
+    return true;
+  }
+
+  /**
+   * wait at most timeout_ms for a free cell,
+   * return false if timeout or queue has been shutdown
+  */
+  bool wait_for_push(T&& item, int32_t timeout_ms) {
+    bool pushed{false};
+    auto ready = [&]() {
+      pushed = TryPush(item);
+      return pushed || stop_.load();
+    };
+    Wait(ready, timeout_ms, &push_waiters_, &not_full_cv_);
+    if (pushed) {
+      Notify(&pop_waiters_, &not_empty_cv_);
+    }
+    return pushed;
+  }
+
+  bool empty() const {
+    size_t head = dequeue_pos_.load(std::memory_order_acquire);
+    size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+    return head >= tail && overflow_size_.load(std::memory_order_acquire) == 0;
+  }
+
+  /**
+   * approximate number of items, exact when queue is not being modified
+  */
+  size_t size() const {
+    size_t head = dequeue_pos_.load(std::memory_order_acquire);
+    size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+    return (tail > head ? tail - head : 0) +
+           overflow_size_.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const {
+    return mask_ + 1;
+  }
+
+  bool try_pop(T& popped_value) {
+    if (!TryPop(popped_value)) {
+      return false;
+    }
+    Notify(&push_waiters_, &not_full_cv_);
+    return true;
+  }
+
+  void wait_and_pop(T& popped_value) {
+    wait_for_and_pop(popped_value, -1);
+  }
+
+  /**
+   * wait at most timeout_ms for an item,
+   * return false if timeout or queue has been shutdown
+  */
+  bool wait_for_and_pop(T& popped_value, int32_t timeout_ms) {
+    bool popped{false};
+    auto ready = [&]() {
+      if (stop_.load()) {
+        return true;
+      }
+      popped = TryPop(popped_value);
+      return popped;
+    };
+    Wait(ready, timeout_ms, &pop_waiters_, &not_empty_cv_);
+    if (popped) {
+      Notify(&push_waiters_, &not_full_cv_);
+    }
+    return popped;
+  }
+
+  bool is_shutdown() const {
+    return stop_.load();
+  }
+
+  T pop() {
+    T item{};
+    wait_and_pop(item);
+    return item;
+  }
+
+  /**
+   * wake up all waiting producers and consumers
+  */
+  void shutdown() {
+    stop_.store(true);
+    std::lock_guard<std::mutex> lock(park_mtx_);
+    not_empty_cv_.notify_all();
+    not_full_cv_.notify_all();
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+  // checks of ready before parking
+  static constexpr int kSpinCount = 256;
+
+  /**
+   * TryPush and TryPop do not notify waiters, they are called by
+   * Wait with park lock held
+  */
+  bool TryPush(T& item) {
+    return !stop_.load() &&
+           overflow_size_.load(std::memory_order_acquire) == 0 &&
+           TryEnqueue(item);
+  }
+
+  bool TryPop(T& item) {
+    if (TryDequeue(item)) {
+      return true;
+    }
+    if (overflow_size_.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(overflow_mtx_);
+    // ring is drained before overflow, items in ring are older
+    if (TryDequeue(item)) {
+      return true;
+    }
+    if (overflow_.empty()) {
+      return false;
+    }
+    item = std::move(overflow_.front());
+    overflow_.pop_front();
+    overflow_size_.fetch_sub(1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * item is moved into ring only if it succeeds
+  */
+  bool TryEnqueue(T& item) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(item);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryDequeue(T& item) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    item = std::move(cell->data);
+    cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * wake up one parked waiter, the fence pairs with the one in Wait,
+   * so either the waiter sees the change or this sees the waiter
+  */
+  void Notify(std::atomic<int>* waiters, std::condition_variable* cv) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters->load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(park_mtx_);
+      cv->notify_one();
+    }
+  }
+
+  /**
+   * spin then park until ready() returns true,
+   * timeout_ms < 0 means no limit, return false if timeout
+  */
+  template<typename Ready>
+  bool Wait(const Ready& ready, int32_t timeout_ms,
+            std::atomic<int>* waiters, std::condition_variable* cv) {
+    for (int i = 0; i < kSpinCount; i++) {
+      if (ready()) {
+        return true;
+      }
+      if (i >= kSpinCount / 2) {
+        std::this_thread::yield();
+      }
+    }
+    std::unique_lock<std::mutex> lock(park_mtx_);
+    waiters->fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool result{true};
+    if (timeout_ms < 0) {
+      cv->wait(lock, ready);
+    } else {
+      result = cv->wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                            ready);
+    }
+    waiters->fetch_sub(1);
+    return result;
+  }
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_{0};
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  alignas(64) std::atomic<size_t> dequeue_pos_{0};
+  alignas(64) std::atomic<size_t> overflow_size_{0};
+  std::mutex overflow_mtx_;
+  std::deque<T> overflow_;
+  std::mutex park_mtx_;
+  std::condition_variable not_empty_cv_;
+  std::condition_variable not_full_cv_;
+  std::atomic<int> pop_waiters_{0};
+  std::atomic<int> push_waiters_{0};
+  std::atomic<bool> stop_{false};
+};
+}  // namespace primihub
+#endif  // SRC_PRIMIHUB_UTIL_LOCKFREE_QUEUE_H_
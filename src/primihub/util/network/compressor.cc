@@ -0,0 +1,163 @@
+/*
+* Copyright (c) 2023 by PrimiHub
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      https://www.apache.org/licenses/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include "src/primihub/util/network/compressor.h"
+#include <glog/logging.h>
+#include <zstd.h>
+#include <lz4.h>
+#include <limits>
+
+namespace primihub::network {
+namespace {
+// lz4 can not expand data more than 255 times
+constexpr size_t kLz4MaxCompressRatio = 255;
+}  // namespace
+
+retcode Compressor::Compress(const CompressOption& option,
+                             std::string_view raw_data,
+                             std::string* compressed_data) {
+  switch (option.mode) {
+  case CompressMode::ZSTD: {
+    size_t bound = ZSTD_compressBound(raw_data.size());
+    compressed_data->resize(bound);
+    size_t compressed_size = ZSTD_compress(compressed_data->data(), bound,
+        raw_data.data(), raw_data.size(), option.level);
+    if (ZSTD_isError(compressed_size)) {
+      LOG(ERROR) << "zstd compress failed: "
+                 << ZSTD_getErrorName(compressed_size);
+      return retcode::FAIL;
+    }
+    compressed_data->resize(compressed_size);
+    break;
+  }
+  case CompressMode::LZ4: {
+    if (raw_data.size() > LZ4_MAX_INPUT_SIZE) {
+      LOG(ERROR) << "data size: " << raw_data.size() << " "
+                 << "exceeds lz4 max input size: " << LZ4_MAX_INPUT_SIZE;
+      return retcode::FAIL;
+    }
+    int bound = LZ4_compressBound(raw_data.size());
+    compressed_data->resize(bound);
+    int compressed_size = LZ4_compress_default(raw_data.data(),
+        compressed_data->data(), raw_data.size(), bound);
+    if (compressed_size <= 0) {
+      LOG(ERROR) << "lz4 compress failed";
+      return retcode::FAIL;
+    }
+    compressed_data->resize(compressed_size);
+    break;
+  }
+  default:
+    LOG(ERROR) << "unsupported compress mode: "
+               << static_cast<uint32_t>(option.mode);
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+retcode Compressor::Decompress(CompressMode mode,
+                               std::string_view compressed_data,
+                               size_t raw_data_len,
+                               std::string* raw_data,
+                               size_t max_raw_data_len) {
+  if (raw_data_len > max_raw_data_len) {
+    LOG(ERROR) << "raw data length: " << raw_data_len << " "
+               << "exceeds max size: " << max_raw_data_len;
+    return retcode::FAIL;
+  }
+  switch (mode) {
+  case CompressMode::ZSTD: {
+    // the frame written by ZSTD_compress records its content size
+    auto content_size = ZSTD_getFrameContentSize(compressed_data.data(),
+                                                 compressed_data.size());
+    if (content_size == ZSTD_CONTENTSIZE_ERROR ||
+        content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+      LOG(ERROR) << "invalid zstd frame header";
+      return retcode::FAIL;
+    }
+    if (content_size != raw_data_len) {
+      LOG(ERROR) << "zstd frame content size does not match, "
+                 << "expected: " << raw_data_len << " get: " << content_size;
+      return retcode::FAIL;
+    }
+    raw_data->resize(raw_data_len);
+    size_t raw_size = ZSTD_decompress(raw_data->data(), raw_data_len,
+        compressed_data.data(), compressed_data.size());
+    if (ZSTD_isError(raw_size)) {
+      LOG(ERROR) << "zstd decompress failed: " << ZSTD_getErrorName(raw_size);
+      return retcode::FAIL;
+    }
+    if (raw_size != raw_data_len) {
+      LOG(ERROR) << "zstd decompress data length does not match, "
+                 << "expected: " << raw_data_len << " get: " << raw_size;
+      return retcode::FAIL;
+    }
+    break;
+  }
+  case CompressMode::LZ4: {
+    if (raw_data_len > static_cast<size_t>(std::numeric_limits<int>::max())) {
+      LOG(ERROR) << "raw data length: " << raw_data_len << " is too large";
+      return retcode::FAIL;
+    }
+    if (raw_data_len / kLz4MaxCompressRatio > compressed_data.size()) {
+      LOG(ERROR) << "raw data length: " << raw_data_len << " is too large "
+                 << "for lz4 compressed size: " << compressed_data.size();
+      return retcode::FAIL;
+    }
+    raw_data->resize(raw_data_len);
+    int raw_size = LZ4_decompress_safe(compressed_data.data(),
+        raw_data->data(), compressed_data.size(), raw_data_len);
+    if (raw_size < 0 || static_cast<size_t>(raw_size) != raw_data_len) {
+      LOG(ERROR) << "lz4 decompress failed, "
+                 << "expected: " << raw_data_len << " get: " << raw_size;
+      return retcode::FAIL;
+    }
+    break;
+  }
+  default:
+    LOG(ERROR) << "unsupported compress mode: " << static_cast<uint32_t>(mode);
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+uint32_t Compressor::SupportedModes() {
+  return (1u << static_cast<uint32_t>(CompressMode::NONE)) |
+         (1u << static_cast<uint32_t>(CompressMode::ZSTD)) |
+         (1u << static_cast<uint32_t>(CompressMode::LZ4));
+}
+
+CompressMode Compressor::StrToMode(const std::string& mode_str) {
+  if (mode_str == "zstd") {
+    return CompressMode::ZSTD;
+  } else if (mode_str == "lz4") {
+    return CompressMode::LZ4;
+  } else if (mode_str != "none" && !mode_str.empty()) {
+    LOG(WARNING) << "unknown compress mode: " << mode_str << ", use none";
+  }
+  return CompressMode::NONE;
+}
+
+std::string Compressor::ModeToStr(CompressMode mode) {
+  switch (mode) {
+  case CompressMode::ZSTD:
+    return "zstd";
+  case CompressMode::LZ4:
+    return "lz4";
+  default:
+    return "none";
+  }
+}
+}  // namespace primihub::network
@@ -0,0 +1,71 @@
+/*
+* Copyright (c) 2023 by PrimiHub
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      https://www.apache.org/licenses/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef SRC_PRIMIHUB_UTIL_NETWORK_COMPRESSOR_H_
+#define SRC_PRIMIHUB_UTIL_NETWORK_COMPRESSOR_H_
+#include <string>
+#include <string_view>
+
+#include "src/primihub/common/common.h"
+
+namespace primihub::network {
+enum class CompressMode : uint32_t {
+  NONE = 0,
+  ZSTD = 1,
+  LZ4 = 2,
+};
+
+struct CompressOption {
+  CompressMode mode{CompressMode::NONE};
+  // compression level for zstd, ignored by lz4
+  int level{1};
+  // message smaller than threshold is sent without compression
+  size_t threshold{COMPRESS_THRESHOLD_SIZE};
+};
+
+/**
+ * payload compression used by link framing
+*/
+class Compressor {
+ public:
+  static retcode Compress(const CompressOption& option,
+                          std::string_view raw_data,
+                          std::string* compressed_data);
+  /**
+   * raw_data_len is sent by peer and is checked against
+   * max_raw_data_len and the compressed data before raw_data is allocated
+  */
+  static retcode Decompress(CompressMode mode,
+                            std::string_view compressed_data,
+                            size_t raw_data_len,
+                            std::string* raw_data,
+                            size_t max_raw_data_len =
+                                MAX_DECOMPRESSED_DATA_SIZE);
+  /**
+   * bitmask of compress mode supported by current node,
+   * bit (1 << mode) is set if mode is supported
+  */
+  static uint32_t SupportedModes();
+  static bool IsSupported(uint32_t supported_modes, CompressMode mode) {
+    return supported_modes & (1u << static_cast<uint32_t>(mode));
+  }
+  /**
+   * none, zstd, lz4
+  */
+  static CompressMode StrToMode(const std::string& mode_str);
+  static std::string ModeToStr(CompressMode mode);
+};
+}  // namespace primihub::network
+#endif  // SRC_PRIMIHUB_UTIL_NETWORK_COMPRESSOR_H_
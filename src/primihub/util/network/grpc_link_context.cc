@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <utility>
 #include <memory>
+#include <chrono>
 
 #include "src/primihub/util/util.h"
 
@@ -17,6 +18,19 @@ GrpcChannel::GrpcChannel(const primihub::Node& node, LinkContext* link_ctx) :
   stub_ = rpc::VMNode::NewStub(channel);
 }
 
+GrpcChannel::~GrpcChannel() {
+  stopSubscribe();
+  std::lock_guard<std::mutex> lck(stream_mtx_);
+  if (data_stream_ != nullptr) {
+    auto status = closeDataStream();
+    if (!status.ok()) {
+      LOG(WARNING) << "close data stream to [" << dest_node_.to_string()
+                   << "] failed. error_code: " << status.error_code() << " "
+                   << "error message: " << status.error_message();
+    }
+  }
+}
+
 std::shared_ptr<grpc::Channel> GrpcChannel::buildChannel(
     std::string& server_address,
     bool use_tls) {
@@ -39,6 +53,46 @@ std::shared_ptr<grpc::Channel> GrpcChannel::buildChannel(
   return grpc_channel_;
 }
 
+template<typename Writer>
+bool GrpcChannel::writeTaskRequest(Writer* writer,
+                                   const std::string& role,
+                                   std::string_view data_sv,
+                                   uint64_t seq_no,
+                                   CompressMode compress_mode,
+                                   uint64_t raw_data_len) {
+  size_t sended_size = 0;
+  size_t max_package_size = LIMITED_PACKAGE_SIZE;  // limit data size 4M
+  size_t total_length = data_sv.size();
+  const char* send_buf = data_sv.data();
+  auto link_ctx = this->getLinkContext();
+  // the package is reused for each slice, only data field is updated,
+  // grpc sync api has serialized the package when Write returns
+  rpc::TaskRequest task_request;
+  auto task_info = task_request.mutable_task_info();
+  task_info->set_job_id(link_ctx->job_id());
+  task_info->set_task_id(link_ctx->task_id());
+  task_info->set_request_id(link_ctx->request_id());
+  task_request.set_role(role);
+  task_request.set_data_len(total_length);
+  task_request.set_seq_no(seq_no);
+  if (compress_mode != CompressMode::NONE) {
+    task_request.set_compress_mode(static_cast<uint32_t>(compress_mode));
+    task_request.set_raw_data_len(raw_data_len);
+  }
+  do {
+    size_t data_len = std::min(max_package_size, total_length - sended_size);
+    task_request.set_data(send_buf + sended_size, data_len);
+    if (!writer->Write(task_request)) {
+      LOG(ERROR) << "write package to [" << dest_node_.to_string() << "] "
+                 << "failed, sended size: " << sended_size << " "
+                 << "total size: " << total_length;
+      return false;
+    }
+    sended_size += data_len;
+  } while (sended_size < total_length);
+  return true;
+}
+
 retcode GrpcChannel::sendRecv(const std::string& role,
     std::string_view send_data, std::string* recv_data) {
   grpc::ClientContext context;
@@ -51,17 +105,17 @@ retcode GrpcChannel::sendRecv(const std::string& role,
   using reader_writer_t =
       grpc::ClientReaderWriter<rpc::TaskRequest, rpc::TaskResponse>;
   std::shared_ptr<reader_writer_t> client_stream(stub_->SendRecv(&context));
-  std::vector<rpc::TaskRequest> send_requests;
-  buildTaskRequest(role, send_data, &send_requests);
-  for (const auto& request : send_requests) {
-    client_stream->Write(request);
-  }
+  writeTaskRequest(client_stream.get(), role, send_data);
   client_stream->WritesDone();
   // waiting for response
   rpc::TaskResponse recv_response;
+  bool init_flag{false};
   while (client_stream->Read(&recv_response)) {
-    auto data = recv_response.data();
-    recv_data->append(data);
+    if (!init_flag) {
+      recv_data->reserve(recv_response.data_len());
+      init_flag = true;
+    }
+    recv_data->append(recv_response.data());
   }
   grpc::Status status = client_stream->Finish();
   if (!status.ok()) {
@@ -104,9 +158,235 @@ retcode GrpcChannel::send(const std::string& role, const std::string& data) {
 }
 
 retcode GrpcChannel::send(const std::string& role, std::string_view data_sv) {
+  if (stream_unsupported_.load(std::memory_order::memory_order_relaxed)) {
+    return sendByRpc(role, data_sv);
+  }
+  return sendByStream(role, data_sv);
+}
+
+retcode GrpcChannel::sendByStream(const std::string& role,
+                                  std::string_view data_sv) {
+  auto send_tiemout_ms = this->getLinkContext()->sendTimeout();
+  std::lock_guard<std::mutex> lck(stream_mtx_);
+  bool handshake{false};
+  if (data_stream_ == nullptr) {
+    auto ret = initDataStream();
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "init data stream to [" << dest_node_.to_string()
+                 << "] failed";
+      return retcode::FAIL;
+    }
+    handshake = true;
+  } else {
+    bool peer_error{false};
+    {
+      std::lock_guard<std::mutex> ack_lck(ack_mtx_);
+      peer_error = stream_error_ || stream_closed_;
+    }
+    if (peer_error) {
+      LOG(ERROR) << "data stream to [" << dest_node_.to_string() << "] "
+                 << "is in abnormal status, previous message may be lost";
+      closeDataStream(true);
+      return retcode::FAIL;
+    }
+  }
+  uint64_t seq_no = ++next_seq_no_;
+  // flow control, limit the number of messages which have not been acked
+  if (seq_no > stream_window_size_) {
+    auto ret = waitForAck(seq_no - stream_window_size_, send_tiemout_ms);
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "wait for ack from [" << dest_node_.to_string()
+                 << "] failed, seq_no: " << seq_no - stream_window_size_;
+      closeDataStream(true);
+      return retcode::FAIL;
+    }
+  }
+  // the first message of stream is never compressed,
+  // since compress mode supported by peer is unknown until it is acked
+  std::string compressed_data;
+  std::string_view payload_sv = data_sv;
+  auto compress_mode = handshake ? CompressMode::NONE :
+                                   selectCompressMode(data_sv.size());
+  if (compress_mode != CompressMode::NONE) {
+    auto link_ctx = this->getLinkContext();
+    auto ret = Compressor::Compress(link_ctx->compressOption(),
+                                    data_sv, &compressed_data);
+    if (ret == retcode::SUCCESS && compressed_data.size() < data_sv.size()) {
+      payload_sv = std::string_view(compressed_data);
+    } else {
+      compress_mode = CompressMode::NONE;
+    }
+    link_ctx->AddCompressStatistics(data_sv.size(), payload_sv.size());
+  }
+  bool write_success = writeTaskRequest(data_stream_.get(), role, payload_sv,
+                                        seq_no, compress_mode, data_sv.size());
+  if (write_success && !handshake) {
+    return retcode::SUCCESS;
+  }
+  if (write_success) {
+    auto ret = waitForAck(seq_no, send_tiemout_ms);
+    if (ret == retcode::SUCCESS) {
+      return retcode::SUCCESS;
+    }
+  }
+  auto status = closeDataStream(true);
+  if (handshake && status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+    LOG(WARNING) << "[" << dest_node_.to_string() << "] "
+                 << "does not support DataStream, fallback to Send rpc";
+    stream_unsupported_.store(true);
+    return sendByRpc(role, data_sv);
+  }
+  if (handshake &&
+      status.error_code() == grpc::StatusCode::RESOURCE_EXHAUSTED) {
+    LOG(WARNING) << "[" << dest_node_.to_string() << "] "
+                 << "has too many data streams, fallback to Send rpc";
+    stream_unsupported_.store(true);
+    return sendByRpc(role, data_sv);
+  }
+  LOG(ERROR) << "send data to [" << dest_node_.to_string() << "] "
+             << "by data stream failed. error_code: " << status.error_code()
+             << " error message: " << status.error_message();
+  return retcode::FAIL;
+}
+
+retcode GrpcChannel::flush() {
+  std::lock_guard<std::mutex> lck(stream_mtx_);
+  if (data_stream_ == nullptr) {
+    return retcode::SUCCESS;
+  }
+  auto send_tiemout_ms = this->getLinkContext()->sendTimeout();
+  auto ret = waitForAck(next_seq_no_, send_tiemout_ms);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "wait for ack from [" << dest_node_.to_string()
+               << "] failed, seq_no: " << next_seq_no_;
+    closeDataStream(true);
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+CompressMode GrpcChannel::selectCompressMode(size_t data_size) {
+  const auto& option = this->getLinkContext()->compressOption();
+  if (option.mode == CompressMode::NONE || data_size < option.threshold) {
+    return CompressMode::NONE;
+  }
+  std::lock_guard<std::mutex> lck(ack_mtx_);
+  if (!Compressor::IsSupported(peer_compress_support_, option.mode)) {
+    return CompressMode::NONE;
+  }
+  return option.mode;
+}
+
+retcode GrpcChannel::initDataStream() {
+  stream_context_ = std::make_unique<grpc::ClientContext>();
+  data_stream_ = stub_->DataStream(stream_context_.get());
+  if (data_stream_ == nullptr) {
+    stream_context_.reset();
+    return retcode::FAIL;
+  }
+  next_seq_no_ = 0;
+  {
+    std::lock_guard<std::mutex> lck(ack_mtx_);
+    acked_seq_no_ = 0;
+    peer_compress_support_ = 0;
+    stream_closed_ = false;
+    stream_error_ = false;
+  }
+  stream_ack_thread_ = std::thread([this]() {
+    SET_THREAD_NAME("DataStreamAck");
+    processDataStreamAck();
+  });
+  return retcode::SUCCESS;
+}
+
+grpc::Status GrpcChannel::closeDataStream(bool cancel) {
+  if (data_stream_ == nullptr) {
+    return grpc::Status::OK;
+  }
+  if (cancel) {
+    stream_context_->TryCancel();
+  }
+  data_stream_->WritesDone();
+  {
+    // peer closes the stream once the rest messages are acked,
+    // cancel it if peer stops responding, so close never hangs
+    auto timeout_ms = this->getLinkContext()->sendTimeout();
+    if (timeout_ms <= 0) {
+      timeout_ms = DATA_STREAM_CLOSE_TIMEOUT_MS;
+    }
+    std::unique_lock<std::mutex> lck(ack_mtx_);
+    bool closed = ack_cv_.wait_for(lck, std::chrono::milliseconds(timeout_ms),
+                                   [&]() { return stream_closed_; });
+    if (!closed) {
+      LOG(WARNING) << "[" << dest_node_.to_string() << "] "
+                   << "does not close data stream in " << timeout_ms << "ms, "
+                   << "cancel it";
+      stream_context_->TryCancel();
+    }
+  }
+  if (stream_ack_thread_.joinable()) {
+    stream_ack_thread_.join();
+  }
+  auto status = data_stream_->Finish();
+  data_stream_.reset();
+  stream_context_.reset();
+  {
+    std::lock_guard<std::mutex> lck(ack_mtx_);
+    if (!status.ok() || stream_error_) {
+      // all messages have not been acked are regarded as lost
+      if (acked_seq_no_ < next_seq_no_) {
+        LOG(ERROR) << "messages from seq_no: " << acked_seq_no_ + 1 << " "
+                   << "to seq_no: " << next_seq_no_ << " "
+                   << "have not been acked by [" << dest_node_.to_string()
+                   << "]";
+      }
+    }
+  }
+  return status;
+}
+
+void GrpcChannel::processDataStreamAck() {
+  rpc::TaskResponse ack;
+  while (data_stream_->Read(&ack)) {
+    std::lock_guard<std::mutex> lck(ack_mtx_);
+    if (ack.ret_code() != rpc::retcode::SUCCESS) {
+      LOG(ERROR) << "[" << dest_node_.to_string() << "] "
+                 << "process message failed, seq_no: " << ack.seq_no() << " "
+                 << "error message: " << ack.msg_info();
+      stream_error_ = true;
+    }
+    acked_seq_no_ = ack.seq_no();
+    peer_compress_support_ = ack.compress_support();
+    ack_cv_.notify_all();
+  }
+  std::lock_guard<std::mutex> lck(ack_mtx_);
+  stream_closed_ = true;
+  ack_cv_.notify_all();
+}
+
+retcode GrpcChannel::waitForAck(uint64_t seq_no, int32_t timeout_ms) {
+  std::unique_lock<std::mutex> lck(ack_mtx_);
+  auto acked = [&]() {
+    return acked_seq_no_ >= seq_no || stream_closed_ || stream_error_;
+  };
+  if (timeout_ms > 0) {
+    auto timeout = std::chrono::milliseconds(timeout_ms);
+    if (!ack_cv_.wait_for(lck, timeout, acked)) {
+      LOG(ERROR) << "wait for ack timeout(ms): " << timeout_ms;
+      return retcode::FAIL;
+    }
+  } else {
+    ack_cv_.wait(lck, acked);
+  }
+  if (stream_error_ || acked_seq_no_ < seq_no) {
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+retcode GrpcChannel::sendByRpc(const std::string& role,
+                               std::string_view data_sv) {
   // VLOG(5) << "GrpcChannel::send begin to send, use key: " << role;
-  std::vector<rpc::TaskRequest> send_requests;
-  buildTaskRequest(role, data_sv, &send_requests);
   auto send_tiemout_ms = this->getLinkContext()->sendTimeout();
   int retry_time{0};
   do {
@@ -119,16 +399,15 @@ retcode GrpcChannel::send(const std::string& role, std::string_view data_sv) {
     rpc::TaskResponse task_response;
     using writer_t = grpc::ClientWriter<rpc::TaskRequest>;
     std::unique_ptr<writer_t> writer(stub_->Send(&context, &task_response));
-    for (const auto& request : send_requests) {
-      writer->Write(request);
-    }
+    writeTaskRequest(writer.get(), role, data_sv);
     writer->WritesDone();
     grpc::Status status = writer->Finish();
     if (status.ok()) {
       auto ret_code = task_response.ret_code();
       if (ret_code) {
           LOG(ERROR) << "send data to [" << dest_node_.to_string()
-            << "] return failed error code: " << ret_code;
+            << "] return failed error code: " << ret_code << " "
+            << "error message: " << task_response.msg_info();
           return retcode::FAIL;
       }
       break;
@@ -152,50 +431,6 @@ retcode GrpcChannel::send(const std::string& role, std::string_view data_sv) {
   return retcode::SUCCESS;
 }
 
-retcode GrpcChannel::buildTaskRequest(const std::string& role,
-    const std::string& data, std::vector<rpc::TaskRequest>* send_pb_data) {
-  std::string_view data_sv(data.c_str(), data.length());
-  return buildTaskRequest(role, data_sv, send_pb_data);
-}
-
-retcode GrpcChannel::buildTaskRequest(const std::string& role,
-    std::string_view data_sv, std::vector<rpc::TaskRequest>* send_pb_data) {
-  size_t sended_size = 0;
-  size_t max_package_size = LIMITED_PACKAGE_SIZE;  // limit data size 4M
-  size_t total_length = data_sv.size();
-  char* send_buf = const_cast<char*>(data_sv.data());
-  std::string job_id = this->getLinkContext()->job_id();
-  std::string task_id = this->getLinkContext()->task_id();
-  std::string request_id = this->getLinkContext()->request_id();
-  // VLOG(5) << "job_id: " << job_id << " "
-  //     << "task_id: " << task_id << " "
-  //     << "request id: " << request_id << " "
-  //     << "key: " << role << " "
-  //     << "send data length: " << total_length;
-  do {
-    rpc::TaskRequest task_request;
-    auto task_info = task_request.mutable_task_info();
-    task_info->set_job_id(job_id);
-    task_info->set_task_id(task_id);
-    task_info->set_request_id(request_id);
-    task_request.set_role(role);
-    task_request.set_data_len(total_length);
-    auto data_ptr = task_request.mutable_data();
-    data_ptr->reserve(max_package_size);
-    size_t data_len = std::min(max_package_size, total_length - sended_size);
-    data_ptr->append(send_buf + sended_size, data_len);
-    sended_size += data_len;
-    // VLOG(5) << "sended_size: " << sended_size << " data_len: " << data_len;
-    send_pb_data->emplace_back(std::move(task_request));
-    if (sended_size < total_length) {
-      continue;
-    } else {
-      break;
-    }
-  } while (true);
-  return retcode::SUCCESS;
-}
-
 std::string GrpcChannel::forwardRecv(const std::string& role) {
   SCopedTimer timer;
   grpc::ClientContext context;
@@ -225,9 +460,15 @@ std::string GrpcChannel::forwardRecv(const std::string& role) {
   rpc::TaskRequest recv_response;
   bool init_flag{false};
   while (client_reader->Read(&recv_response)) {
-    auto data = recv_response.data();
+    const auto& data = recv_response.data();
     if (!init_flag) {
       size_t data_len = recv_response.data_len();
+      if (data.size() == data_len) {
+        // the whole message is in one package, take over it directly
+        tmp_buff.swap(*recv_response.mutable_data());
+        init_flag = true;
+        continue;
+      }
       tmp_buff.reserve(data_len);
       init_flag = true;
     }
@@ -247,6 +488,112 @@ std::string GrpcChannel::forwardRecv(const std::string& role) {
   return tmp_buff;
 }
 
+retcode GrpcChannel::subscribeRecv(const std::string& role) {
+  if (subscribe_unsupported_.load(std::memory_order_relaxed)) {
+    return retcode::FAIL;
+  }
+  std::lock_guard<std::mutex> lck(subscribe_mtx_);
+  if (subscriptions_.find(role) != subscriptions_.end()) {
+    return retcode::SUCCESS;
+  }
+  rpc::TaskRequest request;
+  auto task_info = request.mutable_task_info();
+  task_info->set_task_id(this->getLinkContext()->task_id());
+  task_info->set_job_id(this->getLinkContext()->job_id());
+  task_info->set_request_id(this->getLinkContext()->request_id());
+  request.set_role(role);
+  auto sub = std::make_unique<Subscription>();
+  sub->context = std::make_unique<grpc::ClientContext>();
+  sub->reader = stub_->SubscribeRecv(sub->context.get(), request);
+  // wait for confirmation frame, old proxy node returns UNIMPLEMENTED
+  rpc::TaskRequest confirm;
+  if (!sub->reader->Read(&confirm)) {
+    auto status = sub->reader->Finish();
+    if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+      subscribe_unsupported_.store(true);
+      LOG(WARNING) << "[" << dest_node_.to_string() << "] "
+                   << "does not support SubscribeRecv, "
+                   << "fallback to ForwardRecv";
+    } else if (status.error_code() == grpc::StatusCode::RESOURCE_EXHAUSTED) {
+      // proxy node is serving too many subscriptions, only this key
+      // falls back, later keys may subscribe again
+      LOG(WARNING) << "[" << dest_node_.to_string() << "] "
+                   << "rejects subscription of key: " << role << ", "
+                   << status.error_message();
+    } else {
+      LOG(ERROR) << "subscribe key: " << role << " from ["
+                 << dest_node_.to_string() << "] failed. error_code: "
+                 << status.error_code() << " "
+                 << "error message: " << status.error_message();
+    }
+    return retcode::FAIL;
+  }
+  auto sub_ptr = sub.get();
+  sub->recv_thread = std::thread([this, role, sub_ptr]() {
+    SET_THREAD_NAME("SubscribeRecv");
+    processSubscription(role, sub_ptr);
+  });
+  subscriptions_[role] = std::move(sub);
+  VLOG(5) << "subscribe key: " << role << " from ["
+          << dest_node_.to_string() << "] success";
+  return retcode::SUCCESS;
+}
+
+void GrpcChannel::processSubscription(const std::string& role,
+                                      Subscription* sub) {
+  auto& recv_queue = this->getLinkContext()->GetRecvQueue(role);
+  std::string data_buffer;
+  uint64_t data_len{0};
+  bool recv_meta_info{false};
+  rpc::TaskRequest package;
+  while (sub->reader->Read(&package)) {
+    if (!recv_meta_info) {
+      data_len = package.data_len();
+      recv_meta_info = true;
+      if (package.data().size() == data_len) {
+        // the whole message is in one package, take over it directly
+        data_buffer.swap(*package.mutable_data());
+      } else {
+        data_buffer.reserve(data_len);
+        data_buffer.append(package.data());
+      }
+    } else {
+      data_buffer.append(package.data());
+    }
+    if (data_buffer.size() < data_len) {
+      continue;
+    }
+    recv_queue.push(std::move(data_buffer));
+    data_buffer = std::string();
+    recv_meta_info = false;
+  }
+  auto status = sub->reader->Finish();
+  if (!status.ok() && status.error_code() != grpc::StatusCode::CANCELLED) {
+    LOG(ERROR) << "subscription of key: " << role << " from ["
+               << dest_node_.to_string() << "] broken. error_code: "
+               << status.error_code() << " "
+               << "error message: " << status.error_message();
+    // wake up receivers instead of blocking them forever
+    recv_queue.shutdown();
+  }
+}
+
+void GrpcChannel::stopSubscribe() {
+  std::unordered_map<std::string, std::unique_ptr<Subscription>> subs;
+  {
+    std::lock_guard<std::mutex> lck(subscribe_mtx_);
+    subs.swap(subscriptions_);
+  }
+  for (auto& [role, sub] : subs) {
+    sub->context->TryCancel();
+  }
+  for (auto& [role, sub] : subs) {
+    if (sub->recv_thread.joinable()) {
+      sub->recv_thread.join();
+    }
+  }
+}
+
 retcode GrpcChannel::submitTask(const rpc::PushTaskRequest& request,
                                 rpc::PushTaskReply* reply) {
   int retry_time{0};
@@ -441,6 +788,37 @@ retcode GrpcChannel::fetchTaskStatus(const rpc::TaskContext& request,
   return retcode::SUCCESS;
 }
 
+GrpcLinkContext::~GrpcLinkContext() {
+  {
+    // subscriptions push data into recv queues which are destroyed
+    // before connection_mgr, stop them first
+    std::shared_lock<std::shared_mutex> lck(this->connection_mgr_mtx);
+    for (auto& [node_info, channel] : connection_mgr) {
+      std::static_pointer_cast<GrpcChannel>(channel)->stopSubscribe();
+    }
+  }
+  auto coalesced_messages = coalescedMessages();
+  if (coalesced_messages > 0) {
+    auto coalesced_frames = coalescedFrames();
+    LOG(INFO) << "request id: " << request_id() << " "
+              << "coalesced messages: " << coalesced_messages << " "
+              << "frames: " << coalesced_frames << " "
+              << "saved frames: " << coalesced_messages - coalesced_frames;
+  }
+  auto raw_bytes = rawSendBytes();
+  if (raw_bytes == 0) {
+    return;
+  }
+  auto compressed_bytes = compressedSendBytes();
+  LOG(INFO) << "request id: " << request_id() << " "
+            << "compress mode: "
+            << Compressor::ModeToStr(compressOption().mode) << " "
+            << "bytes before compression: " << raw_bytes << " "
+            << "bytes after compression: " << compressed_bytes << " "
+            << "saved bytes: " << static_cast<int64_t>(raw_bytes) -
+                                  static_cast<int64_t>(compressed_bytes);
+}
+
 std::shared_ptr<IChannel> GrpcLinkContext::buildChannel(
     const primihub::Node& node,
     LinkContext* link_ctx) {
@@ -10,8 +10,13 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include "src/primihub/util/network/link_context.h"
+#include "src/primihub/util/network/compressor.h"
 #include "src/primihub/common/common.h"
 #include "src/primihub/protos/worker.grpc.pb.h"
 
@@ -19,8 +24,11 @@ namespace primihub::network {
 namespace rpc = primihub::rpc;
 class GrpcChannel : public IChannel {
  public:
+  using data_stream_t =
+      grpc::ClientReaderWriter<rpc::TaskRequest, rpc::TaskResponse>;
+  using subscribe_reader_t = grpc::ClientReader<rpc::TaskRequest>;
   GrpcChannel(const primihub::Node& node, LinkContext* link_ctx);
-  virtual ~GrpcChannel() = default;
+  virtual ~GrpcChannel();
   retcode send(const std::string& role, const std::string& data) override;
   retcode send(const std::string& role, std::string_view sv_data) override;
   bool send_wrapper(const std::string& role, const std::string& data) override;
@@ -44,26 +52,99 @@ class GrpcChannel : public IChannel {
   retcode fetchTaskStatus(const rpc::TaskContext& request,
                           rpc::TaskStatusReply* reply) override;
   std::string forwardRecv(const std::string& role) override;
-  retcode buildTaskRequest(const std::string& role,
-                           const std::string& data,
-                           std::vector<rpc::TaskRequest>* send_pb_data);
-  retcode buildTaskRequest(const std::string& role,
-                           std::string_view sv_data,
-                           std::vector<rpc::TaskRequest>* send_pb_data);
+  retcode subscribeRecv(const std::string& role) override;
+  retcode flush() override;
+  /**
+   * cancel all subscriptions and wait until their threads exit
+  */
+  void stopSubscribe();
   std::shared_ptr<grpc::Channel> buildChannel(std::string& server_addr,
                                               bool use_tls);
 
+ protected:
+  /**
+   * send data through the long-lived DataStream to dest node,
+   * each message costs one or more frames on the stream instead of one rpc.
+   * the first message of a stream is sent synchronously to make sure
+   * the peer supports DataStream, otherwise fallback to Send rpc.
+   * other messages return once written, up to stream_window_size_ of them
+   * may be unacked, their failure is reported by a later send or flush
+  */
+  retcode sendByStream(const std::string& role, std::string_view sv_data);
+  /**
+   * send data by one Send rpc for each message
+  */
+  retcode sendByRpc(const std::string& role, std::string_view sv_data);
+  /**
+   * slice data into packages no larger than LIMITED_PACKAGE_SIZE lazily
+   * and write each package as soon as it is built,
+   * so no extra copy of the whole data is made before sending
+  */
+  template<typename Writer>
+  bool writeTaskRequest(Writer* writer,
+                        const std::string& role,
+                        std::string_view sv_data,
+                        uint64_t seq_no = 0,
+                        CompressMode compress_mode = CompressMode::NONE,
+                        uint64_t raw_data_len = 0);
+  /**
+   * compress mode used for data with size of data_size,
+   * NONE if compression is disabled, data is too small
+   * or peer does not support the configured mode
+  */
+  CompressMode selectCompressMode(size_t data_size);
+  retcode initDataStream();
+  /**
+   * close stream and wait until all messages on the fly have been acked,
+   * cancel the stream directly if it is in abnormal status,
+   * or if peer does not close it within the send timeout,
+   * DATA_STREAM_CLOSE_TIMEOUT_MS when no send timeout is set
+  */
+  grpc::Status closeDataStream(bool cancel = false);
+  void processDataStreamAck();
+  /**
+   * wait until message with sequence number seq_no has been acked by peer
+  */
+  retcode waitForAck(uint64_t seq_no, int32_t timeout_ms);
+  struct Subscription {
+    std::unique_ptr<grpc::ClientContext> context{nullptr};
+    std::unique_ptr<subscribe_reader_t> reader{nullptr};
+    std::thread recv_thread;
+  };
+  /**
+   * read data pushed by proxy node and deliver it into recv queue of key
+  */
+  void processSubscription(const std::string& role, Subscription* sub);
+
  private:
   std::unique_ptr<rpc::VMNode::Stub> stub_{nullptr};
   std::shared_ptr<grpc::Channel> grpc_channel_{nullptr};
   primihub::Node dest_node_;
   int retry_max_times_{3};
+  // data stream related
+  std::mutex stream_mtx_;   // protect stream creation and write
+  std::unique_ptr<grpc::ClientContext> stream_context_{nullptr};
+  std::unique_ptr<data_stream_t> data_stream_{nullptr};
+  std::thread stream_ack_thread_;
+  uint64_t next_seq_no_{0};
+  uint64_t stream_window_size_{DATA_STREAM_WINDOW_SIZE};
+  std::atomic<bool> stream_unsupported_{false};
+  std::mutex ack_mtx_;
+  std::condition_variable ack_cv_;
+  uint64_t acked_seq_no_{0};
+  uint32_t peer_compress_support_{0};
+  bool stream_closed_{false};
+  bool stream_error_{false};
+  // subscription related, key: role
+  std::mutex subscribe_mtx_;
+  std::unordered_map<std::string, std::unique_ptr<Subscription>> subscriptions_;
+  std::atomic<bool> subscribe_unsupported_{false};
 };
 
 class GrpcLinkContext : public LinkContext {
  public:
   GrpcLinkContext() = default;
-  virtual ~GrpcLinkContext() = default;
+  virtual ~GrpcLinkContext();
   std::shared_ptr<IChannel> buildChannel(const primihub::Node& node,
                                          LinkContext* link_ctx);
   std::shared_ptr<IChannel> getChannel(const primihub::Node& node) override;
@@ -80,6 +80,19 @@ LinkContext::StatusDataQueue& LinkContext::GetCompleteQueue(
   }
 }
 
+retcode LinkContext::Flush() {
+  auto ret{retcode::SUCCESS};
+  std::shared_lock<std::shared_mutex> lck(this->connection_mgr_mtx);
+  for (auto& [node_info, channel] : connection_mgr) {
+    if (channel->flush() != retcode::SUCCESS) {
+      LOG(ERROR) << "data sent to [" << node_info << "] "
+                 << "has not been delivered completely";
+      ret = retcode::FAIL;
+    }
+  }
+  return ret;
+}
+
 retcode LinkContext::Send(const std::string& key,
                           const Node& dest_node,
                           const std::string& send_buf) {
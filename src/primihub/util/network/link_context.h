@@ -11,10 +11,19 @@
 #include "src/primihub/common/config/config.h"
 #include "src/primihub/protos/worker.pb.h"
 #include "src/primihub/util/threadsafe_queue.h"
+#include "src/primihub/util/lockfree_queue.h"
+#include "src/primihub/util/network/compressor.h"
+#include "src/primihub/util/network/message_coalescer.h"
 
 namespace primihub::network {
 namespace rpc = primihub::rpc;
 class IChannel;
+enum class LinkMode {
+    GRPC = 0,
+    RAW_SOCKET,
+    // control by grpc, data between co-located parties by shared memory
+    SHARED_MEMORY,
+};
 /**
  * link connection manager
  * manage channel create by node info
@@ -23,7 +32,8 @@ class IChannel;
 */
 class LinkContext {
  public:
-  using StringDataQueue = primihub::ThreadSafeQueue<std::string>;
+  // data path between grpc service and channels
+  using StringDataQueue = primihub::LockFreeQueue<std::string>;
   using StringDataContainer = std::unordered_map<std::string, StringDataQueue>;
   using StatusDataQueue = primihub::ThreadSafeQueue<retcode>;
   using StatusDataContainer = std::unordered_map<std::string, StatusDataQueue>;
@@ -59,6 +69,7 @@ class LinkContext {
    * if channel is not exist, create
   */
   virtual std::shared_ptr<IChannel> getChannel(const primihub::Node& node) = 0;
+  virtual LinkMode linkMode() const {return LinkMode::GRPC;}
   inline void setRecvTimeout(const int32_t recv_timeout_ms) {
     recv_timeout_ms_ = recv_timeout_ms;
   }
@@ -67,6 +78,50 @@ class LinkContext {
   }
   int32_t sendTimeout() const {return send_timeout_ms_;}
   int32_t recvTimeout() const {return recv_timeout_ms_;}
+  /**
+   * payload compression for data sent by this link,
+   * it takes effect only when peer supports the compress mode
+  */
+  inline void setCompressOption(const CompressOption& option) {
+    compress_option_ = option;
+  }
+  const CompressOption& compressOption() const {return compress_option_;}
+  /**
+   * statistics of bytes before and after compression for sent data
+  */
+  void AddCompressStatistics(size_t raw_size, size_t compressed_size) {
+    raw_send_bytes_.fetch_add(raw_size, std::memory_order_relaxed);
+    compressed_send_bytes_.fetch_add(compressed_size,
+                                     std::memory_order_relaxed);
+  }
+  uint64_t rawSendBytes() const {
+    return raw_send_bytes_.load(std::memory_order_relaxed);
+  }
+  uint64_t compressedSendBytes() const {
+    return compressed_send_bytes_.load(std::memory_order_relaxed);
+  }
+  /**
+   * packing of small messages sent by mpc channels of this link,
+   * peer must use the same option
+  */
+  inline void setCoalesceOption(const CoalesceOption& option) {
+    coalesce_option_ = option;
+  }
+  const CoalesceOption& coalesceOption() const {return coalesce_option_;}
+  /**
+   * statistics of messages and frames sent by coalescers,
+   * frames saved by coalescing is messages - frames
+  */
+  void AddCoalesceStatistics(size_t messages, size_t frames) {
+    coalesced_messages_.fetch_add(messages, std::memory_order_relaxed);
+    coalesced_frames_.fetch_add(frames, std::memory_order_relaxed);
+  }
+  uint64_t coalescedMessages() const {
+    return coalesced_messages_.load(std::memory_order_relaxed);
+  }
+  uint64_t coalescedFrames() const {
+    return coalesced_frames_.load(std::memory_order_relaxed);
+  }
   primihub::common::CertificateConfig& getCertificateConfig() {
     return *cert_config_;
   }
@@ -122,6 +177,12 @@ class LinkContext {
   retcode SendRecv(const std::string& key,
                    const std::string& send_buf,
                    std::string* recv_buf);
+  /**
+   * wait until data sent by all channels has been delivered to peers,
+   * Send may return before delivery, so the task must call it after
+   * its last send and fail if it returns FAIL
+  */
+  retcode Flush();
 
 
  protected:
@@ -147,6 +208,14 @@ class LinkContext {
   std::mutex complete_queue_mtx;
   StatusDataContainer complete_queue;
   std::atomic<bool> stop_{false};
+  CompressOption compress_option_;
+  // bytes of data sent by compressed message, before and after compression
+  std::atomic<uint64_t> raw_send_bytes_{0};
+  std::atomic<uint64_t> compressed_send_bytes_{0};
+  CoalesceOption coalesce_option_;
+  // messages sent by coalescers and frames they are packed into
+  std::atomic<uint64_t> coalesced_messages_{0};
+  std::atomic<uint64_t> coalesced_frames_{0};
 };
 
 class IChannel {
@@ -179,6 +248,17 @@ class IChannel {
   virtual retcode StopTask(const rpc::TaskContext& request,
                            rpc::Empty* reply) = 0;
   virtual std::string forwardRecv(const std::string& key) = 0;
+  /**
+   * subscribe data of key from proxy node, data is pushed into
+   * recv queue of link context as soon as it arrives,
+   * return FAIL if subscription is not supported by proxy node
+  */
+  virtual retcode subscribeRecv(const std::string& key) = 0;
+  /**
+   * wait until all data sent by this channel has been acked by peer,
+   * channel which sends synchronously has nothing to wait for
+  */
+  virtual retcode flush() {return retcode::SUCCESS;}
   LinkContext* getLinkContext() { return link_ctx_; }
 
  protected:
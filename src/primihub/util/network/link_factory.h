@@ -19,19 +19,17 @@
 #include <memory>
 #include "src/primihub/util/network/link_context.h"
 #include "src/primihub/util/network/grpc_link_context.h"
+#include "src/primihub/util/network/shm_link_context.h"
 
 namespace primihub::network {
-enum class LinkMode {
-    GRPC = 0,
-    RAW_SOCKET,
-};
-
 class LinkFactory {
  public:
   static std::unique_ptr<LinkContext> createLinkContext(
       LinkMode mode = LinkMode::GRPC) {
     if (mode == LinkMode::GRPC) {
       return std::make_unique<GrpcLinkContext>();
+    } else if (mode == LinkMode::SHARED_MEMORY) {
+      return std::make_unique<ShmLinkContext>();
     } else {
       LOG(ERROR) << "Unimplement Mode: " << static_cast<int>(mode);
     }
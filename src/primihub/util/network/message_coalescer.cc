@@ -0,0 +1,449 @@
+/*
+* Copyright (c) 2023 by PrimiHub
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      https://www.apache.org/licenses/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include "src/primihub/util/network/message_coalescer.h"
+#include <glog/logging.h>
+#include <arpa/inet.h>
+#include <cstring>
+#include <utility>
+
+#include "src/primihub/util/endian_util.h"
+#include "src/primihub/util/network/link_context.h"
+
+namespace primihub::network {
+namespace {
+void BuildFrame(const std::vector<uint64_t>& sizes,
+                std::string_view data,
+                std::string* frame) {
+  uint32_t count = sizes.size();
+  size_t header_size = sizeof(count) + sizeof(uint64_t) * count;
+  frame->resize(header_size + data.size());
+  char* ptr = frame->data();
+  uint32_t be_count = htonl(count);
+  memcpy(ptr, &be_count, sizeof(be_count));
+  ptr += sizeof(be_count);
+  for (const auto size : sizes) {
+    uint64_t be_size = htonll(size);
+    memcpy(ptr, &be_size, sizeof(be_size));
+    ptr += sizeof(be_size);
+  }
+  memcpy(ptr, data.data(), data.size());
+}
+
+/**
+ * return true if frame is the header of a message sent directly
+*/
+bool ParseDirectHeader(std::string_view frame, uint64_t* size) {
+  uint32_t be_count{0};
+  uint64_t be_size{0};
+  if (frame.size() != sizeof(be_count) + sizeof(be_size)) {
+    return false;
+  }
+  memcpy(&be_count, frame.data(), sizeof(be_count));
+  if (ntohl(be_count) != MessageCoalescer::kDirectMessageMark) {
+    return false;
+  }
+  memcpy(&be_size, frame.data() + sizeof(be_count), sizeof(be_size));
+  *size = ntohll(be_size);
+  return true;
+}
+}  // namespace
+
+MessageCoalescer::MessageCoalescer(const CoalesceOption& option,
+                                   SendFunc send_fn,
+                                   LinkContext* link_ctx)
+    : option_(option), send_fn_(std::move(send_fn)), link_ctx_(link_ctx) {}
+
+MessageCoalescer::~MessageCoalescer() {
+  if (option_.max_delay_us > 0) {
+    CoalesceTimer::getInstance().Cancel(this);
+  }
+  auto ret = Flush();
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "send pending frame failed when coalescer is destroyed";
+  }
+}
+
+retcode MessageCoalescer::Send(std::string_view message) {
+  std::lock_guard<std::mutex> lck(mtx_);
+  auto ret = AppendLocked(message);
+  if (ret == retcode::SUCCESS && option_.max_delay_us <= 0) {
+    ret = FlushLocked();
+  }
+  return ret;
+}
+
+retcode MessageCoalescer::Send(const std::vector<std::string_view>& messages) {
+  std::lock_guard<std::mutex> lck(mtx_);
+  for (const auto& message : messages) {
+    auto ret = AppendLocked(message);
+    if (ret != retcode::SUCCESS) {
+      return ret;
+    }
+  }
+  if (option_.max_delay_us <= 0) {
+    return FlushLocked();
+  }
+  return retcode::SUCCESS;
+}
+
+retcode MessageCoalescer::Flush() {
+  std::lock_guard<std::mutex> lck(mtx_);
+  return FlushLocked();
+}
+
+retcode MessageCoalescer::NegotiateLocked() {
+  auto ret{retcode::SUCCESS};
+  if (!hello_sent_) {
+    ret = send_fn_(kHelloMessage);
+    hello_sent_ = true;
+  }
+  if (ret == retcode::SUCCESS &&
+      peer_supported_.load(std::memory_order_acquire)) {
+    // messages after it are in frames
+    ret = send_fn_(kSwitchMessage);
+    framing_ = true;
+  }
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "send coalesce negotiation message failed";
+    last_error_ = ret;
+  }
+  return ret;
+}
+
+retcode MessageCoalescer::AppendLocked(std::string_view message) {
+  if (last_error_ != retcode::SUCCESS) {
+    return last_error_;
+  }
+  if (!framing_) {
+    auto ret = NegotiateLocked();
+    if (ret != retcode::SUCCESS) {
+      return ret;
+    }
+    if (!framing_) {
+      // peer is not known to split frames
+      ret = send_fn_(message);
+      if (ret != retcode::SUCCESS) {
+        LOG(ERROR) << "send message of size: " << message.size() << " failed";
+        last_error_ = ret;
+      }
+      return ret;
+    }
+  }
+  if (message.size() >= option_.max_frame_size) {
+    return SendDirectLocked(message);
+  }
+  if (!pending_sizes_.empty() &&
+      pending_data_.size() + message.size() > option_.max_frame_size) {
+    auto ret = FlushLocked();
+    if (ret != retcode::SUCCESS) {
+      return ret;
+    }
+  }
+  if (pending_sizes_.empty()) {
+    first_pending_time_ = std::chrono::steady_clock::now();
+    if (option_.max_delay_us > 0) {
+      CoalesceTimer::getInstance().Schedule(this,
+          first_pending_time_ + std::chrono::microseconds(option_.max_delay_us));
+    }
+  }
+  pending_data_.append(message.data(), message.size());
+  pending_sizes_.push_back(message.size());
+  if (pending_data_.size() >= option_.max_frame_size) {
+    return FlushLocked();
+  }
+  return retcode::SUCCESS;
+}
+
+retcode MessageCoalescer::FlushLocked() {
+  if (last_error_ != retcode::SUCCESS) {
+    return last_error_;
+  }
+  if (pending_sizes_.empty()) {
+    return retcode::SUCCESS;
+  }
+  std::string frame;
+  BuildFrame(pending_sizes_, pending_data_, &frame);
+  size_t count = pending_sizes_.size();
+  pending_sizes_.clear();
+  pending_data_.clear();
+  auto ret = send_fn_(frame);
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "send frame of " << count << " messages failed";
+    last_error_ = ret;
+    return ret;
+  }
+  messages_.fetch_add(count, std::memory_order_relaxed);
+  frames_.fetch_add(1, std::memory_order_relaxed);
+  if (link_ctx_ != nullptr) {
+    link_ctx_->AddCoalesceStatistics(count, 1);
+  }
+  return retcode::SUCCESS;
+}
+
+retcode MessageCoalescer::SendDirectLocked(std::string_view message) {
+  auto ret = FlushLocked();
+  if (ret != retcode::SUCCESS) {
+    return ret;
+  }
+  uint32_t be_mark = htonl(kDirectMessageMark);
+  uint64_t be_size = htonll(message.size());
+  char header[sizeof(be_mark) + sizeof(be_size)];
+  memcpy(header, &be_mark, sizeof(be_mark));
+  memcpy(header + sizeof(be_mark), &be_size, sizeof(be_size));
+  ret = send_fn_(std::string_view(header, sizeof(header)));
+  if (ret == retcode::SUCCESS) {
+    ret = send_fn_(message);
+  }
+  if (ret != retcode::SUCCESS) {
+    LOG(ERROR) << "send message of size: " << message.size() << " failed";
+    last_error_ = ret;
+  }
+  return ret;
+}
+
+void MessageCoalescer::OnTimer() {
+  std::lock_guard<std::mutex> lck(mtx_);
+  if (pending_sizes_.empty()) {
+    return;
+  }
+  auto deadline =
+      first_pending_time_ + std::chrono::microseconds(option_.max_delay_us);
+  if (std::chrono::steady_clock::now() < deadline) {
+    CoalesceTimer::getInstance().Schedule(this, deadline);
+    return;
+  }
+  // error is kept in last_error_ and returned to next sender
+  FlushLocked();
+}
+
+CoalesceTimer::CoalesceTimer() {
+  thread_ = std::thread([this]() { Run(); });
+}
+
+CoalesceTimer::~CoalesceTimer() {
+  {
+    std::lock_guard<std::mutex> lck(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void CoalesceTimer::Schedule(MessageCoalescer* coalescer,
+                             std::chrono::steady_clock::time_point deadline) {
+  std::lock_guard<std::mutex> lck(mtx_);
+  auto it = index_.find(coalescer);
+  if (it != index_.end()) {
+    timers_.erase(it->second);
+  }
+  index_[coalescer] = timers_.emplace(deadline, coalescer);
+  // timer thread sleeps until the earliest deadline
+  if (timers_.begin()->second == coalescer) {
+    cv_.notify_one();
+  }
+}
+
+void CoalesceTimer::Cancel(MessageCoalescer* coalescer) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  // running OnTimer may schedule coalescer again, remove it after that
+  done_cv_.wait(lck, [&]() { return running_ != coalescer; });
+  auto it = index_.find(coalescer);
+  if (it != index_.end()) {
+    timers_.erase(it->second);
+    index_.erase(it);
+  }
+}
+
+void CoalesceTimer::Run() {
+  std::unique_lock<std::mutex> lck(mtx_);
+  while (!stop_) {
+    if (timers_.empty()) {
+      cv_.wait(lck);
+      continue;
+    }
+    auto first = timers_.begin();
+    if (std::chrono::steady_clock::now() < first->first) {
+      cv_.wait_until(lck, first->first);
+      continue;
+    }
+    auto coalescer = first->second;
+    timers_.erase(first);
+    index_.erase(coalescer);
+    running_ = coalescer;
+    // coalescer may schedule itself again, so lock is released
+    lck.unlock();
+    coalescer->OnTimer();
+    lck.lock();
+    running_ = nullptr;
+    done_cv_.notify_all();
+  }
+}
+
+void MessageCoalescer::Encode(const std::vector<std::string_view>& messages,
+                              std::string* frame) {
+  std::vector<uint64_t> sizes;
+  std::string data;
+  for (const auto& message : messages) {
+    sizes.push_back(message.size());
+    data.append(message.data(), message.size());
+  }
+  BuildFrame(sizes, data, frame);
+}
+
+retcode MessageCoalescer::Decode(std::string_view frame,
+                                 std::deque<std::string>* messages) {
+  std::deque<std::string_view> views;
+  auto ret = DecodeView(frame, &views);
+  if (ret != retcode::SUCCESS) {
+    return ret;
+  }
+  for (const auto& view : views) {
+    messages->emplace_back(view);
+  }
+  return retcode::SUCCESS;
+}
+
+retcode MessageCoalescer::DecodeView(std::string_view frame,
+                                     std::deque<std::string_view>* messages) {
+  uint32_t count{0};
+  if (frame.size() < sizeof(count)) {
+    LOG(ERROR) << "frame is too short: " << frame.size();
+    return retcode::FAIL;
+  }
+  memcpy(&count, frame.data(), sizeof(count));
+  count = ntohl(count);
+  if (count == kDirectMessageMark) {
+    LOG(ERROR) << "header of direct message can not be decoded as frame";
+    return retcode::FAIL;
+  }
+  size_t offset = sizeof(count);
+  size_t header_size = offset + sizeof(uint64_t) * count;
+  if (frame.size() < header_size) {
+    LOG(ERROR) << "frame size: " << frame.size() << " "
+               << "is less than header of " << count << " messages";
+    return retcode::FAIL;
+  }
+  std::vector<uint64_t> sizes(count);
+  memcpy(sizes.data(), frame.data() + offset, sizeof(uint64_t) * count);
+  for (auto& size : sizes) {
+    size = ntohll(size);
+  }
+  offset = header_size;
+  for (const auto size : sizes) {
+    if (size > frame.size() - offset) {
+      LOG(ERROR) << "message size: " << size << " exceeds frame size: "
+                 << frame.size() << " at offset: " << offset;
+      return retcode::FAIL;
+    }
+    messages->emplace_back(frame.substr(offset, size));
+    offset += size;
+  }
+  if (offset != frame.size()) {
+    LOG(ERROR) << "frame has " << frame.size() - offset << " trailing bytes";
+    return retcode::FAIL;
+  }
+  return retcode::SUCCESS;
+}
+
+retcode FrameSplitter::Recv(const RecvFunc& recv_fn, std::string* message) {
+  bool is_direct{false};
+  std::string_view view;
+  auto ret = Next(recv_fn, message, &is_direct, &view);
+  if (ret != retcode::SUCCESS) {
+    return ret;
+  }
+  if (!is_direct) {
+    message->assign(view.data(), view.size());
+  }
+  return retcode::SUCCESS;
+}
+
+retcode FrameSplitter::Recv(const RecvFunc& recv_fn, char* buf, size_t size) {
+  std::string direct;
+  bool is_direct{false};
+  std::string_view view;
+  auto ret = Next(recv_fn, &direct, &is_direct, &view);
+  if (ret != retcode::SUCCESS) {
+    return ret;
+  }
+  if (is_direct) {
+    view = direct;
+  }
+  if (view.size() != size) {
+    LOG(ERROR) << "message size: " << view.size() << " "
+               << "does not match expected size: " << size;
+    return retcode::FAIL;
+  }
+  memcpy(buf, view.data(), size);
+  return retcode::SUCCESS;
+}
+
+retcode FrameSplitter::Next(const RecvFunc& recv_fn, std::string* direct,
+                            bool* is_direct, std::string_view* view) {
+  *is_direct = false;
+  while (!framing_) {
+    // message of peer which does not send frames is received as is
+    auto ret = recv_fn(direct);
+    if (ret != retcode::SUCCESS) {
+      return ret;
+    }
+    if (*direct == MessageCoalescer::kHelloMessage) {
+      if (hello_handler_) {
+        hello_handler_();
+      }
+      continue;
+    }
+    if (*direct == MessageCoalescer::kSwitchMessage) {
+      framing_ = true;
+      break;
+    }
+    *is_direct = true;
+    return retcode::SUCCESS;
+  }
+  while (messages_.empty()) {
+    // views of previous frame have all been taken
+    auto ret = recv_fn(&frame_);
+    if (ret != retcode::SUCCESS) {
+      return ret;
+    }
+    uint64_t direct_size{0};
+    if (ParseDirectHeader(frame_, &direct_size)) {
+      // the next one is the message itself
+      ret = recv_fn(direct);
+      if (ret != retcode::SUCCESS) {
+        return ret;
+      }
+      if (direct->size() != direct_size) {
+        LOG(ERROR) << "direct message size: " << direct->size() << " "
+                   << "does not match header: " << direct_size;
+        return retcode::FAIL;
+      }
+      *is_direct = true;
+      return retcode::SUCCESS;
+    }
+    ret = MessageCoalescer::DecodeView(frame_, &messages_);
+    if (ret != retcode::SUCCESS) {
+      messages_.clear();
+      return ret;
+    }
+  }
+  *view = messages_.front();
+  messages_.pop_front();
+  return retcode::SUCCESS;
+}
+}  // namespace primihub::network
@@ -0,0 +1,214 @@
+/*
+* Copyright (c) 2023 by PrimiHub
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      https://www.apache.org/licenses/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef SRC_PRIMIHUB_UTIL_NETWORK_MESSAGE_COALESCER_H_
+#define SRC_PRIMIHUB_UTIL_NETWORK_MESSAGE_COALESCER_H_
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "src/primihub/common/common.h"
+
+namespace primihub::network {
+class LinkContext;
+
+struct CoalesceOption {
+  bool enable{false};
+  // pending frame is sent when it reaches this size
+  size_t max_frame_size{COALESCE_MAX_FRAME_SIZE};
+  // pending frame is sent this long after its first message,
+  // 0: frame is sent at the end of every Send call
+  int max_delay_us{COALESCE_MAX_DELAY_US};
+};
+
+/**
+ * packs consecutive messages sent with one key into one frame,
+ * frame layout: [uint32 count][uint64 size of message x count][messages]
+ * integers of header are in network byte order.
+ * message not smaller than max_frame_size is not copied into a frame,
+ * it is sent as is after a header frame [uint32 kDirectMessageMark][uint64 size].
+ * message boundaries are restored by FrameSplitter on receiver.
+ * coalescing is negotiated on each link: the first Send announces it by
+ * kHelloMessage, messages are sent as is until the hello of peer has been
+ * received (SetPeerSupported), then kSwitchMessage is sent and frames follow.
+ * so a peer which does not enable coalescing never receives a frame.
+ * sender must Flush before it waits for data from peer, otherwise
+ * the pending frame is held back until max_delay_us
+*/
+class MessageCoalescer {
+ public:
+  using SendFunc = std::function<retcode(std::string_view frame)>;
+  /**
+   * link_ctx: statistics of coalesced messages are added to it, can be null
+  */
+  MessageCoalescer(const CoalesceOption& option,
+                   SendFunc send_fn,
+                   LinkContext* link_ctx = nullptr);
+  ~MessageCoalescer();
+  /**
+   * append messages to pending frame, they are sent in order
+   * error of a frame sent by timer is returned by next call
+  */
+  retcode Send(std::string_view message);
+  retcode Send(const std::vector<std::string_view>& messages);
+  retcode Flush();
+  /**
+   * peer is able to split frames, frames are sent from the next Send
+  */
+  void SetPeerSupported() {
+    peer_supported_.store(true, std::memory_order_release);
+  }
+
+  uint64_t messages() const {
+    return messages_.load(std::memory_order_relaxed);
+  }
+  uint64_t frames() const {
+    return frames_.load(std::memory_order_relaxed);
+  }
+
+  static constexpr uint32_t kDirectMessageMark = 0xFFFFFFFF;
+  // control messages of negotiation
+  static constexpr std::string_view kHelloMessage{"\x7fPH_COALESCE_HELLO"};
+  static constexpr std::string_view kSwitchMessage{"\x7fPH_COALESCE_FRAME"};
+  static void Encode(const std::vector<std::string_view>& messages,
+                     std::string* frame);
+  static retcode Decode(std::string_view frame,
+                        std::deque<std::string>* messages);
+  /**
+   * messages refer to frame, which must outlive them
+  */
+  static retcode DecodeView(std::string_view frame,
+                            std::deque<std::string_view>* messages);
+
+ private:
+  friend class CoalesceTimer;
+  retcode AppendLocked(std::string_view message);
+  /**
+   * send hello once, and switch to frames once peer supports them
+  */
+  retcode NegotiateLocked();
+  retcode FlushLocked();
+  /**
+   * send pending frame, then header of message and message itself
+  */
+  retcode SendDirectLocked(std::string_view message);
+  /**
+   * called by CoalesceTimer, send pending frame if it is due
+  */
+  void OnTimer();
+
+  CoalesceOption option_;
+  SendFunc send_fn_;
+  LinkContext* link_ctx_{nullptr};
+  std::mutex mtx_;
+  // payloads and sizes of pending messages
+  std::string pending_data_;
+  std::vector<uint64_t> pending_sizes_;
+  std::chrono::steady_clock::time_point first_pending_time_;
+  retcode last_error_{retcode::SUCCESS};
+  bool hello_sent_{false};
+  bool framing_{false};
+  std::atomic<bool> peer_supported_{false};
+  std::atomic<uint64_t> messages_{0};
+  std::atomic<uint64_t> frames_{0};
+};
+
+/**
+ * one thread for the pending frames of all coalescers in the process,
+ * each coalescer has at most one deadline registered.
+ * frame is sent on the timer thread, so a slow link delays the frames
+ * of others which are due at the same time
+*/
+class CoalesceTimer {
+ public:
+  static CoalesceTimer& getInstance() {
+    static CoalesceTimer ins;
+    return ins;
+  }
+  /**
+   * register deadline of coalescer, replacing the previous one
+  */
+  void Schedule(MessageCoalescer* coalescer,
+                std::chrono::steady_clock::time_point deadline);
+  /**
+   * remove coalescer, wait until its running OnTimer returns
+  */
+  void Cancel(MessageCoalescer* coalescer);
+
+ private:
+  CoalesceTimer();
+  ~CoalesceTimer();
+  void Run();
+  using TimerQueue = std::multimap<std::chrono::steady_clock::time_point,
+                                   MessageCoalescer*>;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  // notified when OnTimer of running_ returns
+  std::condition_variable done_cv_;
+  TimerQueue timers_;
+  std::unordered_map<MessageCoalescer*, TimerQueue::iterator> index_;
+  MessageCoalescer* running_{nullptr};
+  bool stop_{false};
+  std::thread thread_;
+};
+
+/**
+ * receiver side of MessageCoalescer, returns one message per Recv.
+ * it must be used on every receiver, even if local coalescing is disabled,
+ * so the hello of peer is dropped instead of being taken as data.
+ * messages are kept as views into the last received frame,
+ * so each of them is copied only once, into the buffer of Recv
+*/
+class FrameSplitter {
+ public:
+  using RecvFunc = std::function<retcode(std::string* frame)>;
+  /**
+   * handler is called when hello of peer is received,
+   * it tells the local coalescer that frames can be sent to peer
+  */
+  void SetPeerHelloHandler(std::function<void()> handler) {
+    hello_handler_ = std::move(handler);
+  }
+  retcode Recv(const RecvFunc& recv_fn, std::string* message);
+  /**
+   * copy next message into buf, FAIL if its size is not size
+  */
+  retcode Recv(const RecvFunc& recv_fn, char* buf, size_t size);
+
+ private:
+  /**
+   * take next message, a message sent directly is received into direct
+   * and is_direct is set, otherwise view refers to it in frame_
+  */
+  retcode Next(const RecvFunc& recv_fn, std::string* direct,
+               bool* is_direct, std::string_view* view);
+
+  std::string frame_;
+  std::deque<std::string_view> messages_;
+  std::function<void()> hello_handler_;
+  // peer has switched to frames, messages before it are received as is
+  bool framing_{false};
+};
+}  // namespace primihub::network
+#endif  // SRC_PRIMIHUB_UTIL_NETWORK_MESSAGE_COALESCER_H_
@@ -5,6 +5,7 @@
 #include <atomic>
 #include <functional>
 #include <utility>
+#include <vector>
 
 #include "boost/system/system_error.hpp"
 
@@ -22,6 +23,7 @@ void TaskMessagePassInterface::_channelSend(
   boost::system::error_code errcode;
   u64 bytes_send = 0;
   bool errors = false;
+  std::vector<std::string_view> coalesced;
 
   for (u64 i = 0; i < buffers.size(); i++) {
     uint8_t *ptr = boost::asio::buffer_cast<u8 *>(buffers[i]);
@@ -35,6 +37,13 @@ void TaskMessagePassInterface::_channelSend(
     }
 
     std::string_view send_str(reinterpret_cast<const char *>(ptr), size);
+    if (coalescer_ != nullptr) {
+      // buffers of one span are packed together and sent after the loop
+      coalesced.push_back(send_str);
+      bytes_send += size;
+      index += 1;
+      continue;
+    }
     auto ret = send_channel_->send(send_key, send_str);
     if (ret != retcode::SUCCESS) {
       std::stringstream ss;
@@ -62,6 +71,15 @@ void TaskMessagePassInterface::_channelSend(
     }
   }
 
+  if (!coalesced.empty() && !cancel_) {
+    auto ret = coalescer_->Send(coalesced);
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "Send " << coalesced.size() << " coalesced messages to "
+                 << peer_node_id_ << " failed, send key " << send_key << ".";
+      errors = true;
+    }
+  }
+
   if (cancel_) {
     errcode = boost::system::errc::make_error_code(
         boost::system::errc::operation_canceled);
@@ -83,7 +101,7 @@ void TaskMessagePassInterface::_channelSend(
 }
 
 void TaskMessagePassInterface::_channelRecv(
-    const std::string recv_key, ThreadSafeQueue<std::string> &queue,
+    const std::string recv_key, LinkContext::StringDataQueue &queue,
     osuCrypto::span<boost::asio::mutable_buffer> buffers,
     io_completion_handle &&fn) {
   std::shared_ptr<WaitLock> wait_lock(new WaitLock());
@@ -118,7 +136,15 @@ void TaskMessagePassInterface::_channelRecv(
       break;
     }
 
-    std::string recv_str = recv_channel_->forwardRecv(recv_key);
+    std::string recv_str;
+    // peer may wait for pending frame of this side before it replies
+    if (coalescer_ == nullptr || coalescer_->Flush() == retcode::SUCCESS) {
+      // splitter drops hello of peer even if coalesce is disabled
+      splitter_.Recv([&](std::string* frame) {
+        *frame = recv_channel_->forwardRecv(recv_key);
+        return frame->empty() ? retcode::FAIL : retcode::SUCCESS;
+      }, &recv_str);
+    }
 
     if (!recv_str.size()) {
       LOG(ERROR) << "Recv queue has shutdown, recv failed, already recv "
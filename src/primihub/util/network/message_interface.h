@@ -11,6 +11,7 @@
 #include "cryptoTools/Network/SocketAdapter.h"
 #include "src/primihub/util/network/grpc_link_context.h"
 #include "src/primihub/util/network/link_context.h"
+#include "src/primihub/util/network/message_coalescer.h"
 #include "src/primihub/util/threadsafe_queue.h"
 
 using io_completion_handle = osuCrypto::io_completion_handle;
@@ -89,6 +90,17 @@ class TaskMessagePassInterface : public SocketInterface {
     recv_key_ = ss_recv.str();
     send_count_.store(0);
     recv_count_.store(0);
+    if (link_context->coalesceOption().enable) {
+      coalescer_ = std::make_unique<MessageCoalescer>(
+          link_context->coalesceOption(),
+          [this](std::string_view frame) {
+            return send_channel_->send(send_key_, frame);
+          },
+          link_context);
+      splitter_.SetPeerHelloHandler([coalescer = coalescer_.get()]() {
+        coalescer->SetPeerSupported();
+      });
+    }
     VLOG(3) << "job_id " << job_id_ << ", task_id " << task_id_
             << ", request_id " << request_id_
             << ", local_node " << local_node_id_ << ", peer node "
@@ -126,7 +138,7 @@ class TaskMessagePassInterface : public SocketInterface {
                     io_completion_handle &&fn);
 
   void _channelRecv(const std::string recv_key,
-                    ThreadSafeQueue<std::string> &queue,
+                    LinkContext::StringDataQueue &queue,
                     osuCrypto::span<boost::asio::mutable_buffer> buffers,
                     io_completion_handle &&fn);
   std::string& SendKey() {
@@ -153,6 +165,9 @@ class TaskMessagePassInterface : public SocketInterface {
   std::atomic_int recv_count_{0};
   std::string send_key_;
   std::string recv_key_;
+  FrameSplitter splitter_;
+  // declared last, pending frame is sent before other members are destroyed
+  std::unique_ptr<MessageCoalescer> coalescer_{nullptr};
 };
 }  // namespace primihub::network
 #endif  // SRC_PRIMIHUB_UTIL_NETWORK_MESSAGE_INTERFACE_H_
@@ -19,8 +19,28 @@ ph_link::retcode MPCTaskChannel::SendImpl(const char* buff, size_t size) {
   return SendImpl(send_sv);
 }
 
+void MPCTaskChannel::InitCoalescer() {
+  const auto& option = link_context_->coalesceOption();
+  if (!option.enable) {
+    return;
+  }
+  coalescer_ = std::make_unique<MessageCoalescer>(option,
+      [this](std::string_view frame) {
+        return send_channel_->send(send_key_, frame);
+      },
+      link_context_);
+  splitter_.SetPeerHelloHandler([coalescer = coalescer_.get()]() {
+    coalescer->SetPeerSupported();
+  });
+}
+
 ph_link::retcode MPCTaskChannel::SendImpl(std::string_view send_buff_sv) {
-  auto ret = send_channel_->send(send_key_, send_buff_sv);
+  auto ret{retcode::SUCCESS};
+  if (coalescer_ != nullptr) {
+    ret = coalescer_->Send(send_buff_sv);
+  } else {
+    ret = send_channel_->send(send_key_, send_buff_sv);
+  }
   if (ret != retcode::SUCCESS) {
     std::stringstream ss;
     ss << "Send message to " << peer_node_id_ << " failed, size "
@@ -42,8 +62,46 @@ ph_link::retcode MPCTaskChannel::SendImpl(std::string_view send_buff_sv) {
   return ph_link::retcode::SUCCESS;
 }
 
+ph_link::retcode MPCTaskChannel::RecvData(std::string* recv_buf) {
+  if (coalescer_ != nullptr && coalescer_->Flush() != retcode::SUCCESS) {
+    LOG(ERROR) << "send pending frame of key: " << send_key_ << " failed";
+    return ph_link::retcode::FAIL;
+  }
+  // splitter is used even if coalesce is disabled to drop hello of peer
+  auto ret = splitter_.Recv([this](std::string* frame) {
+    return RecvFrame(frame) == ph_link::retcode::SUCCESS ? retcode::SUCCESS :
+                                                           retcode::FAIL;
+  }, recv_buf);
+  return ret == retcode::SUCCESS ? ph_link::retcode::SUCCESS :
+                                   ph_link::retcode::FAIL;
+}
+
+ph_link::retcode MPCTaskChannel::RecvFrame(std::string* recv_buf) {
+  std::call_once(subscribe_flag_, [this]() {
+    subscribed_ = recv_channel_->subscribeRecv(recv_key_) == retcode::SUCCESS;
+    if (!subscribed_) {
+      LOG(WARNING) << "subscribe recv key: " << recv_key_ << " failed, "
+                   << "fetch data by ForwardRecv";
+    }
+  });
+  if (!subscribed_) {
+    *recv_buf = recv_channel_->forwardRecv(recv_key_);
+    return ph_link::retcode::SUCCESS;
+  }
+  auto& recv_queue = link_context_->GetRecvQueue(recv_key_);
+  recv_queue.wait_and_pop(*recv_buf);
+  if (recv_queue.is_shutdown()) {
+    LOG(ERROR) << "recv queue of key: " << recv_key_ << " has been shutdown";
+    return ph_link::retcode::FAIL;
+  }
+  return ph_link::retcode::SUCCESS;
+}
+
 ph_link::retcode MPCTaskChannel::RecvImpl(std::string* recv_buf) {
-  *recv_buf = recv_channel_->forwardRecv(recv_key_);
+  auto ret = RecvData(recv_buf);
+  if (ret != ph_link::retcode::SUCCESS) {
+    return ret;
+  }
   if (VLOG_IS_ON(8)) {
     std::string recv_data;
     for (const auto& ch : *recv_buf) {
@@ -57,18 +115,29 @@ ph_link::retcode MPCTaskChannel::RecvImpl(std::string* recv_buf) {
   return ph_link::retcode::SUCCESS;
 }
 
-ph_link::retcode MPCTaskChannel::RecvImpl(char* recv_buf, size_t recv_size) {
-  std::string tmp_recv_buf = recv_channel_->forwardRecv(recv_key_);
-  if (tmp_recv_buf.size() != recv_size) {
-    LOG(ERROR) << "data length does not match: " << " "
-               << "expected: " << recv_size << " "
-              << "actually: " << tmp_recv_buf.size();
+ph_link::retcode MPCTaskChannel::RecvData(char* recv_buf, size_t recv_size) {
+  if (coalescer_ != nullptr && coalescer_->Flush() != retcode::SUCCESS) {
+    LOG(ERROR) << "send pending frame of key: " << send_key_ << " failed";
     return ph_link::retcode::FAIL;
   }
-  memcpy(recv_buf, tmp_recv_buf.data(), recv_size);
+  // payload is moved out of recv queue, then copied once into recv_buf
+  auto ret = splitter_.Recv([this](std::string* frame) {
+    return RecvFrame(frame) == ph_link::retcode::SUCCESS ? retcode::SUCCESS :
+                                                           retcode::FAIL;
+  }, recv_buf, recv_size);
+  return ret == retcode::SUCCESS ? ph_link::retcode::SUCCESS :
+                                   ph_link::retcode::FAIL;
+}
+
+ph_link::retcode MPCTaskChannel::RecvImpl(char* recv_buf, size_t recv_size) {
+  auto ret = RecvData(recv_buf, recv_size);
+  if (ret != ph_link::retcode::SUCCESS) {
+    return ret;
+  }
   if (VLOG_IS_ON(8)) {
     std::string recv_data;
-    for (const auto& ch : tmp_recv_buf) {
+    for (size_t i = 0; i < recv_size; i++) {
+      auto ch = recv_buf[i];
       recv_data.append(std::to_string(static_cast<int>(ch))).append(" ");
     }
     LOG(ERROR) << "MPCTaskChannel::RecvImpl "
@@ -81,6 +150,9 @@ ph_link::retcode MPCTaskChannel::RecvImpl(char* recv_buf, size_t recv_size) {
 }
 
 void MPCTaskChannel::close() {
+  if (coalescer_ != nullptr) {
+    coalescer_->Flush();
+  }
 }
 
 void MPCTaskChannel::cancel() {
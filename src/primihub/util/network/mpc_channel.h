@@ -19,12 +19,14 @@
 #include <queue>
 #include <memory>
 #include <atomic>
+#include <mutex>
 #include <utility>
 
 #include "cryptoTools/Common/Defines.h"
 #include "cryptoTools/Network/SocketAdapter.h"
 #include "src/primihub/util/network/grpc_link_context.h"
 #include "src/primihub/util/network/link_context.h"
+#include "src/primihub/util/network/message_coalescer.h"
 #include "src/primihub/util/threadsafe_queue.h"
 #include "network/base_channel.h"
 
@@ -64,6 +66,7 @@ class MPCTaskChannel : public ph_link::ChannelBase {
             << ", request_id " << request_id_
             << ", local_node " << local_node_id_ << ", peer node "
             << peer_node_id_;
+    InitCoalescer();
   }
 
   MPCTaskChannel(const std::string &local_node_id,
@@ -95,6 +98,7 @@ class MPCTaskChannel : public ph_link::ChannelBase {
             << ", request_id " << request_id_
             << ", local_node " << local_node_id_ << ", peer node "
             << peer_node_id_;
+    InitCoalescer();
   }
 
   MPCTaskChannel(const std::string &local_node_id,
@@ -125,6 +129,7 @@ class MPCTaskChannel : public ph_link::ChannelBase {
             << "request_id " << request_id_ << ", "
             << "local_node " << local_node_id_ << ", peer node "
             << peer_node_id_;
+    InitCoalescer();
   }
 
   ~MPCTaskChannel() {}
@@ -137,6 +142,29 @@ class MPCTaskChannel : public ph_link::ChannelBase {
   void cancel() override;
 
  private:
+  /**
+   * small messages are packed into frames if coalesce is enabled
+   * by link context and peer has announced that it splits frames,
+   * frames are split back into messages on receive
+  */
+  void InitCoalescer();
+  /**
+   * receive one message, pending frame of this channel is sent first,
+   * since peer may wait for it before it replies
+  */
+  ph_link::retcode RecvData(std::string* recv_buf);
+  /**
+   * receive one message of recv_size into recv_buf,
+   * its payload is copied only once, into recv_buf
+  */
+  ph_link::retcode RecvData(char* recv_buf, size_t recv_size);
+  /**
+   * receive one frame, peer data is pushed into recv queue of
+   * link context by subscription of proxy node if proxy supports it,
+   * otherwise fetch it by one ForwardRecv rpc for each frame
+  */
+  ph_link::retcode RecvFrame(std::string* recv_buf);
+
   std::atomic<bool> cancel_{false};
   std::string job_id_;
   std::string task_id_;
@@ -149,6 +177,11 @@ class MPCTaskChannel : public ph_link::ChannelBase {
   network::LinkContext* link_context_{nullptr};
   std::string send_key_;
   std::string recv_key_;
+  std::once_flag subscribe_flag_;
+  bool subscribed_{false};
+  FrameSplitter splitter_;
+  // declared last, pending frame is sent before other members are destroyed
+  std::unique_ptr<MessageCoalescer> coalescer_{nullptr};
 };
 }  // namespace primihub::network
 #endif  // SRC_PRIMIHUB_UTIL_NETWORK_MPC_CHANNEL_H_
@@ -0,0 +1,472 @@
+/*
+* Copyright (c) 2023 by PrimiHub
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      https://www.apache.org/licenses/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include "src/primihub/util/network/shm_channel.h"
+#include <glog/logging.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace primihub::network {
+/**
+ * control block at the beginning of shared memory segment,
+ * writer and reader fields are kept in different cache lines
+*/
+struct ShmRingHeader {
+  std::atomic<uint32_t> magic;
+  std::atomic<uint32_t> attached;
+  uint64_t capacity;
+  alignas(64) std::atomic<uint64_t> write_pos;
+  // futex word, bumped by writer after data is published
+  std::atomic<uint32_t> data_seq;
+  std::atomic<uint32_t> reader_waiting;
+  alignas(64) std::atomic<uint64_t> read_pos;
+  // futex word, bumped by reader after data is consumed
+  std::atomic<uint32_t> space_seq;
+  std::atomic<uint32_t> writer_waiting;
+  alignas(64) std::atomic<uint32_t> closed;
+};
+
+namespace {
+constexpr uint32_t kShmRingMagic = 0x50485348;
+constexpr size_t kShmHeaderSize = 256;
+// number of checks before waiting on futex
+constexpr int kSpinCount = 1000;
+// waiting on futex is split into slices to check cancel and close
+constexpr int32_t kWaitSliceMs = 100;
+// buffer to drop payload of unexpected length
+constexpr size_t kDrainBufferSize = 64 * 1024;
+static_assert(sizeof(ShmRingHeader) <= kShmHeaderSize,
+              "shared memory ring header is too large");
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+              sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex word must be a plain 32-bit integer");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "position of ring must be lock free across processes");
+
+void FutexWait(std::atomic<uint32_t>* addr, uint32_t expected,
+               int32_t timeout_ms) {
+  struct timespec ts;
+  ts.tv_sec = timeout_ms / 1000;
+  ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT,
+          expected, &ts, nullptr, 0);
+}
+
+void FutexWake(std::atomic<uint32_t>* addr) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE,
+          INT_MAX, nullptr, nullptr, 0);
+}
+
+int64_t ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start).count();
+}
+}  // namespace
+
+ShmRing::ShmRing(const std::string& name, size_t capacity)
+    : name_(name), capacity_(capacity) {}
+
+ShmRing::~ShmRing() {
+  if (addr_ == nullptr) {
+    return;
+  }
+  // peer has never attached, name is still there
+  if (header_->attached.load() < 2) {
+    shm_unlink(name_.c_str());
+  }
+  munmap(addr_, map_size_);
+}
+
+retcode ShmRing::Attach() {
+  auto ret{retcode::SUCCESS};
+  int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd >= 0) {
+    ret = Create(fd);
+  } else if (errno == EEXIST) {
+    fd = shm_open(name_.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+      LOG(ERROR) << "open shared memory " << name_ << " failed: "
+                 << strerror(errno);
+      return retcode::FAIL;
+    }
+    ret = Open(fd);
+  } else {
+    LOG(ERROR) << "create shared memory " << name_ << " failed: "
+               << strerror(errno);
+    return retcode::FAIL;
+  }
+  ::close(fd);
+  if (ret != retcode::SUCCESS) {
+    return ret;
+  }
+  // name is no longer needed once both sides have mapped the segment
+  if (header_->attached.fetch_add(1) + 1 == 2) {
+    shm_unlink(name_.c_str());
+  }
+  VLOG(3) << "attach shared memory ring " << name_ << " "
+          << "capacity: " << capacity_;
+  return retcode::SUCCESS;
+}
+
+retcode ShmRing::Create(int fd) {
+  map_size_ = kShmHeaderSize + capacity_;
+  if (ftruncate(fd, map_size_) != 0) {
+    LOG(ERROR) << "resize shared memory " << name_ << " to " << map_size_
+               << " failed: " << strerror(errno);
+    shm_unlink(name_.c_str());
+    return retcode::FAIL;
+  }
+  addr_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr_ == MAP_FAILED) {
+    addr_ = nullptr;
+    LOG(ERROR) << "map shared memory " << name_ << " failed: "
+               << strerror(errno);
+    shm_unlink(name_.c_str());
+    return retcode::FAIL;
+  }
+  // segment is zero filled by ftruncate
+  header_ = new (addr_) ShmRingHeader();
+  header_->capacity = capacity_;
+  data_ = reinterpret_cast<char*>(addr_) + kShmHeaderSize;
+  header_->magic.store(kShmRingMagic, std::memory_order_release);
+  return retcode::SUCCESS;
+}
+
+retcode ShmRing::Open(int fd) {
+  auto start = std::chrono::steady_clock::now();
+  struct stat st;
+  // creator resizes segment before initializing it
+  while (fstat(fd, &st) == 0 &&
+         static_cast<size_t>(st.st_size) <= kShmHeaderSize) {
+    if (ElapsedMs(start) > SHM_ATTACH_TIMEOUT_MS) {
+      LOG(ERROR) << "wait for shared memory " << name_ << " timeout";
+      return retcode::FAIL;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  map_size_ = st.st_size;
+  addr_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr_ == MAP_FAILED) {
+    addr_ = nullptr;
+    LOG(ERROR) << "map shared memory " << name_ << " failed: "
+               << strerror(errno);
+    return retcode::FAIL;
+  }
+  header_ = reinterpret_cast<ShmRingHeader*>(addr_);
+  while (header_->magic.load(std::memory_order_acquire) != kShmRingMagic) {
+    if (ElapsedMs(start) > SHM_ATTACH_TIMEOUT_MS) {
+      LOG(ERROR) << "wait for initialization of shared memory "
+                 << name_ << " timeout";
+      return retcode::FAIL;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (header_->attached.load() >= 2) {
+    LOG(ERROR) << "shared memory " << name_ << " is left by another task";
+    return retcode::FAIL;
+  }
+  capacity_ = header_->capacity;
+  data_ = reinterpret_cast<char*>(addr_) + kShmHeaderSize;
+  return retcode::SUCCESS;
+}
+
+template <typename Ready>
+retcode ShmRing::Wait(std::atomic<uint32_t>* seq,
+                      std::atomic<uint32_t>* waiting,
+                      const Ready& ready,
+                      const std::atomic<bool>& cancel,
+                      int32_t timeout_ms) {
+  for (int i = 0; i < kSpinCount; i++) {
+    if (ready()) {
+      return retcode::SUCCESS;
+    }
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (!ready()) {
+    if (cancel.load(std::memory_order_relaxed)) {
+      LOG(WARNING) << "wait on shared memory ring " << name_ << " is canceled";
+      return retcode::FAIL;
+    }
+    if (header_->closed.load(std::memory_order_acquire)) {
+      LOG(ERROR) << "shared memory ring " << name_ << " has been closed";
+      return retcode::FAIL;
+    }
+    int32_t wait_ms = kWaitSliceMs;
+    if (timeout_ms >= 0) {
+      auto elapsed_ms = ElapsedMs(start);
+      if (elapsed_ms >= timeout_ms) {
+        LOG(ERROR) << "wait on shared memory ring " << name_ << " timeout";
+        return retcode::FAIL;
+      }
+      wait_ms = std::min<int64_t>(wait_ms, timeout_ms - elapsed_ms);
+    }
+    // peer wakes futex only when waiting flag is set, the flag is set
+    // before ready() is checked again so no wake up is lost
+    waiting->store(1);
+    uint32_t cur_seq = seq->load();
+    if (!ready()) {
+      FutexWait(seq, cur_seq, wait_ms);
+    }
+    waiting->store(0);
+  }
+  return retcode::SUCCESS;
+}
+
+retcode ShmRing::Write(const char* data, size_t size,
+                       const std::atomic<bool>& cancel, int32_t timeout_ms) {
+  auto* header = header_;
+  size_t written = 0;
+  while (written < size) {
+    uint64_t write_pos = header->write_pos.load(std::memory_order_relaxed);
+    auto free_size = [&]() -> uint64_t {
+      return capacity_ - (write_pos - header->read_pos.load());
+    };
+    if (free_size() == 0) {
+      auto ret = Wait(&header->space_seq, &header->writer_waiting,
+                      [&]() { return free_size() > 0; }, cancel, timeout_ms);
+      if (ret != retcode::SUCCESS) {
+        return ret;
+      }
+    }
+    size_t len = std::min<uint64_t>(free_size(), size - written);
+    size_t offset = write_pos % capacity_;
+    size_t first_len = std::min(len, capacity_ - offset);
+    memcpy(data_ + offset, data + written, first_len);
+    memcpy(data_, data + written + first_len, len - first_len);
+    header->write_pos.store(write_pos + len);
+    header->data_seq.fetch_add(1);
+    if (header->reader_waiting.load()) {
+      FutexWake(&header->data_seq);
+    }
+    written += len;
+  }
+  return retcode::SUCCESS;
+}
+
+retcode ShmRing::Read(char* data, size_t size,
+                      const std::atomic<bool>& cancel, int32_t timeout_ms) {
+  auto* header = header_;
+  size_t read_size = 0;
+  while (read_size < size) {
+    uint64_t read_pos = header->read_pos.load(std::memory_order_relaxed);
+    auto data_size = [&]() -> uint64_t {
+      return header->write_pos.load() - read_pos;
+    };
+    if (data_size() == 0) {
+      auto ret = Wait(&header->data_seq, &header->reader_waiting,
+                      [&]() { return data_size() > 0; }, cancel, timeout_ms);
+      if (ret != retcode::SUCCESS) {
+        return ret;
+      }
+    }
+    size_t len = std::min<uint64_t>(data_size(), size - read_size);
+    size_t offset = read_pos % capacity_;
+    size_t first_len = std::min(len, capacity_ - offset);
+    memcpy(data + read_size, data_ + offset, first_len);
+    memcpy(data + read_size + first_len, data_, len - first_len);
+    header->read_pos.store(read_pos + len);
+    header->space_seq.fetch_add(1);
+    if (header->writer_waiting.load()) {
+      FutexWake(&header->space_seq);
+    }
+    read_size += len;
+  }
+  return retcode::SUCCESS;
+}
+
+void ShmRing::Close() {
+  if (header_ == nullptr) {
+    return;
+  }
+  header_->closed.store(1);
+  header_->data_seq.fetch_add(1);
+  header_->space_seq.fetch_add(1);
+  FutexWake(&header_->data_seq);
+  FutexWake(&header_->space_seq);
+}
+
+ShmChannel::ShmChannel(const std::string& local_node_id,
+                       const std::string& peer_node_id,
+                       LinkContext* link_context,
+                       size_t ring_size)
+    : local_node_id_(local_node_id), peer_node_id_(peer_node_id),
+      link_context_(link_context) {
+  auto request_id = link_context->request_id();
+  auto sub_task_id = link_context->sub_task_id();
+  send_ring_ = std::make_unique<ShmRing>(
+      RingName(request_id, sub_task_id, local_node_id, peer_node_id),
+      ring_size);
+  recv_ring_ = std::make_unique<ShmRing>(
+      RingName(request_id, sub_task_id, peer_node_id, local_node_id),
+      ring_size);
+  if (send_ring_->Attach() != retcode::SUCCESS ||
+      recv_ring_->Attach() != retcode::SUCCESS) {
+    std::string err_info = "attach shared memory ring between " +
+        local_node_id + " and " + peer_node_id + " failed";
+    LOG(ERROR) << err_info;
+    throw std::runtime_error(err_info);
+  }
+  VLOG(3) << "request_id " << request_id << ", "
+          << "local_node " << local_node_id_ << ", peer node "
+          << peer_node_id_ << ", shared memory ring size " << ring_size;
+}
+
+ShmChannel::~ShmChannel() {
+  close();
+}
+
+std::string ShmChannel::RingName(const std::string& request_id,
+                                 const std::string& sub_task_id,
+                                 const std::string& from,
+                                 const std::string& to) {
+  std::string name = "primihub_" + request_id + "_" + sub_task_id + "_" +
+                     from + "_" + to;
+  std::replace(name.begin(), name.end(), '/', '_');
+  return "/" + name;
+}
+
+ph_link::retcode ShmChannel::SendImpl(const std::string& send_buf) {
+  auto send_sv = std::string_view(send_buf.data(), send_buf.size());
+  return SendImpl(send_sv);
+}
+
+ph_link::retcode ShmChannel::SendImpl(const char* buff, size_t size) {
+  auto send_sv = std::string_view(buff, size);
+  return SendImpl(send_sv);
+}
+
+ph_link::retcode ShmChannel::SendImpl(std::string_view send_buff_sv) {
+  uint64_t data_len = send_buff_sv.size();
+  int32_t timeout_ms = link_context_->sendTimeout();
+  std::lock_guard<std::mutex> lck(send_mtx_);
+  if (send_broken_) {
+    LOG(ERROR) << "Send to " << peer_node_id_ << " is broken by previous "
+               << "failure.";
+    return ph_link::retcode::FAIL;
+  }
+  auto ret = send_ring_->Write(reinterpret_cast<const char*>(&data_len),
+                               sizeof(data_len), cancel_, timeout_ms);
+  if (ret == retcode::SUCCESS) {
+    ret = send_ring_->Write(send_buff_sv.data(), send_buff_sv.size(),
+                            cancel_, timeout_ms);
+  }
+  if (ret != retcode::SUCCESS) {
+    // part of message may have been written, peer can not find the next one
+    send_broken_ = true;
+    LOG(ERROR) << "Send message to " << peer_node_id_ << " failed, size "
+               << send_buff_sv.size() << ".";
+    return ph_link::retcode::FAIL;
+  }
+  return ph_link::retcode::SUCCESS;
+}
+
+ph_link::retcode ShmChannel::RecvHeader(uint64_t* data_len) {
+  if (recv_broken_) {
+    LOG(ERROR) << "Recv from " << peer_node_id_ << " is broken by previous "
+               << "failure.";
+    return ph_link::retcode::FAIL;
+  }
+  auto ret = recv_ring_->Read(reinterpret_cast<char*>(data_len),
+                              sizeof(uint64_t), cancel_,
+                              link_context_->recvTimeout());
+  if (ret != retcode::SUCCESS) {
+    recv_broken_ = true;
+    LOG(ERROR) << "Recv message from " << peer_node_id_ << " failed";
+    return ph_link::retcode::FAIL;
+  }
+  return ph_link::retcode::SUCCESS;
+}
+
+ph_link::retcode ShmChannel::RecvImpl(std::string* recv_buf) {
+  std::lock_guard<std::mutex> lck(recv_mtx_);
+  uint64_t data_len{0};
+  auto ret = RecvHeader(&data_len);
+  if (ret != ph_link::retcode::SUCCESS) {
+    return ret;
+  }
+  recv_buf->resize(data_len);
+  return RecvPayload(recv_buf->data(), data_len, data_len);
+}
+
+ph_link::retcode ShmChannel::RecvImpl(char* recv_buf, size_t recv_size) {
+  std::lock_guard<std::mutex> lck(recv_mtx_);
+  uint64_t data_len{0};
+  auto ret = RecvHeader(&data_len);
+  if (ret != ph_link::retcode::SUCCESS) {
+    return ret;
+  }
+  return RecvPayload(recv_buf, recv_size, data_len);
+}
+
+ph_link::retcode ShmChannel::RecvPayload(char* recv_buf, size_t recv_size,
+                                         uint64_t data_len) {
+  if (data_len != recv_size) {
+    LOG(ERROR) << "data length does not match: " << " "
+               << "expected: " << recv_size << " "
+               << "actually: " << data_len;
+    // drop the payload, so the next message is still found
+    if (DrainPayload(data_len) != retcode::SUCCESS) {
+      recv_broken_ = true;
+    }
+    return ph_link::retcode::FAIL;
+  }
+  // payload is copied from ring into caller buffer directly
+  auto ret = recv_ring_->Read(recv_buf, recv_size, cancel_,
+                              link_context_->recvTimeout());
+  if (ret != retcode::SUCCESS) {
+    recv_broken_ = true;
+    LOG(ERROR) << "Recv message from " << peer_node_id_ << " failed, size "
+               << recv_size << ".";
+    return ph_link::retcode::FAIL;
+  }
+  return ph_link::retcode::SUCCESS;
+}
+
+retcode ShmChannel::DrainPayload(uint64_t size) {
+  std::string buf(std::min<uint64_t>(size, kDrainBufferSize), 0);
+  while (size > 0) {
+    size_t len = std::min<uint64_t>(size, buf.size());
+    auto ret = recv_ring_->Read(buf.data(), len, cancel_,
+                                link_context_->recvTimeout());
+    if (ret != retcode::SUCCESS) {
+      LOG(ERROR) << "drain message from " << peer_node_id_ << " failed";
+      return retcode::FAIL;
+    }
+    size -= len;
+  }
+  return retcode::SUCCESS;
+}
+
+void ShmChannel::close() {
+  send_ring_->Close();
+  recv_ring_->Close();
+}
+
+void ShmChannel::cancel() {
+  cancel_.store(true);
+}
+}  // namespace primihub::network
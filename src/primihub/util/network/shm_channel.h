@@ -0,0 +1,141 @@
+/*
+* Copyright (c) 2023 by PrimiHub
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      https://www.apache.org/licenses/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef SRC_PRIMIHUB_UTIL_NETWORK_SHM_CHANNEL_H_
+#define SRC_PRIMIHUB_UTIL_NETWORK_SHM_CHANNEL_H_
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "src/primihub/common/common.h"
+#include "src/primihub/util/network/link_context.h"
+#include "network/base_channel.h"
+
+namespace ph_link = primihub::link;
+namespace primihub::network {
+struct ShmRingHeader;
+/**
+ * single producer single consumer byte ring in a posix shared memory
+ * segment, shared by two processes on the same host.
+ * whichever side comes first creates and initializes the segment,
+ * the name is unlinked as soon as both sides have mapped it.
+ * blocked reader or writer sleeps on a futex in the segment and is woken
+ * by the other side only when it is waiting.
+*/
+class ShmRing {
+ public:
+  /**
+   * name: name of shared memory segment, capacity: ring size in bytes,
+   * used only by the side which creates the segment
+  */
+  ShmRing(const std::string& name, size_t capacity);
+  ~ShmRing();
+  /**
+   * attach to segment, create it if peer has not done it
+  */
+  retcode Attach();
+  /**
+   * blocking write and read of exactly size bytes, data is copied
+   * between ring and caller buffer directly.
+   * timeout_ms: limit of waiting for peer, -1: no limit
+  */
+  retcode Write(const char* data, size_t size,
+                const std::atomic<bool>& cancel, int32_t timeout_ms);
+  retcode Read(char* data, size_t size,
+               const std::atomic<bool>& cancel, int32_t timeout_ms);
+  /**
+   * wake up peer which waits on this ring, peer fails once the ring is
+   * drained (reader) or can not make progress (writer)
+  */
+  void Close();
+
+ private:
+  retcode Create(int fd);
+  retcode Open(int fd);
+  /**
+   * wait until ready() or timeout, seq is the futex word bumped by peer
+  */
+  template <typename Ready>
+  retcode Wait(std::atomic<uint32_t>* seq, std::atomic<uint32_t>* waiting,
+               const Ready& ready, const std::atomic<bool>& cancel,
+               int32_t timeout_ms);
+  std::string name_;
+  size_t capacity_{0};
+  size_t map_size_{0};
+  void* addr_{nullptr};
+  ShmRingHeader* header_{nullptr};
+  char* data_{nullptr};
+};
+
+/**
+ * channel between two parties on the same host, data of each direction
+ * goes through one ShmRing named by request id and the sender/receiver.
+ * each message is written as [uint64 length][payload], concurrent sends
+ * or recvs on one channel are serialized so messages never interleave.
+ * a direction whose message is broken, e.g. by timeout in the middle of
+ * a message, fails every later call instead of reading misaligned data
+*/
+class ShmChannel : public ph_link::ChannelBase {
+ public:
+  ShmChannel(const std::string& local_node_id,
+             const std::string& peer_node_id,
+             LinkContext* link_context,
+             size_t ring_size = SHM_RING_SIZE);
+  ~ShmChannel();
+  ph_link::retcode SendImpl(const std::string& send_buf) override;
+  ph_link::retcode SendImpl(std::string_view send_buff_sv) override;
+  ph_link::retcode SendImpl(const char* buff, size_t size) override;
+  ph_link::retcode RecvImpl(std::string* recv_buf) override;
+  ph_link::retcode RecvImpl(char* recv_buf, size_t recv_size) override;
+  void close() override;
+  void cancel() override;
+
+  /**
+   * name of ring which carries data from one party to another
+  */
+  static std::string RingName(const std::string& request_id,
+                              const std::string& sub_task_id,
+                              const std::string& from,
+                              const std::string& to);
+
+ private:
+  ph_link::retcode RecvHeader(uint64_t* data_len);
+  /**
+   * read payload of data_len bytes into caller buffer of recv_size,
+   * payload of unexpected length is drained from ring and FAIL is returned
+  */
+  ph_link::retcode RecvPayload(char* recv_buf, size_t recv_size,
+                               uint64_t data_len);
+  /**
+   * read and drop size bytes from recv ring
+  */
+  retcode DrainPayload(uint64_t size);
+
+  std::atomic<bool> cancel_{false};
+  std::mutex send_mtx_;
+  std::mutex recv_mtx_;
+  // set when a message is partially written or read
+  bool send_broken_{false};
+  bool recv_broken_{false};
+  std::string local_node_id_;
+  std::string peer_node_id_;
+  LinkContext* link_context_{nullptr};
+  std::unique_ptr<ShmRing> send_ring_{nullptr};
+  std::unique_ptr<ShmRing> recv_ring_{nullptr};
+};
+}  // namespace primihub::network
+#endif  // SRC_PRIMIHUB_UTIL_NETWORK_SHM_CHANNEL_H_
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2023 by PrimiHub
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      https://www.apache.org/licenses/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_PRIMIHUB_UTIL_NETWORK_SHM_LINK_CONTEXT_H_
+#define SRC_PRIMIHUB_UTIL_NETWORK_SHM_LINK_CONTEXT_H_
+#include <string>
+#include "src/primihub/common/common.h"
+#include "src/primihub/util/network/grpc_link_context.h"
+
+namespace primihub::network {
+/**
+ * link for parties which may run on the same host,
+ * rpc to nodes still goes through grpc, data channel between parties
+ * on the same host is built on shared memory rings, see ShmChannel,
+ * channel to party on another host goes through grpc as GrpcLinkContext
+*/
+class ShmLinkContext : public GrpcLinkContext {
+ public:
+  ShmLinkContext() = default;
+  LinkMode linkMode() const override {return LinkMode::SHARED_MEMORY;}
+  inline void setRingSize(size_t ring_size) {ring_size_ = ring_size;}
+  size_t ringSize() const {return ring_size_;}
+  /**
+   * whether two nodes run on the same host according to their address.
+   * the result is symmetric, so both parties choose the same kind of channel
+  */
+  static bool IsSameHost(const Node& local_node, const Node& peer_node) {
+    if (local_node.ip_.empty() || peer_node.ip_.empty()) {
+      return false;
+    }
+    if (IsLoopback(local_node.ip_) && IsLoopback(peer_node.ip_)) {
+      return true;
+    }
+    return local_node.ip_ == peer_node.ip_;
+  }
+
+ protected:
+  static bool IsLoopback(const std::string& ip) {
+    return ip == "localhost" || ip == "::1" || ip.rfind("127.", 0) == 0;
+  }
+
+ private:
+  size_t ring_size_{SHM_RING_SIZE};
+};
+}  // namespace primihub::network
+#endif  // SRC_PRIMIHUB_UTIL_NETWORK_SHM_LINK_CONTEXT_H_
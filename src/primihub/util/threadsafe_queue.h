@@ -6,6 +6,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 
 namespace primihub {
 template<typename T>
@@ -56,6 +58,26 @@ class ThreadSafeQueue {
     m_queue.pop();
   }
 
+  /**
+   * wait at most timeout_ms for an item,
+   * return false if timeout or queue has been shutdown
+  */
+  bool wait_for_and_pop(T& popped_value, int32_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto ready = m_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+        [&]() {return stop_.load() || !m_queue.empty();});
+    if (!ready || stop_.load()) {
+      return false;
+    }
+    popped_value = std::move(m_queue.front());
+    m_queue.pop();
+    return true;
+  }
+
+  bool is_shutdown() const {
+    return stop_.load();
+  }
+
   // Provides only basic exception safety guarantee when RVO is not applied.
   T pop() {
     std::unique_lock<std::mutex> lock(m_mutex);
@@ -73,7 +95,7 @@ class ThreadSafeQueue {
 
   void shutdown() {
     stop_.store(true);
-    m_cv.notify_one();
+    m_cv.notify_all();
   }
 
  private:
@@ -0,0 +1,148 @@
+// "Copyright [2023] <PrimiHub>"
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/api.h>
+#include "gtest/gtest.h"
+#include "src/primihub/data_store/dataset_cache.h"
+
+namespace primihub {
+namespace fs = std::filesystem;
+namespace {
+/**
+ * cache instance owned by test, the node level one is a singleton
+*/
+class TestDatasetCache : public DatasetCache {
+ public:
+  TestDatasetCache() = default;
+  using DatasetCache::CachePath;
+};
+
+std::shared_ptr<arrow::Table> MakeTable(int64_t start, int64_t num_rows) {
+  arrow::Int64Builder builder;
+  for (int64_t i = 0; i < num_rows; i++) {
+    EXPECT_TRUE(builder.Append(start + i).ok());
+  }
+  std::shared_ptr<arrow::Array> array;
+  EXPECT_TRUE(builder.Finish(&array).ok());
+  auto schema = arrow::schema({arrow::field("id", arrow::int64())});
+  return arrow::Table::Make(schema, {array});
+}
+
+/**
+ * set last use time of cache file of key to seconds since epoch
+*/
+void SetLastUse(TestDatasetCache* cache, const std::string& key,
+                time_t seconds) {
+  struct timeval times[2];
+  times[0].tv_sec = seconds;
+  times[0].tv_usec = 0;
+  times[1] = times[0];
+  ASSERT_EQ(::utimes(cache->CachePath(key).c_str(), times), 0);
+}
+
+class DatasetCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    cache_dir_ = (fs::temp_directory_path() /
+        ("dataset_cache_test_" + std::to_string(::getpid()))).string();
+    fs::remove_all(cache_dir_);
+  }
+  void TearDown() override {
+    fs::remove_all(cache_dir_);
+  }
+  std::string cache_dir_;
+};
+}  // namespace
+
+TEST_F(DatasetCacheTest, PutAndGet) {
+  TestDatasetCache cache;
+  ASSERT_EQ(cache.Init(cache_dir_, 64 * 1024 * 1024), retcode::SUCCESS);
+  EXPECT_EQ(cache.Get("key"), nullptr);
+  auto table = MakeTable(0, 100);
+  ASSERT_EQ(cache.Put("key", table), retcode::SUCCESS);
+  auto cached = cache.Get("key");
+  ASSERT_NE(cached, nullptr);
+  EXPECT_TRUE(cached->Equals(*table));
+  // key stored in file is not exposed in schema
+  EXPECT_EQ(cached->schema()->metadata(), nullptr);
+  auto stat = cache.Stat();
+  EXPECT_EQ(stat.hit_count, 1);
+  EXPECT_EQ(stat.miss_count, 1);
+  EXPECT_EQ(stat.put_count, 1);
+}
+
+TEST_F(DatasetCacheTest, Disabled) {
+  TestDatasetCache cache;
+  ASSERT_EQ(cache.Init(cache_dir_, 0), retcode::SUCCESS);
+  EXPECT_FALSE(cache.Enabled());
+  EXPECT_EQ(cache.Put("key", MakeTable(0, 10)), retcode::FAIL);
+  EXPECT_EQ(cache.Get("key"), nullptr);
+}
+
+TEST_F(DatasetCacheTest, RejectKeyCollision) {
+  TestDatasetCache cache;
+  ASSERT_EQ(cache.Init(cache_dir_, 64 * 1024 * 1024), retcode::SUCCESS);
+  ASSERT_EQ(cache.Put("key_a", MakeTable(0, 10)), retcode::SUCCESS);
+  // file of key_a found under the name of key_b, as if their hash collided
+  fs::copy_file(cache.CachePath("key_a"), cache.CachePath("key_b"));
+  EXPECT_EQ(cache.Get("key_b"), nullptr);
+  EXPECT_NE(cache.Get("key_a"), nullptr);
+}
+
+TEST_F(DatasetCacheTest, EvictLeastRecentlyUsed) {
+  TestDatasetCache cache;
+  ASSERT_EQ(cache.Init(cache_dir_, 64 * 1024 * 1024), retcode::SUCCESS);
+  auto table = MakeTable(0, 1000);
+  ASSERT_EQ(cache.Put("key_0", table), retcode::SUCCESS);
+  auto file_size = fs::file_size(cache.CachePath("key_0"));
+
+  // room for two files only
+  TestDatasetCache small_cache;
+  ASSERT_EQ(small_cache.Init(cache_dir_, file_size * 2 + file_size / 2),
+            retcode::SUCCESS);
+  ASSERT_EQ(small_cache.Put("key_1", table), retcode::SUCCESS);
+  SetLastUse(&small_cache, "key_0", 1000);
+  SetLastUse(&small_cache, "key_1", 2000);
+  // key_0 is used again, key_1 becomes least recently used
+  ASSERT_NE(small_cache.Get("key_0"), nullptr);
+  ASSERT_EQ(small_cache.Put("key_2", table), retcode::SUCCESS);
+  EXPECT_EQ(small_cache.Stat().evict_count, 1);
+  EXPECT_EQ(small_cache.Get("key_1"), nullptr);
+  EXPECT_NE(small_cache.Get("key_0"), nullptr);
+  EXPECT_NE(small_cache.Get("key_2"), nullptr);
+
+  // dataset larger than capacity is not cached
+  EXPECT_EQ(small_cache.Put("key_3", MakeTable(0, 100000)), retcode::FAIL);
+  EXPECT_NE(small_cache.Get("key_0"), nullptr);
+}
+
+TEST_F(DatasetCacheTest, ChangedFingerprintInvalidatesEntry) {
+  TestDatasetCache cache;
+  ASSERT_EQ(cache.Init(cache_dir_, 64 * 1024 * 1024), retcode::SUCCESS);
+  auto file_path = cache_dir_ + "/source.csv";
+  {
+    std::ofstream out(file_path);
+    out << "id\n1\n";
+  }
+  std::string stamp;
+  ASSERT_EQ(DatasetCache::FileStamp(file_path, &stamp), retcode::SUCCESS);
+  auto key = file_path + "|" + stamp;
+  ASSERT_EQ(cache.Put(key, MakeTable(1, 1)), retcode::SUCCESS);
+  ASSERT_NE(cache.Get(key), nullptr);
+  {
+    std::ofstream out(file_path, std::ios::app);
+    out << "2\n";
+  }
+  std::string new_stamp;
+  ASSERT_EQ(DatasetCache::FileStamp(file_path, &new_stamp), retcode::SUCCESS);
+  EXPECT_NE(new_stamp, stamp);
+  EXPECT_EQ(cache.Get(file_path + "|" + new_stamp), nullptr);
+}
+}  // namespace primihub
@@ -0,0 +1,195 @@
+// "Copyright [2023] <PrimiHub>"
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <arrow/api.h>
+#include "gtest/gtest.h"
+#include "src/primihub/data_store/csv/csv_driver.h"
+#include "src/primihub/data_store/sqlite/sqlite_driver.h"
+
+namespace primihub {
+namespace fs = std::filesystem;
+namespace {
+using FieldSchema = std::vector<std::tuple<std::string, int>>;
+
+FieldSchema IdNameSchema() {
+  return {std::make_tuple("id", arrow::Type::type::INT64),
+          std::make_tuple("name", arrow::Type::type::STRING)};
+}
+
+std::shared_ptr<DataDriver> MakeCsvDriver(const std::string& file_path) {
+  DatasetMetaInfo meta_info;
+  meta_info.id = "csv_dataset";
+  meta_info.driver_type = "CSV";
+  meta_info.access_info = file_path;
+  meta_info.schema = IdNameSchema();
+  auto access_info = std::make_unique<CSVAccessInfo>();
+  EXPECT_EQ(access_info->FromMetaInfo(meta_info), retcode::SUCCESS);
+  return std::make_shared<CSVDriver>("test address", std::move(access_info));
+}
+
+std::shared_ptr<DataDriver> MakeSQLiteDriver(const std::string& db_path,
+                                             const std::string& table_name) {
+  DatasetMetaInfo meta_info;
+  meta_info.id = "sqlite_dataset";
+  meta_info.driver_type = "SQLITE";
+  meta_info.access_info =
+      R"({"db_path": ")" + db_path + R"(", "tableName": ")" + table_name + R"("})";
+  meta_info.schema = IdNameSchema();
+  auto access_info = std::make_unique<SQLiteAccessInfo>();
+  EXPECT_EQ(access_info->FromMetaInfo(meta_info), retcode::SUCCESS);
+  return std::make_shared<SQLiteDriver>("test address", std::move(access_info));
+}
+
+void WriteCsv(const std::string& file_path, int64_t num_rows) {
+  std::ofstream out(file_path);
+  out << "id,name\n";
+  for (int64_t i = 0; i < num_rows; i++) {
+    out << i << ",name_" << i << "\n";
+  }
+}
+
+void CreateSQLiteTable(const std::string& db_path,
+                       const std::string& table_name, int64_t num_rows) {
+  SQLite::Database db(db_path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+  db.exec("CREATE TABLE " + table_name + " (id INTEGER, name TEXT)");
+  SQLite::Transaction transaction(db);
+  SQLite::Statement insert(db, "INSERT INTO " + table_name + " VALUES (?, ?)");
+  for (int64_t i = 0; i < num_rows; i++) {
+    insert.bind(1, static_cast<int64_t>(i));
+    insert.bind(2, "name_" + std::to_string(i));
+    insert.exec();
+    insert.reset();
+  }
+  transaction.commit();
+}
+
+/**
+ * read all batches of cursor, check rows are returned in order and
+ * no batch is larger than batch_size, return number of rows read
+*/
+int64_t ReadAllBatches(Cursor* cursor, int64_t batch_size,
+                       std::vector<int64_t>* batch_rows) {
+  int64_t expected_id{0};
+  while (true) {
+    std::shared_ptr<arrow::RecordBatch> batch;
+    EXPECT_EQ(cursor->ReadNextBatch(batch_size, &batch), retcode::SUCCESS);
+    if (batch == nullptr) {
+      break;
+    }
+    EXPECT_LE(batch->num_rows(), batch_size);
+    EXPECT_GT(batch->num_rows(), 0);
+    auto ids = std::static_pointer_cast<arrow::Int64Array>(batch->column(0));
+    for (int64_t i = 0; i < ids->length(); i++) {
+      EXPECT_EQ(ids->Value(i), expected_id++);
+    }
+    batch_rows->push_back(batch->num_rows());
+  }
+  return expected_id;
+}
+
+class DriverTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    data_dir_ = (fs::temp_directory_path() /
+        ("driver_test_" + std::to_string(::getpid()))).string();
+    fs::remove_all(data_dir_);
+    fs::create_directories(data_dir_);
+  }
+  void TearDown() override {
+    fs::remove_all(data_dir_);
+  }
+  std::string data_dir_;
+};
+}  // namespace
+
+TEST_F(DriverTest, CsvReadNextBatchAcrossBlocks) {
+  // larger than the block parsed by csv reader at once
+  int64_t num_rows = 200000;
+  auto file_path = data_dir_ + "/data.csv";
+  WriteCsv(file_path, num_rows);
+  ASSERT_GT(fs::file_size(file_path), 2 * 1024 * 1024);
+  auto driver = MakeCsvDriver(file_path);
+  auto cursor = driver->GetCursor();
+  ASSERT_NE(cursor, nullptr);
+  std::vector<int64_t> batch_rows;
+  EXPECT_EQ(ReadAllBatches(cursor.get(), 7000, &batch_rows), num_rows);
+  EXPECT_GE(batch_rows.size(), static_cast<size_t>(num_rows / 7000));
+  // read after end of data
+  std::shared_ptr<arrow::RecordBatch> batch;
+  EXPECT_EQ(cursor->ReadNextBatch(7000, &batch), retcode::SUCCESS);
+  EXPECT_EQ(batch, nullptr);
+}
+
+TEST_F(DriverTest, CsvReadNextBatchWithSchema) {
+  auto file_path = data_dir_ + "/data.csv";
+  WriteCsv(file_path, 10);
+  auto driver = MakeCsvDriver(file_path);
+  auto cursor = driver->GetCursor();
+  ASSERT_NE(cursor, nullptr);
+  cursor->SetBatchSchema({std::make_tuple("id", arrow::Type::type::STRING),
+                          std::make_tuple("name", arrow::Type::type::STRING)});
+  std::shared_ptr<arrow::RecordBatch> batch;
+  ASSERT_EQ(cursor->ReadNextBatch(100, &batch), retcode::SUCCESS);
+  ASSERT_NE(batch, nullptr);
+  EXPECT_EQ(batch->num_rows(), 10);
+  ASSERT_EQ(batch->column(0)->type_id(), arrow::Type::type::STRING);
+  auto ids = std::static_pointer_cast<arrow::StringArray>(batch->column(0));
+  EXPECT_EQ(ids->GetString(9), "9");
+}
+
+TEST_F(DriverTest, CsvEmptyTable) {
+  auto file_path = data_dir_ + "/empty.csv";
+  WriteCsv(file_path, 0);
+  auto driver = MakeCsvDriver(file_path);
+  auto cursor = driver->GetCursor();
+  ASSERT_NE(cursor, nullptr);
+  std::shared_ptr<arrow::RecordBatch> batch;
+  EXPECT_EQ(cursor->ReadNextBatch(100, &batch), retcode::SUCCESS);
+  EXPECT_EQ(batch, nullptr);
+}
+
+TEST_F(DriverTest, SQLiteReadWithOffsetAndLimit) {
+  auto db_path = data_dir_ + "/data.db";
+  CreateSQLiteTable(db_path, "test_table", 1000);
+  auto driver = MakeSQLiteDriver(db_path, "test_table");
+  auto cursor = driver->GetCursor();
+  ASSERT_NE(cursor, nullptr);
+  auto dataset = cursor->read(10, 5);
+  ASSERT_NE(dataset, nullptr);
+  auto& table = std::get<std::shared_ptr<arrow::Table>>(dataset->data);
+  ASSERT_EQ(table->num_rows(), 5);
+  auto ids = std::static_pointer_cast<arrow::Int64Array>(
+      table->column(0)->chunk(0));
+  EXPECT_EQ(ids->Value(0), 10);
+  EXPECT_EQ(ids->Value(4), 14);
+}
+
+TEST_F(DriverTest, SQLiteReadNextBatch) {
+  auto db_path = data_dir_ + "/data.db";
+  CreateSQLiteTable(db_path, "test_table", 1000);
+  auto driver = MakeSQLiteDriver(db_path, "test_table");
+  auto cursor = driver->GetCursor();
+  ASSERT_NE(cursor, nullptr);
+  std::vector<int64_t> batch_rows;
+  EXPECT_EQ(ReadAllBatches(cursor.get(), 300, &batch_rows), 1000);
+  EXPECT_EQ(batch_rows, std::vector<int64_t>({300, 300, 300, 100}));
+}
+
+TEST_F(DriverTest, SQLiteEmptyTable) {
+  auto db_path = data_dir_ + "/data.db";
+  CreateSQLiteTable(db_path, "empty_table", 0);
+  auto driver = MakeSQLiteDriver(db_path, "empty_table");
+  auto cursor = driver->GetCursor();
+  ASSERT_NE(cursor, nullptr);
+  std::shared_ptr<arrow::RecordBatch> batch;
+  EXPECT_EQ(cursor->ReadNextBatch(100, &batch), retcode::SUCCESS);
+  EXPECT_EQ(batch, nullptr);
+}
+}  // namespace primihub
@@ -0,0 +1,116 @@
+// "Copyright [2023] <PrimiHub>"
+#include <glog/logging.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "private_set_intersection/cpp/psi_client.h"
+#include "private_set_intersection/cpp/psi_server.h"
+#include "src/primihub/kernel/psi/operator/ecdh_parallel.h"
+#include "src/primihub/util/util.h"
+
+namespace primihub::psi {
+namespace openminded_psi = private_set_intersection;
+namespace {
+constexpr size_t kClientElementNum = 64 * 1024;
+constexpr size_t kServerElementNum = 64 * 1024;
+
+void BuildDataset(std::vector<std::string>* client_data,
+                  std::vector<std::string>* server_data,
+                  std::vector<int64_t>* expected) {
+  // every third client element is in server set
+  for (size_t i = 0; i < kClientElementNum; i++) {
+    if (i % 3 == 0) {
+      client_data->push_back("common_" + std::to_string(i));
+      expected->push_back(i);
+    } else {
+      client_data->push_back("client_" + std::to_string(i));
+    }
+  }
+  for (size_t i = 0; server_data->size() < kServerElementNum; i++) {
+    if (i % 3 == 0 && i < kClientElementNum) {
+      server_data->push_back("common_" + std::to_string(i));
+    } else {
+      server_data->push_back("server_" + std::to_string(i));
+    }
+  }
+}
+}  // namespace
+
+TEST(EcdhParallelTest, ScaleWithWorkerNum) {
+  std::vector<std::string> client_data;
+  std::vector<std::string> server_data;
+  std::vector<int64_t> expected;
+  BuildDataset(&client_data, &server_data, &expected);
+  bool reveal_intersection{true};
+  auto client = openminded_psi::PsiClient::CreateWithNewKey(
+      reveal_intersection).value();
+  auto server = openminded_psi::PsiServer::CreateWithNewKey(
+      reveal_intersection).value();
+  auto client_key = client->GetPrivateKeyBytes();
+  auto server_key = server->GetPrivateKeyBytes();
+  auto server_setup = server->CreateSetupMessage(
+      0.000001, client_data.size(), server_data).value();
+
+  size_t max_worker_num = std::max<size_t>(
+      std::thread::hardware_concurrency(), 1);
+  psi_proto::Request base_request;
+  for (size_t worker_num = 1; worker_num <= max_worker_num; worker_num *= 2) {
+    EcdhParallelExecutor executor(worker_num);
+    SCopedTimer timer;
+    psi_proto::Request request;
+    auto ret = executor.CreateRequest(client_key, reveal_intersection,
+                                      absl::MakeConstSpan(client_data),
+                                      &request);
+    ASSERT_EQ(ret, retcode::SUCCESS);
+    auto create_request_ts = timer.timeElapse();
+    psi_proto::Response response;
+    ret = executor.ProcessRequest(server_key, reveal_intersection,
+                                  request, &response);
+    ASSERT_EQ(ret, retcode::SUCCESS);
+    auto process_request_ts = timer.timeElapse();
+    std::vector<int64_t> intersection;
+    ret = executor.GetIntersection(client_key, reveal_intersection,
+                                   server_setup, response, &intersection);
+    ASSERT_EQ(ret, retcode::SUCCESS);
+    auto get_intersection_ts = timer.timeElapse();
+    LOG(INFO) << "worker num: " << worker_num << " "
+              << "create request(ms): " << create_request_ts << " "
+              << "process request(ms): "
+              << process_request_ts - create_request_ts << " "
+              << "get intersection(ms): "
+              << get_intersection_ts - process_request_ts;
+    // blinding is deterministic for the same key,
+    // so output must not depend on worker num
+    if (worker_num == 1) {
+      base_request = request;
+    } else {
+      ASSERT_EQ(request.encrypted_elements_size(),
+                base_request.encrypted_elements_size());
+      for (int i = 0; i < request.encrypted_elements_size(); i++) {
+        EXPECT_EQ(request.encrypted_elements(i),
+                  base_request.encrypted_elements(i));
+      }
+    }
+    EXPECT_EQ(intersection, expected);
+  }
+}
+
+TEST(EcdhParallelTest, StopFlag) {
+  std::vector<std::string> client_data;
+  std::vector<std::string> server_data;
+  std::vector<int64_t> expected;
+  BuildDataset(&client_data, &server_data, &expected);
+  auto client = openminded_psi::PsiClient::CreateWithNewKey(true).value();
+  std::atomic<bool> stop_flag{true};
+  EcdhParallelExecutor executor(2, &stop_flag);
+  psi_proto::Request request;
+  auto ret = executor.CreateRequest(client->GetPrivateKeyBytes(), true,
+                                    absl::MakeConstSpan(client_data),
+                                    &request);
+  EXPECT_EQ(ret, retcode::FAIL);
+}
+}  // namespace primihub::psi
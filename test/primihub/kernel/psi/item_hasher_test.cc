@@ -0,0 +1,67 @@
+// "Copyright [2023] <PrimiHub>"
+#include <glog/logging.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/primihub/kernel/psi/operator/item_hasher.h"
+#include "src/primihub/util/util.h"
+
+namespace primihub::psi {
+namespace {
+std::vector<std::string> BuildItems(size_t item_num) {
+  std::vector<std::string> items;
+  items.reserve(item_num);
+  for (size_t i = 0; i < item_num; i++) {
+    if (i % 2 == 0) {
+      items.push_back(std::to_string(i));
+    } else {
+      items.push_back("long_item_with_more_than_16_bytes_" + std::to_string(i));
+    }
+  }
+  return items;
+}
+}  // namespace
+
+TEST(ItemHasherTest, SameResultForAnyWorkerNum) {
+  auto items = BuildItems(1000000);
+  std::vector<oc::block> base_result;
+  size_t max_worker_num = std::max<size_t>(
+      std::thread::hardware_concurrency(), 1);
+  for (size_t worker_num = 1; worker_num <= max_worker_num; worker_num *= 2) {
+    std::vector<oc::block> result;
+    SCopedTimer timer;
+    auto ret = ItemHasher(worker_num).HashItems(items, &result);
+    ASSERT_EQ(ret, retcode::SUCCESS);
+    LOG(INFO) << "worker num: " << worker_num << " "
+              << "hash " << items.size() << " items "
+              << "time cost(ms): " << timer.timeElapse();
+    ASSERT_EQ(result.size(), items.size());
+    if (worker_num == 1) {
+      base_result = std::move(result);
+      continue;
+    }
+    for (size_t i = 0; i < items.size(); i++) {
+      EXPECT_TRUE(result[i] == base_result[i]);
+    }
+  }
+}
+
+TEST(ItemHasherTest, NoCollisionForPaddedItems) {
+  // items differ only in trailing zero bytes must not collide
+  std::vector<std::string> items{"", std::string(1, '\0'),
+                                 "a", std::string("a\0", 2),
+                                 std::string(15, 'a'), std::string(16, 'a')};
+  std::vector<oc::block> result;
+  auto ret = ItemHasher(1).HashItems(items, &result);
+  ASSERT_EQ(ret, retcode::SUCCESS);
+  for (size_t i = 0; i < result.size(); i++) {
+    for (size_t j = i + 1; j < result.size(); j++) {
+      EXPECT_FALSE(result[i] == result[j]) << "item " << i << " " << j;
+    }
+  }
+}
+}  // namespace primihub::psi
@@ -0,0 +1,131 @@
+// "Copyright [2023] <PrimiHub>"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/primihub/service/dataset/service.h"
+#include "src/primihub/service/dataset/meta_service/interface.h"
+
+namespace primihub::service {
+namespace {
+/**
+ * meta service which knows no dataset and counts GetMeta calls
+*/
+class CountingMetaService : public DatasetMetaService {
+ public:
+  explicit CountingMetaService(std::atomic<int>* get_meta_count)
+      : get_meta_count_(get_meta_count) {}
+  retcode PutMeta(const DatasetMeta& meta) override {
+    return retcode::SUCCESS;
+  }
+  retcode GetMeta(const DatasetId& id, FoundMetaHandler handler) override {
+    get_meta_count_->fetch_add(1);
+    return handler(nullptr);
+  }
+  retcode FindPeerListFromDatasets(
+      const std::vector<DatasetWithParamTag>& datasets_with_tag,
+      FoundMetaListHandler handler) override {
+    return retcode::SUCCESS;
+  }
+  retcode GetAllMetas(std::vector<DatasetMeta>* metas) override {
+    return retcode::SUCCESS;
+  }
+
+ protected:
+  std::atomic<int>* get_meta_count_;
+};
+
+/**
+ * meta service which knows every dataset and counts GetMeta calls
+*/
+class FoundMetaService : public CountingMetaService {
+ public:
+  explicit FoundMetaService(std::atomic<int>* get_meta_count)
+      : CountingMetaService(get_meta_count) {}
+  retcode GetMeta(const DatasetId& id, FoundMetaHandler handler) override {
+    get_meta_count_->fetch_add(1);
+    auto meta = std::make_shared<DatasetMeta>();
+    meta->SetDatasetId(id);
+    meta->SetDriverType("csv");
+    meta->SetAccessInfo("access_info_v" +
+                        std::to_string(get_meta_count_->load()));
+    std::vector<FieldType> fields{
+        std::make_tuple("id", static_cast<int>(arrow::Type::INT64))};
+    meta->SetDataSchema(fields);
+    return handler(meta);
+  }
+};
+
+/**
+ * expose meta cache operations to test
+*/
+class TestDatasetService : public DatasetService {
+ public:
+  using DatasetService::DatasetService;
+  using DatasetService::GetMetaInfo;
+  using DatasetService::PutMeta;
+};
+}  // namespace
+
+TEST(DatasetMetaCacheTest, NegativeCacheAndInvalidation) {
+  std::atomic<int> get_meta_count{0};
+  DatasetService service(
+      std::make_unique<CountingMetaService>(&get_meta_count));
+  service.SetMetaCacheTTL(60000, 60000);
+  EXPECT_EQ(service.getDriver("missing_dataset"), nullptr);
+  EXPECT_EQ(service.getDriver("missing_dataset"), nullptr);
+  EXPECT_EQ(get_meta_count.load(), 1);
+  auto stat = service.MetaCacheStat();
+  EXPECT_EQ(stat.hit_count, 1);
+  EXPECT_EQ(stat.miss_count, 1);
+
+  service.InvalidateMetaCache("missing_dataset");
+  EXPECT_EQ(service.getDriver("missing_dataset"), nullptr);
+  EXPECT_EQ(get_meta_count.load(), 2);
+}
+
+TEST(DatasetMetaCacheTest, CacheDisabled) {
+  std::atomic<int> get_meta_count{0};
+  DatasetService service(
+      std::make_unique<CountingMetaService>(&get_meta_count));
+  service.SetMetaCacheTTL(0, 0);
+  EXPECT_EQ(service.getDriver("missing_dataset"), nullptr);
+  EXPECT_EQ(service.getDriver("missing_dataset"), nullptr);
+  EXPECT_EQ(get_meta_count.load(), 2);
+}
+TEST(DatasetMetaCacheTest, PositiveCacheAndInvalidation) {
+  std::atomic<int> get_meta_count{0};
+  TestDatasetService service(
+      std::make_unique<FoundMetaService>(&get_meta_count));
+  service.SetMetaCacheTTL(60000, 60000);
+  DatasetMetaInfo meta_info;
+  ASSERT_EQ(service.GetMetaInfo("dataset", &meta_info), retcode::SUCCESS);
+  EXPECT_EQ(meta_info.access_info, "access_info_v1");
+  ASSERT_EQ(service.GetMetaInfo("dataset", &meta_info), retcode::SUCCESS);
+  EXPECT_EQ(meta_info.id, "dataset");
+  EXPECT_EQ(meta_info.driver_type, "csv");
+  EXPECT_EQ(meta_info.access_info, "access_info_v1");
+  EXPECT_EQ(get_meta_count.load(), 1);
+  auto stat = service.MetaCacheStat();
+  EXPECT_EQ(stat.hit_count, 1);
+  EXPECT_EQ(stat.miss_count, 1);
+  EXPECT_EQ(stat.entry_count, 1);
+
+  // meta published by PutMeta is fetched again
+  DatasetMeta meta;
+  meta.SetDatasetId("dataset");
+  service.PutMeta(meta);
+  ASSERT_EQ(service.GetMetaInfo("dataset", &meta_info), retcode::SUCCESS);
+  EXPECT_EQ(meta_info.access_info, "access_info_v2");
+  EXPECT_EQ(get_meta_count.load(), 2);
+
+  service.InvalidateMetaCache("dataset");
+  EXPECT_EQ(service.MetaCacheStat().entry_count, 0);
+  ASSERT_EQ(service.GetMetaInfo("dataset", &meta_info), retcode::SUCCESS);
+  EXPECT_EQ(meta_info.access_info, "access_info_v3");
+  ASSERT_EQ(service.GetMetaInfo("dataset", &meta_info), retcode::SUCCESS);
+  EXPECT_EQ(get_meta_count.load(), 3);
+}
+}  // namespace primihub::service
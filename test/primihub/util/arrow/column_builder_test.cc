@@ -0,0 +1,109 @@
+// "Copyright [2023] <PrimiHub>"
+#include <glog/logging.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/primihub/util/arrow_wrapper_util.h"
+#include "src/primihub/util/util.h"
+
+namespace primihub::arrow_wrapper::util {
+namespace {
+constexpr size_t kRowNum = 1000 * 1000;
+const std::vector<int> kFieldTypes = {
+  arrow::Type::type::INT64,
+  arrow::Type::type::INT32,
+  arrow::Type::type::DOUBLE,
+  arrow::Type::type::STRING,
+};
+
+/**
+ * rows as returned by mysql_fetch_row, empty cell is NULL
+*/
+void BuildRows(std::vector<std::vector<std::string>>* rows) {
+  rows->resize(kRowNum);
+  for (size_t i = 0; i < kRowNum; i++) {
+    auto& row = (*rows)[i];
+    row.push_back(std::to_string(i));
+    row.push_back(i % 10 == 0 ? "" : std::to_string(i % 1000));
+    row.push_back(std::to_string(i * 0.25));
+    row.push_back(i % 10 == 0 ? "" : "name_" + std::to_string(i));
+  }
+}
+}  // namespace
+
+TEST(ArrowColumnBuilderTest, CompareWithStringPath) {
+  std::vector<std::vector<std::string>> rows;
+  BuildRows(&rows);
+  size_t num_fields = kFieldTypes.size();
+
+  // string path: materialize every cell, then convert column by column
+  SCopedTimer timer;
+  std::vector<std::vector<std::string>> columns(num_fields);
+  for (const auto& row : rows) {
+    for (size_t i = 0; i < num_fields; i++) {
+      std::string item{"NA"};
+      if (!row[i].empty()) {
+        item = std::string(row[i].data(), row[i].size());
+      }
+      columns[i].push_back(item);
+    }
+  }
+  std::vector<std::shared_ptr<arrow::Array>> expected;
+  for (size_t i = 0; i < num_fields; i++) {
+    expected.push_back(MakeArrowArray(kFieldTypes[i], columns[i]));
+  }
+  auto string_path_ms = timer.timeElapse();
+
+  // builder path: append cells to typed builders directly
+  std::vector<ArrowColumnBuilder> builders;
+  for (const auto field_type : kFieldTypes) {
+    builders.emplace_back(field_type);
+  }
+  for (const auto& row : rows) {
+    for (size_t i = 0; i < num_fields; i++) {
+      ASSERT_EQ(builders[i].Append(row[i].data(), row[i].size()),
+                retcode::SUCCESS);
+    }
+  }
+  std::vector<std::shared_ptr<arrow::Array>> result;
+  for (auto& builder : builders) {
+    std::shared_ptr<arrow::Array> array;
+    ASSERT_EQ(builder.Finish(&array), retcode::SUCCESS);
+    result.push_back(array);
+  }
+  auto builder_path_ms = timer.timeElapse() - string_path_ms;
+  LOG(INFO) << "rows: " << kRowNum << " "
+            << "string path rows/sec: "
+            << kRowNum * 1000 / std::max<int64_t>(string_path_ms, 1) << " "
+            << "builder path rows/sec: "
+            << kRowNum * 1000 / std::max<int64_t>(builder_path_ms, 1);
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < num_fields; i++) {
+    EXPECT_TRUE(result[i]->Equals(expected[i])) << "column: " << i;
+  }
+}
+
+TEST(ArrowColumnBuilderTest, InvalidValue) {
+  ArrowColumnBuilder int_builder(arrow::Type::type::INT64);
+  ArrowColumnBuilder double_builder(arrow::Type::type::DOUBLE);
+  std::string invalid{"abc"};
+  std::string large{"12345678901234"};
+  ASSERT_EQ(int_builder.Append(invalid.data(), invalid.size()),
+            retcode::SUCCESS);
+  ASSERT_EQ(int_builder.Append(large.data(), large.size()), retcode::SUCCESS);
+  ASSERT_EQ(double_builder.Append(nullptr, 0), retcode::SUCCESS);
+  std::shared_ptr<arrow::Array> int_array;
+  std::shared_ptr<arrow::Array> double_array;
+  ASSERT_EQ(int_builder.Finish(&int_array), retcode::SUCCESS);
+  ASSERT_EQ(double_builder.Finish(&double_array), retcode::SUCCESS);
+  auto int_values = std::static_pointer_cast<arrow::Int64Array>(int_array);
+  EXPECT_EQ(int_values->Value(0), 0);
+  EXPECT_EQ(int_values->Value(1), 12345678901234);
+  auto double_values =
+      std::static_pointer_cast<arrow::DoubleArray>(double_array);
+  EXPECT_EQ(double_values->Value(0), 0.0);
+}
+}  // namespace primihub::arrow_wrapper::util
@@ -0,0 +1,113 @@
+// Copyright [2023] <primihub.com>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "src/primihub/util/lockfree_queue.h"
+
+using primihub::LockFreeQueue;
+
+TEST(LockFreeQueueTest, fifo_across_overflow) {
+  LockFreeQueue<std::string> queue(4);
+  EXPECT_EQ(queue.capacity(), 4);
+  for (int i = 0; i < 100; i++) {
+    queue.push(std::to_string(i));
+  }
+  EXPECT_EQ(queue.size(), 100);
+  // ring is full while overflow is not empty, push goes to overflow
+  EXPECT_FALSE(queue.try_push(std::string("full")));
+  for (int i = 0; i < 100; i++) {
+    std::string item;
+    ASSERT_TRUE(queue.try_pop(item));
+    EXPECT_EQ(item, std::to_string(i));
+    // new item is taken after overflow is drained
+    queue.push(std::to_string(100 + i));
+  }
+  for (int i = 100; i < 200; i++) {
+    std::string item;
+    ASSERT_TRUE(queue.try_pop(item));
+    EXPECT_EQ(item, std::to_string(i));
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(LockFreeQueueTest, backpressure_and_timeout) {
+  LockFreeQueue<int> queue(2);
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_FALSE(queue.try_push(3));
+  EXPECT_FALSE(queue.wait_for_push(3, 10));
+  auto consumer = std::async(std::launch::async, [&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return queue.pop();
+  });
+  EXPECT_TRUE(queue.wait_for_push(3, 10 * 1000));
+  EXPECT_EQ(consumer.get(), 1);
+  int item{0};
+  EXPECT_TRUE(queue.wait_for_and_pop(item, 10));
+  EXPECT_EQ(item, 2);
+  EXPECT_TRUE(queue.wait_for_and_pop(item, 10));
+  EXPECT_EQ(item, 3);
+  EXPECT_FALSE(queue.wait_for_and_pop(item, 10));
+}
+
+TEST(LockFreeQueueTest, shutdown_wakes_all_waiters) {
+  LockFreeQueue<int> queue;
+  std::vector<std::future<bool>> waiters;
+  for (int i = 0; i < 4; i++) {
+    waiters.push_back(std::async(std::launch::async, [&]() {
+      int item{0};
+      return queue.wait_for_and_pop(item, 10 * 1000);
+    }));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  queue.shutdown();
+  for (auto& waiter : waiters) {
+    EXPECT_FALSE(waiter.get());
+  }
+  EXPECT_TRUE(queue.is_shutdown());
+}
+
+TEST(LockFreeQueueTest, multi_producer_multi_consumer) {
+  constexpr int kProducers = 4;
+  constexpr int kItems = 20000;
+  LockFreeQueue<int> queue(64);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < kItems; i++) {
+        queue.push(p * kItems + i);
+      }
+    });
+  }
+  std::vector<std::future<std::vector<int>>> consumers;
+  for (int c = 0; c < 2; c++) {
+    consumers.push_back(std::async(std::launch::async, [&]() {
+      std::vector<int> items;
+      int item{0};
+      while (queue.wait_for_and_pop(item, 200)) {
+        items.push_back(item);
+      }
+      return items;
+    }));
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  std::vector<int> count(kProducers * kItems, 0);
+  for (auto& consumer : consumers) {
+    auto items = consumer.get();
+    // items of one producer keep their order in each consumer
+    std::vector<int> last(kProducers, -1);
+    for (auto item : items) {
+      EXPECT_GT(item, last[item / kItems]);
+      last[item / kItems] = item;
+      count[item]++;
+    }
+  }
+  for (auto c : count) {
+    ASSERT_EQ(c, 1);
+  }
+}
@@ -0,0 +1,83 @@
+// Copyright [2023] <primihub.com>
+#include <string>
+#include "gtest/gtest.h"
+#include "src/primihub/util/network/compressor.h"
+
+using primihub::retcode;
+using primihub::network::CompressMode;
+using primihub::network::CompressOption;
+using primihub::network::Compressor;
+
+namespace {
+std::string BuildTestData() {
+  std::string data;
+  for (int i = 0; i < 10000; i++) {
+    data.append(std::to_string(i % 100)).append("####");
+  }
+  return data;
+}
+
+void CompressRoundTrip(CompressMode mode) {
+  std::string raw_data = BuildTestData();
+  CompressOption option;
+  option.mode = mode;
+  std::string compressed_data;
+  auto ret = Compressor::Compress(option, raw_data, &compressed_data);
+  EXPECT_EQ(ret, retcode::SUCCESS);
+  EXPECT_LT(compressed_data.size(), raw_data.size());
+  std::string decompressed_data;
+  ret = Compressor::Decompress(mode, compressed_data,
+                               raw_data.size(), &decompressed_data);
+  EXPECT_EQ(ret, retcode::SUCCESS);
+  EXPECT_EQ(decompressed_data, raw_data);
+}
+}  // namespace
+
+TEST(CompressorTest, zstd_round_trip) {
+  CompressRoundTrip(CompressMode::ZSTD);
+}
+
+TEST(CompressorTest, lz4_round_trip) {
+  CompressRoundTrip(CompressMode::LZ4);
+}
+
+TEST(CompressorTest, decompress_length_mismatch) {
+  std::string raw_data = BuildTestData();
+  CompressOption option;
+  option.mode = CompressMode::ZSTD;
+  std::string compressed_data;
+  Compressor::Compress(option, raw_data, &compressed_data);
+  std::string decompressed_data;
+  auto ret = Compressor::Decompress(CompressMode::ZSTD, compressed_data,
+                                    raw_data.size() - 1, &decompressed_data);
+  EXPECT_EQ(ret, retcode::FAIL);
+}
+
+TEST(CompressorTest, decompress_length_exceeds_limit) {
+  std::string raw_data = BuildTestData();
+  for (auto mode : {CompressMode::ZSTD, CompressMode::LZ4}) {
+    CompressOption option;
+    option.mode = mode;
+    std::string compressed_data;
+    Compressor::Compress(option, raw_data, &compressed_data);
+    std::string decompressed_data;
+    // length claimed by peer is larger than the configured max size
+    auto ret = Compressor::Decompress(mode, compressed_data, raw_data.size(),
+                                      &decompressed_data, raw_data.size() - 1);
+    EXPECT_EQ(ret, retcode::FAIL);
+    // length claimed by peer can not be produced by compressed data
+    ret = Compressor::Decompress(mode, compressed_data,
+                                 compressed_data.size() * 1000,
+                                 &decompressed_data);
+    EXPECT_EQ(ret, retcode::FAIL);
+    EXPECT_LT(decompressed_data.capacity(), raw_data.size());
+  }
+}
+
+TEST(CompressorTest, supported_modes) {
+  auto modes = Compressor::SupportedModes();
+  EXPECT_TRUE(Compressor::IsSupported(modes, CompressMode::ZSTD));
+  EXPECT_TRUE(Compressor::IsSupported(modes, CompressMode::LZ4));
+  EXPECT_EQ(Compressor::StrToMode("zstd"), CompressMode::ZSTD);
+  EXPECT_EQ(Compressor::StrToMode("unknown"), CompressMode::NONE);
+}
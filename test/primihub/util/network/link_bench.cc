@@ -0,0 +1,532 @@
+// Copyright [2023] <primihub.com>
+/**
+ * latency and throughput benchmark of LinkContext transports on loopback.
+ * two bench nodes serve the data rpcs of VMNode (Send, DataStream,
+ * ForwardRecv, SubscribeRecv) by VMNodeInterface and VMNodeImpl,
+ * a stub worker whose task only owns a link context is registered on
+ * each node for every transport, and two parties exchange messages
+ * through them:
+ *   memory:        SimpleMemoryChannel, baseline without network
+ *   grpc:          GrpcChannel::send to peer node, received from the
+ *                  node recv queue directly like an in-process task
+ *   forward:       GrpcChannel::send, received by forwardRecv from proxy
+ *   mpc:           MPCTaskChannel, received by subscription of proxy
+ *   msg_interface: TaskMessagePassInterface through oc::Channel
+ * patterns:
+ *   pingpong: round trip of one message, latency percentiles
+ *   stream:   back-to-back messages from one party, throughput
+ * usage:
+ *   link_bench --config=config/node0.yaml --transport=all --pattern=all
+ *              --min_size=8 --max_size=1073741824
+ *   link_bench --use_tls --root_ca=... --key=... --cert=...
+ */
+#include <glog/logging.h>
+#include <grpcpp/grpcpp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_split.h"
+#include "cryptoTools/Network/Channel.h"
+#include "cryptoTools/Network/IOService.h"
+#include "src/primihub/common/common.h"
+#include "src/primihub/node/node_impl.h"
+#include "src/primihub/node/node_interface.h"
+#include "src/primihub/node/server_config.h"
+#include "src/primihub/node/worker/worker.h"
+#include "src/primihub/protos/worker.grpc.pb.h"
+#include "src/primihub/service/dataset/meta_service/factory.h"
+#include "src/primihub/service/dataset/service.h"
+#include "src/primihub/task/semantic/task.h"
+#include "src/primihub/util/network/grpc_link_context.h"
+#include "src/primihub/util/network/mem_channel.h"
+#include "src/primihub/util/network/message_interface.h"
+#include "src/primihub/util/network/mpc_channel.h"
+
+ABSL_FLAG(std::string, transport, "all",
+          "comma separated: memory,grpc,forward,mpc,msg_interface or all");
+ABSL_FLAG(std::string, pattern, "all", "comma separated: pingpong,stream or all");
+ABSL_FLAG(uint64_t, min_size, 8, "min message size in bytes");
+ABSL_FLAG(uint64_t, max_size, 64 * 1024 * 1024, "max message size in bytes");
+ABSL_FLAG(uint64_t, size_step, 8, "message size is multiplied by step");
+ABSL_FLAG(uint64_t, rounds, 200, "max messages for each size");
+ABSL_FLAG(uint64_t, bytes_per_case, 256 * 1024 * 1024,
+          "messages of each size are limited to this volume, at least 2");
+ABSL_FLAG(std::string, config, "config/node0.yaml",
+          "node config used by both bench nodes");
+ABSL_FLAG(int32_t, port, 50150, "port of first bench node, second uses port+1");
+ABSL_FLAG(bool, use_tls, false, "use tls between parties and nodes");
+ABSL_FLAG(std::string, root_ca, "data/cert/ca.crt", "root ca for tls");
+ABSL_FLAG(std::string, key, "data/cert/node0.key", "private key for tls");
+ABSL_FLAG(std::string, cert, "data/cert/node0.crt", "certificate for tls");
+
+namespace primihub::network {
+namespace {
+// node id referenced by stub workers, lives as long as the process
+const std::string kBenchNodeId = "bench_node";  // NOLINT
+
+/**
+ * VMNodeImpl with stub workers, the task of a stub worker executes
+ * nothing and only owns the link context its data is delivered to,
+ * like a task executed in thread mode
+ */
+class BenchNodeImpl : public VMNodeImpl {
+ public:
+  using VMNodeImpl::VMNodeImpl;
+
+  LinkContext* AddStubWorker(const std::string& request_id) {
+    auto task = std::make_shared<task::TaskBase>();
+    task->setTaskInfo(kBenchNodeId, "bench_job", "bench_task", request_id,
+                      "0");
+    auto worker = std::make_shared<Worker>(kBenchNodeId, request_id,
+                                           GetNodelet());
+    worker->AttachTask(task);
+    ExecuteAddTaskOperation(std::make_tuple(request_id,
+        std::make_tuple(std::move(worker), std::future<void>()),
+        OperateTaskType::kAdd));
+    stub_tasks_.push_back(task);
+    return task->getTaskContext().getLinkContext().get();
+  }
+
+  /**
+   * release rpc handlers blocked on recv queues of stub workers
+   */
+  void StopStubWorkers() {
+    for (auto& task : stub_tasks_) {
+      task->kill_task();
+    }
+  }
+
+ private:
+  std::vector<std::shared_ptr<task::TaskBase>> stub_tasks_;
+};
+
+/**
+ * grpc server of VMNodeInterface over BenchNodeImpl
+ */
+class BenchNode {
+ public:
+  BenchNode(const Node& node, common::CertificateConfig* cert_config)
+      : node_(node), cert_config_(cert_config) {}
+
+  retcode Start(const std::string& config_file,
+                std::shared_ptr<service::DatasetService> dataset_service) {
+    auto node_impl = std::make_unique<BenchNodeImpl>(config_file,
+                                                     dataset_service);
+    node_impl_ = node_impl.get();
+    node_service_ = std::make_unique<VMNodeInterface>(std::move(node_impl));
+    std::string address = node_.ip_ + ":" + std::to_string(node_.port_);
+    std::shared_ptr<grpc::ServerCredentials> creds{nullptr};
+    if (node_.use_tls_) {
+      grpc::SslServerCredentialsOptions ssl_opts(
+          GRPC_SSL_REQUEST_AND_REQUIRE_CLIENT_CERTIFICATE_AND_VERIFY);
+      ssl_opts.pem_root_certs = cert_config_->rootCAContent();
+      ssl_opts.pem_key_cert_pairs.push_back(
+          {cert_config_->keyContent(), cert_config_->certContent()});
+      creds = grpc::SslServerCredentials(ssl_opts);
+    } else {
+      creds = grpc::InsecureServerCredentials();
+    }
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(address, creds);
+    builder.RegisterService(node_service_.get());
+    builder.SetMaxReceiveMessageSize(128 * 1024 * 1024);
+    server_ = builder.BuildAndStart();
+    if (server_ == nullptr) {
+      LOG(ERROR) << "start bench node on " << address << " failed";
+      return retcode::FAIL;
+    }
+    return retcode::SUCCESS;
+  }
+
+  void Stop() {
+    if (node_impl_ != nullptr) {
+      node_impl_->StopStubWorkers();
+    }
+    if (server_ != nullptr) {
+      auto deadline = std::chrono::system_clock::now() +
+                      std::chrono::seconds(1);
+      server_->Shutdown(deadline);
+      server_->Wait();
+      server_.reset();
+    }
+    node_service_.reset();
+    node_impl_ = nullptr;
+  }
+
+  /**
+   * register worker for task with request_id,
+   * return link context of its task
+   */
+  LinkContext* AddStubWorker(const std::string& request_id) {
+    return node_impl_->AddStubWorker(request_id);
+  }
+
+ private:
+  Node node_;
+  common::CertificateConfig* cert_config_{nullptr};
+  std::unique_ptr<grpc::Server> server_{nullptr};
+  std::unique_ptr<VMNodeInterface> node_service_{nullptr};
+  BenchNodeImpl* node_impl_{nullptr};
+};
+
+/**
+ * one side of a transport, message size is known by receiver
+ */
+struct Endpoint {
+  std::function<retcode(std::string_view)> send;
+  std::function<retcode(char*, size_t)> recv;
+};
+
+struct Transport {
+  Endpoint party_a;
+  Endpoint party_b;
+  // objects kept alive while the transport is used
+  std::vector<std::shared_ptr<void>> holders;
+};
+
+class LinkBench {
+ public:
+  retcode Init() {
+    use_tls_ = absl::GetFlag(FLAGS_use_tls);
+    if (use_tls_) {
+      auto ret = cert_config_.init(absl::GetFlag(FLAGS_root_ca),
+                                   absl::GetFlag(FLAGS_key),
+                                   absl::GetFlag(FLAGS_cert));
+      if (ret != retcode::SUCCESS) {
+        LOG(ERROR) << "load certificate failed";
+        return retcode::FAIL;
+      }
+    }
+    auto config_file = absl::GetFlag(FLAGS_config);
+    auto& server_config = ServerConfig::getInstance();
+    if (server_config.initServerConfig(config_file) != retcode::SUCCESS) {
+      LOG(ERROR) << "init server config failed";
+      return retcode::FAIL;
+    }
+    Node meta_node;
+    auto meta_service = service::MetaServiceFactory::Create(
+        service::MetaServiceMode::MODE_MEMORY, meta_node);
+    auto dataset_service =
+        std::make_shared<service::DatasetService>(std::move(meta_service));
+    int32_t port = absl::GetFlag(FLAGS_port);
+    node_a_ = Node("127.0.0.1", port, use_tls_);
+    node_b_ = Node("127.0.0.1", port + 1, use_tls_);
+    bench_node_a_ = std::make_unique<BenchNode>(node_a_, &cert_config_);
+    bench_node_b_ = std::make_unique<BenchNode>(node_b_, &cert_config_);
+    if (bench_node_a_->Start(config_file, dataset_service) !=
+            retcode::SUCCESS ||
+        bench_node_b_->Start(config_file, dataset_service) !=
+            retcode::SUCCESS) {
+      return retcode::FAIL;
+    }
+    return retcode::SUCCESS;
+  }
+
+  void Stop() {
+    bench_node_a_->Stop();
+    bench_node_b_->Stop();
+  }
+
+  /**
+   * request id is the transport name, each transport has its own
+   * stub worker on both nodes, so data left in node queues by
+   * one transport is never consumed by the next one
+   */
+  std::unique_ptr<GrpcLinkContext> NewPartyLinkContext(
+      const std::string& request_id) {
+    auto link_ctx = std::make_unique<GrpcLinkContext>();
+    link_ctx->setTaskInfo("bench_job", "bench_task", request_id, "0");
+    if (use_tls_) {
+      link_ctx->initCertificate(cert_config_);
+    }
+    return link_ctx;
+  }
+
+  std::unique_ptr<Transport> BuildTransport(const std::string& name) {
+    auto transport = std::make_unique<Transport>();
+    if (name == "memory") {
+      auto storage = std::make_shared<StorageType>();
+      auto chl_a = std::make_shared<SimpleMemoryChannel>(
+          "bench_job", "bench_task", "bench_request", "A", "B", storage);
+      auto chl_b = std::make_shared<SimpleMemoryChannel>(
+          "bench_job", "bench_task", "bench_request", "B", "A", storage);
+      transport->party_a = ChannelEndpoint(chl_a);
+      transport->party_b = ChannelEndpoint(chl_b);
+      transport->holders = {storage, chl_a, chl_b};
+      return transport;
+    }
+    auto worker_ctx_a = bench_node_a_->AddStubWorker(name);
+    auto worker_ctx_b = bench_node_b_->AddStubWorker(name);
+    std::shared_ptr<GrpcLinkContext> ctx_a = NewPartyLinkContext(name);
+    std::shared_ptr<GrpcLinkContext> ctx_b = NewPartyLinkContext(name);
+    transport->holders = {ctx_a, ctx_b};
+    if (name == "mpc") {
+      auto chl_a = std::make_shared<MPCTaskChannel>(
+          "A", "B", ctx_a.get(), ctx_a->getChannel(node_b_),
+          ctx_a->getChannel(node_a_));
+      auto chl_b = std::make_shared<MPCTaskChannel>(
+          "B", "A", ctx_b.get(), ctx_b->getChannel(node_a_),
+          ctx_b->getChannel(node_b_));
+      transport->party_a = ChannelEndpoint(chl_a);
+      transport->party_b = ChannelEndpoint(chl_b);
+      // channels first, they use link contexts
+      transport->holders.insert(transport->holders.begin(), {chl_a, chl_b});
+      return transport;
+    }
+    if (name == "msg_interface") {
+      auto ios = std::make_shared<oc::IOService>();
+      // oc::Channel takes over the interface
+      auto chl_a = std::make_shared<oc::Channel>(*ios,
+          new TaskMessagePassInterface("A", "B", ctx_a.get(),
+              ctx_a->getChannel(node_b_), ctx_a->getChannel(node_a_)));
+      auto chl_b = std::make_shared<oc::Channel>(*ios,
+          new TaskMessagePassInterface("B", "A", ctx_b.get(),
+              ctx_b->getChannel(node_a_), ctx_b->getChannel(node_b_)));
+      transport->party_a = OcChannelEndpoint(chl_a);
+      transport->party_b = OcChannelEndpoint(chl_b);
+      transport->holders.insert(transport->holders.begin(),
+                                {chl_a, chl_b, ios});
+      return transport;
+    }
+    bool forward = name == "forward";
+    if (!forward && name != "grpc") {
+      LOG(ERROR) << "unknown transport: " << name;
+      return nullptr;
+    }
+    transport->party_a = GrpcEndpoint(ctx_a.get(), name + "_A", name + "_B",
+        node_b_, node_a_, worker_ctx_a, forward);
+    transport->party_b = GrpcEndpoint(ctx_b.get(), name + "_B", name + "_A",
+        node_a_, node_b_, worker_ctx_b, forward);
+    return transport;
+  }
+
+  void Run() {
+    auto transports = ParseList(absl::GetFlag(FLAGS_transport),
+        {"memory", "grpc", "forward", "mpc", "msg_interface"});
+    auto patterns = ParseList(absl::GetFlag(FLAGS_pattern),
+                              {"pingpong", "stream"});
+    std::cout << std::left << std::setw(14) << "transport"
+              << std::setw(10) << "pattern"
+              << std::setw(12) << "size(B)"
+              << std::setw(8) << "msgs"
+              << std::setw(12) << "p50(us)"
+              << std::setw(12) << "p90(us)"
+              << std::setw(12) << "p99(us)"
+              << std::setw(12) << "max(us)"
+              << "MB/s" << std::endl;
+    for (const auto& name : transports) {
+      auto transport = BuildTransport(name);
+      if (transport == nullptr) {
+        continue;
+      }
+      for (const auto& pattern : patterns) {
+        uint64_t step = std::max<uint64_t>(absl::GetFlag(FLAGS_size_step), 2);
+        for (uint64_t size = absl::GetFlag(FLAGS_min_size);
+             size <= absl::GetFlag(FLAGS_max_size); size *= step) {
+          auto ret = RunCase(name, pattern, size, transport.get());
+          if (ret != retcode::SUCCESS) {
+            LOG(ERROR) << "transport: " << name << " pattern: " << pattern
+                       << " size: " << size << " failed";
+            break;
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  template <typename Channel>
+  static Endpoint ChannelEndpoint(std::shared_ptr<Channel> chl) {
+    Endpoint ep;
+    ep.send = [chl](std::string_view data) -> retcode {
+      return chl->SendImpl(data) == ph_link::retcode::SUCCESS ?
+          retcode::SUCCESS : retcode::FAIL;
+    };
+    ep.recv = [chl](char* buf, size_t size) -> retcode {
+      return chl->RecvImpl(buf, size) == ph_link::retcode::SUCCESS ?
+          retcode::SUCCESS : retcode::FAIL;
+    };
+    return ep;
+  }
+
+  static Endpoint OcChannelEndpoint(std::shared_ptr<oc::Channel> chl) {
+    Endpoint ep;
+    ep.send = [chl](std::string_view data) -> retcode {
+      chl->send(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+      return retcode::SUCCESS;
+    };
+    ep.recv = [chl](char* buf, size_t size) -> retcode {
+      chl->recv(reinterpret_cast<uint8_t*>(buf), size);
+      return retcode::SUCCESS;
+    };
+    return ep;
+  }
+
+  /**
+   * send to peer node, receive from the recv queue of own node directly,
+   * or by forwardRecv of own node as proxy
+   */
+  static Endpoint GrpcEndpoint(LinkContext* link_ctx,
+                               const std::string& local,
+                               const std::string& peer,
+                               const Node& peer_node,
+                               const Node& proxy_node,
+                               LinkContext* worker_link_ctx,
+                               bool forward) {
+    std::string send_key = local + "_" + peer;
+    std::string recv_key = peer + "_" + local;
+    auto send_channel = link_ctx->getChannel(peer_node);
+    std::shared_ptr<IChannel> recv_channel{nullptr};
+    if (forward) {
+      recv_channel = link_ctx->getChannel(proxy_node);
+    }
+    Endpoint ep;
+    ep.send = [send_channel, send_key](std::string_view data) {
+      return send_channel->send(send_key, data);
+    };
+    ep.recv = [recv_channel, recv_key, worker_link_ctx](char* buf,
+                                                        size_t size) {
+      std::string data;
+      if (recv_channel != nullptr) {
+        data = recv_channel->forwardRecv(recv_key);
+      } else {
+        worker_link_ctx->GetRecvQueue(recv_key).wait_and_pop(data);
+      }
+      if (data.size() != size) {
+        LOG(ERROR) << "expected: " << size << " received: " << data.size();
+        return retcode::FAIL;
+      }
+      memcpy(buf, data.data(), size);
+      return retcode::SUCCESS;
+    };
+    return ep;
+  }
+
+  static std::vector<std::string> ParseList(
+      const std::string& value, const std::vector<std::string>& all) {
+    if (value == "all") {
+      return all;
+    }
+    return absl::StrSplit(value, ',', absl::SkipEmpty());
+  }
+
+  retcode RunCase(const std::string& name, const std::string& pattern,
+                  uint64_t size, Transport* transport) {
+    uint64_t num = absl::GetFlag(FLAGS_bytes_per_case) / size;
+    num = std::max<uint64_t>(std::min(num, absl::GetFlag(FLAGS_rounds)), 2);
+    std::string send_buf(size, 'a');
+    std::string recv_buf(size, 0);
+    std::string peer_buf(size, 0);
+    bool pingpong = pattern == "pingpong";
+    if (!pingpong && pattern != "stream") {
+      LOG(ERROR) << "unknown pattern: " << pattern;
+      return retcode::FAIL;
+    }
+    // party b echoes every message in pingpong,
+    // and acks the whole stream by one byte
+    auto peer_fut = std::async(std::launch::async, [&]() -> retcode {
+      char ack{1};
+      for (uint64_t i = 0; i < num; ++i) {
+        if (transport->party_b.recv(peer_buf.data(), size) !=
+            retcode::SUCCESS) {
+          return retcode::FAIL;
+        }
+        if (pingpong &&
+            transport->party_b.send(peer_buf) != retcode::SUCCESS) {
+          return retcode::FAIL;
+        }
+      }
+      if (!pingpong) {
+        return transport->party_b.send(std::string_view(&ack, 1));
+      }
+      return retcode::SUCCESS;
+    });
+
+    std::vector<double> latency_us;
+    auto ret{retcode::SUCCESS};
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < num && ret == retcode::SUCCESS; ++i) {
+      auto msg_start = std::chrono::steady_clock::now();
+      ret = transport->party_a.send(send_buf);
+      if (ret == retcode::SUCCESS && pingpong) {
+        ret = transport->party_a.recv(recv_buf.data(), size);
+        std::chrono::duration<double, std::micro> cost =
+            std::chrono::steady_clock::now() - msg_start;
+        latency_us.push_back(cost.count());
+      }
+    }
+    if (ret == retcode::SUCCESS && !pingpong) {
+      char ack{0};
+      ret = transport->party_a.recv(&ack, 1);
+    }
+    std::chrono::duration<double> total =
+        std::chrono::steady_clock::now() - start;
+    auto peer_ret = peer_fut.get();
+    if (ret != retcode::SUCCESS || peer_ret != retcode::SUCCESS) {
+      return retcode::FAIL;
+    }
+    if (pingpong && recv_buf != send_buf) {
+      LOG(ERROR) << "echo data mismatch";
+      return retcode::FAIL;
+    }
+    if (!pingpong) {
+      // latency of a streamed message is not observable,
+      // report average cost per message instead
+      latency_us.assign(1, total.count() * 1e6 / num);
+    }
+    std::sort(latency_us.begin(), latency_us.end());
+    auto percentile = [&](double p) {
+      size_t index = static_cast<size_t>(p * (latency_us.size() - 1));
+      return latency_us[index];
+    };
+    double bytes = static_cast<double>(size) * num * (pingpong ? 2 : 1);
+    double mbps = bytes / total.count() / (1024 * 1024);
+    std::cout << std::left << std::setw(14) << name
+              << std::setw(10) << pattern
+              << std::setw(12) << size
+              << std::setw(8) << num
+              << std::fixed << std::setprecision(1)
+              << std::setw(12) << percentile(0.5)
+              << std::setw(12) << percentile(0.9)
+              << std::setw(12) << percentile(0.99)
+              << std::setw(12) << latency_us.back()
+              << std::setprecision(2) << mbps << std::endl;
+    return retcode::SUCCESS;
+  }
+
+  bool use_tls_{false};
+  common::CertificateConfig cert_config_;
+  Node node_a_;
+  Node node_b_;
+  std::unique_ptr<BenchNode> bench_node_a_{nullptr};
+  std::unique_ptr<BenchNode> bench_node_b_{nullptr};
+};
+}  // namespace
+}  // namespace primihub::network
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+  absl::ParseCommandLine(argc, argv);
+  primihub::network::LinkBench bench;
+  if (bench.Init() != primihub::retcode::SUCCESS) {
+    LOG(ERROR) << "init link bench failed";
+    return -1;
+  }
+  bench.Run();
+  bench.Stop();
+  return 0;
+}
@@ -0,0 +1,295 @@
+// Copyright [2023] <primihub.com>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "src/primihub/util/network/message_coalescer.h"
+
+using primihub::retcode;
+using primihub::network::CoalesceOption;
+using primihub::network::FrameSplitter;
+using primihub::network::MessageCoalescer;
+
+namespace {
+std::vector<std::string> BuildMessages() {
+  std::vector<std::string> messages;
+  for (int i = 0; i < 100; i++) {
+    messages.push_back(std::string(i % 10, 'a' + i % 26));
+  }
+  return messages;
+}
+
+std::vector<std::string> SplitFrames(const std::vector<std::string>& frames,
+                                     size_t num) {
+  FrameSplitter splitter;
+  size_t index = 0;
+  std::vector<std::string> messages;
+  for (size_t i = 0; i < num; i++) {
+    std::string message;
+    auto ret = splitter.Recv([&](std::string* frame) {
+      if (index >= frames.size()) {
+        return retcode::FAIL;
+      }
+      *frame = frames[index++];
+      return retcode::SUCCESS;
+    }, &message);
+    EXPECT_EQ(ret, retcode::SUCCESS);
+    messages.push_back(message);
+  }
+  EXPECT_EQ(index, frames.size());
+  return messages;
+}
+}  // namespace
+
+TEST(MessageCoalescerTest, split_by_frame_size) {
+  auto messages = BuildMessages();
+  std::vector<std::string> frames;
+  CoalesceOption option;
+  option.max_frame_size = 64;
+  option.max_delay_us = 1000 * 1000;
+  {
+    MessageCoalescer coalescer(option, [&](std::string_view frame) {
+      frames.emplace_back(frame);
+      return retcode::SUCCESS;
+    });
+    coalescer.SetPeerSupported();
+    for (const auto& message : messages) {
+      EXPECT_EQ(coalescer.Send(message), retcode::SUCCESS);
+    }
+    EXPECT_EQ(coalescer.Flush(), retcode::SUCCESS);
+    EXPECT_EQ(coalescer.messages(), messages.size());
+    // hello and switch are sent before frames
+    EXPECT_EQ(coalescer.frames(), frames.size() - 2);
+  }
+  EXPECT_LT(frames.size(), messages.size());
+  EXPECT_EQ(SplitFrames(frames, messages.size()), messages);
+}
+
+TEST(MessageCoalescerTest, flush_at_end_of_send_call) {
+  auto messages = BuildMessages();
+  std::vector<std::string> frames;
+  CoalesceOption option;
+  option.max_delay_us = 0;
+  MessageCoalescer coalescer(option, [&](std::string_view frame) {
+    frames.emplace_back(frame);
+    return retcode::SUCCESS;
+  });
+  coalescer.SetPeerSupported();
+  std::vector<std::string_view> batch(messages.begin(), messages.end());
+  EXPECT_EQ(coalescer.Send(batch), retcode::SUCCESS);
+  EXPECT_EQ(frames.size(), 3);
+  EXPECT_EQ(SplitFrames(frames, messages.size()), messages);
+}
+
+TEST(MessageCoalescerTest, flush_by_timer) {
+  std::vector<std::string> frames;
+  CoalesceOption option;
+  option.max_delay_us = 1000;
+  MessageCoalescer coalescer(option, [&](std::string_view frame) {
+    frames.emplace_back(frame);
+    return retcode::SUCCESS;
+  });
+  coalescer.SetPeerSupported();
+  EXPECT_EQ(coalescer.Send("hello"), retcode::SUCCESS);
+  EXPECT_EQ(coalescer.Send("world"), retcode::SUCCESS);
+  for (int i = 0; i < 100 && coalescer.frames() == 0; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(coalescer.frames(), 1);
+  EXPECT_EQ(coalescer.Flush(), retcode::SUCCESS);
+  ASSERT_EQ(frames.size(), 3);
+  std::vector<std::string> expected{"hello", "world"};
+  EXPECT_EQ(SplitFrames(frames, expected.size()), expected);
+}
+
+TEST(MessageCoalescerTest, large_message_sent_directly) {
+  std::vector<std::string> messages{"hello", std::string(128, 'x'), "world"};
+  std::vector<std::string> frames;
+  CoalesceOption option;
+  option.max_frame_size = 64;
+  option.max_delay_us = 1000 * 1000;
+  MessageCoalescer coalescer(option, [&](std::string_view frame) {
+    frames.emplace_back(frame);
+    return retcode::SUCCESS;
+  });
+  coalescer.SetPeerSupported();
+  for (const auto& message : messages) {
+    EXPECT_EQ(coalescer.Send(message), retcode::SUCCESS);
+  }
+  EXPECT_EQ(coalescer.Flush(), retcode::SUCCESS);
+  // hello, switch, frame of "hello", header and large message, frame of "world"
+  ASSERT_EQ(frames.size(), 6);
+  EXPECT_EQ(frames[4], messages[1]);
+  EXPECT_EQ(coalescer.messages(), 2);
+  EXPECT_EQ(SplitFrames(frames, messages.size()), messages);
+}
+
+TEST(MessageCoalescerTest, header_in_network_byte_order) {
+  std::string frame;
+  MessageCoalescer::Encode({"hello"}, &frame);
+  std::string expected_header{"\x00\x00\x00\x01"
+                              "\x00\x00\x00\x00\x00\x00\x00\x05", 12};
+  EXPECT_EQ(frame, expected_header + "hello");
+}
+
+TEST(MessageCoalescerTest, decode_corrupted_frame) {
+  std::string frame;
+  MessageCoalescer::Encode({"hello", "world"}, &frame);
+  std::deque<std::string> messages;
+  EXPECT_EQ(MessageCoalescer::Decode(frame, &messages), retcode::SUCCESS);
+  EXPECT_EQ(messages.size(), 2);
+  messages.clear();
+  frame.pop_back();
+  EXPECT_EQ(MessageCoalescer::Decode(frame, &messages), retcode::FAIL);
+  EXPECT_EQ(MessageCoalescer::Decode("ab", &messages), retcode::FAIL);
+}
+
+TEST(MessageCoalescerTest, split_into_buffer) {
+  std::vector<std::string> messages{"hello", std::string(128, 'x'), "world"};
+  std::vector<std::string> frames;
+  CoalesceOption option;
+  option.max_frame_size = 64;
+  option.max_delay_us = 0;
+  MessageCoalescer coalescer(option, [&](std::string_view frame) {
+    frames.emplace_back(frame);
+    return retcode::SUCCESS;
+  });
+  coalescer.SetPeerSupported();
+  std::vector<std::string_view> batch(messages.begin(), messages.end());
+  EXPECT_EQ(coalescer.Send(batch), retcode::SUCCESS);
+  FrameSplitter splitter;
+  size_t index = 0;
+  auto recv_fn = [&](std::string* frame) {
+    if (index >= frames.size()) {
+      return retcode::FAIL;
+    }
+    *frame = frames[index++];
+    return retcode::SUCCESS;
+  };
+  for (const auto& message : messages) {
+    std::string buf(message.size(), '\0');
+    ASSERT_EQ(splitter.Recv(recv_fn, buf.data(), buf.size()),
+              retcode::SUCCESS);
+    EXPECT_EQ(buf, message);
+  }
+  EXPECT_EQ(index, frames.size());
+  // size of message does not match the buffer
+  EXPECT_EQ(coalescer.Send("hello"), retcode::SUCCESS);
+  char buf[4];
+  EXPECT_EQ(splitter.Recv(recv_fn, buf, sizeof(buf)), retcode::FAIL);
+}
+
+TEST(MessageCoalescerTest, raw_until_peer_hello) {
+  std::vector<std::string> messages{"hello", "world"};
+  std::vector<std::string> frames;
+  CoalesceOption option;
+  option.max_delay_us = 0;
+  MessageCoalescer coalescer(option, [&](std::string_view frame) {
+    frames.emplace_back(frame);
+    return retcode::SUCCESS;
+  });
+  for (const auto& message : messages) {
+    EXPECT_EQ(coalescer.Send(message), retcode::SUCCESS);
+  }
+  // peer which never says hello receives messages as is
+  ASSERT_EQ(frames.size(), 3);
+  EXPECT_EQ(frames[0], MessageCoalescer::kHelloMessage);
+  EXPECT_EQ(frames[1], messages[0]);
+  EXPECT_EQ(frames[2], messages[1]);
+  EXPECT_EQ(coalescer.frames(), 0);
+  EXPECT_EQ(SplitFrames(frames, messages.size()), messages);
+  // size of raw message is checked against the buffer
+  FrameSplitter splitter;
+  size_t index = 0;
+  auto recv_fn = [&](std::string* frame) {
+    *frame = frames[index++];
+    return retcode::SUCCESS;
+  };
+  char buf[4];
+  EXPECT_EQ(splitter.Recv(recv_fn, buf, sizeof(buf)), retcode::FAIL);
+}
+
+TEST(MessageCoalescerTest, switch_to_frames_after_peer_hello) {
+  CoalesceOption option;
+  option.max_delay_us = 0;
+  // frames in flight of each direction of a link
+  std::deque<std::string> to_b;
+  std::deque<std::string> to_a;
+  MessageCoalescer coalescer_a(option, [&](std::string_view frame) {
+    to_b.emplace_back(frame);
+    return retcode::SUCCESS;
+  });
+  MessageCoalescer coalescer_b(option, [&](std::string_view frame) {
+    to_a.emplace_back(frame);
+    return retcode::SUCCESS;
+  });
+  FrameSplitter splitter_a;
+  FrameSplitter splitter_b;
+  splitter_a.SetPeerHelloHandler([&]() { coalescer_a.SetPeerSupported(); });
+  splitter_b.SetPeerHelloHandler([&]() { coalescer_b.SetPeerSupported(); });
+  auto recv_from = [](std::deque<std::string>* queue) {
+    return [queue](std::string* frame) {
+      if (queue->empty()) {
+        return retcode::FAIL;
+      }
+      *frame = std::move(queue->front());
+      queue->pop_front();
+      return retcode::SUCCESS;
+    };
+  };
+  std::string message;
+  // a does not know b yet, its first message is sent as is
+  ASSERT_EQ(coalescer_a.Send("ping"), retcode::SUCCESS);
+  ASSERT_EQ(splitter_b.Recv(recv_from(&to_b), &message), retcode::SUCCESS);
+  EXPECT_EQ(message, "ping");
+  // b has received hello of a, its reply is in a frame
+  ASSERT_EQ(coalescer_b.Send("pong"), retcode::SUCCESS);
+  EXPECT_EQ(coalescer_b.frames(), 1);
+  ASSERT_EQ(splitter_a.Recv(recv_from(&to_a), &message), retcode::SUCCESS);
+  EXPECT_EQ(message, "pong");
+  ASSERT_EQ(coalescer_a.Send("ping"), retcode::SUCCESS);
+  EXPECT_EQ(coalescer_a.frames(), 1);
+  ASSERT_EQ(splitter_b.Recv(recv_from(&to_b), &message), retcode::SUCCESS);
+  EXPECT_EQ(message, "ping");
+  EXPECT_TRUE(to_a.empty());
+  EXPECT_TRUE(to_b.empty());
+}
+
+TEST(MessageCoalescerTest, shared_timer_flushes_all_coalescers) {
+  CoalesceOption option;
+  option.max_delay_us = 1000;
+  std::mutex mtx;
+  size_t num_frames{0};
+  std::vector<std::unique_ptr<MessageCoalescer>> coalescers;
+  for (int i = 0; i < 50; i++) {
+    coalescers.push_back(std::make_unique<MessageCoalescer>(option,
+        [&](std::string_view frame) {
+          std::lock_guard<std::mutex> lck(mtx);
+          num_frames++;
+          return retcode::SUCCESS;
+        }));
+    coalescers.back()->SetPeerSupported();
+    EXPECT_EQ(coalescers.back()->Send("hello"), retcode::SUCCESS);
+  }
+  auto all_flushed = [&]() {
+    for (const auto& coalescer : coalescers) {
+      if (coalescer->frames() == 0) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (int i = 0; i < 100 && !all_flushed(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(all_flushed());
+  // coalescer with a pending deadline is destroyed safely
+  EXPECT_EQ(coalescers[0]->Send("world"), retcode::SUCCESS);
+  coalescers.clear();
+  // hello, switch and frame of each, plus the one flushed on destruction
+  EXPECT_EQ(num_frames, 50 * 3 + 1);
+}
@@ -0,0 +1,126 @@
+// Copyright [2023] <primihub.com>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "src/primihub/util/network/shm_channel.h"
+#include "src/primihub/util/network/shm_link_context.h"
+
+using primihub::network::ShmChannel;
+using primihub::network::ShmLinkContext;
+namespace ph_link = primihub::link;
+
+namespace {
+void EchoPeer(ShmLinkContext* link_ctx, size_t num) {
+  ShmChannel channel("party_1", "party_0", link_ctx, 4096);
+  for (size_t i = 0; i < num; i++) {
+    std::string data;
+    ASSERT_EQ(channel.RecvImpl(&data), ph_link::retcode::SUCCESS);
+    ASSERT_EQ(channel.SendImpl(data), ph_link::retcode::SUCCESS);
+  }
+}
+}  // namespace
+
+TEST(ShmChannelTest, echo_messages_larger_than_ring) {
+  ShmLinkContext link_ctx;
+  link_ctx.setTaskInfo("job", "task", "shm_channel_test", "0");
+  link_ctx.setRecvTimeout(10 * 1000);
+  std::vector<std::string> messages{"", "a", std::string(4096, 'b'),
+                                    std::string(100000, 'c')};
+  auto peer = std::async(std::launch::async, EchoPeer, &link_ctx,
+                         messages.size());
+  ShmChannel channel("party_0", "party_1", &link_ctx, 4096);
+  for (const auto& message : messages) {
+    ASSERT_EQ(channel.SendImpl(message), ph_link::retcode::SUCCESS);
+    std::string recv_data(message.size(), 0);
+    ASSERT_EQ(channel.RecvImpl(recv_data.data(), recv_data.size()),
+              ph_link::retcode::SUCCESS);
+    EXPECT_EQ(recv_data, message);
+  }
+  peer.get();
+}
+
+TEST(ShmChannelTest, recv_fails_after_peer_closed) {
+  ShmLinkContext link_ctx;
+  link_ctx.setTaskInfo("job", "task", "shm_channel_close_test", "0");
+  ShmChannel channel("party_0", "party_1", &link_ctx, 4096);
+  {
+    ShmChannel peer("party_1", "party_0", &link_ctx, 4096);
+    ASSERT_EQ(peer.SendImpl(std::string("last")), ph_link::retcode::SUCCESS);
+  }
+  std::string data;
+  // data sent before close is still delivered
+  ASSERT_EQ(channel.RecvImpl(&data), ph_link::retcode::SUCCESS);
+  EXPECT_EQ(data, "last");
+  EXPECT_EQ(channel.RecvImpl(&data), ph_link::retcode::FAIL);
+}
+
+TEST(ShmChannelTest, concurrent_senders_do_not_interleave) {
+  ShmLinkContext link_ctx;
+  link_ctx.setTaskInfo("job", "task", "shm_channel_concurrent_test", "0");
+  ShmChannel channel("party_0", "party_1", &link_ctx, 4096);
+  ShmChannel peer("party_1", "party_0", &link_ctx, 4096);
+  size_t num = 200;
+  // each sender fills its messages with its own char
+  auto sender = [&](char c) {
+    for (size_t i = 0; i < num; i++) {
+      std::string data(100 + i * 50, c);
+      ASSERT_EQ(channel.SendImpl(data), ph_link::retcode::SUCCESS);
+    }
+  };
+  std::thread sender_a(sender, 'a');
+  std::thread sender_b(sender, 'b');
+  size_t count_a{0};
+  size_t count_b{0};
+  for (size_t i = 0; i < 2 * num; i++) {
+    std::string data;
+    ASSERT_EQ(peer.RecvImpl(&data), ph_link::retcode::SUCCESS);
+    ASSERT_FALSE(data.empty());
+    char c = data[0];
+    ASSERT_EQ(data, std::string(data.size(), c));
+    // messages of one sender arrive in order
+    if (c == 'a') {
+      EXPECT_EQ(data.size(), 100 + count_a++ * 50);
+    } else {
+      EXPECT_EQ(data.size(), 100 + count_b++ * 50);
+    }
+  }
+  sender_a.join();
+  sender_b.join();
+  EXPECT_EQ(count_a, num);
+  EXPECT_EQ(count_b, num);
+}
+
+TEST(ShmChannelTest, recv_size_mismatch_keeps_channel_aligned) {
+  ShmLinkContext link_ctx;
+  link_ctx.setTaskInfo("job", "task", "shm_channel_mismatch_test", "0");
+  ShmChannel channel("party_0", "party_1", &link_ctx, 4096);
+  ShmChannel peer("party_1", "party_0", &link_ctx, 4096);
+  // message is larger than ring, sent while receiver drains it
+  auto sender = std::async(std::launch::async, [&]() {
+    EXPECT_EQ(peer.SendImpl(std::string(10000, 'x')),
+              ph_link::retcode::SUCCESS);
+    EXPECT_EQ(peer.SendImpl(std::string("next")), ph_link::retcode::SUCCESS);
+  });
+  std::string buf(8, 0);
+  EXPECT_EQ(channel.RecvImpl(buf.data(), buf.size()), ph_link::retcode::FAIL);
+  std::string data;
+  ASSERT_EQ(channel.RecvImpl(&data), ph_link::retcode::SUCCESS);
+  EXPECT_EQ(data, "next");
+  sender.get();
+}
+
+TEST(ShmChannelTest, peer_never_attaches) {
+  ShmLinkContext link_ctx;
+  link_ctx.setTaskInfo("job", "task", "shm_channel_no_peer_test", "0");
+  link_ctx.setRecvTimeout(200);
+  link_ctx.setSendTimeout(200);
+  ShmChannel channel("party_0", "party_1", &link_ctx, 4096);
+  std::string data;
+  EXPECT_EQ(channel.RecvImpl(&data), ph_link::retcode::FAIL);
+  // message larger than ring can not be written without reader
+  EXPECT_EQ(channel.SendImpl(std::string(8192, 'x')), ph_link::retcode::FAIL);
+  // the rest of the broken message is never sent, later sends fail fast
+  EXPECT_EQ(channel.SendImpl(std::string("a")), ph_link::retcode::FAIL);
+}
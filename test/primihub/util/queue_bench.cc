@@ -0,0 +1,101 @@
+// Copyright [2023] <primihub.com>
+/**
+ * throughput of ThreadSafeQueue and LockFreeQueue carrying std::string,
+ * the item type of LinkContext recv/send queues.
+ * each case runs producers pushing and consumers waiting on the queue
+ * like grpc service threads and channels do.
+ * usage:
+ *   queue_bench --items=1000000 --item_size=64 --cases=1x1,4x1,4x4
+ */
+#include <glog/logging.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "src/primihub/util/lockfree_queue.h"
+#include "src/primihub/util/threadsafe_queue.h"
+
+ABSL_FLAG(uint64_t, items, 1000000, "items pushed in each case");
+ABSL_FLAG(uint64_t, item_size, 64, "size of each string item in bytes");
+ABSL_FLAG(std::string, cases, "1x1,4x1,4x4",
+          "comma separated producers x consumers");
+
+namespace primihub {
+namespace {
+template <typename Queue>
+double RunCase(size_t producers, size_t consumers, size_t items,
+               size_t item_size) {
+  Queue queue;
+  size_t per_producer = items / producers;
+  size_t total = per_producer * producers;
+  std::atomic<size_t> popped{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < consumers; i++) {
+    threads.emplace_back([&]() {
+      std::string item;
+      while (popped.load(std::memory_order_relaxed) < total) {
+        if (queue.wait_for_and_pop(item, 10)) {
+          popped.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (size_t i = 0; i < producers; i++) {
+    threads.emplace_back([&]() {
+      for (size_t j = 0; j < per_producer; j++) {
+        queue.push(std::string(item_size, 'x'));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return total / elapsed.count();
+}
+}  // namespace
+}  // namespace primihub
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  auto items = absl::GetFlag(FLAGS_items);
+  auto item_size = absl::GetFlag(FLAGS_item_size);
+  std::cout << std::setw(8) << "case"
+            << std::setw(20) << "ThreadSafeQueue"
+            << std::setw(20) << "LockFreeQueue"
+            << std::setw(10) << "speedup" << std::endl;
+  for (auto& c : absl::StrSplit(absl::GetFlag(FLAGS_cases), ',')) {
+    std::vector<std::string> num = absl::StrSplit(c, 'x');
+    size_t producers{0};
+    size_t consumers{0};
+    if (num.size() != 2 ||
+        !absl::SimpleAtoi(num[0], &producers) ||
+        !absl::SimpleAtoi(num[1], &consumers) ||
+        producers == 0 || consumers == 0) {
+      LOG(ERROR) << "invalid case: " << c;
+      return -1;
+    }
+    using primihub::RunCase;
+    auto mutex_ops = RunCase<primihub::ThreadSafeQueue<std::string>>(
+        producers, consumers, items, item_size);
+    auto lockfree_ops = RunCase<primihub::LockFreeQueue<std::string>>(
+        producers, consumers, items, item_size);
+    std::cout << std::setw(8) << c << std::fixed << std::setprecision(0)
+              << std::setw(14) << mutex_ops << " ops/s"
+              << std::setw(14) << lockfree_ops << " ops/s"
+              << std::setprecision(2)
+              << std::setw(9) << lockfree_ops / mutex_ops << "x" << std::endl;
+  }
+  return 0;
+}